@@ -245,7 +245,7 @@ Rectangle {
 
                             Rectangle {
                                 Layout.fillWidth: true
-                                height: 70
+                                height: 96
                                 color: Qt.rgba(0,0,0,0.1)
                                 radius: 4
 
@@ -283,6 +283,20 @@ Rectangle {
                                         font.family: "Consolas, monospace"
                                         Layout.fillWidth: true
                                     }
+
+                                    Text {
+                                        text: "航程:"
+                                        color: textColor
+                                        font.pixelSize: fontSize
+                                    }
+
+                                    Text {
+                                        text: (vesselModule.odometer / 1000).toFixed(2) + " km"
+                                        color: accentColor
+                                        font.pixelSize: fontSize
+                                        font.family: "Consolas, monospace"
+                                        Layout.fillWidth: true
+                                    }
                                 }
                             }
                         }
@@ -1398,12 +1398,8 @@ Window {
                                 }
 
                                 onClicked: {
-                                    // 重置图表缩放
-                                    if (chartTypeSelector.currentIndex === 0 || chartTypeSelector.currentIndex === 1) {
-                                        // 折线图或面积图
-                                        timeAxis.min = chartData[0] ? chartData[0].x : new Date(2023, 0, 1);
-                                        timeAxis.max = chartData[chartData.length-1] ? chartData[chartData.length-1].x : new Date(2023, 11, 31);
-                                    }
+                                    // 重置图表缩放：回到所选日期范围
+                                    resetChartView();
                                 }
                             }
                         }
@@ -1485,6 +1481,31 @@ Window {
                                 name: "严重阈值"
                                 visible: false
                             }
+
+                            // 拖动平移、滚轮缩放；数据由 historyCache 按可见范围拼接
+                            MouseArea {
+                                anchors.fill: parent
+                                acceptedButtons: Qt.LeftButton
+                                property real lastX: 0
+
+                                onPressed: lastX = mouse.x
+                                onPositionChanged: {
+                                    panChart(mouse.x - lastX);
+                                    lastX = mouse.x;
+                                }
+                                onWheel: {
+                                    zoomChart(wheel.x, wheel.angleDelta.y > 0 ? 0.8 : 1.25);
+                                }
+                                onDoubleClicked: resetChartView()
+                            }
+
+                            BusyIndicator {
+                                anchors.centerIn: parent
+                                running: historyCache.loading
+                                visible: running
+                            }
+
+                            Component.onCompleted: updateChart()
                         }
                     }
                 }
@@ -2063,6 +2084,7 @@ Window {
 
                                             // 原始数据线
                                             LineSeries {
+                                                id: trendRawSeries
                                                 name: "原始数据"
                                                 axisX: trendTimeAxis
                                                 axisY: trendValueAxis
@@ -2070,7 +2092,7 @@ Window {
                                                 width: 1.5
                                                 pointsVisible: false
 
-                                                // 动态生成的示例数据点
+                                                // 切换到趋势分析视图时由 updateAnalysis 发起计算
                                                 Component.onCompleted: {
                                                     generateTrendData();
                                                 }
@@ -2078,7 +2100,8 @@ Window {
 
                                             // 移动平均线
                                             LineSeries {
-                                                name: "移动平均 (24小时)"
+                                                id: trendAverageSeries
+                                                name: "移动平均 (" + trendWindowHours.toFixed(trendWindowHours < 10 ? 1 : 0) + "小时)"
                                                 axisX: trendTimeAxis
                                                 axisY: trendValueAxis
                                                 color: successColor
@@ -2092,8 +2115,32 @@ Window {
                                                 }
                                             }
 
+                                            // 滚动标准差带
+                                            LineSeries {
+                                                id: trendUpperSeries
+                                                name: "±2σ 区间"
+                                                axisX: trendTimeAxis
+                                                axisY: trendValueAxis
+                                                color: Qt.rgba(successColor.r, successColor.g, successColor.b, 0.6)
+                                                width: 1
+                                                style: Qt.DotLine
+                                                pointsVisible: false
+                                            }
+
+                                            LineSeries {
+                                                id: trendLowerSeries
+                                                name: ""
+                                                axisX: trendTimeAxis
+                                                axisY: trendValueAxis
+                                                color: Qt.rgba(successColor.r, successColor.g, successColor.b, 0.6)
+                                                width: 1
+                                                style: Qt.DotLine
+                                                pointsVisible: false
+                                            }
+
                                             // 趋势线
                                             LineSeries {
+                                                id: trendLineSeries
                                                 name: "线性趋势"
                                                 axisX: trendTimeAxis
                                                 axisY: trendValueAxis
@@ -2110,16 +2157,19 @@ Window {
 
                                             // 警戒阈值线
                                             LineSeries {
+                                                id: trendWarningSeries
                                                 name: "警戒阈值"
                                                 axisX: trendTimeAxis
                                                 axisY: trendValueAxis
                                                 color: warningColor
                                                 width: 1.5
                                                 style: Qt.DashLine
+                                            }
 
-                                                // 固定的警戒线
-                                                XYPoint { x: new Date(2023, 10, 1, 0, 0).getTime(); y: 1000 }
-                                                XYPoint { x: new Date(2023, 10, 7, 23, 59).getTime(); y: 1000 }
+                                            BusyIndicator {
+                                                anchors.centerIn: parent
+                                                running: trendAnalyzer.busy
+                                                visible: running
                                             }
                                         }
                                     }
@@ -2170,12 +2220,12 @@ Window {
                                                             width: 16
                                                             height: 16
                                                             radius: 8
-                                                            color: dangerColor
+                                                            color: trendDirectionColor()
                                                         }
 
                                                         Text {
-                                                            text: "上升 (+2.3%/天)"
-                                                            color: dangerColor
+                                                            text: trendDirectionText()
+                                                            color: trendDirectionColor()
                                                             font.bold: true
                                                         }
                                                     }
@@ -2187,7 +2237,7 @@ Window {
                                                     }
 
                                                     Text {
-                                                        text: "+14.8 ppm/天"
+                                                        text: trendStats.count ? formatTrendValue(trendStats.slopePerDay, true) + "/天" : "--"
                                                         color: textColor
                                                     }
 
@@ -2198,7 +2248,7 @@ Window {
                                                     }
 
                                                     Text {
-                                                        text: "检测到每日波动模式"
+                                                        text: !trendStats.count ? "--" : hasDailyPattern() ? "检测到每日波动模式" : "无明显日内规律"
                                                         color: textColor
                                                     }
 
@@ -2209,7 +2259,7 @@ Window {
                                                     }
 
                                                     Text {
-                                                        text: "通常在14:00-16:00"
+                                                        text: trendStats.peakHour >= 0 ? "通常在" + formatHourRange(trendStats.peakHour) : "--"
                                                         color: textColor
                                                     }
 
@@ -2220,12 +2270,12 @@ Window {
                                                     }
 
                                                     Text {
-                                                        text: "通常在03:00-05:00"
+                                                        text: trendStats.troughHour >= 0 ? "通常在" + formatHourRange(trendStats.troughHour) : "--"
                                                         color: textColor
                                                     }
 
                                                     Text {
-                                                        text: "预测信度:"
+                                                        text: "拟合优度 R²:"
                                                         font.bold: true
                                                         color: textColor
                                                     }
@@ -2240,7 +2290,7 @@ Window {
                                                             color: Qt.rgba(0.2, 0.2, 0.2, 1)
 
                                                             Rectangle {
-                                                                width: parent.width * 0.85
+                                                                width: parent.width * (trendStats.r2 || 0)
                                                                 height: parent.height
                                                                 radius: 4
                                                                 color: accentColor
@@ -2248,7 +2298,7 @@ Window {
                                                         }
 
                                                         Text {
-                                                            text: "85%"
+                                                            text: trendStats.count ? trendStats.r2.toFixed(2) : "--"
                                                             color: textColor
                                                         }
                                                     }
@@ -2280,44 +2330,16 @@ Window {
                                                         anchors.margins: 10
                                                         spacing: 10
 
-                                                        Text {
-                                                            text: "• 数据显示<b>明显的上升趋势</b>，若继续此趋势，预计3天后将持续超过警戒阈值"
-                                                            color: textColor
-                                                            font.pixelSize: smallFontSize
-                                                            wrapMode: Text.WordWrap
-                                                            Layout.fillWidth: true
-                                                        }
+                                                        Repeater {
+                                                            model: trendInsights()
 
-                                                        Text {
-                                                            text: "• 检测到<b>明显的每日周期性变化</b>，峰值出现在下午(14:00-16:00)，符合典型的工作时间模式"
-                                                            color: textColor
-                                                            font.pixelSize: smallFontSize
-                                                            wrapMode: Text.WordWrap
-                                                            Layout.fillWidth: true
-                                                        }
-
-                                                        Text {
-                                                            text: "• 波动幅度逐日增大，表明环境稳定性<b>正在下降</b>"
-                                                            color: textColor
-                                                            font.pixelSize: smallFontSize
-                                                            wrapMode: Text.WordWrap
-                                                            Layout.fillWidth: true
-                                                        }
-
-                                                        Text {
-                                                            text: "• <b>建议</b>: 检查通风系统是否正常工作，考虑在14:00-16:00增加换气频率"
-                                                            color: textColor
-                                                            font.pixelSize: smallFontSize
-                                                            wrapMode: Text.WordWrap
-                                                            Layout.fillWidth: true
-                                                        }
-
-                                                        Text {
-                                                            text: "• <b>建议</b>: 设置预警系统，当浓度达到900ppm时提前预警"
-                                                            color: textColor
-                                                            font.pixelSize: smallFontSize
-                                                            wrapMode: Text.WordWrap
-                                                            Layout.fillWidth: true
+                                                            Text {
+                                                                text: "• " + modelData
+                                                                color: textColor
+                                                                font.pixelSize: smallFontSize
+                                                                wrapMode: Text.WordWrap
+                                                                Layout.fillWidth: true
+                                                            }
                                                         }
 
                                                         Item { Layout.fillHeight: true }
@@ -2384,6 +2406,7 @@ Window {
 
                                             // 原始数据线
                                             LineSeries {
+                                                id: anomalyRawSeries
                                                 name: "原始数据"
                                                 axisX: anomalyTimeAxis
                                                 axisY: anomalyValueAxis
@@ -2391,7 +2414,7 @@ Window {
                                                 width: 1.5
                                                 pointsVisible: false
 
-                                                // 使用与趋势分析相同的数据生成
+                                                // 切换到异常检测视图时由 updateAnalysis 发起批量检测
                                                 Component.onCompleted: {
                                                     generateAnomalyData();
                                                 }
@@ -2399,6 +2422,7 @@ Window {
 
                                             // 预期范围上边界
                                             LineSeries {
+                                                id: anomalyUpperSeries
                                                 name: "正常范围上限"
                                                 axisX: anomalyTimeAxis
                                                 axisY: anomalyValueAxis
@@ -2414,6 +2438,7 @@ Window {
 
                                             // 预期范围下边界
                                             LineSeries {
+                                                id: anomalyLowerSeries
                                                 name: "正常范围下限"
                                                 axisX: anomalyTimeAxis
                                                 axisY: anomalyValueAxis
@@ -2429,17 +2454,18 @@ Window {
 
                                             // 异常点
                                             ScatterSeries {
+                                                id: anomalyPointSeries
                                                 name: "检测到的异常"
                                                 axisX: anomalyTimeAxis
                                                 axisY: anomalyValueAxis
                                                 color: dangerColor
                                                 markerSize: 12
+                                            }
 
-                                                // 预设的异常点
-                                                XYPoint { x: new Date(2023, 10, 2, 15, 45).getTime(); y: 1102 }
-                                                XYPoint { x: new Date(2023, 10, 4, 9, 30).getTime(); y: 342 }
-                                                XYPoint { x: new Date(2023, 10, 5, 14, 23).getTime(); y: 1198 }
-                                                XYPoint { x: new Date(2023, 10, 6, 21, 10).getTime(); y: 978 }
+                                            BusyIndicator {
+                                                anchors.centerIn: parent
+                                                running: anomalyMonitor.busy
+                                                visible: running
                                             }
                                         }
                                     }
@@ -2469,7 +2495,7 @@ Window {
                                                 }
 
                                                 Text {
-                                                    text: "4个"
+                                                    text: anomalyTotal + "个"
                                                     color: textColor
                                                 }
 
@@ -2480,7 +2506,7 @@ Window {
                                                 }
 
                                                 Text {
-                                                    text: "0.32%"
+                                                    text: anomalySamples > 0 ? (anomalyTotal * 100 / anomalySamples).toFixed(2) + "%" : "--"
                                                     color: textColor
                                                 }
 
@@ -2491,8 +2517,8 @@ Window {
                                                 }
 
                                                 Text {
-                                                    text: "11月5日 14:23 (1198 ppm)"
-                                                    color: dangerColor
+                                                    text: anomalyWorst ? anomalyDescription(anomalyWorst) : "无"
+                                                    color: anomalyWorst ? dangerColor : textColor
                                                 }
 
                                                 Text {
@@ -2502,37 +2528,28 @@ Window {
                                                 }
 
                                                 Text {
-                                                    text: "季节性分解+IQR"
+                                                    text: anomalyMonitor.mode === 0 ? "EWMA z 分数" : "中位数/MAD"
                                                     color: textColor
+
+                                                    MouseArea {
+                                                        anchors.fill: parent
+                                                        cursorShape: Qt.PointingHandCursor
+                                                        onClicked: {
+                                                            anomalyMonitor.mode = anomalyMonitor.mode === 0 ? 1 : 0;
+                                                            generateAnomalyData();
+                                                        }
+                                                    }
                                                 }
 
                                                 Text {
-                                                    text: "置信度:"
+                                                    text: "样本数:"
                                                     font.bold: true
                                                     color: textColor
                                                 }
 
-                                                RowLayout {
-                                                    spacing: 5
-
-                                                    Rectangle {
-                                                        width: 80
-                                                        height: 8
-                                                        radius: 4
-                                                        color: Qt.rgba(0.2, 0.2, 0.2, 1)
-
-                                                        Rectangle {
-                                                            width: parent.width * 0.92
-                                                            height: parent.height
-                                                            radius: 4
-                                                            color: accentColor
-                                                        }
-                                                    }
-
-                                                    Text {
-                                                        text: "92%"
-                                                        color: textColor
-                                                    }
+                                                Text {
+                                                    text: anomalySamples + " (耗时 " + anomalyElapsedMs.toFixed(0) + " ms)"
+                                                    color: textColor
                                                 }
                                             }
 
@@ -2546,7 +2563,7 @@ Window {
                                                 ListView {
                                                     anchors.fill: parent
                                                     anchors.margins: 5
-                                                    model: 4
+                                                    model: anomalyListModel
                                                     clip: true
 
                                                     delegate: Rectangle {
@@ -2581,36 +2598,21 @@ Window {
                                                                 spacing: 2
 
                                                                 Text {
-                                                                    text: {
-                                                                        if (index === 0) return "11月5日 14:23 - 数值异常高 (1198 ppm)";
-                                                                        if (index === 1) return "11月6日 21:10 - 超出预期模式 (978 ppm)";
-                                                                        if (index === 2) return "11月2日 15:45 - 数值异常高 (1102 ppm)";
-                                                                        return "11月4日 9:30 - 数值异常低 (342 ppm)";
-                                                                    }
+                                                                    text: model.title
                                                                     color: textColor
                                                                     font.pixelSize: fontSize
                                                                 }
 
                                                                 Text {
-                                                                    text: {
-                                                                        if (index === 0) return "偏离预期: +45.3%, 可能原因: 通风系统故障";
-                                                                        if (index === 1) return "偏离预期: +22.8%, 可能原因: 非工作时间活动";
-                                                                        if (index === 2) return "偏离预期: +38.2%, 可能原因: 人员密度异常";
-                                                                        return "偏离预期: -48.7%, 可能原因: 传感器故障或校准错误";
-                                                                    }
+                                                                    text: model.detail
                                                                     color: Qt.rgba(textColor.r, textColor.g, textColor.b, 0.7)
                                                                     font.pixelSize: smallFontSize
                                                                 }
                                                             }
 
-                                                            // 置信度
+                                                            // 偏离程度（z 分数）
                                                             Text {
-                                                                text: {
-                                                                    if (index === 0) return "98%";
-                                                                    if (index === 1) return "85%";
-                                                                    if (index === 2) return "95%";
-                                                                    return "92%";
-                                                                }
+                                                                text: model.score
                                                                 color: accentColor
                                                                 font.bold: true
                                                             }
@@ -2780,21 +2782,21 @@ Window {
 
                                         Item { Layout.fillWidth: true }
 
-                                        // 相关性计算方法
+                                        // 数据范围：查询时间段或实时窗口
                                         Text {
-                                            text: "相关性方法:"
+                                            text: "数据范围:"
                                             color: textColor
                                             font.pixelSize: fontSize
                                         }
 
                                         ComboBox {
-                                            id: correlationMethodCombo
+                                            id: correlationSourceCombo
                                             Layout.preferredWidth: 150
-                                            model: ["皮尔逊相关系数", "斯皮尔曼等级相关", "肯德尔秩相关"]
+                                            model: ["查询时间段", "实时窗口"]
                                             currentIndex: 0
 
                                             contentItem: Text {
-                                                text: correlationMethodCombo.displayText
+                                                text: correlationSourceCombo.displayText
                                                 color: textColor
                                                 font.pixelSize: fontSize
                                                 verticalAlignment: Text.AlignVCenter
@@ -2923,7 +2925,7 @@ Window {
 
                                                         Text {
                                                             id: correlationValueText
-                                                            text: "+0.74"
+                                                            text: formatCorrelation(correlationPair.r)
                                                             color: accentColor
                                                             font.bold: true
                                                             font.pixelSize: 32
@@ -2932,7 +2934,7 @@ Window {
                                                         }
 
                                                         Text {
-                                                            text: "强正相关"
+                                                            text: correlationStrength(correlationPair.r)
                                                             color: textColor
                                                             font.pixelSize: fontSize
                                                             horizontalAlignment: Text.AlignHCenter
@@ -2956,8 +2958,8 @@ Window {
                                                     }
 
                                                     Text {
-                                                        text: "p < 0.001 (高度显著)"
-                                                        color: successColor
+                                                        text: correlationSignificance(correlationPair.pValue)
+                                                        color: correlationPair.pValue < 0.05 ? successColor : textColor
                                                     }
 
                                                     Text {
@@ -2967,7 +2969,7 @@ Window {
                                                     }
 
                                                     Text {
-                                                        text: "0.55"
+                                                        text: isFinite(correlationPair.r2) ? correlationPair.r2.toFixed(2) : "--"
                                                         color: textColor
                                                     }
 
@@ -2978,7 +2980,7 @@ Window {
                                                     }
 
                                                     Text {
-                                                        text: "Y = 0.012X + 14.82"
+                                                        text: correlationEquation()
                                                         color: textColor
                                                         font.family: "Consolas, monospace"
                                                     }
@@ -2990,7 +2992,7 @@ Window {
                                                     }
 
                                                     Text {
-                                                        text: "1,246"
+                                                        text: correlationPair.count !== undefined ? Number(correlationPair.count).toLocaleString(Qt.locale(), "f", 0) : "--"
                                                         color: textColor
                                                     }
                                                 }
@@ -3014,52 +3016,16 @@ Window {
                                                     anchors.margins: 10
                                                     spacing: 10
 
-                                                    Text {
-                                                        text: "• CO₂与空气温度显示<b>强正相关(r = +0.74)</b>，表明两者有显著关联"
-                                                        color: textColor
-                                                        font.pixelSize: smallFontSize
-                                                        wrapMode: Text.WordWrap
-                                                        Layout.fillWidth: true
-                                                    }
-
-                                                    Text {
-                                                        text: "• 相关性<b>高度显著</b> (p < 0.001)，证明此关联不是随机发生的"
-                                                        color: textColor
-                                                        font.pixelSize: smallFontSize
-                                                        wrapMode: Text.WordWrap
-                                                        Layout.fillWidth: true
-                                                    }
-
-                                                    Text {
-                                                        text: "• R² = 0.55表示CO₂浓度变化可解释约<b>55%</b>的空气温度变化"
-                                                        color: textColor
-                                                        font.pixelSize: smallFontSize
-                                                        wrapMode: Text.WordWrap
-                                                        Layout.fillWidth: true
-                                                    }
-
-                                                    Text {
-                                                        text: "• 关联可能反映了<b>人类活动</b>同时影响两个参数：人员活动增加了CO₂排放并提高了室内温度"
-                                                        color: textColor
-                                                        font.pixelSize: smallFontSize
-                                                        wrapMode: Text.WordWrap
-                                                        Layout.fillWidth: true
-                                                    }
-
-                                                    Text {
-                                                        text: "• <b>建议</b>: 考虑温度作为CO₂浓度变化的辅助指标，或将两者结合用于环境质量评估"
-                                                        color: textColor
-                                                        font.pixelSize: smallFontSize
-                                                        wrapMode: Text.WordWrap
-                                                        Layout.fillWidth: true
-                                                    }
+                                                    Repeater {
+                                                        model: correlationInsights()
 
-                                                    Text {
-                                                        text: "• <b>建议</b>: 进一步调查是否存在共同的外部因素同时影响这两个参数"
-                                                        color: textColor
-                                                        font.pixelSize: smallFontSize
-                                                        wrapMode: Text.WordWrap
-                                                        Layout.fillWidth: true
+                                                        Text {
+                                                            text: "• " + modelData
+                                                            color: textColor
+                                                            font.pixelSize: smallFontSize
+                                                            wrapMode: Text.WordWrap
+                                                            Layout.fillWidth: true
+                                                        }
                                                     }
 
                                                     Item { Layout.fillHeight: true }
@@ -4031,8 +3997,87 @@ Window {
         }
     }
 
-    // 图表数据数组
-    property var chartData: []
+    // 历史图表：数据由 historyCache 按可见范围分段读取、拼接
+    property int chartRequestId: 0
+    property var chartDataSeries: null      // 接收数据的系列（面积图为上边界）
+    property var chartLowerSeries: null     // 面积图下边界
+
+    Connections {
+        target: historyCache
+        function onViewReady(requestId, stats) {
+            if (requestId !== historyDataWindow.chartRequestId) return;
+            applyChartView(stats);
+        }
+    }
+
+    // 平移、缩放时合并连续的视图变化
+    Timer {
+        id: chartViewTimer
+        interval: 50
+        onTriggered: requestChartView()
+    }
+
+    // 运行时修改告警阈值后重画警戒线与趋势外推
+    Connections {
+        target: alarmEngine
+        function onThresholdsChanged() {
+            updateThresholdLines(chartSensorCombo.currentText);
+            if (trendStats.count > 0) applyTrendResult(trendStats);
+        }
+    }
+
+    // 异常检测结果
+    ListModel { id: anomalyListModel }
+    property int anomalyRequestId: 0
+    property string anomalyKey: ""
+    property var anomalySeries: []
+    property var anomalyWorst: null
+    property int anomalyTotal: 0
+    property int anomalySamples: 0
+    property real anomalyElapsedMs: 0
+
+    // 趋势分析结果
+    property int trendRequestId: 0
+    property var trendStats: ({})
+    property real trendWindowHours: 24
+
+    Connections {
+        target: trendAnalyzer
+        function onAnalysisFinished(requestId, key, stats, elapsedMs) {
+            if (requestId !== historyDataWindow.trendRequestId) return;
+            applyTrendResult(stats);
+        }
+    }
+
+    // 相关性结果
+    property int correlationRequestId: 0
+    property var correlationMatrix: []
+    property var correlationPair: ({})
+
+    Connections {
+        target: correlationEngine
+        function onRangeFinished(requestId, matrix, pair, samples, elapsedMs) {
+            if (requestId !== historyDataWindow.correlationRequestId) return;
+            applyCorrelationResult(matrix, pair);
+        }
+    }
+
+    // 实时窗口每秒刷新
+    Timer {
+        interval: 1000
+        repeat: true
+        running: historyDataWindow.visible && analysisTypeCombo.currentIndex === 3 &&
+                 correlationSourceCombo.currentIndex === 1
+        onTriggered: updateCorrelationAnalysis()
+    }
+
+    Connections {
+        target: anomalyMonitor
+        function onBatchFinished(requestId, key, series, anomalies, samples, total, elapsedMs) {
+            if (requestId !== historyDataWindow.anomalyRequestId) return;
+            applyAnomalyResult(key, series, anomalies, samples, total, elapsedMs);
+        }
+    }
 
     // 添加示例数据
     function addExampleData() {
@@ -4096,6 +4141,7 @@ Window {
     function queryData() {
         // 这里应实现实际查询逻辑，现在仅显示示例数据
         addExampleData();
+        resetChartView();
 
         // 显示提示信息
         if (warningMessage) {
@@ -4172,7 +4218,7 @@ Window {
         }
     }
 
-    // 更新图表函数
+    // 更新图表函数：按所选传感器与图表类型重建系列，数据由 historyCache 异步填充
     function updateChart() {
         // 清空图表
         if (historyChart.series.length > 2) { // 保留警戒线
@@ -4180,6 +4226,7 @@ Window {
                 historyChart.removeSeries(historyChart.series[i]);
             }
         }
+        chartLowerSeries = null;
 
         // 根据选择的传感器和图表类型创建数据系列
         var sensor = chartSensorCombo.currentText;
@@ -4189,122 +4236,202 @@ Window {
         // 更新Y轴标题
         valueAxis.titleText = sensor + (sensorUnit ? " (" + sensorUnit + ")" : "");
 
-        // 生成或加载数据
-        generateChartData(sensor);
-
         // 根据图表类型创建数据系列
         switch(chartType) {
-            case 0: // 折线图
-                createLineSeries(sensor, chartData);
-                break;
-            case 1: // 面积图
-                createAreaSeries(sensor, chartData);
+            case 1: // 面积图：最小值到最大值的包络
+                var area = createAreaSeries(sensor, []);
+                chartDataSeries = area.upperSeries;
+                chartLowerSeries = area.lowerSeries;
                 break;
             case 2: // 柱状图
-                createBarSeries(sensor, chartData);
+                chartDataSeries = createBarSeries(sensor, []);
                 break;
             case 3: // 散点图
-                createScatterSeries(sensor, chartData);
+                chartDataSeries = createScatterSeries(sensor, []);
                 break;
-            default:
-                createLineSeries(sensor, chartData);
+            default: // 折线图
+                chartDataSeries = createLineSeries(sensor, []);
                 break;
         }
 
         // 更新警戒线
         updateThresholdLines(sensor);
-    }
-
-    // 更新相关性分析
-    function updateCorrelationAnalysis() {
-        // 在实际项目中，应基于真实数据计算相关性
-        // 这里仅为示例，显示预设的相关性值
 
-        // 更新轴标题
-        xCorrelationAxis.titleText = sensor1Combo.currentText + " (" + getSensorUnit(sensor1Combo.currentText) + ")";
-        yCorrelationAxis.titleText = sensor2Combo.currentText + " (" + getSensorUnit(sensor2Combo.currentText) + ")";
-
-        // 更新相关系数显示值
-        correlationValueText.text = getCorrelationValue(sensor1Combo.currentIndex, sensor2Combo.currentIndex);
+        if (chartRequestId === 0) {
+            resetChartView();
+        } else {
+            requestChartView();
+        }
+    }
 
-        // 重新生成数据
-        generateCorrelationData();
-        generateCorrelationTrendLine();
+    // 图表回到所选日期范围
+    function resetChartView() {
+        var from = new Date(startDateBtn.selectedDate);
+        from.setHours(0, 0, 0, 0);
+        var to = new Date(endDateBtn.selectedDate);
+        to.setHours(0, 0, 0, 0);
+        to.setDate(to.getDate() + 1);
+
+        timeAxis.min = from;
+        timeAxis.max = to;
+        updateThresholdLines(chartSensorCombo.currentText);
+        requestChartView();
     }
 
-    // 更新趋势分析
-    function updateAnalysis() {
-        // 在实际项目中，应实现真实的分析逻辑
-        // 这里仅作为UI演示
+    // 按当前坐标轴范围请求数据；已缓存的段立即返回，其余段读到后再次触发 onViewReady
+    function requestChartView() {
+        chartViewTimer.stop();
+        chartRequestId++;
+        historyCache.setView(chartRequestId, timeAxis.min, timeAxis.max, chartSensorCombo.currentIndex,
+                             Math.max(100, Math.round(historyChart.plotArea.width)));
     }
 
-    // 生成图表数据
-    function generateChartData(sensor) {
-        // 这里应从数据模型或数据库中获取数据
-        // 现在仅生成示例数据
+    // 平移 dx 像素：向右拖动看更早的数据
+    function panChart(dx) {
+        var min = timeAxis.min.getTime();
+        var max = timeAxis.max.getTime();
+        var shift = -dx / Math.max(1, historyChart.plotArea.width) * (max - min);
+        if (shift === 0) return;
+        timeAxis.min = new Date(min + shift);
+        timeAxis.max = new Date(max + shift);
+        updateThresholdLines(chartSensorCombo.currentText);
+        chartViewTimer.restart();
+    }
 
-        chartData = [];
-        var baseDate = new Date(2023, 10, 1);
-        var baseValue = 0;
+    // 以 x 像素处的时间为中心缩放，factor < 1 为放大（最小 1 分钟）
+    function zoomChart(x, factor) {
+        var min = timeAxis.min.getTime();
+        var max = timeAxis.max.getTime();
+        var ratio = Math.min(1, Math.max(0, (x - historyChart.plotArea.x) / Math.max(1, historyChart.plotArea.width)));
+        var center = min + (max - min) * ratio;
+        var span = Math.max(60 * 1000, (max - min) * factor);
+        timeAxis.min = new Date(center - span * ratio);
+        timeAxis.max = new Date(center + span * (1 - ratio));
+        updateThresholdLines(chartSensorCombo.currentText);
+        chartViewTimer.restart();
+    }
 
-        // 根据传感器类型设置适当的基础值
-        switch(sensor) {
-            case "CO₂":
-                baseValue = 500;
-                break;
-            case "甲醛":
-                baseValue = 0.05;
-                break;
-            case "TVOC":
-                baseValue = 300;
-                break;
-            case "PM2.5":
-                baseValue = 50;
-                break;
-            case "PM10":
-                baseValue = 80;
-                break;
-            case "空气温度":
-                baseValue = 20;
+    function applyChartView(stats) {
+        switch (chartTypeSelector.currentIndex) {
+            case 1:
+                historyCache.updateSeries(chartDataSeries, 2);     // HistoryCache.Maximum
+                historyCache.updateSeries(chartLowerSeries, 1);    // HistoryCache.Minimum
                 break;
-            case "湿度":
-                baseValue = 60;
+            case 2:
+                // 柱状图不是 XYSeries，按点重建
+                if (chartDataSeries) historyChart.removeSeries(chartDataSeries);
+                chartDataSeries = createBarSeries(chartSensorCombo.currentText, historyCache.points(0));
                 break;
             default:
-                baseValue = 100;
+                historyCache.updateSeries(chartDataSeries, 0);     // HistoryCache.Mean
                 break;
         }
 
-        // 生成48小时的数据，每小时一个点
-        for (var i = 0; i < 48; i++) {
-            var date = new Date(baseDate);
-            date.setHours(date.getHours() + i);
+        if (stats.samples > 0) {
+            var range = stats.maximum - stats.minimum;
+            var padding = range > 0 ? range * 0.1 : Math.max(1, Math.abs(stats.maximum) * 0.1);
+            valueAxis.min = stats.minimum >= 0 ? Math.max(0, stats.minimum - padding) : stats.minimum - padding;
+            valueAxis.max = stats.maximum + padding;
+        }
+    }
 
-            var variation = Math.sin(i / 12 * Math.PI) * 0.3 + Math.random() * 0.2;
-            var value = baseValue * (1 + variation);
+    // 更新相关性分析：实时窗口直接读取，查询时间段交给 correlationEngine 计算，结果在 onRangeFinished 中填充
+    function updateCorrelationAnalysis() {
+        // 更新轴标题
+        xCorrelationAxis.titleText = sensor1Combo.currentText + " (" + getSensorUnit(sensor1Combo.currentText) + ")";
+        yCorrelationAxis.titleText = sensor2Combo.currentText + " (" + getSensorUnit(sensor2Combo.currentText) + ")";
 
-            chartData.push({
-                x: date,
-                y: value
-            });
+        if (correlationSourceCombo.currentIndex === 1) {
+            applyCorrelationResult(correlationEngine.liveMatrix(),
+                                   correlationEngine.livePair(sensor1Combo.currentIndex, sensor2Combo.currentIndex));
+            return;
         }
 
-        // 设置轴范围
-        timeAxis.min = chartData[0].x;
-        timeAxis.max = chartData[chartData.length-1].x;
+        var from = new Date(startDateBtn.selectedDate);
+        from.setHours(0, 0, 0, 0);
+        var to = new Date(endDateBtn.selectedDate);
+        to.setHours(0, 0, 0, 0);
+        to.setDate(to.getDate() + 1);
 
-        // 根据数据设置Y轴范围
-        var min = Number.MAX_VALUE;
-        var max = Number.MIN_VALUE;
+        correlationRequestId++;
+        correlationEngine.requestRange(correlationRequestId, from, to,
+                                       sensor1Combo.currentIndex, sensor2Combo.currentIndex);
+    }
+
+    function applyCorrelationResult(matrix, pair) {
+        correlationMatrix = matrix;
+        correlationPair = pair;
+        generateCorrelationData();
+        generateCorrelationTrendLine();
+    }
+
+    // 帧中甲醛以 0.001 mg/m³ 为单位，按通道序号换算为显示单位
+    function correlationScale(channel) {
+        return channel === 1 ? 0.001 : 1;
+    }
 
-        for (var j = 0; j < chartData.length; j++) {
-            min = Math.min(min, chartData[j].y);
-            max = Math.max(max, chartData[j].y);
+    function formatCorrelation(r) {
+        if (r === undefined || isNaN(r)) return "--";
+        return (r < 0 ? "" : "+") + r.toFixed(2);
+    }
+
+    function correlationStrength(r) {
+        if (r === undefined || isNaN(r)) return "数据不足";
+        var magnitude = Math.abs(r);
+        var direction = r < 0 ? "负相关" : "正相关";
+        if (magnitude >= 0.7) return "强" + direction;
+        if (magnitude >= 0.4) return "中等" + direction;
+        if (magnitude >= 0.2) return "弱" + direction;
+        return "基本无关";
+    }
+
+    function correlationSignificance(p) {
+        if (p === undefined || isNaN(p)) return "--";
+        if (p < 0.001) return "p < 0.001 (高度显著)";
+        if (p < 0.05) return "p = " + p.toFixed(3) + " (显著)";
+        return "p = " + p.toFixed(3) + " (不显著)";
+    }
+
+    function correlationEquation() {
+        var slope = correlationPair.slope;
+        var intercept = correlationPair.intercept;
+        if (slope === undefined || isNaN(slope)) return "--";
+        var sx = correlationScale(sensor1Combo.currentIndex);
+        var sy = correlationScale(sensor2Combo.currentIndex);
+        var a = slope * sy / sx;
+        var b = intercept * sy;
+        return "Y = " + a.toPrecision(3) + "X " + (b < 0 ? "- " : "+ ") + Math.abs(b).toPrecision(4);
+    }
+
+    function correlationInsights() {
+        var r = correlationPair.r;
+        var name1 = sensor1Combo.currentText;
+        var name2 = sensor2Combo.currentText;
+        if (r === undefined || isNaN(r)) {
+            return [name1 + "与" + name2 + "在所选范围内样本不足或读数恒定，无法计算相关系数"];
+        }
+        var lines = [name1 + "与" + name2 + "显示<b>" + correlationStrength(r) + "(r = " + formatCorrelation(r) + ")</b>"];
+        if (correlationPair.pValue < 0.05) {
+            lines.push("相关性<b>统计显著</b> (" + correlationSignificance(correlationPair.pValue) + ")，基于 " +
+                       correlationPair.count + " 个样本");
+        } else {
+            lines.push("相关性<b>不显著</b>，可能只是随机波动");
         }
+        lines.push("R² = " + correlationPair.r2.toFixed(2) + " 表示" + name1 + "的变化可线性解释约<b>" +
+                   (correlationPair.r2 * 100).toFixed(0) + "%</b>的" + name2 + "变化");
+        lines.push("相关不代表因果，两者可能同时受第三个因素（如水温、时段）影响");
+        return lines;
+    }
 
-        var range = max - min;
-        valueAxis.min = Math.max(0, min - range * 0.1);
-        valueAxis.max = max + range * 0.1;
+    // 更新趋势分析
+    function updateAnalysis() {
+        if (analysisTypeCombo.currentIndex === 1) {
+            generateTrendData();
+        } else if (analysisTypeCombo.currentIndex === 2) {
+            generateAnomalyData();
+        } else if (analysisTypeCombo.currentIndex === 3) {
+            updateCorrelationAnalysis();
+        }
     }
 
     // 创建折线图系列
@@ -4317,13 +4444,16 @@ Window {
         for (var i = 0; i < data.length; i++) {
             series.append(data[i].x.getTime(), data[i].y);
         }
+        return series;
     }
 
     // 创建面积图系列
     function createAreaSeries(sensor, data) {
-        // 创建上边界线
+        // 创建上、下边界线
         var upperSeries = historyChart.createSeries(ChartView.SeriesTypeLine, "upper", timeAxis, valueAxis);
         upperSeries.visible = false;
+        var lowerSeries = historyChart.createSeries(ChartView.SeriesTypeLine, "lower", timeAxis, valueAxis);
+        lowerSeries.visible = false;
 
         // 添加数据点
         for (var i = 0; i < data.length; i++) {
@@ -4336,6 +4466,8 @@ Window {
         areaSeries.borderColor = accentColor;
         areaSeries.borderWidth = 2;
         areaSeries.upperSeries = upperSeries;
+        areaSeries.lowerSeries = lowerSeries;
+        return areaSeries;
     }
 
     // 创建柱状图系列
@@ -4346,12 +4478,13 @@ Window {
         var barSets = [];
         var barSet = historyChart.createSeries(ChartView.SeriesTypeBar, sensor, timeAxis, valueAxis);
 
-        // 添加数据点（每6小时一个）
+        // 添加数据点（每6个点一个）
         for (var i = 0; i < data.length; i += 6) {
             if (i < data.length) {
                 barSet.append(data[i].x.getTime(), data[i].y);
             }
         }
+        return barSet;
     }
 
     // 创建散点图系列
@@ -4364,6 +4497,7 @@ Window {
         for (var i = 0; i < data.length; i++) {
             series.append(data[i].x.getTime(), data[i].y);
         }
+        return series;
     }
 
     // 更新警戒线
@@ -4423,166 +4557,320 @@ Window {
         }
     }
 
-    // 获取传感器警戒阈值
-    function getSensorWarningThreshold(sensor) {
+    // 传感器名称对应的通道名（与 sensorModule 属性名一致）
+    function sensorAlarmKey(sensor) {
         switch(sensor) {
             case "CO₂":
-                return 1000;
+                return "co2";
             case "甲醛":
-                return 0.08;
+                return "ch2o";
             case "TVOC":
-                return 500;
+                return "tvoc";
             case "PM2.5":
-                return 75;
+                return "pm25";
             case "PM10":
-                return 150;
+                return "pm10";
             case "浊度":
-                return 5;
+                return "turbidity";
             case "pH值":
-                return 8.5;
+                return "ph";
             case "TDS":
-                return 500;
+                return "tds";
+            case "空气温度":
+                return "airTemperature";
+            case "湿度":
+                return "humidity";
+            case "水温":
+                return "waterTemperature";
+            case "液位":
+                return "levelValue";
             default:
-                return 0;
+                return "";
         }
     }
 
+    // 获取传感器警戒阈值（与实时告警共用 alarmEngine 的阈值表）
+    function getSensorWarningThreshold(sensor) {
+        var key = sensorAlarmKey(sensor);
+        return key ? alarmEngine.warningThreshold(key) : 0;
+    }
+
     // 获取传感器严重阈值
     function getSensorCriticalThreshold(sensor) {
-        switch(sensor) {
-            case "CO₂":
-                return 2000;
-            case "甲醛":
-                return 0.1;
-            case "TVOC":
-                return 800;
-            case "PM2.5":
-                return 150;
-            case "PM10":
-                return 250;
-            case "浊度":
-                return 20;
-            case "pH值":
-                return 9.0;
-            case "TDS":
-                return 1000;
-            default:
-                return 0;
-        }
+        var key = sensorAlarmKey(sensor);
+        return key ? alarmEngine.criticalThreshold(key) : 0;
     }
 
-    // 获取预设的相关性值
+    // 相关性矩阵中的值（通道序号与传感器下拉框顺序一致）
     function getCorrelationValue(sensor1, sensor2) {
-        // 预设的相关性矩阵
-        var correlations = [
-            // CO₂  甲醛  TVOC  PM2.5 PM10  温度  湿度  浊度  pH   TDS   水温  液位
-            [1.00, 0.65, 0.72, 0.58, 0.52, 0.74, 0.48, 0.12, 0.05, 0.08, 0.31, 0.03], // CO₂
-            [0.65, 1.00, 0.81, 0.43, 0.38, 0.29, 0.59, 0.14, 0.08, 0.11, 0.18, 0.04], // 甲醛
-            [0.72, 0.81, 1.00, 0.62, 0.57, 0.41, 0.53, 0.09, 0.07, 0.06, 0.22, 0.02], // TVOC
-            [0.58, 0.43, 0.62, 1.00, 0.91, 0.36, 0.42, 0.15, 0.04, 0.07, 0.25, 0.01], // PM2.5
-            [0.52, 0.38, 0.57, 0.91, 1.00, 0.33, 0.37, 0.18, 0.06, 0.08, 0.21, 0.03], // PM10
-            [0.74, 0.29, 0.41, 0.36, 0.33, 1.00, 0.63, 0.25, 0.22, 0.28, 0.76, 0.12], // 温度
-            [0.48, 0.59, 0.53, 0.42, 0.37, 0.63, 1.00, 0.31, 0.18, 0.23, 0.45, 0.08], // 湿度
-            [0.12, 0.14, 0.09, 0.15, 0.18, 0.25, 0.31, 1.00, 0.42, 0.68, 0.37, 0.55], // 浊度
-            [0.05, 0.08, 0.07, 0.04, 0.06, 0.22, 0.18, 0.42, 1.00, 0.59, 0.31, 0.17], // pH
-            [0.08, 0.11, 0.06, 0.07, 0.08, 0.28, 0.23, 0.68, 0.59, 1.00, 0.42, 0.39], // TDS
-            [0.31, 0.18, 0.22, 0.25, 0.21, 0.76, 0.45, 0.37, 0.31, 0.42, 1.00, 0.25], // 水温
-            [0.03, 0.04, 0.02, 0.01, 0.03, 0.12, 0.08, 0.55, 0.17, 0.39, 0.25, 1.00]  // 液位
-        ];
-
-        var corr = correlations[sensor1][sensor2];
-        if (corr < 0) return corr.toFixed(2);
-        return "+" + corr.toFixed(2);
+        if (!correlationMatrix.length) return "--";
+        return formatCorrelation(correlationMatrix[sensor1][sensor2]);
     }
 
-    // 生成相关性散点图数据
+    // 生成相关性散点图数据：抽样散点，坐标轴按数据范围调整
     function generateCorrelationData() {
-        // 清空现有数据
         correlationScatter.clear();
-
-        // 获取当前选择的传感器
-        var sensor1 = sensor1Combo.currentText;
-        var sensor2 = sensor2Combo.currentText;
-
-        // 获取基础值
-        var baseValue1 = 0;
-        var baseValue2 = 0;
-
-        switch(sensor1) {
-            case "CO₂": baseValue1 = 500; break;
-            case "甲醛": baseValue1 = 0.05; break;
-            case "TVOC": baseValue1 = 300; break;
-            case "PM2.5": baseValue1 = 50; break;
-            case "空气温度": baseValue1 = 20; break;
-            default: baseValue1 = 100; break;
+        var scatter = correlationPair.scatter || [];
+        if (!scatter.length) return;
+
+        var sx = correlationScale(sensor1Combo.currentIndex);
+        var sy = correlationScale(sensor2Combo.currentIndex);
+        var minX = Infinity, maxX = -Infinity, minY = Infinity, maxY = -Infinity;
+        for (var i = 0; i < scatter.length; i++) {
+            var x = scatter[i].x * sx;
+            var y = scatter[i].y * sy;
+            correlationScatter.append(x, y);
+            minX = Math.min(minX, x);
+            maxX = Math.max(maxX, x);
+            minY = Math.min(minY, y);
+            maxY = Math.max(maxY, y);
         }
 
-        switch(sensor2) {
-            case "CO₂": baseValue2 = 500; break;
-            case "甲醛": baseValue2 = 0.05; break;
-            case "TVOC": baseValue2 = 300; break;
-            case "PM2.5": baseValue2 = 50; break;
-            case "空气温度": baseValue2 = 20; break;
-            default: baseValue2 = 100; break;
+        var marginX = Math.max((maxX - minX) * 0.05, 1e-3);
+        var marginY = Math.max((maxY - minY) * 0.05, 1e-3);
+        xCorrelationAxis.min = minX - marginX;
+        xCorrelationAxis.max = maxX + marginX;
+        yCorrelationAxis.min = minY - marginY;
+        yCorrelationAxis.max = maxY + marginY;
+    }
+
+    // 生成相关性趋势线：最小二乘回归直线
+    function generateCorrelationTrendLine() {
+        correlationTrendLine.clear();
+        var slope = correlationPair.slope;
+        if (slope === undefined || isNaN(slope) || !(correlationPair.scatter || []).length) return;
+
+        var sx = correlationScale(sensor1Combo.currentIndex);
+        var sy = correlationScale(sensor2Combo.currentIndex);
+        var a = slope * sy / sx;
+        var b = correlationPair.intercept * sy;
+        correlationTrendLine.append(xCorrelationAxis.min, a * xCorrelationAxis.min + b);
+        correlationTrendLine.append(xCorrelationAxis.max, a * xCorrelationAxis.max + b);
+    }
+
+    // 生成趋势分析图表数据：对所选日期范围请求计算（会取消尚未完成的上一次），结果在 onAnalysisFinished 中填充
+    function generateTrendData() {
+        if (analysisTypeCombo.currentIndex !== 1) return;
+        var key = sensorAlarmKey(analysisSensorCombo.currentText);
+        if (!key) return;
+
+        var from = new Date(startDateBtn.selectedDate);
+        from.setHours(0, 0, 0, 0);
+        var to = new Date(endDateBtn.selectedDate);
+        to.setHours(0, 0, 0, 0);
+        to.setDate(to.getDate() + 1);
+
+        trendRequestId++;
+        trendAnalyzer.request(trendRequestId, key, from, to, 0);
+    }
+
+    function applyTrendResult(stats) {
+        trendStats = stats;
+        trendWindowHours = stats.windowHours;
+        trendAnalyzer.updateSeries(trendRawSeries, 0);      // TrendAnalyzer.Raw
+        generateMovingAverageData();
+        generateTrendLineData();
+        generateTrendBandData();
+
+        if (stats.count > 0) {
+            trendTimeAxis.min = stats.start;
+            trendTimeAxis.max = stats.end;
+            var warning = getSensorWarningThreshold(analysisSensorCombo.currentText) *
+                          (sensorAlarmKey(analysisSensorCombo.currentText) === "ch2o" ? 0.001 : 1);
+            trendWarningSeries.clear();
+            if (warning > 0) {
+                trendWarningSeries.append(stats.start.getTime(), warning);
+                trendWarningSeries.append(stats.end.getTime(), warning);
+            }
+            var low = stats.minimum, high = stats.maximum;
+            if (warning > 0 && warning < high * 1.5) high = Math.max(high, warning);
+            var margin = Math.max((high - low) * 0.05, 1e-3);
+            trendValueAxis.min = low - margin;
+            trendValueAxis.max = high + margin;
         }
+    }
+
+    function formatTrendValue(value, signed) {
+        var unit = getSensorUnit(analysisSensorCombo.currentText);
+        var text = Math.abs(value) >= 100 ? value.toFixed(0) : Number(value.toPrecision(3)).toString();
+        return (signed && value >= 0 ? "+" : "") + text + (unit ? " " + unit : "");
+    }
 
-        // 获取相关系数
-        var correlation = parseFloat(correlationValueText.text);
+    function formatHourRange(hour) {
+        var pad = function(h) { return (h < 10 ? "0" : "") + h + ":00"; };
+        return pad(hour) + "-" + pad((hour + 1) % 24);
+    }
 
-        // 设置轴范围
-        xCorrelationAxis.min = baseValue1 * 0.7;
-        xCorrelationAxis.max = baseValue1 * 1.5;
-        yCorrelationAxis.min = baseValue2 * 0.7;
-        yCorrelationAxis.max = baseValue2 * 1.5;
+    // 日内波动明显大于回归残差中的随机成分时认为存在每日规律
+    function hasDailyPattern() {
+        return trendStats.count > 0 && trendStats.dailyAmplitude > trendStats.residualStd;
+    }
 
-        // 生成散点数据
-        for (var i = 0; i < 50; i++) {
-            // 生成具有指定相关性的随机值
-            var x = baseValue1 * (0.8 + Math.random() * 0.5);
-            var y = baseValue2 * (0.8 + correlation * (x/baseValue1 - 1) + Math.random() * 0.2);
+    // 每天变化超过均值 0.5% 视为有趋势
+    function trendPercentPerDay() {
+        return trendStats.mean ? trendStats.slopePerDay / Math.abs(trendStats.mean) * 100 : 0;
+    }
 
-            correlationScatter.append(x, y);
+    function trendDirectionText() {
+        if (!trendStats.count) return "--";
+        var percent = trendPercentPerDay();
+        var label = Math.abs(percent) < 0.5 ? "平稳" : (percent > 0 ? "上升" : "下降");
+        return label + " (" + (percent >= 0 ? "+" : "") + percent.toFixed(1) + "%/天)";
+    }
+
+    function trendDirectionColor() {
+        if (!trendStats.count || Math.abs(trendPercentPerDay()) < 0.5) return successColor;
+        return trendPercentPerDay() > 0 ? dangerColor : accentColor;
+    }
+
+    function trendInsights() {
+        if (!trendStats.count) return ["所选日期范围内没有" + analysisSensorCombo.currentText + "数据"];
+
+        var lines = [];
+        var percent = trendPercentPerDay();
+        if (Math.abs(percent) < 0.5) {
+            lines.push("数据<b>整体平稳</b>，线性趋势每天变化 " + formatTrendValue(trendStats.slopePerDay, true));
+        } else {
+            lines.push("数据显示<b>" + (percent > 0 ? "上升" : "下降") + "趋势</b>，每天约 " +
+                       formatTrendValue(trendStats.slopePerDay, true) + "（R² = " + trendStats.r2.toFixed(2) + "）");
+        }
+
+        // 按趋势线外推到警戒阈值
+        var warning = getSensorWarningThreshold(analysisSensorCombo.currentText) *
+                      (sensorAlarmKey(analysisSensorCombo.currentText) === "ch2o" ? 0.001 : 1);
+        if (warning > 0 && trendStats.slopePerDay > 0 && trendStats.trendEnd !== undefined) {
+            if (trendStats.trendEnd < warning) {
+                lines.push("若保持此趋势，约 <b>" + ((warning - trendStats.trendEnd) / trendStats.slopePerDay).toFixed(1) +
+                           " 天</b>后趋势线将达到警戒阈值 " + formatTrendValue(warning, false));
+            } else {
+                lines.push("趋势线已<b>超过警戒阈值</b> " + formatTrendValue(warning, false));
+            }
         }
+
+        if (hasDailyPattern()) {
+            lines.push("检测到<b>每日周期性变化</b>，峰值在 " + formatHourRange(trendStats.peakHour) + "，谷值在 " +
+                       formatHourRange(trendStats.troughHour) + "，日内波幅约 " + formatTrendValue(trendStats.dailyAmplitude, false));
+        }
+        lines.push("虚线区间为 " + trendWindowHours.toFixed(trendWindowHours < 10 ? 1 : 0) +
+                   " 小时滚动均值 ±2σ，读数越出区间的时段值得关注");
+        return lines;
     }
 
-    // 生成相关性趋势线
-    function generateCorrelationTrendLine() {
-        // 清空现有数据
-        correlationTrendLine.clear();
+    // 生成异常检测数据：对所选日期范围批量检测，结果在 onBatchFinished 中填充；
+    // 新请求会取代尚未完成的旧请求
+    function generateAnomalyData() {
+        if (analysisTypeCombo.currentIndex !== 2) return;
+        var key = sensorAlarmKey(analysisSensorCombo.currentText);
+        if (!key) return;
+
+        var from = new Date(startDateBtn.selectedDate);
+        from.setHours(0, 0, 0, 0);
+        var to = new Date(endDateBtn.selectedDate);
+        to.setHours(0, 0, 0, 0);
+        to.setDate(to.getDate() + 1);
+
+        anomalyRequestId++;
+        anomalyMonitor.requestBatch(anomalyRequestId, key, from, to);
+    }
 
-        // 简单线性回归
-        correlationTrendLine.append(xCorrelationAxis.min, yCorrelationAxis.min + (yCorrelationAxis.max - yCorrelationAxis.min) * 0.1);
-        correlationTrendLine.append(xCorrelationAxis.max, yCorrelationAxis.min + (yCorrelationAxis.max - yCorrelationAxis.min) * 0.9);
+    // 帧中甲醛以 0.001 mg/m³ 为单位，图表按 mg/m³ 显示
+    function anomalyDisplayScale(key) {
+        return key === "ch2o" ? 0.001 : 1;
     }
 
-    // 生成趋势分析图表数据
-    function generateTrendData() {
-        // 实际项目中应使用真实数据
+    function anomalyDescription(anomaly) {
+        var scale = anomalyDisplayScale(anomaly.key);
+        var unit = getSensorUnit(analysisSensorCombo.currentText);
+        return Qt.formatDateTime(anomaly.time, "MM月dd日 hh:mm") + " (" +
+               Number(anomaly.value * scale).toPrecision(4) + (unit ? " " + unit : "") + ")";
     }
 
-    // 生成异常检测数据
-    function generateAnomalyData() {
-        // 实际项目中应使用真实数据
+    function applyAnomalyResult(key, series, anomalies, samples, total, elapsedMs) {
+        var scale = anomalyDisplayScale(key);
+        var unit = getSensorUnit(analysisSensorCombo.currentText);
+        anomalyKey = key;
+        anomalySeries = series;
+        anomalyTotal = total;
+        anomalySamples = samples;
+        anomalyElapsedMs = elapsedMs;
+
+        anomalyRawSeries.clear();
+        anomalyPointSeries.clear();
+        var minValue = Infinity, maxValue = -Infinity;
+        for (var i = 0; i < series.length; i++) {
+            var point = series[i];
+            anomalyRawSeries.append(point.time.getTime(), point.value * scale);
+            minValue = Math.min(minValue, point.value * scale, point.lower * scale);
+            maxValue = Math.max(maxValue, point.value * scale, point.upper * scale);
+        }
+        generateUpperBoundData();
+        generateLowerBoundData();
+
+        anomalyListModel.clear();
+        anomalyWorst = null;
+        for (var j = 0; j < anomalies.length; j++) {
+            var a = anomalies[j];
+            anomalyPointSeries.append(a.time.getTime(), a.value * scale);
+            minValue = Math.min(minValue, a.value * scale);
+            maxValue = Math.max(maxValue, a.value * scale);
+            if (a.kind === 1 && (!anomalyWorst || Math.abs(a.score) > Math.abs(anomalyWorst.score))) {
+                anomalyWorst = a;
+            }
+
+            var stuck = a.kind === 2;
+            var deviation = a.expected !== 0 ? (a.value - a.expected) / Math.abs(a.expected) * 100 : 0;
+            anomalyListModel.append({
+                title: Qt.formatDateTime(a.time, "MM月dd日 hh:mm") + " - " +
+                       (stuck ? "读数卡滞" : (a.score > 0 ? "数值异常高" : "数值异常低")) +
+                       " (" + Number(a.value * scale).toPrecision(4) + (unit ? " " + unit : "") + ")",
+                detail: stuck ? "读数长时间不变，可能原因: 传感器故障或通信中断"
+                              : "偏离预期: " + (deviation >= 0 ? "+" : "") + deviation.toFixed(1) + "%, 预期 " +
+                                Number(a.expected * scale).toPrecision(4),
+                score: stuck ? "卡滞" : "z=" + a.score.toFixed(1)
+            });
+        }
+
+        if (series.length > 0) {
+            anomalyTimeAxis.min = series[0].time;
+            anomalyTimeAxis.max = series[series.length - 1].time;
+            var margin = Math.max((maxValue - minValue) * 0.05, 1e-3);
+            anomalyValueAxis.min = minValue - margin;
+            anomalyValueAxis.max = maxValue + margin;
+        }
     }
 
     // 生成移动平均数据
     function generateMovingAverageData() {
-        // 实际项目中应使用真实数据
+        trendAnalyzer.updateSeries(trendAverageSeries, 1);  // TrendAnalyzer.MovingAverage
     }
 
     // 生成趋势线数据
     function generateTrendLineData() {
-        // 实际项目中应使用真实数据
+        trendAnalyzer.updateSeries(trendLineSeries, 4);     // TrendAnalyzer.Trend
     }
 
-    // 生成上边界数据
+    // 生成滚动标准差带
+    function generateTrendBandData() {
+        trendAnalyzer.updateSeries(trendUpperSeries, 2);    // TrendAnalyzer.Upper
+        trendAnalyzer.updateSeries(trendLowerSeries, 3);    // TrendAnalyzer.Lower
+    }
+
+    // 生成上边界数据：检测器给出的正常范围上限
     function generateUpperBoundData() {
-        // 实际项目中应使用真实数据
+        anomalyUpperSeries.clear();
+        var scale = anomalyDisplayScale(anomalyKey);
+        for (var i = 0; i < anomalySeries.length; i++) {
+            anomalyUpperSeries.append(anomalySeries[i].time.getTime(), anomalySeries[i].upper * scale);
+        }
     }
 
-    // 生成下边界数据
+    // 生成下边界数据：检测器给出的正常范围下限
     function generateLowerBoundData() {
-        // 实际项目中应使用真实数据
+        anomalyLowerSeries.clear();
+        var scale = anomalyDisplayScale(anomalyKey);
+        for (var i = 0; i < anomalySeries.length; i++) {
+            anomalyLowerSeries.append(anomalySeries[i].time.getTime(), anomalySeries[i].lower * scale);
+        }
     }
 
     // ========== 组件库 ==========
@@ -28,27 +28,6 @@ Item {
         }
     }
 
-    // 更新任务点显示
-    function updateTaskPointsDisplay(points, model) {
-        // 更新连接线
-        if (points && points.length > 0) {
-            var path = [];
-            for (var i = 0; i < points.length; i++) {
-                var point = points[i];
-                path.push(QtPositioning.coordinate(point.latitude, point.longitude));
-            }
-            taskPathLine.path = path;
-        } else {
-            taskPathLine.path = [];
-        }
-
-        // 更新标记
-        if (model) {
-            taskMarkersView.model = model;
-            taskMarkersView.delegate = taskPointDelegate;
-        }
-    }
-
     // 背景地图
     Map {
         id: map
@@ -331,16 +310,158 @@ Item {
             line.width: 3
             line.color: accentColor
             opacity: 0.7
-            // 初始化为空数组，而不是null或undefined
-            path: []
+            // 航线（Home点 + 任务点，由 missionPlanner 维护）
+            path: missionPlanner.path
+            z: 1
+        }
+
+        // 水质热力图瓦片（由 heatmapLayer 按视口提供，图像从多级网格渲染）
+        MapItemView {
+            id: heatmapView
+            model: heatmapLayer
+            z: 0
+
+            delegate: MapQuickItem {
+                coordinate: model.coordinate
+                zoomLevel: model.tileZoom
+                anchorPoint.x: 0
+                anchorPoint.y: 0
+
+                sourceItem: Image {
+                    width: 256
+                    height: 256
+                    source: model.source
+                    asynchronous: true
+                    smooth: false
+                }
+            }
+        }
+
+        // 水质插值曲面（surfaceLayer 计算完成后整张叠加，无数据区域透明）
+        MapQuickItem {
+            id: surfaceOverlay
+            visible: surfaceLayer.available
+            coordinate: surfaceLayer.coordinate
+            zoomLevel: surfaceLayer.overlayZoom
+            anchorPoint.x: 0
+            anchorPoint.y: 0
+            z: 0
+
+            sourceItem: Image {
+                width: surfaceLayer.overlayWidth
+                height: surfaceLayer.overlayHeight
+                source: surfaceLayer.source
+                asynchronous: true
+                smooth: true
+            }
+        }
+
+        Connections {
+            target: surfaceLayer
+            function onComputeFinished(samples, elapsedMs) {
+                if (samples === 0) {
+                    warningMessage.showWarning("范围内没有带位置的水质样本", dangerColor);
+                    return;
+                }
+                warningMessage.showWarning("插值曲面: " + samples + " 个样本, " + surfaceLayer.minimum.toFixed(1) + " ~ " +
+                                           surfaceLayer.maximum.toFixed(1) + ", 耗时 " + elapsedMs.toFixed(0) + " ms", accentColor);
+            }
+        }
+
+        // 视口变化后节流更新热力图瓦片
+        Timer {
+            id: heatmapViewportTimer
+            interval: 150
+            onTriggered: heatmapLayer.setViewport(map.toCoordinate(Qt.point(0, 0), false),
+                                                  map.toCoordinate(Qt.point(map.width, map.height), false),
+                                                  map.zoomLevel)
+        }
+        onCenterChanged: if (heatmapLayer.enabled) heatmapViewportTimer.restart()
+        onZoomLevelChanged: if (heatmapLayer.enabled) heatmapViewportTimer.restart()
+        onWidthChanged: if (heatmapLayer.enabled) heatmapViewportTimer.restart()
+        onHeightChanged: if (heatmapLayer.enabled) heatmapViewportTimer.restart()
+
+        // 电子围栏：禁入区为红色，作业区为绿色，越界时加深显示
+        MapItemView {
+            id: geofenceView
+            model: geofenceManager
+            z: 0
+
+            delegate: MapPolygon {
+                path: model.path
+                color: model.kind === 0 ? Qt.rgba(1, 0, 0, model.breached ? 0.35 : 0.15)
+                                        : Qt.rgba(0, 0.8, 0.3, model.breached ? 0.05 : 0.12)
+                border.width: model.breached ? 3 : 1
+                border.color: model.kind === 0 ? dangerColor : successColor
+            }
+        }
+
+        // 船队轨迹（每船一条，模型中已按秒抽稀）
+        MapItemView {
+            id: fleetTrajectoryView
+            model: fleetModel
             z: 1
+
+            delegate: MapPolyline {
+                line.width: 2
+                line.color: Qt.hsla((model.vesselId * 0.17) % 1.0, 0.7, 0.5, 1.0)
+                opacity: 0.7
+                path: model.path
+            }
+        }
+
+        // 船队各船位置标记
+        MapItemView {
+            id: fleetMarkersView
+            model: fleetModel
+            z: 3
+
+            delegate: MapQuickItem {
+                coordinate: model.coordinate
+                anchorPoint.x: 15
+                anchorPoint.y: 15
+
+                sourceItem: Rectangle {
+                    width: 30
+                    height: 30
+                    radius: 15
+                    color: Qt.hsla((model.vesselId * 0.17) % 1.0, 0.7, 0.5, 1.0)
+                    border.width: 2
+                    border.color: "white"
+
+                    // 航向指示
+                    transform: Rotation {
+                        origin.x: 15
+                        origin.y: 15
+                        angle: model.heading
+                    }
+
+                    Rectangle {
+                        width: 3
+                        height: 8
+                        color: "white"
+                        anchors.horizontalCenter: parent.horizontalCenter
+                        anchors.top: parent.top
+                        anchors.topMargin: 2
+                    }
+
+                    Text {
+                        anchors.centerIn: parent
+                        text: model.vesselId
+                        color: "white"
+                        font.pixelSize: 12
+                        font.bold: true
+                    }
+                }
+            }
         }
 
         // 任务点标记
         MapItemView {
             id: taskMarkersView
             z: 2
-            model: [] // 初始化为空数组
+            model: missionPlanner
+            delegate: taskPointDelegate
         }
     }
 
@@ -353,7 +474,7 @@ Item {
             margins: 20
         }
         width: 50
-        height: 230
+        height: 330
         color: cardColor
         radius: 25
         opacity: 0.9
@@ -413,6 +534,54 @@ Item {
                     );
                 }
             }
+
+            // 热力图按钮：关闭 → 浊度 → TDS → pH → 关闭
+            MapControlButton {
+                text: "▦"
+                isActive: heatmapLayer.enabled
+                onClicked: {
+                    var names = ["浊度", "TDS", "pH"];
+                    heatmapLayer.channel = heatmapLayer.channel >= 2 ? -1 : heatmapLayer.channel + 1;
+                    if (!heatmapLayer.enabled) {
+                        warningMessage.showWarning("已关闭热力图", accentColor);
+                        return;
+                    }
+                    // 首次打开时从近 30 天历史重建
+                    if (heatmapLayer.sampleCount === 0 && !heatmapLayer.rebuilding) {
+                        heatmapLayer.rebuildFromHistory(new Date(Date.now() - 30 * 24 * 3600 * 1000), new Date());
+                    }
+                    heatmapViewportTimer.restart();
+                    warningMessage.showWarning("热力图: " + names[heatmapLayer.channel] + " (" +
+                                               heatmapLayer.minimum.toFixed(1) + " ~ " + heatmapLayer.maximum.toFixed(1) + ")", accentColor);
+                }
+            }
+
+            // 插值曲面按钮：关闭 → 反距离加权 → 克里金 → 关闭
+            // 通道跟随热力图（未打开时为 TDS），有作业区围栏时在围栏内计算，否则在当前视口内计算
+            MapControlButton {
+                text: "≈"
+                isActive: surfaceLayer.available || surfaceLayer.busy
+                onClicked: {
+                    if (surfaceLayer.busy) return;
+                    var nextMethod = !surfaceLayer.available ? 0 : surfaceLayer.method + 1;
+                    if (nextMethod > 1) {
+                        surfaceLayer.clear();
+                        warningMessage.showWarning("已关闭插值曲面", accentColor);
+                        return;
+                    }
+                    var channel = heatmapLayer.enabled ? heatmapLayer.channel : 1;
+                    var from = new Date(Date.now() - 30 * 24 * 3600 * 1000);
+                    var survey = geofenceManager.surveyPath();
+                    if (survey.length >= 3) {
+                        surfaceLayer.computeInPolygon(channel, nextMethod, from, new Date(), survey);
+                    } else {
+                        surfaceLayer.computeInBox(channel, nextMethod, from, new Date(),
+                                                  map.toCoordinate(Qt.point(0, 0), false),
+                                                  map.toCoordinate(Qt.point(map.width, map.height), false));
+                    }
+                    warningMessage.showWarning("正在计算插值曲面（" + (nextMethod === 0 ? "反距离加权" : "克里金") + "）…", accentColor);
+                }
+            }
         }
     }
 
@@ -20,6 +20,9 @@ Item {
     property real warningThreshold: 0              // 警告阈值
     property real criticalThreshold: 0             // 严重阈值
 
+    // 告警引擎给出的状态，-1 时按阈值自行判断
+    property int alarmLevel: -1
+
     // 当前状态 (0=正常, 1=超标, 2=严重超标)
     property int currentStatus: 0
 
@@ -58,11 +61,13 @@ Item {
 
     // ========== 方法实现 ==========
 
-    // 检查传感器状态 - 优化版本
+    // 检查传感器状态 - 优化版本（超标提示由 alarmEngine 的状态变化事件统一发出）
     function checkStatus(val) {
         var newStatus = 0;
 
-        if (criticalThreshold > 0 && val >= criticalThreshold) {
+        if (alarmLevel >= 0) {
+            newStatus = alarmLevel;
+        } else if (criticalThreshold > 0 && val >= criticalThreshold) {
             newStatus = 2;
         } else if (warningThreshold > 0 && val >= warningThreshold) {
             newStatus = 1;
@@ -77,17 +82,10 @@ Item {
                 lineSeriesObj.color = dangerColor;
                 currentValueColor = dangerColor;
                 currentBackgroundColor = Qt.rgba(dangerColor.r, dangerColor.g, dangerColor.b, 0.3);
-                // 只在状态变化时发送警告
-                if (warningMessage) {
-                    warningMessage.showWarning(title + "严重超标: " + val.toFixed(2) + unit, dangerColor);
-                }
             } else if (currentStatus === 1) {
                 lineSeriesObj.color = warningColor;
                 currentValueColor = warningColor;
                 currentBackgroundColor = Qt.rgba(warningColor.r, warningColor.g, warningColor.b, 0.3);
-                if (warningMessage) {
-                    warningMessage.showWarning(title + "超标: " + val.toFixed(2) + unit, warningColor);
-                }
             } else {
                 lineSeriesObj.color = chartColor;
                 currentValueColor = chartColor;
@@ -101,6 +99,8 @@ Item {
         return currentStatus;
     }
 
+    onAlarmLevelChanged: checkStatus(value)
+
     // 更新图表样式
     function updateChartStyle() {
         // 根据显示模式切换图表类型
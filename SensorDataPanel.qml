@@ -24,20 +24,16 @@ Rectangle {
                     type: "air",
                     dataKey: "co2",
                     status: 0,
-                    warningThreshold: 1000,
-                    criticalThreshold: 2000,
                     chartColor: accentColor,
                     dataArray: []
                 },
                 {
                     name: "甲醛浓度",
                     value: 0,
-                    unit: "mg/m³",
+                    unit: "μg/m³",
                     type: "air",
                     dataKey: "ch2o",
                     status: 0,
-                    warningThreshold: 0.08,
-                    criticalThreshold: 0.1,
                     chartColor: accentColor,
                     dataArray: []
                 },
@@ -48,8 +44,6 @@ Rectangle {
                     type: "air",
                     dataKey: "tvoc",
                     status: 0,
-                    warningThreshold: 500,
-                    criticalThreshold: 800,
                     chartColor: accentColor,
                     dataArray: []
                 },
@@ -60,8 +54,6 @@ Rectangle {
                     type: "air",
                     dataKey: "pm25",
                     status: 0,
-                    warningThreshold: 75,
-                    criticalThreshold: 150,
                     chartColor: accentColor,
                     dataArray: []
                 },
@@ -72,8 +64,6 @@ Rectangle {
                     type: "air",
                     dataKey: "pm10",
                     status: 0,
-                    warningThreshold: 150,
-                    criticalThreshold: 250,
                     chartColor: accentColor,
                     dataArray: []
                 },
@@ -84,8 +74,6 @@ Rectangle {
                     type: "air",
                     dataKey: "airTemperature",
                     status: 0,
-                    warningThreshold: 0,
-                    criticalThreshold: 0,
                     chartColor: accentColor,
                     dataArray: []
                 },
@@ -96,8 +84,6 @@ Rectangle {
                     type: "air",
                     dataKey: "humidity",
                     status: 0,
-                    warningThreshold: 0,
-                    criticalThreshold: 0,
                     chartColor: accentColor,
                     dataArray: []
                 }
@@ -113,8 +99,6 @@ Rectangle {
                     type: "water",
                     dataKey: "turbidity",
                     status: 0,
-                    warningThreshold: 5,
-                    criticalThreshold: 20,
                     chartColor: "#3498DB",
                     dataArray: []
                 },
@@ -125,8 +109,6 @@ Rectangle {
                     type: "water",
                     dataKey: "ph",
                     status: 0,
-                    warningThreshold: 8.5,
-                    criticalThreshold: 9.0,
                     chartColor: "#3498DB",
                     dataArray: []
                 },
@@ -137,8 +119,6 @@ Rectangle {
                     type: "water",
                     dataKey: "tds",
                     status: 0,
-                    warningThreshold: 500,
-                    criticalThreshold: 1000,
                     chartColor: "#3498DB",
                     dataArray: []
                 },
@@ -149,8 +129,6 @@ Rectangle {
                     type: "water",
                     dataKey: "waterTemperature",
                     status: 0,
-                    warningThreshold: 0,
-                    criticalThreshold: 0,
                     chartColor: "#3498DB",
                     dataArray: []
                 },
@@ -161,8 +139,6 @@ Rectangle {
                     type: "level",
                     dataKey: "levelValue",
                     status: 0,
-                    warningThreshold: 0,
-                    criticalThreshold: 0,
                     chartColor: "#2ECC71",
                     dataArray: []
                 }
@@ -210,29 +186,23 @@ Rectangle {
         return result;
     }
 
-    // 检查传感器状态
+    // 检查传感器状态（由 alarmEngine 判定，含回差与去抖）
     function checkSensorStatus(sensor) {
-        if (sensor.criticalThreshold > 0 && sensor.value >= sensor.criticalThreshold) {
-            if (sensor.status !== 2) {
-                sensor.status = 2;
-                if (warningMessage) {
-                    warningMessage.showWarning(sensor.name + "严重超标: " + sensor.value.toFixed(2) + sensor.unit, dangerColor);
-                }
-            }
-            return 2;
-        } else if (sensor.warningThreshold > 0 && sensor.value >= sensor.warningThreshold) {
-            if (sensor.status !== 1 && sensor.status !== 2) {
-                sensor.status = 1;
-                if (warningMessage) {
-                    warningMessage.showWarning(sensor.name + "超标: " + sensor.value.toFixed(2) + sensor.unit, warningColor);
-                }
-            }
-            return 1;
-        } else {
-            if (sensor.status !== 0) {
-                sensor.status = 0;
+        sensor.status = alarmEngine.levels[sensor.dataKey];
+        return sensor.status;
+    }
+
+    // 告警状态变化时提示
+    Connections {
+        target: alarmEngine
+        function onAlarmChanged(key, level, previous, value) {
+            var sensor = findSensor(key);
+            if (!sensor || !warningMessage || level <= previous) return;
+            if (level === 2) {
+                warningMessage.showWarning(sensor.name + "严重超标: " + value.toFixed(2) + sensor.unit, dangerColor);
+            } else {
+                warningMessage.showWarning(sensor.name + "超标: " + value.toFixed(2) + sensor.unit, warningColor);
             }
-            return 0;
         }
     }
 
@@ -557,8 +527,10 @@ Rectangle {
                     title: selectedSensor ? selectedSensor.name : ""
                     unit: selectedSensor ? selectedSensor.unit : ""
                     chartColor: selectedSensor ? selectedSensor.chartColor : accentColor
-                    warningThreshold: selectedSensor ? selectedSensor.warningThreshold : 0
-                    criticalThreshold: selectedSensor ? selectedSensor.criticalThreshold : 0
+                    // 阈值直接绑定 alarmEngine.thresholds，运行时修改后立即生效
+                    warningThreshold: selectedSensor ? alarmEngine.thresholds[selectedSensor.dataKey].warning : 0
+                    criticalThreshold: selectedSensor ? alarmEngine.thresholds[selectedSensor.dataKey].critical : 0
+                    alarmLevel: selectedSensor ? alarmEngine.levels[selectedSensor.dataKey] : -1
                     value: selectedSensor ? selectedSensor.value : 0
 
                     // 更新图表数据
@@ -676,8 +648,9 @@ Rectangle {
                         title: modelData.name
                         unit: modelData.unit
                         chartColor: modelData.chartColor
-                        warningThreshold: modelData.warningThreshold
-                        criticalThreshold: modelData.criticalThreshold
+                        warningThreshold: alarmEngine.thresholds[modelData.dataKey].warning
+                        criticalThreshold: alarmEngine.thresholds[modelData.dataKey].critical
+                        alarmLevel: alarmEngine.levels[modelData.dataKey]
                         value: modelData.value
 
                         // 组件完成加载后填充数据
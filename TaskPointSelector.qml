@@ -11,27 +11,8 @@ Rectangle {
 
     // 属性定义
     property bool isSettingHomePoint: false
-    property var taskPoints: []
-    property alias taskPointsModel: taskPointsModel
 
-    // 移除重复的信号声明，使用model的onCountChanged替代
-    // 注意：删除了原来的 signal taskPointsChanged() 声明
-
-    // 任务点模型
-    ListModel {
-        id: taskPointsModel
-        // 当模型内容变化时触发任务点更新
-        onCountChanged: updateTaskPoints()
-    }
-
-    // 添加内部函数来处理任务点更新
-    function updateTaskPoints() {
-        // 这会通知地图面板更新任务点显示
-        if (mapViewPanel) {
-            // 调用地图视图的更新函数
-            mapViewPanel.updateTaskPointsDisplay(taskPoints, taskPointsModel)
-        }
-    }
+    // 任务点保存在 C++ 的 missionPlanner 模型中（类型化坐标、航段距离、航线优化）
 
     // 添加任务点
     function addTaskPoint(lat, lon) {
@@ -43,38 +24,38 @@ Rectangle {
             if (mapViewPanel) {
                 mapViewPanel.setHomePoint(lat, lon, timestamp);
             }
+            missionPlanner.setHome(lat, lon);
             isSettingHomePoint = false;
             console.log("Home点已设置：", lat, lon, timestamp);
         } else {
             // 添加普通任务点
-            var newPoint = {
-                latitude: lat,
-                longitude: lon,
-                timestamp: new Date().toISOString()
-            };
-
-            taskPoints.push(newPoint);
-            taskPointsModel.append(newPoint);
-            warningMessage.showWarning("已添加任务点 #" + taskPoints.length, accentColor);
+            missionPlanner.append(lat, lon);
+            warningMessage.showWarning("已添加任务点 #" + missionPlanner.count, accentColor);
         }
     }
 
     // 删除任务点
     function removeTaskPoint(index) {
-        if (index >= 0 && index < taskPoints.length) {
-            taskPoints.splice(index, 1);
-            taskPointsModel.remove(index);
+        if (index >= 0 && index < missionPlanner.count) {
+            missionPlanner.remove(index);
             warningMessage.showWarning("已删除任务点", accentColor);
         }
     }
 
     // 清空任务点
     function clearTaskPoints() {
-        taskPoints = [];
-        taskPointsModel.clear();
+        missionPlanner.clear();
         warningMessage.showWarning("已清空所有任务点", accentColor);
     }
 
+    // 优化任务点访问顺序（从Home点出发）
+    function optimizeTaskPoints() {
+        if (missionPlanner.optimize(false)) {
+            warningMessage.showWarning("航线已优化，总航程 " + (missionPlanner.totalDistance / 1000).toFixed(2) +
+                                       " km (" + missionPlanner.lastOptimizeMs.toFixed(1) + " ms)", successColor);
+        }
+    }
+
     // 设置Home点模式
     function setHomePointMode() {
         isSettingHomePoint = true;
@@ -252,13 +233,37 @@ Rectangle {
                 }
             }
 
+            // 优化航线按钮
+            Button {
+                text: "优化航线"
+                Layout.fillWidth: true
+                enabled: missionPlanner.hasHome && missionPlanner.count > 1
+                onClicked: optimizeTaskPoints()
+
+                contentItem: Text {
+                    text: parent.text
+                    color: textColor
+                    font.pixelSize: fontSize
+                    horizontalAlignment: Text.AlignHCenter
+                    verticalAlignment: Text.AlignVCenter
+                    opacity: parent.enabled ? 1.0 : 0.5
+                }
+
+                background: Rectangle {
+                    color: parent.enabled ? (parent.down ? Qt.darker(successColor, 1.2) :
+                                          parent.hovered ? successColor : Qt.darker(successColor, 1.1)) :
+                                          Qt.rgba(0.3, 0.3, 0.3, 1)
+                    radius: 4
+                }
+            }
+
             // 发送任务点按钮
             Button {
                 text: "发送任务点"
                 Layout.fillWidth: true
 
                 // 只有当存在Home点和至少一个任务点时才启用
-                enabled: mapViewPanel.homePoint !== null && taskPoints.length > 0
+                enabled: missionPlanner.hasHome && missionPlanner.count > 0
 
                 contentItem: Text {
                     text: parent.text
@@ -277,78 +282,32 @@ Rectangle {
                 }
 
                 onClicked: {
-                    // 准备发送数据
-                    var stringArray = [];
-
-                    // 首先添加Home点数据
-                    if (mapViewPanel.homePoint) {
-                        var home = mapViewPanel.homePoint;
-
-                        // 格式化时间戳
-                        var timestamp = Qt.formatDateTime(new Date(home.timestamp), "yyyy-MM-dd hh:mm:ss");
-                        var homeStr = home.coordinate.latitude.toFixed(6) + "," +
-                                    home.coordinate.longitude.toFixed(6) + "," +
-                                    timestamp;
-
-                        stringArray.push(homeStr);
-                        console.log("Home点数据：", homeStr);
-                    } else {
-                        warningMessage.showWarning("未设置Home点！", warningColor);
-                        return;
-                    }
-
-                    // 然后添加任务点数据
-                    for (var i = 0; i < taskPoints.length; i++) {
-                        var point = taskPoints[i];
-
-                        // 确保时间戳的正确格式
-                        var pointTimestamp = "";
-                        if (typeof point.timestamp === 'string') {
-                            pointTimestamp = point.timestamp;
-                        } else if (point.timestamp instanceof Date) {
-                            pointTimestamp = Qt.formatDateTime(point.timestamp, "yyyy-MM-dd hh:mm:ss");
-                        } else {
-                            // 使用当前时间作为默认值
-                            pointTimestamp = Qt.formatDateTime(new Date(), "yyyy-MM-dd hh:mm:ss");
-                        }
-
-                        var pointStr = point.latitude.toFixed(6) + "," +
-                                     point.longitude.toFixed(6) + "," +
-                                     pointTimestamp;
-
-                        stringArray.push(pointStr);
-                    }
-
-                    // 任务点数量限制检查
+                    // 任务点数量限制检查（分块上传不受单帧限制）
                     var maxPoints = 50; // 与后端常量保持一致
-                    if (taskPoints.length > maxPoints) {
+                    if (!dataSource.chunkedMissionUpload && missionPlanner.count > maxPoints) {
                         warningMessage.showWarning("任务点数量超出上限(" + maxPoints + ")，将只发送前" + maxPoints + "个点", warningColor);
                     }
 
-                    console.log("准备发送点的数据：", stringArray);
-
-                    // 调用数据源发送数据
-                    try {
-                        if (dataSource && stringArray.length > 0) {
-                            dataSource.sendData(stringArray);
-                            warningMessage.showWarning("任务点已发送 (" + Math.min(taskPoints.length, maxPoints) + " 个点)", successColor);
-                        }
-                    } catch (e) {
-                        warningMessage.showWarning("发送失败: " + e, dangerColor);
-                        console.error("发送任务点时出错:", e);
+                    // 任务直接由 C++ 模型编码发送
+                    if (missionPlanner.upload()) {
+                        var sent = dataSource.chunkedMissionUpload ? missionPlanner.count : Math.min(missionPlanner.count, maxPoints);
+                        warningMessage.showWarning("任务点已发送 (" + sent + " 个点)", successColor);
+                    } else {
+                        warningMessage.showWarning("发送失败", dangerColor);
                     }
                 }
 
                 // 提示信息
                 ToolTip.visible: hovered && !enabled
-                ToolTip.text: mapViewPanel.homePoint === null ? "请先设置Home点" : "请添加至少一个任务点"
+                ToolTip.text: !missionPlanner.hasHome ? "请先设置Home点" : "请添加至少一个任务点"
                 ToolTip.delay: 500
             }
             }
 
         // 任务点列表标题
         Text {
-            text: "已添加任务点 (" + taskPointsModel.count + ")"
+            text: "已添加任务点 (" + missionPlanner.count + ")  航程 " + (missionPlanner.totalDistance / 1000).toFixed(2) + " km，约 " +
+                  Math.ceil(missionPlanner.totalDuration / 60) + " 分钟"
             color: textColor
             font.pixelSize: fontSize
             font.bold: true
@@ -359,7 +318,7 @@ Rectangle {
             id: taskPointListView
             Layout.fillWidth: true
             Layout.fillHeight: true
-            model: taskPointsModel
+            model: missionPlanner
             clip: true
             spacing: 4
 
@@ -369,7 +328,7 @@ Rectangle {
                 text: "尚未添加任务点"
                 color: Qt.rgba(1,1,1,0.5)
                 font.pixelSize: fontSize
-                visible: taskPointsModel.count === 0
+                visible: missionPlanner.count === 0
             }
 
             // 任务点列表项
@@ -413,7 +372,7 @@ Rectangle {
                         }
 
                         Text {
-                            text: "经度: " + model.longitude.toFixed(6)
+                            text: "经度: " + model.longitude.toFixed(6) + "  航段: " + model.legDistance.toFixed(0) + " m / " + model.bearing.toFixed(0) + "°"
                             color: textColor
                             font.pixelSize: smallFontSize
                             font.family: "Consolas, monospace"
@@ -419,22 +419,14 @@ Rectangle {
         TopBarButton {
             text: "历史数据"
             iconText: "📊"
-            onClicked: {
-                var component = Qt.createComponent("HistoryDataWindow.qml");
-                if (component.status === Component.Ready) {
-                    var window = component.createObject(appWindow);
-                    window.show();
-                } else {
-                    console.error("Error loading component:", component.errorString());
-                }
-            }
+            onClicked: appWindow.openHistoryDataWindow()
         }
 
         // 设置按钮
         TopBarButton {
             text: "设置"
             iconText: "⚙"
-            onClicked: settingsDialog.open()
+            onClicked: appWindow.openSettingsDialog()
         }
     }
 
@@ -15,7 +15,34 @@ SOURCES += \
     sensor_module.cpp \
     vessel_module.cpp \
     datasource.cpp \
-    database.cpp
+    database.cpp \
+    metrics.cpp \
+    trace.cpp \
+    latency_tracer.cpp \
+    serial_replay.cpp \
+    simulation_generator.cpp \
+    frame_codec.cpp \
+    fleet_manager.cpp \
+    epoll_reader.cpp \
+    port_watcher.cpp \
+    command_scheduler.cpp \
+    control_loop.cpp \
+    mission_upload.cpp \
+    route_optimizer.cpp \
+    mission_planner.cpp \
+    geodesy.cpp \
+    geofence.cpp \
+    heatmap.cpp \
+    surface_interpolation.cpp \
+    surface_layer.cpp \
+    alarm_engine.cpp \
+    anomaly_detector.cpp \
+    correlation_engine.cpp \
+    trend_analysis.cpp \
+    trend_analyzer.cpp \
+    job_scheduler.cpp \
+    history_segments.cpp \
+    history_cache.cpp
 
 HEADERS += \
     device_module.h \
@@ -23,7 +50,35 @@ HEADERS += \
     sensor_module.h \
     vessel_module.h \
     datasource.h \
-    database.h
+    database.h \
+    metrics.h \
+    trace.h \
+    latency_tracer.h \
+    serial_replay.h \
+    simulation_generator.h \
+    frame_constants.h \
+    frame_codec.h \
+    fleet_manager.h \
+    epoll_reader.h \
+    port_watcher.h \
+    command_scheduler.h \
+    control_loop.h \
+    mission_upload.h \
+    route_optimizer.h \
+    mission_planner.h \
+    geodesy.h \
+    geofence.h \
+    heatmap.h \
+    surface_interpolation.h \
+    surface_layer.h \
+    alarm_engine.h \
+    anomaly_detector.h \
+    correlation_engine.h \
+    trend_analysis.h \
+    trend_analyzer.h \
+    job_scheduler.h \
+    history_segments.h \
+    history_cache.h
 
 # QML 资源文件
 RESOURCES += qml.qrc
@@ -31,6 +86,11 @@ RESOURCES += qml.qrc
 # 额外的编译选项
 DEFINES += REPLACE_INTER_FONT
 
+# 结构化追踪（qmake CONFIG+=usv_trace 启用，默认编译为空操作）
+usv_trace {
+    DEFINES += USV_TRACE_ENABLED
+}
+
 # 指定QML文件的导入路径
 QML_IMPORT_PATH = $$PWD/qml
 
@@ -0,0 +1,238 @@
+#include "alarm_engine.h"
+#include "frame_constants.h"
+#include "metrics.h"
+#include <QDateTime>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+const char* const CHANNEL_KEYS[AlarmEvaluator::CHANNEL_COUNT] = {
+    "co2", "ch2o", "tvoc", "pm25", "pm10", "airTemperature", "humidity",
+    "turbidity", "ph", "tds", "waterTemperature", "levelValue"
+};
+
+// 回差默认取两级阈值差的 10%，只有一级阈值时取阈值的 5%
+float defaultDeadband(float warning, float critical)
+{
+    return critical > warning ? (critical - warning) * 0.1f : warning * 0.05f;
+}
+
+}
+
+AlarmEvaluator::AlarmEvaluator()
+{
+    using namespace FrameConstants::SensorLimits;
+    std::fill(std::begin(m_warning), std::end(m_warning), std::numeric_limits<float>::infinity());
+    std::fill(std::begin(m_critical), std::end(m_critical), std::numeric_limits<float>::infinity());
+    std::fill(std::begin(m_warningClear), std::end(m_warningClear), std::numeric_limits<float>::infinity());
+    std::fill(std::begin(m_criticalClear), std::end(m_criticalClear), std::numeric_limits<float>::infinity());
+
+    auto seed = [this](int channel, double warning, double critical) {
+        Threshold threshold;
+        threshold.warning = static_cast<float>(warning);
+        threshold.critical = static_cast<float>(critical);
+        threshold.deadband = defaultDeadband(threshold.warning, threshold.critical);
+        setThreshold(channel, threshold);
+    };
+    seed(Co2, CO2_WARNING, CO2_CRITICAL);
+    // 帧中甲醛以 0.001 mg/m³ 为单位上报
+    seed(Ch2o, CH2O_WARNING * 1000, CH2O_CRITICAL * 1000);
+    seed(Tvoc, TVOC_WARNING, TVOC_CRITICAL);
+    seed(Pm25, PM25_WARNING, PM25_CRITICAL);
+    seed(Pm10, PM10_WARNING, PM10_CRITICAL);
+    seed(Turbidity, TURBIDITY_WARNING, TURBIDITY_CRITICAL);
+    seed(Ph, PH_WARNING, PH_CRITICAL);
+    seed(Tds, TDS_WARNING, TDS_CRITICAL);
+    reset();
+}
+
+void AlarmEvaluator::setThreshold(int channel, const Threshold& threshold)
+{
+    if (channel < 0 || channel >= CHANNEL_COUNT) return;
+    m_thresholds[channel] = threshold;
+
+    const float inf = std::numeric_limits<float>::infinity();
+    const bool enabled = threshold.warning > 0.0f;
+    const bool hasCritical = enabled && threshold.critical > threshold.warning;
+    m_warning[channel] = enabled ? threshold.warning : inf;
+    m_critical[channel] = hasCritical ? threshold.critical : inf;
+    m_warningClear[channel] = enabled ? threshold.warning - threshold.deadband : inf;
+    m_criticalClear[channel] = hasCritical ? threshold.critical - threshold.deadband : inf;
+}
+
+void AlarmEvaluator::reset()
+{
+    std::fill(std::begin(m_level), std::end(m_level), Normal);
+    std::fill(std::begin(m_target), std::end(m_target), Normal);
+    std::fill(std::begin(m_pending), std::end(m_pending), Normal);
+    std::fill(std::begin(m_pendingSince), std::end(m_pendingSince), 0);
+}
+
+int AlarmEvaluator::evaluate(const float* values, qint64 nowMs, AlarmTransition* out)
+{
+    alignas(32) float v[LANES] = {};
+    std::copy(values, values + CHANNEL_COUNT, v);
+
+    // 目标状态：按阈值可升到的级别，与按回差阈值可保持的当前级别取大
+    for (int i = 0; i < LANES; ++i) {
+        const qint32 up = (v[i] >= m_warning[i]) + (v[i] >= m_critical[i]);
+        const qint32 hold = (v[i] >= m_warningClear[i]) + (v[i] >= m_criticalClear[i]);
+        m_target[i] = std::max(up, std::min(m_level[i], hold));
+    }
+
+    int count = 0;
+    for (int i = 0; i < CHANNEL_COUNT; ++i) {
+        if (m_target[i] == m_level[i]) {
+            m_pending[i] = m_level[i];
+            continue;
+        }
+        if (m_target[i] != m_pending[i]) {
+            m_pending[i] = m_target[i];
+            m_pendingSince[i] = nowMs;
+        }
+        if (nowMs - m_pendingSince[i] < m_thresholds[i].minDurationMs) continue;
+
+        out[count++] = {i, m_level[i], m_target[i], v[i]};
+        m_level[i] = m_target[i];
+    }
+    return count;
+}
+
+const char* AlarmEvaluator::channelKey(int channel)
+{
+    return channel >= 0 && channel < CHANNEL_COUNT ? CHANNEL_KEYS[channel] : "";
+}
+
+int AlarmEvaluator::channelFromKey(const QString& key)
+{
+    for (int i = 0; i < CHANNEL_COUNT; ++i) {
+        if (key == QLatin1String(CHANNEL_KEYS[i])) return i;
+    }
+    return -1;
+}
+
+AlarmEngine::AlarmEngine(QObject *parent)
+    : QObject(parent)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_evaluateLatency = metrics.histogram("usv_alarm_evaluate_duration_seconds", "Time spent evaluating alarm thresholds for one sensor frame");
+    m_transitions = metrics.counter("usv_alarm_transitions_total", "Sensor alarm level changes");
+    updateLevels();
+    updateThresholds();
+}
+
+int AlarmEngine::activeCount() const
+{
+    int count = 0;
+    for (int i = 0; i < AlarmEvaluator::CHANNEL_COUNT; ++i) {
+        if (m_evaluator.level(i) != AlarmEvaluator::Normal) ++count;
+    }
+    return count;
+}
+
+int AlarmEngine::highestLevel() const
+{
+    int level = AlarmEvaluator::Normal;
+    for (int i = 0; i < AlarmEvaluator::CHANNEL_COUNT; ++i) level = std::max(level, m_evaluator.level(i));
+    return level;
+}
+
+double AlarmEngine::warningThreshold(const QString& key) const
+{
+    const int channel = AlarmEvaluator::channelFromKey(key);
+    return channel >= 0 ? std::max(0.0f, m_evaluator.threshold(channel).warning) : 0.0;
+}
+
+double AlarmEngine::criticalThreshold(const QString& key) const
+{
+    const int channel = AlarmEvaluator::channelFromKey(key);
+    return channel >= 0 ? std::max(0.0f, m_evaluator.threshold(channel).critical) : 0.0;
+}
+
+bool AlarmEngine::setThreshold(const QString& key, double warning, double critical, double deadband)
+{
+    const int channel = AlarmEvaluator::channelFromKey(key);
+    if (channel < 0) return false;
+
+    AlarmEvaluator::Threshold threshold = m_evaluator.threshold(channel);
+    threshold.warning = static_cast<float>(warning);
+    threshold.critical = static_cast<float>(critical);
+    threshold.deadband = deadband >= 0 ? static_cast<float>(deadband)
+                                       : defaultDeadband(threshold.warning, threshold.critical);
+    m_evaluator.setThreshold(channel, threshold);
+    updateThresholds();
+    emit thresholdsChanged();
+    return true;
+}
+
+bool AlarmEngine::setMinDuration(const QString& key, int milliseconds)
+{
+    const int channel = AlarmEvaluator::channelFromKey(key);
+    if (channel < 0) return false;
+
+    AlarmEvaluator::Threshold threshold = m_evaluator.threshold(channel);
+    threshold.minDurationMs = std::max(0, milliseconds);
+    m_evaluator.setThreshold(channel, threshold);
+    updateThresholds();
+    emit thresholdsChanged();
+    return true;
+}
+
+void AlarmEngine::setMinDuration(int milliseconds)
+{
+    for (int i = 0; i < AlarmEvaluator::CHANNEL_COUNT; ++i) {
+        AlarmEvaluator::Threshold threshold = m_evaluator.threshold(i);
+        threshold.minDurationMs = std::max(0, milliseconds);
+        m_evaluator.setThreshold(i, threshold);
+    }
+    updateThresholds();
+    emit thresholdsChanged();
+}
+
+void AlarmEngine::evaluateFrame(int co2, int ch2o, int tvoc, int pm25, int pm10,
+                                double airTemp, double humidity,
+                                int turbidity, double ph, int tds, double waterTemp,
+                                int levelValue)
+{
+    const float values[AlarmEvaluator::CHANNEL_COUNT] = {
+        float(co2), float(ch2o), float(tvoc), float(pm25), float(pm10), float(airTemp), float(humidity),
+        float(turbidity), float(ph), float(tds), float(waterTemp), float(levelValue)
+    };
+
+    AlarmTransition transitions[AlarmEvaluator::CHANNEL_COUNT];
+    int count;
+    {
+        MetricScopeTimer timer(m_evaluateLatency);
+        count = m_evaluator.evaluate(values, QDateTime::currentMSecsSinceEpoch(), transitions);
+    }
+    if (count == 0) return;
+
+    m_transitions->add(count);
+    updateLevels();
+    emit levelsChanged();
+    for (int i = 0; i < count; ++i) {
+        const AlarmTransition& t = transitions[i];
+        emit alarmChanged(QLatin1String(AlarmEvaluator::channelKey(t.channel)), t.level, t.previous, t.value);
+    }
+}
+
+void AlarmEngine::updateThresholds()
+{
+    for (int i = 0; i < AlarmEvaluator::CHANNEL_COUNT; ++i) {
+        const AlarmEvaluator::Threshold& threshold = m_evaluator.threshold(i);
+        m_thresholds[QLatin1String(AlarmEvaluator::channelKey(i))] = QVariantMap{
+            {"warning", std::max(0.0f, threshold.warning)},
+            {"critical", std::max(0.0f, threshold.critical)},
+            {"deadband", threshold.deadband},
+            {"minDurationMs", threshold.minDurationMs}
+        };
+    }
+}
+
+void AlarmEngine::updateLevels()
+{
+    for (int i = 0; i < AlarmEvaluator::CHANNEL_COUNT; ++i) {
+        m_levels[QLatin1String(AlarmEvaluator::channelKey(i))] = m_evaluator.level(i);
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <QObject>
+#include <QVariantMap>
+
+class LatencyHistogram;
+class MetricCounter;
+
+// 告警状态变化
+struct AlarmTransition {
+    int channel;
+    int previous;
+    int level;
+    float value;
+};
+
+// 阈值判定：每帧对全部通道做一次无分支的批量比较，再只对状态有变化的通道做去抖。
+// 回差（deadband）：升级按阈值判断，降级需低于阈值减回差；
+// 去抖（minDurationMs）：新状态需持续该时长才生效，期间状态来回跳变则重新计时。
+class AlarmEvaluator {
+public:
+    enum Channel {
+        Co2 = 0, Ch2o, Tvoc, Pm25, Pm10, AirTemperature, Humidity,
+        Turbidity, Ph, Tds, WaterTemperature, LevelValue,
+        CHANNEL_COUNT
+    };
+    enum Level { Normal = 0, Warning = 1, Critical = 2 };
+
+    static constexpr int LANES = 16;    // 通道数补齐到 16，便于向量化
+    static constexpr int DEFAULT_MIN_DURATION_MS = 1000;
+
+    // warning <= 0 表示该通道不告警（与界面上阈值为 0 的约定一致）
+    struct Threshold {
+        float warning = 0.0f;
+        float critical = 0.0f;
+        float deadband = 0.0f;
+        int minDurationMs = DEFAULT_MIN_DURATION_MS;
+    };
+
+    // 以 FrameConstants::SensorLimits 初始化阈值表
+    AlarmEvaluator();
+
+    void setThreshold(int channel, const Threshold& threshold);
+    const Threshold& threshold(int channel) const { return m_thresholds[channel]; }
+    int level(int channel) const { return m_level[channel]; }
+    void reset();
+
+    // values 为 CHANNEL_COUNT 个读数；状态变化写入 out（至少 CHANNEL_COUNT 个），返回变化数
+    int evaluate(const float* values, qint64 nowMs, AlarmTransition* out);
+
+    // 与 QML 中 sensorModule 属性名一致
+    static const char* channelKey(int channel);
+    static int channelFromKey(const QString& key);
+
+private:
+    Threshold m_thresholds[CHANNEL_COUNT];
+
+    alignas(32) float m_warning[LANES];
+    alignas(32) float m_critical[LANES];
+    alignas(32) float m_warningClear[LANES];
+    alignas(32) float m_criticalClear[LANES];
+    alignas(32) qint32 m_level[LANES];
+    alignas(32) qint32 m_target[LANES];
+    qint32 m_pending[LANES];
+    qint64 m_pendingSince[LANES];
+};
+
+// 传感器告警引擎：接收每帧读数，维护各通道状态与阈值供 QML 绑定，状态变化时发出 alarmChanged。
+class AlarmEngine : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantMap levels READ levels NOTIFY levelsChanged)
+    Q_PROPERTY(int activeCount READ activeCount NOTIFY levelsChanged)
+    Q_PROPERTY(int highestLevel READ highestLevel NOTIFY levelsChanged)
+    Q_PROPERTY(QVariantMap thresholds READ thresholds NOTIFY thresholdsChanged)
+public:
+    explicit AlarmEngine(QObject *parent = nullptr);
+
+    // 通道名 → 状态（0 正常，1 超标，2 严重超标）
+    QVariantMap levels() const { return m_levels; }
+    int activeCount() const;
+    int highestLevel() const;
+    // 通道名 → {warning, critical, deadband, minDurationMs}；运行时修改阈值后发出 thresholdsChanged
+    QVariantMap thresholds() const { return m_thresholds; }
+
+    // 阈值以帧中上报的单位为准；未知通道返回 0
+    Q_INVOKABLE double warningThreshold(const QString& key) const;
+    Q_INVOKABLE double criticalThreshold(const QString& key) const;
+    // 运行时修改阈值，回差默认取两级阈值差的 10%
+    Q_INVOKABLE bool setThreshold(const QString& key, double warning, double critical, double deadband = -1.0);
+    Q_INVOKABLE bool setMinDuration(const QString& key, int milliseconds);
+    // 全部通道的去抖时长
+    void setMinDuration(int milliseconds);
+
+public slots:
+    // 与 SensorModule::sensorDataParsed 的参数一致
+    void evaluateFrame(int co2, int ch2o, int tvoc, int pm25, int pm10,
+                       double airTemp, double humidity,
+                       int turbidity, double ph, int tds, double waterTemp,
+                       int levelValue);
+
+signals:
+    void levelsChanged();
+    void thresholdsChanged();
+    void alarmChanged(const QString& key, int level, int previous, double value);
+
+private:
+    void updateLevels();
+    void updateThresholds();
+
+    AlarmEvaluator m_evaluator;
+    QVariantMap m_levels;
+    QVariantMap m_thresholds;
+
+    LatencyHistogram* m_evaluateLatency;
+    MetricCounter* m_transitions;
+};
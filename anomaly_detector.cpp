@@ -0,0 +1,337 @@
+#include "anomaly_detector.h"
+#include "alarm_engine.h"
+#include "database.h"
+#include "metrics.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace {
+
+constexpr double MAD_TO_SIGMA = 1.4826;
+constexpr double ROBUST_STEP = 0.2;     // 中位数与 MAD 每步的移动量（相对 alpha × 离散度）
+constexpr int MIN_SEGMENT_SAMPLES = 10000;
+const QString JOB_GROUP = QStringLiteral("anomaly");
+
+// 离散度下限：避免读数长时间不变后方差趋于 0，任何微小变化都被判为尖峰
+double spreadFloor(double center, double tolerance)
+{
+    return 1e-3 * std::max(1.0, std::abs(center)) + tolerance;
+}
+
+// 库中时间戳按 UTC 解析得到的秒数转回本地时间
+QDateTime localTime(double seconds)
+{
+    QDateTime time = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(seconds * 1000.0), Qt::UTC);
+    time.setTimeSpec(Qt::LocalTime);
+    return time;
+}
+
+}
+
+ChannelAnomalyDetector::ChannelAnomalyDetector(const AnomalyConfig& config)
+    : m_config(config)
+{
+}
+
+void ChannelAnomalyDetector::reset()
+{
+    *this = ChannelAnomalyDetector(m_config);
+}
+
+ChannelAnomalyDetector::Kind ChannelAnomalyDetector::update(double value, double seconds)
+{
+    if (m_count == 0) {
+        m_mean = m_median = value;
+        m_variance = m_mad = 0.0;
+        m_expected = value;
+        m_spread = spreadFloor(value, m_config.stuckTolerance);
+        m_score = 0.0;
+        m_stuckValue = value;
+        m_stuckSince = seconds;
+        m_stuckReported = false;
+        m_count = 1;
+        return None;
+    }
+
+    const bool robust = m_config.mode == AnomalyConfig::Robust && m_count > m_config.warmup;
+    m_expected = robust ? m_median : m_mean;
+    m_spread = std::max(robust ? MAD_TO_SIGMA * m_mad : std::sqrt(m_variance),
+                        spreadFloor(m_expected, m_config.stuckTolerance));
+    m_score = (value - m_expected) / m_spread;
+
+    Kind kind = None;
+    double x = value;
+    if (m_count >= m_config.warmup && std::abs(m_score) > m_config.threshold) {
+        kind = Spike;
+        x = m_expected + std::copysign(m_config.threshold * m_spread, m_score);
+    }
+
+    // 指数加权均值与方差（增量形式）
+    const double diff = x - m_mean;
+    const double increment = m_config.alpha * diff;
+    m_mean += increment;
+    m_variance = (1.0 - m_config.alpha) * (m_variance + diff * increment);
+
+    if (m_config.mode == AnomalyConfig::Robust) {
+        if (m_count <= m_config.warmup) {
+            // 预热期用均值与标准差初始化
+            m_median = m_mean;
+            m_mad = std::sqrt(m_variance) / MAD_TO_SIGMA;
+        } else {
+            // 中位数与 MAD 各按符号走一步，步长与当前离散度成比例
+            const double step = ROBUST_STEP * m_config.alpha * m_spread;
+            m_median += x > m_median ? step : (x < m_median ? -step : 0.0);
+            const double deviation = std::abs(x - m_median);
+            m_mad = std::max(0.0, m_mad + (deviation > m_mad ? step : (deviation < m_mad ? -step : 0.0)));
+        }
+    }
+    ++m_count;
+
+    if (m_config.stuckSeconds > 0.0) {
+        if (std::abs(value - m_stuckValue) <= m_config.stuckTolerance) {
+            if (!m_stuckReported && kind == None && seconds - m_stuckSince >= m_config.stuckSeconds) {
+                m_stuckReported = true;
+                kind = Stuck;
+            }
+        } else {
+            m_stuckValue = value;
+            m_stuckSince = seconds;
+            m_stuckReported = false;
+        }
+    }
+    return kind;
+}
+
+QVector<AnomalyHit> detectAnomalies(const QVector<double>& seconds, const QVector<float>& values,
+                                    const AnomalyConfig& config, int threads,
+                                    QVector<float>* lower, QVector<float>* upper)
+{
+    const int n = values.size();
+    if (lower) lower->resize(n);
+    if (upper) upper->resize(n);
+    threads = std::clamp(threads, 1, std::max(1, n / MIN_SEGMENT_SAMPLES));
+
+    std::vector<QVector<AnomalyHit>> partial(threads);
+    auto runSegment = [&](int segment) {
+        const int begin = static_cast<int>(static_cast<qint64>(n) * segment / threads);
+        const int end = static_cast<int>(static_cast<qint64>(n) * (segment + 1) / threads);
+        int start = std::max(0, begin - AnomalyMonitor::WARMUP_OVERLAP);
+        while (start > 0 && std::abs(values[start - 1] - values[start]) <= config.stuckTolerance) --start;
+
+        ChannelAnomalyDetector detector(config);
+        QVector<AnomalyHit>& hits = partial[segment];
+        for (int i = start; i < end; ++i) {
+            const ChannelAnomalyDetector::Kind kind = detector.update(values[i], seconds[i]);
+            if (i < begin) continue;
+            if (lower) (*lower)[i] = static_cast<float>(detector.lower());
+            if (upper) (*upper)[i] = static_cast<float>(detector.upper());
+            if (kind != ChannelAnomalyDetector::None) {
+                hits.append({i, kind, values[i], static_cast<float>(detector.score()),
+                             static_cast<float>(detector.expected())});
+            }
+        }
+    };
+
+    JobScheduler::instance().parallelFor(threads, runSegment);
+
+    QVector<AnomalyHit> hits;
+    for (const QVector<AnomalyHit>& segment : partial) hits += segment;
+    return hits;
+}
+
+AnomalyMonitor::AnomalyMonitor(QObject *parent)
+    : QObject(parent)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_spikes = metrics.counter("usv_anomaly_spikes_total", "Sensor readings flagged as spikes");
+    m_stuck = metrics.counter("usv_anomaly_stuck_total", "Sensor channels flagged as stuck");
+    resetDetectors();
+}
+
+void AnomalyMonitor::resetDetectors()
+{
+    m_detectors.fill(ChannelAnomalyDetector(m_config), AlarmEvaluator::CHANNEL_COUNT);
+}
+
+void AnomalyMonitor::setMode(int mode)
+{
+    const AnomalyConfig::Mode value = mode == AnomalyConfig::Robust ? AnomalyConfig::Robust : AnomalyConfig::Ewma;
+    if (value == m_config.mode) return;
+    m_config.mode = value;
+    resetDetectors();
+    emit modeChanged();
+}
+
+void AnomalyMonitor::setStuckSeconds(double seconds)
+{
+    m_config.stuckSeconds = seconds;
+    resetDetectors();
+}
+
+void AnomalyMonitor::evaluateFrame(int co2, int ch2o, int tvoc, int pm25, int pm10,
+                                   double airTemp, double humidity,
+                                   int turbidity, double ph, int tds, double waterTemp,
+                                   int levelValue)
+{
+    const double values[AlarmEvaluator::CHANNEL_COUNT] = {
+        double(co2), double(ch2o), double(tvoc), double(pm25), double(pm10), airTemp, humidity,
+        double(turbidity), ph, double(tds), waterTemp, double(levelValue)
+    };
+    const double now = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+
+    int found = 0;
+    for (int c = 0; c < AlarmEvaluator::CHANNEL_COUNT; ++c) {
+        ChannelAnomalyDetector& detector = m_detectors[c];
+        const ChannelAnomalyDetector::Kind kind = detector.update(values[c], now);
+        if (kind == ChannelAnomalyDetector::None) continue;
+
+        ++found;
+        (kind == ChannelAnomalyDetector::Spike ? m_spikes : m_stuck)->add();
+        emit anomalyDetected(QLatin1String(AlarmEvaluator::channelKey(c)), kind, values[c],
+                             detector.score(), detector.expected());
+    }
+    if (found) {
+        m_anomalyCount += found;
+        emit anomalyCountChanged();
+    }
+}
+
+void AnomalyMonitor::release()
+{
+    if (--m_running == 0) emit busyChanged();
+}
+
+void AnomalyMonitor::requestBatch(int requestId, const QString& key, const QDateTime& from, const QDateTime& to,
+                                  int vesselId)
+{
+    if (!m_database) return;
+    const int channel = key.isEmpty() ? -1 : AlarmEvaluator::channelFromKey(key);
+    if (!key.isEmpty() && channel < 0) return;
+
+    const AnomalyConfig config = m_config;
+    const ResultKey cacheKey{QString("%1/%2/%3/%4").arg(vesselId).arg(key.isEmpty() ? QStringLiteral("*") : key)
+                                 .arg(config.mode).arg(config.stuckSeconds),
+                             from, to, MAX_CHART_POINTS};
+    const JobScheduler::CancelFlag token = JobScheduler::instance().supersede(JOB_GROUP);
+    if (m_running++ == 0) emit busyChanged();
+
+    // 命中缓存说明该区间已检测并写库，直接返回结果
+    if (auto cached = m_cache.find(cacheKey)) {
+        QMetaObject::invokeMethod(this, [=]() {
+            if (!token->load()) {
+                emit batchFinished(requestId, key, cached->series, cached->anomalies, cached->samples,
+                                   cached->anomalyTotal, 0.0);
+            }
+            release();
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    // 数据库线程读取序列，调度器中分段并行检测，检测结果再排队写回数据库
+    Database* database = m_database;
+    QMetaObject::invokeMethod(database, [=]() {
+        auto series = std::make_shared<SensorSeries>();
+        const QDateTime loadedAt = QDateTime::currentDateTime();
+        if (!token->load()) database->sensorSeries(from, to, vesselId, *series);
+
+        auto result = std::make_shared<BatchResult>();
+        auto records = std::make_shared<QVector<SensorAnomaly>>();
+        auto elapsedMs = std::make_shared<double>(0.0);
+        JobScheduler::instance().submit(token, JobScheduler::Interactive, this,
+            [=](const std::atomic<bool>& cancelled) {
+                QElapsedTimer timer;
+                timer.start();
+
+                struct Found {
+                    int channel;
+                    AnomalyHit hit;
+                };
+                QVector<Found> found;
+                const int first = channel >= 0 ? channel : 0;
+                const int last = channel >= 0 ? channel : AlarmEvaluator::CHANNEL_COUNT - 1;
+                for (int c = first; c <= last; ++c) {
+                    if (cancelled.load()) return;
+                    QVector<float> lower, upper;
+                    const bool withChart = channel >= 0;
+                    const QVector<AnomalyHit> hits = detectAnomalies(series->seconds, series->channels[c], config,
+                                                                     JobScheduler::instance().threadCount(),
+                                                                     withChart ? &lower : nullptr,
+                                                                     withChart ? &upper : nullptr);
+                    for (const AnomalyHit& hit : hits) found.append({c, hit});
+
+                    if (withChart && series->size() > 0) {
+                        const int stride = (series->size() + MAX_CHART_POINTS - 1) / MAX_CHART_POINTS;
+                        for (int i = 0; i < series->size(); i += stride) {
+                            result->series.append(QVariantMap{
+                                {"time", localTime(series->seconds[i])},
+                                {"value", series->channels[c][i]},
+                                {"lower", lower[i]},
+                                {"upper", upper[i]}
+                            });
+                        }
+                    }
+                }
+
+                for (const Found& f : qAsConst(found)) {
+                    SensorAnomaly record;
+                    record.sensorId = series->ids[f.hit.index];
+                    record.vesselId = vesselId;
+                    record.timestamp = QDateTime::fromMSecsSinceEpoch(
+                        static_cast<qint64>(series->seconds[f.hit.index] * 1000.0), Qt::UTC).toString("yyyy-MM-ddTHH:mm:ss");
+                    record.channel = QLatin1String(AlarmEvaluator::channelKey(f.channel));
+                    record.kind = f.hit.kind;
+                    record.value = f.hit.value;
+                    record.score = f.hit.score;
+                    record.expected = f.hit.expected;
+                    records->append(record);
+                }
+
+                // 返回给界面的异常：卡滞优先，其余按 |z| 取最大的若干个，再按时间排序
+                auto severity = [](const Found& f) {
+                    return f.hit.kind == ChannelAnomalyDetector::Stuck ? std::numeric_limits<float>::max()
+                                                                       : std::abs(f.hit.score);
+                };
+                if (found.size() > MAX_REPORTED_ANOMALIES) {
+                    std::nth_element(found.begin(), found.begin() + MAX_REPORTED_ANOMALIES, found.end(),
+                                     [&severity](const Found& a, const Found& b) { return severity(a) > severity(b); });
+                    found.resize(MAX_REPORTED_ANOMALIES);
+                }
+                std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) {
+                    return a.hit.index < b.hit.index;
+                });
+                for (const Found& f : qAsConst(found)) {
+                    result->anomalies.append(QVariantMap{
+                        {"time", localTime(series->seconds[f.hit.index])},
+                        {"key", QLatin1String(AlarmEvaluator::channelKey(f.channel))},
+                        {"kind", f.hit.kind},
+                        {"value", f.hit.value},
+                        {"score", f.hit.score},
+                        {"expected", f.hit.expected}
+                    });
+                }
+                result->samples = series->size();
+                result->anomalyTotal = records->size();
+                *elapsedMs = timer.nsecsElapsed() / 1e6;
+            },
+            [=](bool cancelled) {
+                if (!cancelled) {
+                    QMetaObject::invokeMethod(database, [database, records]() {
+                        database->insertAnomalies(*records);
+                    }, Qt::QueuedConnection);
+                    if (ResultCache<BatchResult>::cacheable(cacheKey, loadedAt)) {
+                        m_cache.insert(cacheKey, result, result->series.size() + result->anomalies.size() + 1);
+                    }
+
+                    qDebug() << "异常批量检测完成，样本数:" << result->samples << "异常数:" << result->anomalyTotal
+                             << "耗时:" << *elapsedMs << "ms";
+                    emit batchFinished(requestId, key, result->series, result->anomalies, result->samples,
+                                       result->anomalyTotal, *elapsedMs);
+                }
+                release();
+            });
+    }, Qt::QueuedConnection);
+}
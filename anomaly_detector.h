@@ -0,0 +1,143 @@
+#pragma once
+
+#include "database.h"
+#include "job_scheduler.h"
+#include <QDateTime>
+#include <QObject>
+#include <QVariantList>
+#include <QVector>
+
+class MetricCounter;
+
+struct AnomalyConfig {
+    enum Mode {
+        Ewma = 0,       // 指数加权均值与方差
+        Robust = 1      // 随机逼近估计中位数与 MAD，对成片离群值不敏感
+    };
+
+    Mode mode = Ewma;
+    double alpha = 0.05;            // 学习率（约 20 个样本的记忆）
+    double threshold = 4.0;         // |z| 超过该值判为尖峰
+    int warmup = 30;                // 前 warmup 个样本只学习不报警
+    double stuckTolerance = 0.0;    // 与卡滞起点相差不超过该值视为未变化
+    double stuckSeconds = 600.0;    // 读数不变超过该时长判为卡滞，<= 0 时不检测
+};
+
+// 单通道流式异常检测：每个样本 O(1) 时间、固定内存。
+// 尖峰按 z 分数判断，参与学习前先截断到阈值边界，避免单个离群值拉偏基线；
+// 卡滞在读数持续不变达到 stuckSeconds 时报告一次，读数变化后重新计时。
+class ChannelAnomalyDetector {
+public:
+    enum Kind { None = 0, Spike = 1, Stuck = 2 };
+
+    explicit ChannelAnomalyDetector(const AnomalyConfig& config = AnomalyConfig());
+
+    Kind update(double value, double seconds);
+    void reset();
+
+    // 本次 update 前的基线估计
+    double expected() const { return m_expected; }
+    double lower() const { return m_expected - m_config.threshold * m_spread; }
+    double upper() const { return m_expected + m_config.threshold * m_spread; }
+    double score() const { return m_score; }
+
+private:
+    AnomalyConfig m_config;
+    qint64 m_count = 0;
+    double m_mean = 0.0;
+    double m_variance = 0.0;
+    double m_median = 0.0;
+    double m_mad = 0.0;
+
+    double m_expected = 0.0;
+    double m_spread = 0.0;
+    double m_score = 0.0;
+
+    double m_stuckValue = 0.0;
+    double m_stuckSince = 0.0;
+    bool m_stuckReported = false;
+};
+
+struct AnomalyHit {
+    int index;          // 序列下标
+    int kind;
+    float value;
+    float score;
+    float expected;
+};
+
+// 批量检测一个通道：序列按时间切成 threads 段，在 JobScheduler 中并行处理，每段先用前面至少 WARMUP_OVERLAP 个样本预热，
+// 预热起点退到读数不变区段的开头，卡滞判定与顺序处理一致；EWMA 模式预热后与顺序处理的结果相同，
+// 稳健模式的中位数估计与起点有关，段首附近个别样本的判定可能不同。
+// lower / upper 非空时写出每个样本的正常范围
+QVector<AnomalyHit> detectAnomalies(const QVector<double>& seconds, const QVector<float>& values,
+                                    const AnomalyConfig& config, int threads,
+                                    QVector<float>* lower = nullptr, QVector<float>* upper = nullptr);
+
+// 传感器异常监测：实时帧逐通道检测并发出 anomalyDetected；也可对历史区间批量检测并写回数据库
+class AnomalyMonitor : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int mode READ mode WRITE setMode NOTIFY modeChanged)
+    Q_PROPERTY(int anomalyCount READ anomalyCount NOTIFY anomalyCountChanged)
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+public:
+    static constexpr int WARMUP_OVERLAP = 2000;
+    static constexpr int MAX_CHART_POINTS = 1000;
+    static constexpr int MAX_REPORTED_ANOMALIES = 500;
+    static constexpr qint64 RESULT_CACHE_ITEMS = 30000;     // 缓存结果中曲线点与异常条目的总数上限
+
+    explicit AnomalyMonitor(QObject *parent = nullptr);
+
+    int mode() const { return m_config.mode; }
+    void setMode(int mode);
+    int anomalyCount() const { return m_anomalyCount; }
+    bool busy() const { return m_running > 0; }
+
+    // 卡滞判定时长，<= 0 关闭
+    void setStuckSeconds(double seconds);
+    void setDatabase(Database* database) { m_database = database; }
+
+    // 对 vesselId 的历史区间批量检测；key 为空时检测全部通道（只返回异常，不返回曲线）。
+    // 检测到的异常写入 sensor_anomalies，结果经 batchFinished 返回；新请求取代未完成的旧请求，
+    // 已结束区间的结果按（船只、通道与检测参数, 区间）缓存，命中时不再重复写库
+    Q_INVOKABLE void requestBatch(int requestId, const QString& key, const QDateTime& from, const QDateTime& to,
+                                  int vesselId = PRIMARY_VESSEL_ID);
+
+public slots:
+    // 与 SensorModule::sensorDataParsed 的参数一致
+    void evaluateFrame(int co2, int ch2o, int tvoc, int pm25, int pm10,
+                       double airTemp, double humidity,
+                       int turbidity, double ph, int tds, double waterTemp,
+                       int levelValue);
+
+signals:
+    void modeChanged();
+    void anomalyCountChanged();
+    void busyChanged();
+    void anomalyDetected(const QString& key, int kind, double value, double score, double expected);
+    // series 每项为 {time, value, lower, upper}（抽稀到 MAX_CHART_POINTS 以内），
+    // anomalies 每项为 {time, key, kind, value, score, expected}（最多 MAX_REPORTED_ANOMALIES 个，按 |score| 取最大）
+    void batchFinished(int requestId, const QString& key, const QVariantList& series, const QVariantList& anomalies,
+                       int samples, int anomalyTotal, double elapsedMs);
+
+private:
+    struct BatchResult {
+        QVariantList series;
+        QVariantList anomalies;
+        int samples = 0;
+        int anomalyTotal = 0;
+    };
+
+    void resetDetectors();
+    void release();
+
+    AnomalyConfig m_config;
+    QVector<ChannelAnomalyDetector> m_detectors;
+    Database* m_database = nullptr;
+    int m_anomalyCount = 0;
+    int m_running = 0;              // 已发起、尚未结束（含已取消）的请求数
+    ResultCache<BatchResult> m_cache{RESULT_CACHE_ITEMS};
+
+    MetricCounter* m_spikes;
+    MetricCounter* m_stuck;
+};
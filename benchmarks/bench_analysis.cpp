@@ -0,0 +1,241 @@
+// bench_analysis.cpp
+// 阈值告警、异常检测、相关矩阵与趋势分析
+#include "bench_fixture.h"
+#include "alarm_engine.h"
+#include "anomaly_detector.h"
+#include "correlation_engine.h"
+#include "geodesy.h"
+#include "trend_analysis.h"
+#include <QThread>
+#include <QtTest>
+#include <algorithm>
+#include <cmath>
+
+using namespace BenchFixture;
+
+class AnalysisBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void alarmEvaluate();
+    void anomalyDetect_data();
+    void anomalyDetect();
+    void correlationMatrix_data();
+    void correlationMatrix();
+    void correlationWindow();
+    void trendAnalyze_data();
+    void trendAnalyze();
+};
+
+void AnalysisBenchmark::alarmEvaluate()
+{
+    // 预生成 4096 帧读数，约 10% 的帧越过警戒阈值，按 100 ms 间隔推进时间
+    constexpr int FRAMES = 4096;
+    QRandomGenerator rng(DATASET_SEED);
+    QVector<float> frames(FRAMES * AlarmEvaluator::CHANNEL_COUNT);
+    for (int f = 0; f < FRAMES; ++f) {
+        float* values = frames.data() + f * AlarmEvaluator::CHANNEL_COUNT;
+        const bool high = rng.bounded(10) == 0;
+        values[AlarmEvaluator::Co2] = high ? 1500 : 400 + rng.bounded(500);
+        values[AlarmEvaluator::Ch2o] = 10 + rng.bounded(60);
+        values[AlarmEvaluator::Tvoc] = 50 + rng.bounded(400);
+        values[AlarmEvaluator::Pm25] = rng.bounded(70);
+        values[AlarmEvaluator::Pm10] = rng.bounded(140);
+        values[AlarmEvaluator::AirTemperature] = 20 + rng.bounded(10);
+        values[AlarmEvaluator::Humidity] = 40 + rng.bounded(40);
+        values[AlarmEvaluator::Turbidity] = high ? 8 : rng.bounded(5);
+        values[AlarmEvaluator::Ph] = 6.5f + rng.generateDouble() * 1.5;
+        values[AlarmEvaluator::Tds] = high ? 700 : 100 + rng.bounded(300);
+        values[AlarmEvaluator::WaterTemperature] = 15 + rng.bounded(10);
+        values[AlarmEvaluator::LevelValue] = rng.bounded(100);
+    }
+
+    AlarmTransition transitions[AlarmEvaluator::CHANNEL_COUNT];
+
+    // 回差与去抖的确定性检查：CO₂ 警戒 1000、严重 2000、回差 100、去抖 500 ms
+    {
+        AlarmEvaluator checker;
+        checker.setThreshold(AlarmEvaluator::Co2, {1000.0f, 2000.0f, 100.0f, 500});
+        struct Step { qint64 ms; float co2; int level; };
+        const Step steps[] = {
+            {0, 1200, AlarmEvaluator::Normal},      // 越限未满 500 ms
+            {200, 900, AlarmEvaluator::Normal},     // 回落，去抖重新计时
+            {400, 1200, AlarmEvaluator::Normal},
+            {800, 1200, AlarmEvaluator::Normal},
+            {900, 1200, AlarmEvaluator::Warning},   // 持续 500 ms 后升级
+            {1000, 950, AlarmEvaluator::Warning},   // 在回差内保持
+            {1100, 850, AlarmEvaluator::Warning},
+            {1600, 850, AlarmEvaluator::Normal},    // 低于 900 持续 500 ms 后解除
+            {1700, 2500, AlarmEvaluator::Normal},
+            {2200, 2500, AlarmEvaluator::Critical}, // 直接升到严重
+        };
+        float values[AlarmEvaluator::CHANNEL_COUNT] = {};
+        int checked = 0;
+        for (const Step& step : steps) {
+            values[AlarmEvaluator::Co2] = step.co2;
+            checked += checker.evaluate(values, step.ms, transitions);
+            QCOMPARE(checker.level(AlarmEvaluator::Co2), step.level);
+        }
+        QCOMPARE(checked, 3);
+    }
+
+    AlarmEvaluator evaluator;
+    qint64 nowMs = 0;
+    int changes = 0;
+    QBENCHMARK {
+        for (int f = 0; f < FRAMES; ++f) {
+            changes += evaluator.evaluate(frames.constData() + f * AlarmEvaluator::CHANNEL_COUNT, nowMs, transitions);
+            nowMs += 100;
+        }
+    }
+    // 其余读数都在警戒阈值以下，越限帧彼此独立、远短于 1 s 去抖，不应产生任何状态变化
+    QCOMPARE(changes, 0);
+}
+
+void AnalysisBenchmark::anomalyDetect_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("ewma/1thread") << int(AnomalyConfig::Ewma) << 1;
+    QTest::newRow("ewma/allCores") << int(AnomalyConfig::Ewma) << QThread::idealThreadCount();
+    QTest::newRow("robust/allCores") << int(AnomalyConfig::Robust) << QThread::idealThreadCount();
+}
+
+void AnalysisBenchmark::anomalyDetect()
+{
+    QFETCH(int, mode);
+    QFETCH(int, threads);
+
+    // 1M 个 1 Hz 的 CO₂ 读数：日周期加噪声，每 25000 个样本注入一个尖峰，中间有一段 20 分钟的卡滞
+    constexpr int SAMPLES = 1000000;
+    constexpr int SPIKE_INTERVAL = 25000;
+    QRandomGenerator rng(DATASET_SEED);
+    QVector<double> seconds(SAMPLES);
+    QVector<float> values(SAMPLES);
+    for (int i = 0; i < SAMPLES; ++i) {
+        seconds[i] = i;
+        values[i] = 600 + 150 * std::sin(i * 2 * Geodesy::PI / 86400) + rng.bounded(40);
+        if (i % SPIKE_INTERVAL == SPIKE_INTERVAL / 2) values[i] += 2000;
+    }
+    std::fill(values.begin() + SAMPLES / 2, values.begin() + SAMPLES / 2 + 1200, values[SAMPLES / 2]);
+
+    AnomalyConfig config;
+    config.mode = static_cast<AnomalyConfig::Mode>(mode);
+    QVector<AnomalyHit> hits;
+    QBENCHMARK_ONCE {
+        hits = detectAnomalies(seconds, values, config, threads);
+    }
+    const int spikes = std::count_if(hits.begin(), hits.end(), [](const AnomalyHit& hit) {
+        return hit.kind == ChannelAnomalyDetector::Spike && hit.value > 2000;
+    });
+    const int stuck = std::count_if(hits.begin(), hits.end(), [](const AnomalyHit& hit) {
+        return hit.kind == ChannelAnomalyDetector::Stuck;
+    });
+    QVERIFY(spikes >= SAMPLES / SPIKE_INTERVAL * 9 / 10);
+    QCOMPARE(stuck, 1);
+
+    // EWMA 分段预热后应与顺序处理逐个命中一致
+    if (config.mode == AnomalyConfig::Ewma && threads > 1) {
+        const QVector<AnomalyHit> sequential = detectAnomalies(seconds, values, config, 1);
+        QCOMPARE(hits.size(), sequential.size());
+        for (int i = 0; i < hits.size(); ++i) {
+            QCOMPARE(hits[i].index, sequential[i].index);
+            QCOMPARE(hits[i].kind, sequential[i].kind);
+        }
+    }
+}
+
+void AnalysisBenchmark::correlationMatrix_data()
+{
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("1thread") << 1;
+    QTest::newRow("allCores") << QThread::idealThreadCount();
+}
+
+void AnalysisBenchmark::correlationMatrix()
+{
+    QFETCH(int, threads);
+
+    // 1M 帧 × 12 通道：CO₂ 与空气温度同受一个公共因子驱动，其余通道独立
+    constexpr int SAMPLES = 1000000;
+    QRandomGenerator rng(DATASET_SEED);
+    SensorSeries series;
+    series.ids.resize(SAMPLES);
+    series.seconds.resize(SAMPLES);
+    for (QVector<float>& channel : series.channels) channel.resize(SAMPLES);
+    for (int i = 0; i < SAMPLES; ++i) {
+        series.ids[i] = i + 1;
+        series.seconds[i] = i;
+        const double common = rng.generateDouble();
+        for (int c = 0; c < SensorSeries::CHANNEL_COUNT; ++c) series.channels[c][i] = rng.generateDouble() * 10;
+        series.channels[AlarmEvaluator::Co2][i] += 400 + common * 200;
+        series.channels[AlarmEvaluator::AirTemperature][i] += 15 + common * 20;
+    }
+
+    CoMoments moments;
+    QBENCHMARK {
+        moments = CoMoments::fromSeriesParallel(series, threads);
+    }
+    QCOMPARE(moments.count(), qint64(SAMPLES));
+    QVERIFY(moments.pearson(AlarmEvaluator::Co2, AlarmEvaluator::AirTemperature) > 0.8);
+    QVERIFY(std::abs(moments.pearson(AlarmEvaluator::Co2, AlarmEvaluator::Tds)) < 0.01);
+}
+
+void AnalysisBenchmark::correlationWindow()
+{
+    // 3600 帧的实时窗口持续滚动，每帧增删一次协矩
+    constexpr int FRAMES = 10000;
+    QRandomGenerator rng(DATASET_SEED);
+    QVector<double> frames(FRAMES * CoMoments::CHANNELS);
+    for (double& value : frames) value = rng.generateDouble() * 100;
+
+    CorrelationWindow window(3600);
+    QBENCHMARK {
+        for (int f = 0; f < FRAMES; ++f) window.push(frames.constData() + f * CoMoments::CHANNELS);
+    }
+    QCOMPARE(window.size(), 3600);
+}
+
+void AnalysisBenchmark::trendAnalyze_data()
+{
+    QTest::addColumn<double>("windowHours");
+
+    QTest::newRow("window1h") << 1.0;
+    QTest::newRow("window24h") << 24.0;
+}
+
+void AnalysisBenchmark::trendAnalyze()
+{
+    QFETCH(double, windowHours);
+
+    // 1M 个 1 Hz 的 TDS 读数（约 11.6 天）：每天上升 5 ppm，叠加日周期与噪声
+    constexpr int SAMPLES = 1000000;
+    QRandomGenerator rng(DATASET_SEED);
+    QVector<double> seconds(SAMPLES);
+    QVector<float> values(SAMPLES);
+    for (int i = 0; i < SAMPLES; ++i) {
+        seconds[i] = i;
+        values[i] = 300 + 5.0 * i / 86400 + 40 * std::sin(i * 2 * Geodesy::PI / 86400) + rng.bounded(20);
+    }
+
+    TrendAnalysis::Options options;
+    options.windowSeconds = windowHours * 3600;
+    TrendAnalysis::Result result;
+    QBENCHMARK {
+        result = TrendAnalysis::analyze(seconds, values, options);
+    }
+    // 不足一整天的周期尾巴会让回归斜率略有偏差
+    QCOMPARE(result.count, SAMPLES);
+    QVERIFY(result.movingAverage.size() <= options.maxPoints + 1);
+    QVERIFY(std::abs(result.slopePerDay - 5.0) < 0.5);
+    QCOMPARE(result.peakHour, 6);
+}
+
+std::unique_ptr<QObject> createAnalysisBenchmark()
+{
+    return std::make_unique<AnalysisBenchmark>();
+}
+
+#include "bench_analysis.moc"
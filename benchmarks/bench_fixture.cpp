@@ -0,0 +1,154 @@
+#include "bench_fixture.h"
+#include "database.h"
+#include "frame_constants.h"
+#include <QDateTime>
+#include <QDir>
+#include <QTemporaryDir>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+using namespace FrameConstants;
+
+namespace BenchFixture {
+
+namespace {
+
+constexpr int VESSELS = 20;
+constexpr int FIXES_PER_VESSEL = 10000;
+
+QTemporaryDir* s_dbDir = nullptr;
+QString s_previousDir;
+Database* s_database = nullptr;
+bool s_trajectoryPopulated = false;
+bool s_sensorPopulated = false;
+
+}
+
+QByteArray makeFrame(QRandomGenerator& rng)
+{
+    QByteArray frame(RECEIVE_FRAME_SIZE, 0);
+    frame[0] = static_cast<char>(FRAME_HEADER);
+    frame[1] = static_cast<char>(FRAME_TRAILER);
+    for (int i = SENSOR_DATA_OFFSET; i < RECEIVE_FRAME_SIZE; ++i) {
+        frame[i] = static_cast<char>(rng.bounded(0, 0xFF));
+    }
+    return frame;
+}
+
+QByteArray makeStream(quint32 seed, int frames, int noisePercent)
+{
+    QRandomGenerator rng(seed);
+    QByteArray stream;
+    stream.reserve(frames * (RECEIVE_FRAME_SIZE + 4));
+    for (int i = 0; i < frames; ++i) {
+        if (rng.bounded(100) < noisePercent) {
+            const int noise = rng.bounded(1, 5);
+            for (int k = 0; k < noise; ++k) stream.append(static_cast<char>(rng.bounded(0, 0xFF)));
+        }
+        stream.append(makeFrame(rng));
+    }
+    return stream;
+}
+
+QString makeMergedHex(quint32 seed)
+{
+    QRandomGenerator rng(seed);
+    return makeFrame(rng).mid(SENSOR_DATA_OFFSET, 47).toHex().toUpper();
+}
+
+Database* database()
+{
+    if (s_database) return s_database;
+
+    // Database 在当前目录下建库，切到临时目录以免污染工作目录
+    s_dbDir = new QTemporaryDir;
+    if (!s_dbDir->isValid()) return nullptr;
+    s_previousDir = QDir::currentPath();
+    QDir::setCurrent(s_dbDir->path());
+
+    s_database = new Database;
+    if (!s_database->initialize()) {
+        delete s_database;
+        s_database = nullptr;
+    }
+    return s_database;
+}
+
+void shutdown()
+{
+    if (s_database) {
+        s_database->shutdown();
+        delete s_database;
+        s_database = nullptr;
+    }
+    if (s_dbDir) {
+        QDir::setCurrent(s_previousDir);
+        delete s_dbDir;
+        s_dbDir = nullptr;
+    }
+}
+
+// 随机游走航迹，共 200k 个定位点（空间索引由触发器维护）
+bool populateTrajectory()
+{
+    if (s_trajectoryPopulated) return true;
+    if (!database()) return false;
+
+    QRandomGenerator rng(DATASET_SEED);
+    const QDateTime start(QDate(2024, 6, 1), QTime(0, 0));
+
+    QSqlDatabase db = QSqlDatabase::database();
+    if (!db.transaction()) return false;
+    QSqlQuery query;
+    query.prepare("INSERT INTO trajectory_data (vessel_id, timestamp, latitude, longitude) VALUES (?, ?, ?, ?)");
+    for (int vessel = 0; vessel < VESSELS; ++vessel) {
+        double latitude = 22.0 + rng.generateDouble() * 0.2;
+        double longitude = 113.0 + rng.generateDouble() * 0.2;
+        for (int i = 0; i < FIXES_PER_VESSEL; ++i) {
+            latitude = qBound(22.0, latitude + (rng.generateDouble() - 0.5) * 2e-4, 22.2);
+            longitude = qBound(113.0, longitude + (rng.generateDouble() - 0.5) * 2e-4, 113.2);
+            query.addBindValue(vessel);
+            query.addBindValue(start.addSecs(i).toString(Qt::ISODate));
+            query.addBindValue(latitude);
+            query.addBindValue(longitude);
+            if (!query.exec()) {
+                db.rollback();
+                return false;
+            }
+        }
+    }
+    s_trajectoryPopulated = db.commit();
+    return s_trajectoryPopulated;
+}
+
+// 与航迹同一时段、每船每秒一条
+bool populateSensorData()
+{
+    if (s_sensorPopulated) return true;
+    if (!database()) return false;
+
+    QRandomGenerator rng(DATASET_SEED);
+    const QDateTime start(QDate(2024, 6, 1), QTime(0, 0));
+
+    QSqlDatabase db = QSqlDatabase::database();
+    if (!db.transaction()) return false;
+    QSqlQuery query;
+    query.prepare("INSERT INTO sensor_data (vessel_id, timestamp, ph, water_temperature, turbidity) VALUES (?, ?, ?, ?, ?)");
+    for (int vessel = 0; vessel < VESSELS; ++vessel) {
+        for (int i = 0; i < FIXES_PER_VESSEL; ++i) {
+            query.addBindValue(vessel);
+            query.addBindValue(start.addSecs(i).toString(Qt::ISODate));
+            query.addBindValue(6.5 + rng.generateDouble() * 2);
+            query.addBindValue(18.0 + rng.generateDouble() * 6);
+            query.addBindValue(rng.bounded(100));
+            if (!query.exec()) {
+                db.rollback();
+                return false;
+            }
+        }
+    }
+    s_sensorPopulated = db.commit();
+    return s_sensorPopulated;
+}
+
+}
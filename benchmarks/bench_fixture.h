@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QString>
+#include <memory>
+
+class Database;
+
+// 各基准分组共用的固定种子数据集与临时数据库
+namespace BenchFixture {
+
+constexpr quint32 DATASET_SEED = 20240601;
+constexpr int DATASET_FRAMES = 1000;
+
+// 生成一帧：帧头帧尾固定，载荷避开 0xFF 以免误同步
+QByteArray makeFrame(QRandomGenerator& rng);
+// 连续帧流，noisePercent 为帧间插入噪声字节的概率
+QByteArray makeStream(quint32 seed, int frames, int noisePercent);
+// 模块收到的合并数据（去掉帧头帧尾后的 47 字节十六进制）
+QString makeMergedHex(quint32 seed);
+
+// 临时目录中的共享数据库，首次调用时创建；创建失败返回 nullptr
+Database* database();
+// 关闭数据库并恢复工作目录，全部分组运行结束后调用
+void shutdown();
+
+// 20 条船在约 20 km 见方范围内的航迹与同时段的传感器记录，各只写入一次
+bool populateTrajectory();
+bool populateSensorData();
+
+}
+
+// 各分组的 QtTest 对象，分别定义在 bench_<分组>.cpp 中
+std::unique_ptr<QObject> createIngestBenchmark();
+std::unique_ptr<QObject> createMissionBenchmark();
+std::unique_ptr<QObject> createGeoBenchmark();
+std::unique_ptr<QObject> createAnalysisBenchmark();
+std::unique_ptr<QObject> createJobBenchmark();
@@ -0,0 +1,268 @@
+// bench_geo.cpp
+// 测地计算、地理围栏、航迹空间查询、样本地理配准、热力图与表面插值
+#include "bench_fixture.h"
+#include "database.h"
+#include "geodesy.h"
+#include "geofence.h"
+#include "heatmap.h"
+#include "surface_interpolation.h"
+#include <QDateTime>
+#include <QThread>
+#include <QtTest>
+#include <cmath>
+
+using namespace BenchFixture;
+
+class GeoBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void geodesicSegments_data();
+    void geodesicSegments();
+    void geofenceQuery_data();
+    void geofenceQuery();
+    void trajectorySpatialQuery_data();
+    void trajectorySpatialQuery();
+    void georeferenceSamples();
+    void heatmapBuild_data();
+    void heatmapBuild();
+    void surfaceInterpolate_data();
+    void surfaceInterpolate();
+
+private:
+    Database* m_database = nullptr;
+};
+
+void GeoBenchmark::initTestCase()
+{
+    m_database = BenchFixture::database();
+    QVERIFY(m_database);
+}
+
+void GeoBenchmark::geodesicSegments_data()
+{
+    QTest::addColumn<bool>("batched");
+
+    QTest::newRow("batched") << true;
+    QTest::newRow("scalar") << false;
+}
+
+void GeoBenchmark::geodesicSegments()
+{
+    QFETCH(bool, batched);
+
+    // 1M 个点的随机游走轨迹，步长约数米
+    constexpr int POINTS = 1000000;
+    QRandomGenerator rng(DATASET_SEED);
+    QVector<double> lat(POINTS), lon(POINTS), out(POINTS - 1);
+    lat[0] = 22.0;
+    lon[0] = 113.0;
+    for (int i = 1; i < POINTS; ++i) {
+        lat[i] = lat[i - 1] + (rng.generateDouble() - 0.5) * 1e-4;
+        lon[i] = lon[i - 1] + (rng.generateDouble() - 0.5) * 1e-4;
+    }
+
+    QBENCHMARK {
+        if (batched) {
+            Geodesy::segmentDistances(lat.constData(), lon.constData(), POINTS, out.data());
+        } else {
+            for (int i = 0; i + 1 < POINTS; ++i) {
+                out[i] = Geodesy::distance(lat[i], lon[i], lat[i + 1], lon[i + 1]);
+            }
+        }
+    }
+
+    // 两种实现结果应一致（毫米级）
+    for (int i = 0; i + 1 < POINTS; i += 9973) {
+        QVERIFY(qAbs(out[i] - Geodesy::distance(lat[i], lon[i], lat[i + 1], lon[i + 1])) < 1e-3);
+    }
+}
+
+void GeoBenchmark::geofenceQuery_data()
+{
+    QTest::addColumn<int>("fenceCount");
+
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void GeoBenchmark::geofenceQuery()
+{
+    QFETCH(int, fenceCount);
+
+    // 围栏密度固定（约每 4 km² 一个，半径 200~1200 m 的随机多边形），区域随数量扩大
+    QRandomGenerator rng(DATASET_SEED);
+    const double span = 0.02 * std::sqrt(static_cast<double>(fenceCount));
+    QVector<Geofence> fences(fenceCount);
+    for (Geofence& fence : fences) {
+        const double centerLat = 22.0 + rng.generateDouble() * span;
+        const double centerLon = 113.0 + rng.generateDouble() * span;
+        const double radius = 0.002 + rng.generateDouble() * 0.009;
+        const int vertices = 5 + rng.bounded(20);
+        fence.kind = rng.bounded(2) ? Geofence::KeepOut : Geofence::Survey;
+        for (int i = 0; i < vertices; ++i) {
+            const double angle = 2 * Geodesy::PI * i / vertices;
+            const double r = radius * (0.5 + rng.generateDouble());
+            fence.polygon.append({centerLon + r * std::cos(angle), centerLat + r * std::sin(angle)});
+        }
+    }
+
+    GeofenceIndex index;
+    index.build(fences);
+
+    constexpr int FIXES = 10000;
+    QVector<double> lat(FIXES), lon(FIXES);
+    for (int i = 0; i < FIXES; ++i) {
+        lat[i] = 22.0 + rng.generateDouble() * span;
+        lon[i] = 113.0 + rng.generateDouble() * span;
+    }
+
+    QVector<GeofenceIndex::Hit> hits;
+    int insideCount = 0;
+    QBENCHMARK {
+        insideCount = 0;
+        for (int i = 0; i < FIXES; ++i) {
+            index.query(lat[i], lon[i], hits);
+            for (const GeofenceIndex::Hit& hit : qAsConst(hits)) insideCount += hit.inside;
+        }
+    }
+    QVERIFY(insideCount > 0);
+}
+
+void GeoBenchmark::trajectorySpatialQuery_data()
+{
+    QTest::addColumn<QString>("kind");
+
+    QTest::newRow("box1km") << "box";
+    QTest::newRow("radius50m") << "radius";
+    QTest::newRow("nearest") << "nearest";
+}
+
+void GeoBenchmark::trajectorySpatialQuery()
+{
+    QFETCH(QString, kind);
+
+    QVERIFY(populateTrajectory());
+    QVERIFY(m_database->hasSpatialIndex());
+
+    const double latitude = 22.1;
+    const double longitude = 113.1;
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        if (kind == "nearest") {
+            TrajectoryFix fix;
+            count = m_database->nearestTrajectoryFix(latitude, longitude, 5000.0, -1, fix) ? 1 : 0;
+        } else {
+            const TrajectoryQuery query = kind == "box"
+                ? TrajectoryQuery::inBox(latitude - 0.0045, longitude - 0.0045, latitude + 0.0045, longitude + 0.0045)
+                : TrajectoryQuery::around(latitude, longitude, 50.0);
+            qint64 lastId = 0;
+            count = m_database->queryTrajectory(query, [&lastId](const QVector<TrajectoryFix>& fixes) {
+                // 结果按时间（插入）顺序返回
+                for (const TrajectoryFix& fix : fixes) {
+                    if (fix.id <= lastId) return false;
+                    lastId = fix.id;
+                }
+                return true;
+            });
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+void GeoBenchmark::georeferenceSamples()
+{
+    QVERIFY(populateTrajectory());
+    QVERIFY(populateSensorData());
+
+    GeoSampleQuery query;
+    query.from = QDateTime(QDate(2024, 6, 1), QTime(0, 0));
+    query.to = query.from.addSecs(10000);
+
+    int count = 0;
+    int unmatched = 0;
+    QBENCHMARK {
+        count = m_database->georeferencedSamples(query, [](const QVector<GeoSample>&) { return true; }, &unmatched);
+    }
+    QCOMPARE(count, 200000);
+    QCOMPARE(unmatched, 0);
+}
+
+void GeoBenchmark::heatmapBuild_data()
+{
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("1thread") << 1;
+    QTest::newRow("allCores") << QThread::idealThreadCount();
+}
+
+void GeoBenchmark::heatmapBuild()
+{
+    QFETCH(int, threads);
+
+    // 1M 个样本，分布在约 20 km 见方的测区内
+    constexpr int SAMPLES = 1000000;
+    QRandomGenerator rng(DATASET_SEED);
+    QVector<HeatmapSample> samples(SAMPLES);
+    for (HeatmapSample& sample : samples) {
+        sample.latitude = 22.0 + rng.generateDouble() * 0.2;
+        sample.longitude = 113.0 + rng.generateDouble() * 0.2;
+        sample.values[HeatmapSample::Turbidity] = rng.bounded(100);
+        sample.values[HeatmapSample::Tds] = 300 + rng.bounded(200);
+        sample.values[HeatmapSample::Ph] = 6.5f + rng.generateDouble() * 2;
+    }
+
+    HeatmapPyramid pyramid;
+    QBENCHMARK_ONCE {
+        pyramid = HeatmapPyramid::build(samples, threads);
+    }
+    QCOMPARE(pyramid.total().count, quint32(SAMPLES));
+    QVERIFY(pyramid.cellCount(HeatmapPyramid::MIN_LEVEL) >= 1);
+}
+
+void GeoBenchmark::surfaceInterpolate_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("idw/1thread") << int(SurfaceInterpolation::InverseDistance) << 1;
+    QTest::newRow("idw/allCores") << int(SurfaceInterpolation::InverseDistance) << QThread::idealThreadCount();
+    QTest::newRow("kriging/allCores") << int(SurfaceInterpolation::OrdinaryKriging) << QThread::idealThreadCount();
+}
+
+void GeoBenchmark::surfaceInterpolate()
+{
+    QFETCH(int, method);
+    QFETCH(int, threads);
+
+    // 1M 个 TDS 样本（约 10 km 见方），插值到 1000×1000 网格
+    constexpr int SAMPLES = 1000000;
+    QRandomGenerator rng(DATASET_SEED);
+    QVector<SurfaceInterpolation::Point> points(SAMPLES);
+    for (SurfaceInterpolation::Point& point : points) {
+        point.latitude = 22.0 + rng.generateDouble() * 0.1;
+        point.longitude = 113.0 + rng.generateDouble() * 0.1;
+        point.value = 400 + 80 * std::sin(point.latitude * 200) + 40 * std::cos(point.longitude * 300);
+    }
+
+    SurfaceInterpolation::Options options;
+    options.method = static_cast<SurfaceInterpolation::Method>(method);
+    options.threads = threads;
+    SurfaceInterpolation::Grid grid;
+    QBENCHMARK_ONCE {
+        grid = SurfaceInterpolation::interpolate(points, 22.0, 113.0, 22.1, 113.1, options);
+    }
+    QCOMPARE(grid.filled, options.width * options.height);
+    QVERIFY(grid.minimum < 300 && grid.maximum > 500);
+}
+
+std::unique_ptr<QObject> createGeoBenchmark()
+{
+    return std::make_unique<GeoBenchmark>();
+}
+
+#include "bench_geo.moc"
@@ -0,0 +1,155 @@
+// bench_ingest.cpp
+// 接收热路径：帧切分、模块解析、模拟帧生成、数据库写入与十六进制转换
+#include "bench_fixture.h"
+#include "datasource.h"
+#include "sensor_module.h"
+#include "vessel_module.h"
+#include "device_module.h"
+#include "database.h"
+#include "simulation_generator.h"
+#include <QDateTime>
+#include <QtTest>
+
+using namespace BenchFixture;
+using namespace FrameConstants;
+
+class IngestBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void framing_data();
+    void framing();
+    void sensorParse();
+    void vesselParse();
+    void deviceParse();
+    void generateMergedFrame();
+    void hexEncode();
+    void hexDecode();
+    void insertSensorData();
+    void insertVesselData();
+    void insertDeviceData();
+
+private:
+    Database* m_database = nullptr;
+};
+
+void IngestBenchmark::initTestCase()
+{
+    m_database = BenchFixture::database();
+    QVERIFY(m_database);
+}
+
+void IngestBenchmark::framing_data()
+{
+    QTest::addColumn<int>("noisePercent");
+    QTest::addColumn<int>("chunkSize");
+
+    QTest::newRow("clean/64B") << 0 << 64;
+    QTest::newRow("clean/4KiB") << 0 << 4096;
+    QTest::newRow("noisy5/64B") << 5 << 64;
+    QTest::newRow("noisy5/4KiB") << 5 << 4096;
+}
+
+void IngestBenchmark::framing()
+{
+    QFETCH(int, noisePercent);
+    QFETCH(int, chunkSize);
+
+    const QByteArray stream = makeStream(DATASET_SEED, DATASET_FRAMES, noisePercent);
+    DataSource source;
+
+    QBENCHMARK {
+        for (int offset = 0; offset < stream.size(); offset += chunkSize) {
+            source.processReceivedData(stream.mid(offset, chunkSize), 0);
+        }
+    }
+}
+
+void IngestBenchmark::sensorParse()
+{
+    const QString data = makeMergedHex(DATASET_SEED);
+    SensorModule module;
+    QBENCHMARK {
+        module.receiveData(data);
+    }
+}
+
+void IngestBenchmark::vesselParse()
+{
+    const QString data = makeMergedHex(DATASET_SEED);
+    VesselModule module;
+    QBENCHMARK {
+        module.receiveData(data);
+    }
+}
+
+void IngestBenchmark::deviceParse()
+{
+    const QString data = makeMergedHex(DATASET_SEED);
+    DeviceModule module;
+    QBENCHMARK {
+        module.receiveData(data);
+    }
+}
+
+void IngestBenchmark::generateMergedFrame()
+{
+    SimulatedVessel vessel(DATASET_SEED);
+    QBENCHMARK {
+        QByteArray frame = vessel.generateMergedFrame(0.5);
+        Q_UNUSED(frame);
+    }
+}
+
+void IngestBenchmark::hexEncode()
+{
+    QRandomGenerator rng(DATASET_SEED);
+    const QByteArray payload = makeFrame(rng).mid(SENSOR_DATA_OFFSET, 47);
+    QBENCHMARK {
+        QString hex = payload.toHex().toUpper();
+        Q_UNUSED(hex);
+    }
+}
+
+void IngestBenchmark::hexDecode()
+{
+    const QString hex = makeMergedHex(DATASET_SEED);
+    DataSource source;
+    QBENCHMARK {
+        QByteArray bytes = source.parseHexString(hex);
+        Q_UNUSED(bytes);
+    }
+}
+
+void IngestBenchmark::insertSensorData()
+{
+    const QString timestamp = QDateTime(QDate(2024, 6, 1), QTime(12, 0)).toString(Qt::ISODate);
+    QBENCHMARK {
+        m_database->insertSensorData(timestamp, 800, 50, 300, 35, 60, 24.5, 55.0, 8, 7.2, 400, 21.3, 42);
+    }
+}
+
+void IngestBenchmark::insertVesselData()
+{
+    const QString timestamp = QDateTime(QDate(2024, 6, 1), QTime(12, 0)).toString(Qt::ISODate);
+    QBENCHMARK {
+        m_database->insertVesselData(timestamp, 31.230416, 121.473701, 1.5, 45.0);
+    }
+}
+
+void IngestBenchmark::insertDeviceData()
+{
+    const QString timestamp = QDateTime(QDate(2024, 6, 1), QTime(12, 0)).toString(Qt::ISODate);
+    QBENCHMARK {
+        m_database->insertDeviceData(timestamp, 87, true);
+    }
+}
+
+std::unique_ptr<QObject> createIngestBenchmark()
+{
+    return std::make_unique<IngestBenchmark>();
+}
+
+#include "bench_ingest.moc"
@@ -0,0 +1,133 @@
+// bench_jobs.cpp
+// 任务调度与历史分段拼接
+#include "bench_fixture.h"
+#include "history_segments.h"
+#include "job_scheduler.h"
+#include "metrics.h"
+#include <QCoreApplication>
+#include <QtTest>
+#include <atomic>
+#include <vector>
+
+using namespace BenchFixture;
+
+class JobBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void jobParallelFor();
+    void jobSupersede();
+    void historyPan();
+};
+
+void JobBenchmark::jobParallelFor()
+{
+    // 16M 个浮点数分 1000 块求和：衡量任务拆分、窃取与等待的开销
+    constexpr int VALUES = 16 * 1024 * 1024;
+    constexpr int CHUNKS = 1000;
+    QVector<float> values(VALUES);
+    for (int i = 0; i < VALUES; ++i) values[i] = static_cast<float>(i % 1000);
+    double expected = 0.0;
+    for (float value : values) expected += value;
+
+    JobScheduler& scheduler = JobScheduler::instance();
+    std::vector<double> partial(CHUNKS);
+    QBENCHMARK {
+        scheduler.parallelFor(CHUNKS, [&](int chunk) {
+            const int begin = static_cast<int>(static_cast<qint64>(VALUES) * chunk / CHUNKS);
+            const int end = static_cast<int>(static_cast<qint64>(VALUES) * (chunk + 1) / CHUNKS);
+            double sum = 0.0;
+            for (int i = begin; i < end; ++i) sum += values[i];
+            partial[chunk] = sum;
+        });
+    }
+    double total = 0.0;
+    for (double sum : partial) total += sum;
+    QCOMPARE(total, expected);
+}
+
+void JobBenchmark::jobSupersede()
+{
+    // 连续提交 200 个同组任务（模拟快速拖动选择），每个约 2 ms；旧任务应被跳过或中途退出，
+    // 耗时接近只算最后一个，而不是 200 个排队执行
+    constexpr int JOBS = 200;
+    JobScheduler& scheduler = JobScheduler::instance();
+    QObject context;
+    int completed = 0;
+    int ran = 0;
+    bool lastCancelled = true;
+    std::atomic<int> started{0};
+    QBENCHMARK {
+        completed = 0;
+        started = 0;
+        for (int j = 0; j < JOBS; ++j) {
+            const JobScheduler::CancelFlag flag = scheduler.supersede(QStringLiteral("bench"));
+            scheduler.submit(flag, JobScheduler::Interactive, &context,
+                [&started](const std::atomic<bool>& cancelled) {
+                    ++started;
+                    const qint64 until = MetricsClock::nowNs() + 2000000;
+                    while (!cancelled.load() && MetricsClock::nowNs() < until) {}
+                },
+                [&, j](bool cancelled) {
+                    ++completed;
+                    if (j == JOBS - 1) lastCancelled = cancelled;
+                });
+        }
+        while (completed < JOBS) QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        ran = started;
+    }
+    QVERIFY(!lastCancelled);
+    QVERIFY(ran < JOBS);
+}
+
+void JobBenchmark::historyPan()
+{
+    // 60 天的 15 min 桶按段预先建好（相当于缓存全部命中），一周宽、1000 像素的视图每步平移 1/100 视图，
+    // 共 500 步：衡量每帧的分段规划与拼接开销
+    constexpr int STEPS = 500;
+    constexpr int LEVEL = 3;
+    const double span = 7 * 86400.0;
+    const double origin = 1717200000.0;
+    QRandomGenerator rng(DATASET_SEED);
+    QHash<HistorySegments::SegmentId, SensorBuckets> segments;
+    for (const HistorySegments::SegmentId& id : HistorySegments::segmentsFor(LEVEL, origin - span, origin + 60 * 86400.0)) {
+        SensorBuckets& buckets = segments[id];
+        const qint64 width = HistorySegments::bucketSeconds(LEVEL);
+        for (qint64 start = id.start(); start < id.end(); start += width) {
+            const float value = 300.0f + rng.bounded(50);
+            buckets.starts.append(start);
+            buckets.counts.append(900);
+            for (int channel = 0; channel < SensorBuckets::CHANNEL_COUNT; ++channel) {
+                buckets.mean[channel].append(value);
+                buckets.minimum[channel].append(value - 20);
+                buckets.maximum[channel].append(value + 20);
+            }
+        }
+    }
+
+    HistorySegments::Curves curves;
+    int level = -1;
+    QBENCHMARK {
+        for (int step = 0; step < STEPS; ++step) {
+            const double from = origin + step * span / 100;
+            const HistorySegments::Plan plan = HistorySegments::plan(from, from + span, 1000, 24);
+            QVector<const SensorBuckets*> visible;
+            for (const HistorySegments::SegmentId& id : plan.visible) {
+                const auto it = segments.constFind(id);
+                visible.append(it == segments.constEnd() ? nullptr : &it.value());
+            }
+            HistorySegments::stitch(visible, HistorySegments::bucketSeconds(plan.level), 9, from, from + span, 1.0, curves);
+            level = plan.level;
+        }
+    }
+    QCOMPARE(level, LEVEL);
+    QVERIFY(curves.mean.size() >= 7 * 96 && curves.mean.size() <= 7 * 96 + 1);
+    QVERIFY(curves.lowest >= 280 && curves.highest <= 370);
+}
+
+std::unique_ptr<QObject> createJobBenchmark()
+{
+    return std::make_unique<JobBenchmark>();
+}
+
+#include "bench_jobs.moc"
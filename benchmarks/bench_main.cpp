@@ -0,0 +1,124 @@
+// bench_main.cpp
+// 依次运行各分组的基准，输入由 bench_fixture 按固定种子生成；
+// 运行结束后将各组的 QtTest 结果合并转换为 JSON，供 compare_bench.py 与基线比较。
+#include "bench_fixture.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+#include <QtTest>
+
+namespace {
+
+struct Suite {
+    const char* name;
+    std::unique_ptr<QObject> (*create)();
+};
+
+const Suite SUITES[] = {
+    {"ingest", createIngestBenchmark},
+    {"mission", createMissionBenchmark},
+    {"geo", createGeoBenchmark},
+    {"analysis", createAnalysisBenchmark},
+    {"jobs", createJobBenchmark},
+};
+
+// 将一组 QtTest 的 XML 结果追加到 results
+bool appendXmlResults(const QString& xmlPath, QJsonArray& results)
+{
+    QFile xmlFile(xmlPath);
+    if (!xmlFile.open(QIODevice::ReadOnly)) return false;
+
+    QString function;
+    QXmlStreamReader xml(&xmlFile);
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (!xml.isStartElement()) continue;
+        if (xml.name() == QLatin1String("TestFunction")) {
+            function = xml.attributes().value("name").toString();
+        } else if (xml.name() == QLatin1String("BenchmarkResult")) {
+            const QXmlStreamAttributes attrs = xml.attributes();
+            const QString tag = attrs.value("tag").toString();
+            QJsonObject entry;
+            entry["name"] = tag.isEmpty() ? function : function + ":" + tag;
+            entry["metric"] = attrs.value("metric").toString();
+            entry["value"] = attrs.value("value").toDouble();
+            entry["iterations"] = attrs.value("iterations").toInt();
+            results.append(entry);
+        }
+    }
+    return !xml.hasError();
+}
+
+bool writeJsonResults(const QJsonArray& results, const QString& jsonPath)
+{
+    QJsonObject root;
+    root["suite"] = "ingest";
+    root["seed"] = static_cast<qint64>(BenchFixture::DATASET_SEED);
+    root["qt"] = QString::fromLatin1(qVersion());
+    root["results"] = results;
+
+    QFile jsonFile(jsonPath);
+    if (!jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    jsonFile.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+}
+
+// 用法：bench_ingest [--json <path>] [--suite <分组>] [QtTest 参数...]
+// 分组为 ingest、mission、geo、analysis、jobs；按函数名筛选时需同时用 --suite 指定所在分组
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    QString jsonPath = "bench_results.json";
+    const int jsonIndex = args.indexOf("--json");
+    if (jsonIndex > 0 && jsonIndex + 1 < args.size()) {
+        jsonPath = args.at(jsonIndex + 1);
+        args.removeAt(jsonIndex + 1);
+        args.removeAt(jsonIndex);
+    }
+    QString suiteName;
+    const int suiteIndex = args.indexOf("--suite");
+    if (suiteIndex > 0 && suiteIndex + 1 < args.size()) {
+        suiteName = args.at(suiteIndex + 1);
+        args.removeAt(suiteIndex + 1);
+        args.removeAt(suiteIndex);
+    }
+
+    QTemporaryDir resultDir;
+    QJsonArray results;
+    int ret = 0;
+    bool matched = false;
+    for (const Suite& suite : SUITES) {
+        if (!suiteName.isEmpty() && suiteName != QLatin1String(suite.name)) continue;
+        matched = true;
+
+        const QString xmlPath = resultDir.filePath(QStringLiteral("%1.xml").arg(suite.name));
+        QStringList suiteArgs = args;
+        suiteArgs << "-o" << xmlPath + ",xml" << "-o" << "-,txt";
+
+        const std::unique_ptr<QObject> benchmark = suite.create();
+        ret += QTest::qExec(benchmark.get(), suiteArgs);
+        if (!appendXmlResults(xmlPath, results)) {
+            qWarning() << "无法读取基准结果:" << xmlPath;
+            ++ret;
+        }
+    }
+    BenchFixture::shutdown();
+
+    if (!matched) {
+        qWarning() << "未知的基准分组:" << suiteName;
+        return 1;
+    }
+    if (!writeJsonResults(results, jsonPath)) {
+        qWarning() << "无法写出基准结果:" << jsonPath;
+        return ret ? ret : 1;
+    }
+    return ret;
+}
@@ -0,0 +1,113 @@
+// bench_mission.cpp
+// 任务上传与航线优化
+#include "bench_fixture.h"
+#include "command_scheduler.h"
+#include "frame_codec.h"
+#include "mission_upload.h"
+#include "route_optimizer.h"
+#include <QDateTime>
+#include <QtTest>
+
+using namespace BenchFixture;
+
+class MissionBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void missionUpload_data();
+    void missionUpload();
+    void routeOptimize_data();
+    void routeOptimize();
+};
+
+void MissionBenchmark::missionUpload_data()
+{
+    QTest::addColumn<int>("pointCount");
+    QTest::addColumn<double>("dropRate");
+
+    QTest::newRow("1000pts/lossless") << 1000 << 0.0;
+    QTest::newRow("1000pts/drop5") << 1000 << 0.05;
+}
+
+void MissionBenchmark::missionUpload()
+{
+    QFETCH(int, pointCount);
+    QFETCH(double, dropRate);
+
+    QRandomGenerator rng(DATASET_SEED);
+    QVector<MissionPoint> points(pointCount);
+    for (MissionPoint& point : points) {
+        point.longitude = 113.0 + rng.generateDouble();
+        point.latitude = 22.0 + rng.generateDouble();
+    }
+    const qint64 timestamp = QDateTime(QDate(2024, 6, 1), QTime(12, 0)).toSecsSinceEpoch();
+
+    // 经回环设备完成一次完整上传，并校验船端重组出的航点
+    QBENCHMARK_ONCE {
+        MissionLoopbackDevice device;
+        device.setDropRate(dropRate, DATASET_SEED);
+        QVERIFY(device.open(QIODevice::ReadWrite));
+
+        CommandScheduler scheduler(&device);
+        MissionUploader uploader(&scheduler);
+        FrameDecoder decoder;
+        decoder.setAckFramesEnabled(true);
+        connect(&device, &QIODevice::readyRead, &uploader, [&]() {
+            const QByteArray data = device.readAll();
+            decoder.feed(data.constData(), data.size(), 0, [](const char*, qint64) {},
+                         [&](const char* ack) { uploader.handleAck(ack); });
+        });
+
+        QSignalSpy finished(&uploader, &MissionUploader::finished);
+        QVERIFY(uploader.start(timestamp, points, ControlState()));
+        QVERIFY(finished.wait(30000));
+        QVERIFY(finished.first().at(0).toBool());
+
+        QVERIFY(device.isComplete());
+        QCOMPARE(device.receivedTimestamp(), timestamp);
+        const QVector<MissionPoint> received = device.receivedPoints();
+        QCOMPARE(received.size(), points.size());
+        for (int i = 0; i < points.size(); ++i) {
+            QVERIFY(qAbs(received[i].longitude - points[i].longitude) < 1e-5);
+            QVERIFY(qAbs(received[i].latitude - points[i].latitude) < 1e-5);
+        }
+        if (dropRate > 0.0) QVERIFY(uploader.retransmits() >= device.chunksDropped());
+    }
+}
+
+void MissionBenchmark::routeOptimize_data()
+{
+    QTest::addColumn<int>("pointCount");
+
+    QTest::newRow("200pts") << 200;
+    QTest::newRow("2000pts") << 2000;
+}
+
+void MissionBenchmark::routeOptimize()
+{
+    QFETCH(int, pointCount);
+
+    // 约 5 km 见方范围内的随机航点，首点为 Home 点
+    QRandomGenerator rng(DATASET_SEED);
+    QVector<MissionPoint> points(pointCount);
+    for (MissionPoint& point : points) {
+        point.longitude = 113.0 + rng.generateDouble() * 0.05;
+        point.latitude = 22.0 + rng.generateDouble() * 0.05;
+    }
+
+    RouteOptimizer::Result result;
+    QBENCHMARK {
+        result = RouteOptimizer::optimize(points);
+    }
+
+    QCOMPARE(result.order.size(), pointCount);
+    QCOMPARE(result.order.first(), 0);
+    QVERIFY(result.optimizedLength <= result.seedLength);
+}
+
+std::unique_ptr<QObject> createMissionBenchmark()
+{
+    return std::make_unique<MissionBenchmark>();
+}
+
+#include "bench_mission.moc"
@@ -0,0 +1,92 @@
+# 接收热路径基准测试（独立于主程序构建）
+#   qmake benchmarks/benchmarks.pro && make
+#   ./bench_ingest --json current.json
+#   ./bench_ingest --suite geo geofenceQuery   # 只运行某一分组中的某一项
+#   python3 compare_bench.py baseline.json current.json
+QT += core serialport sql quick positioning testlib
+
+TARGET = bench_ingest
+TEMPLATE = app
+CONFIG += c++17 console testcase_no_bundle
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    bench_main.cpp \
+    bench_fixture.cpp \
+    bench_ingest.cpp \
+    bench_mission.cpp \
+    bench_geo.cpp \
+    bench_analysis.cpp \
+    bench_jobs.cpp \
+    $$PWD/../device_module.cpp \
+    $$PWD/../visualization_base.cpp \
+    $$PWD/../sensor_module.cpp \
+    $$PWD/../vessel_module.cpp \
+    $$PWD/../datasource.cpp \
+    $$PWD/../database.cpp \
+    $$PWD/../metrics.cpp \
+    $$PWD/../trace.cpp \
+    $$PWD/../latency_tracer.cpp \
+    $$PWD/../serial_replay.cpp \
+    $$PWD/../simulation_generator.cpp \
+    $$PWD/../frame_codec.cpp \
+    $$PWD/../fleet_manager.cpp \
+    $$PWD/../epoll_reader.cpp \
+    $$PWD/../port_watcher.cpp \
+    $$PWD/../command_scheduler.cpp \
+    $$PWD/../control_loop.cpp \
+    $$PWD/../mission_upload.cpp \
+    $$PWD/../route_optimizer.cpp \
+    $$PWD/../mission_planner.cpp \
+    $$PWD/../geodesy.cpp \
+    $$PWD/../geofence.cpp \
+    $$PWD/../heatmap.cpp \
+    $$PWD/../surface_interpolation.cpp \
+    $$PWD/../surface_layer.cpp \
+    $$PWD/../alarm_engine.cpp \
+    $$PWD/../anomaly_detector.cpp \
+    $$PWD/../correlation_engine.cpp \
+    $$PWD/../trend_analysis.cpp \
+    $$PWD/../trend_analyzer.cpp \
+    $$PWD/../job_scheduler.cpp \
+    $$PWD/../history_segments.cpp \
+    $$PWD/../history_cache.cpp
+
+HEADERS += \
+    bench_fixture.h \
+    $$PWD/../device_module.h \
+    $$PWD/../visualization_base.h \
+    $$PWD/../sensor_module.h \
+    $$PWD/../vessel_module.h \
+    $$PWD/../datasource.h \
+    $$PWD/../database.h \
+    $$PWD/../metrics.h \
+    $$PWD/../trace.h \
+    $$PWD/../latency_tracer.h \
+    $$PWD/../serial_replay.h \
+    $$PWD/../simulation_generator.h \
+    $$PWD/../frame_constants.h \
+    $$PWD/../frame_codec.h \
+    $$PWD/../fleet_manager.h \
+    $$PWD/../epoll_reader.h \
+    $$PWD/../port_watcher.h \
+    $$PWD/../command_scheduler.h \
+    $$PWD/../control_loop.h \
+    $$PWD/../mission_upload.h \
+    $$PWD/../route_optimizer.h \
+    $$PWD/../mission_planner.h \
+    $$PWD/../geodesy.h \
+    $$PWD/../geofence.h \
+    $$PWD/../heatmap.h \
+    $$PWD/../surface_interpolation.h \
+    $$PWD/../surface_layer.h \
+    $$PWD/../alarm_engine.h \
+    $$PWD/../anomaly_detector.h \
+    $$PWD/../correlation_engine.h \
+    $$PWD/../trend_analysis.h \
+    $$PWD/../trend_analyzer.h \
+    $$PWD/../job_scheduler.h \
+    $$PWD/../history_segments.h \
+    $$PWD/../history_cache.h
@@ -0,0 +1,61 @@
+# -*- coding: utf-8 -*-
+"""
+比较两次 bench_ingest 的 JSON 结果，超过阈值的性能回退以非零退出码报告。
+
+用法:
+    python3 compare_bench.py baseline.json current.json [--threshold 0.10]
+"""
+import argparse
+import json
+import sys
+
+
+def load_results(path):
+    with open(path, 'r', encoding='utf-8') as f:
+        data = json.load(f)
+    return {(r['name'], r['metric']): r['value'] for r in data.get('results', [])}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="比较基准测试结果")
+    parser.add_argument('baseline', help="基线 JSON 文件")
+    parser.add_argument('current', help="当前 JSON 文件")
+    parser.add_argument('--threshold', type=float, default=0.10,
+                        help="允许的相对回退比例，默认 0.10 (10%%)")
+    args = parser.parse_args()
+
+    baseline = load_results(args.baseline)
+    current = load_results(args.current)
+
+    regressions = []
+    print(f"{'benchmark':<36} {'metric':<22} {'baseline':>12} {'current':>12} {'change':>9}")
+    for key in sorted(current):
+        name, metric = key
+        value = current[key]
+        if key not in baseline:
+            print(f"{name:<36} {metric:<22} {'-':>12} {value:>12.6g} {'new':>9}")
+            continue
+        base = baseline[key]
+        change = (value - base) / base if base > 0 else 0.0
+        flag = ''
+        # 所有 QtTest 指标（耗时、CPU 周期等）都是越小越好
+        if change > args.threshold:
+            regressions.append((name, metric, change))
+            flag = '  <-- 回退'
+        print(f"{name:<36} {metric:<22} {base:>12.6g} {value:>12.6g} {change:>+8.1%}{flag}")
+
+    for key in sorted(set(baseline) - set(current)):
+        print(f"{key[0]:<36} {key[1]:<22} {baseline[key]:>12.6g} {'-':>12} {'missing':>9}")
+
+    if regressions:
+        print(f"\n{len(regressions)} 项超过阈值 {args.threshold:.0%}:")
+        for name, metric, change in regressions:
+            print(f"  {name} ({metric}): {change:+.1%}")
+        return 1
+
+    print("\n未发现超过阈值的回退")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
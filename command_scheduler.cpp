@@ -0,0 +1,261 @@
+#include "command_scheduler.h"
+#include "frame_constants.h"
+#include "metrics.h"
+#include "trace.h"
+#include <QDebug>
+#include <QIODevice>
+#include <QThread>
+#include <cstring>
+
+namespace {
+
+const char* priorityLabel(int priority)
+{
+    switch (priority) {
+    case CommandScheduler::Control: return "control";
+    default: return "mission";
+    }
+}
+
+// 各优先级缓冲区的预留容量：控制帧定长；任务帧按单帧上传的最大长度，分块帧更短
+int bufferCapacity(int priority)
+{
+    using namespace FrameConstants;
+    switch (priority) {
+    case CommandScheduler::Control: return CONTROL_FRAME_SIZE;
+    default:
+        return FRAME_HEADER_SIZE + TIMESTAMP_LENGTH + HOME_POINT_SIZE + MAX_TASK_POINTS * TASK_POINT_SIZE
+             + CONTROL_BLOCK_SIZE + RESERVED_SIZE;
+    }
+}
+
+}
+
+CommandScheduler::CommandScheduler(QIODevice* device, QObject *parent)
+    : QObject(parent)
+    , m_device(device)
+    , writeTimeout(new QTimer(this))
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    for (int i = 0; i < PriorityCount; ++i) {
+        m_latency[i] = metrics.histogram("usv_command_latency_seconds",
+                                         "Time from enqueue until the command has been fully written",
+                                         QString("priority=\"%1\"").arg(priorityLabel(i)));
+    }
+    m_enqueued = metrics.counter("usv_commands_enqueued_total", "Outbound commands enqueued");
+    m_coalesced = metrics.counter("usv_commands_coalesced_total", "Outbound commands superseded before being written");
+    m_completed = metrics.counter("usv_commands_written_total", "Outbound commands fully written to the link");
+    m_failed = metrics.counter("usv_commands_failed_total", "Outbound commands dropped or timed out");
+    m_depth = metrics.gauge("usv_command_queue_depth", "Outbound commands waiting to be written");
+
+    for (int i = 0; i < PriorityCount; ++i) {
+        const int count = i == Control ? CONTROL_BUFFERS : MISSION_BUFFERS;
+        m_buffers[i].resize(count);
+        for (QByteArray& buffer : m_buffers[i]) {
+            buffer.reserve(bufferCapacity(i));
+        }
+    }
+
+    writeTimeout->setSingleShot(true);
+    writeTimeout->setInterval(WRITE_TIMEOUT_MS);
+    connect(writeTimeout, &QTimer::timeout, this, &CommandScheduler::onWriteTimeout);
+    connect(m_device, &QIODevice::bytesWritten, this, &CommandScheduler::onBytesWritten);
+}
+
+quint64 CommandScheduler::enqueue(Priority priority, const char* data, int size, const QString& kind, int coalesceKey)
+{
+    const qint64 now = MetricsClock::nowNs();
+    m_enqueued->add();
+
+    quint64 id = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (coalesceKey != NoCoalesce) {
+            for (Command& queued : m_queues[priority]) {
+                if (queued.coalesceKey != coalesceKey) continue;
+                // 直接覆盖原缓冲区，长度不超过预留容量时不重新分配
+                queued.frame.resize(size);
+                std::memcpy(queued.frame.data(), data, static_cast<size_t>(size));
+                queued.kind = kind;
+                queued.enqueueNs = now;
+                m_coalesced->add();
+                USV_TRACE1(Trace::Category::Command, Trace::Level::Debug, "command.coalesced", queued.id);
+                return queued.id;
+            }
+        }
+
+        Command command;
+        command.id = m_nextId++;
+        command.priority = priority;
+        command.frame = acquireBuffer(priority, data, size);
+        command.kind = kind;
+        command.coalesceKey = coalesceKey;
+        command.enqueueNs = now;
+        id = command.id;
+        m_queues[priority].push_back(std::move(command));
+        m_depth->set(depthLocked());
+    }
+    emit queueChanged();
+
+    // 写出与 bytesWritten 确认始终在调度器所在线程进行
+    if (QThread::currentThread() == thread()) {
+        writeNext();
+    } else {
+        QMetaObject::invokeMethod(this, &CommandScheduler::writeNext, Qt::QueuedConnection);
+    }
+    return id;
+}
+
+quint64 CommandScheduler::enqueue(Priority priority, const QByteArray& frame, const QString& kind, int coalesceKey)
+{
+    return enqueue(priority, frame.constData(), frame.size(), kind, coalesceKey);
+}
+
+void CommandScheduler::clear(const QString& reason)
+{
+    writeTimeout->stop();
+    if (m_hasInFlight) {
+        m_hasInFlight = false;
+        releaseBuffer(m_inFlight);
+        m_failed->add();
+        emit commandFailed(m_inFlight.id, m_inFlight.kind, reason);
+    }
+
+    std::array<std::deque<Command>, PriorityCount> dropped;
+    {
+        QMutexLocker locker(&m_mutex);
+        dropped.swap(m_queues);
+        m_depth->set(depthLocked());
+    }
+    for (auto& queue : dropped) {
+        for (Command& command : queue) {
+            releaseBuffer(command);
+            m_failed->add();
+            emit commandFailed(command.id, command.kind, reason);
+        }
+    }
+    emit queueChanged();
+}
+
+int CommandScheduler::queueDepth() const
+{
+    QMutexLocker locker(&m_mutex);
+    return depthLocked();
+}
+
+int CommandScheduler::depthLocked() const
+{
+    int depth = 0;
+    for (const auto& queue : m_queues) {
+        depth += static_cast<int>(queue.size());
+    }
+    return depth;
+}
+
+void CommandScheduler::writeNext()
+{
+    if (m_hasInFlight) return;
+
+    while (takeNext(m_inFlight)) {
+        m_hasInFlight = true;
+        emit queueChanged();
+
+        if (!m_device->isOpen()) {
+            m_hasInFlight = false;
+            releaseBuffer(m_inFlight);
+            m_failed->add();
+            emit commandFailed(m_inFlight.id, m_inFlight.kind, "串口未打开");
+            continue;
+        }
+
+        const qint64 written = m_device->write(m_inFlight.frame);
+        if (written != m_inFlight.frame.size()) {
+            m_hasInFlight = false;
+            releaseBuffer(m_inFlight);
+            m_failed->add();
+            qDebug() << "命令写入失败:" << m_inFlight.kind << m_device->errorString();
+            emit commandFailed(m_inFlight.id, m_inFlight.kind, "数据发送不完整");
+            continue;
+        }
+
+        // 字节已复制到设备缓冲，帧缓冲区可立即回收；等待 bytesWritten 确认全部写出
+        USV_TRACE2(Trace::Category::Command, Trace::Level::Debug, "command.write", m_inFlight.id, written);
+        releaseBuffer(m_inFlight);
+        writeTimeout->start();
+        return;
+    }
+}
+
+bool CommandScheduler::takeNext(Command& command)
+{
+    QMutexLocker locker(&m_mutex);
+    for (auto& queue : m_queues) {
+        if (queue.empty()) continue;
+
+        command = std::move(queue.front());
+        queue.pop_front();
+        m_depth->set(depthLocked());
+        return true;
+    }
+    return false;
+}
+
+void CommandScheduler::onBytesWritten()
+{
+    if (!m_hasInFlight) return;
+
+    // 以设备写缓冲清空为准，而不是累计 bytes：超时命令的剩余字节仍在缓冲中，
+    // 它们稍后的 bytesWritten 不能算作当前命令已写完
+    if (m_device->bytesToWrite() > 0) return;
+
+    finishInFlight();
+    writeNext();
+}
+
+void CommandScheduler::onWriteTimeout()
+{
+    if (!m_hasInFlight) return;
+
+    // 超时帧的字节可能仍留在设备缓冲中，之后的命令要等它们一起写出才算完成
+    m_hasInFlight = false;
+    m_failed->add();
+    qDebug() << "命令写出超时:" << m_inFlight.kind;
+    emit commandFailed(m_inFlight.id, m_inFlight.kind, "写出超时");
+    writeNext();
+}
+
+void CommandScheduler::finishInFlight()
+{
+    writeTimeout->stop();
+    m_hasInFlight = false;
+
+    const qint64 elapsedNs = MetricsClock::nowNs() - m_inFlight.enqueueNs;
+    m_latency[m_inFlight.priority]->observe(elapsedNs);
+    m_completed->add();
+    const double latencyMs = elapsedNs / 1e6;
+    m_lastLatencyMs.store(latencyMs, std::memory_order_relaxed);
+    emit commandCompleted(m_inFlight.id, m_inFlight.kind, latencyMs);
+}
+
+QByteArray CommandScheduler::acquireBuffer(Priority priority, const char* data, int size)
+{
+    std::vector<QByteArray>& pool = m_buffers[priority];
+    QByteArray buffer;
+    if (!pool.empty()) {
+        buffer = std::move(pool.back());
+        pool.pop_back();
+    } else {
+        buffer.reserve(qMax(size, bufferCapacity(priority)));
+    }
+    buffer.resize(size);
+    std::memcpy(buffer.data(), data, static_cast<size_t>(size));
+    return buffer;
+}
+
+void CommandScheduler::releaseBuffer(Command& command)
+{
+    if (command.frame.isNull()) return;
+    QMutexLocker locker(&m_mutex);
+    m_buffers[command.priority].push_back(std::move(command.frame));
+    command.frame = QByteArray();
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QByteArray>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <vector>
+
+class QIODevice;
+class MetricCounter;
+class MetricGauge;
+class LatencyHistogram;
+
+// 下行命令调度：按优先级排队，同一时刻只有一条命令在写出，
+// 收到 bytesWritten 且设备写缓冲已清空后再写下一条，因此高优先级命令不会排在已交给驱动的大任务帧之后。
+// 带合并键的命令（如电机控制）在尚未开始写出前会被同键的新命令直接覆盖，只发送最新值。
+// 帧数据存放在按优先级预分配、写完后回收的缓冲区中，稳定运行时入队不再分配内存。
+// 写出与确认都在调度器所在线程（串口 I/O 线程）中进行；入队、queueDepth 与 lastLatencyMs 可在任意线程调用。
+class CommandScheduler : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int queueDepth READ queueDepth NOTIFY queueChanged)
+    Q_PROPERTY(double lastLatencyMs READ lastLatencyMs NOTIFY commandCompleted)
+public:
+    enum Priority {
+        Control = 0,    // 控制帧（电机、水泵、模式）
+        Mission,        // 任务上传
+        PriorityCount
+    };
+    Q_ENUM(Priority)
+
+    // 合并键
+    enum CoalesceKey {
+        NoCoalesce = 0,
+        ControlStateKey
+    };
+
+    // 写出超时：超过该时间设备写缓冲仍未清空视为失败
+    static constexpr int WRITE_TIMEOUT_MS = 1000;
+    // 每个优先级预分配的帧缓冲区个数：控制帧最多一条排队、一条在途；任务帧覆盖分块上传的 8 块窗口加一条在途
+    static constexpr int CONTROL_BUFFERS = 2;
+    static constexpr int MISSION_BUFFERS = 9;
+
+    explicit CommandScheduler(QIODevice* device, QObject *parent = nullptr);
+
+    // 入队并返回命令号；被合并时返回被覆盖命令的命令号。
+    // 在调度器所在线程调用时直接开始写出，其他线程（如控制心跳的定时线程）入队后排队到调度器线程写出
+    quint64 enqueue(Priority priority, const char* data, int size, const QString& kind,
+                    int coalesceKey = NoCoalesce);
+    quint64 enqueue(Priority priority, const QByteArray& frame, const QString& kind,
+                    int coalesceKey = NoCoalesce);
+
+    // 丢弃全部排队和在途命令（如串口关闭）；只能在调度器所在线程调用
+    void clear(const QString& reason);
+
+    int queueDepth() const;
+    double lastLatencyMs() const { return m_lastLatencyMs.load(std::memory_order_relaxed); }
+
+signals:
+    // latencyMs：从入队（或最后一次被合并覆盖）到全部字节写出的时间
+    void commandCompleted(quint64 id, const QString& kind, double latencyMs);
+    void commandFailed(quint64 id, const QString& kind, const QString& reason);
+    void queueChanged();
+
+private:
+    struct Command {
+        quint64 id = 0;
+        Priority priority = Control;
+        QByteArray frame;
+        QString kind;
+        int coalesceKey = NoCoalesce;
+        qint64 enqueueNs = 0;
+    };
+
+    void writeNext();
+    // 按优先级取出下一条排队命令
+    bool takeNext(Command& command);
+    int depthLocked() const;
+    void onBytesWritten();
+    void onWriteTimeout();
+    void finishInFlight();
+    // 从该优先级的缓冲池取出缓冲区并复制帧数据；池空时按该优先级的最大帧长新分配。调用方持有 m_mutex
+    QByteArray acquireBuffer(Priority priority, const char* data, int size);
+    void releaseBuffer(Command& command);
+
+    QIODevice* m_device;
+    // 排队命令、缓冲池与命令号可被任意线程的 enqueue 访问
+    mutable QMutex m_mutex;
+    std::array<std::deque<Command>, PriorityCount> m_queues;
+    std::array<std::vector<QByteArray>, PriorityCount> m_buffers;
+    quint64 m_nextId = 1;
+    // 在途命令只在调度器所在线程访问
+    Command m_inFlight;
+    bool m_hasInFlight = false;
+    std::atomic<double> m_lastLatencyMs{0.0};
+    QTimer* writeTimeout;
+
+    std::array<LatencyHistogram*, PriorityCount> m_latency{};
+    MetricCounter* m_enqueued;
+    MetricCounter* m_coalesced;
+    MetricCounter* m_completed;
+    MetricCounter* m_failed;
+    MetricGauge* m_depth;
+};
@@ -0,0 +1,286 @@
+#include "control_loop.h"
+#include "command_scheduler.h"
+#include "metrics.h"
+#include <QDebug>
+#include <QThread>
+#include <QTimer>
+#include <cstdlib>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 心跳帧与变化触发的控制帧共用合并键，排队时可能互相覆盖，写完的是哪一种都满足当前节拍
+bool isControlFrame(const QString& kind)
+{
+    return kind == QLatin1String("heartbeat") || kind == QLatin1String("control");
+}
+
+}
+
+ControlLoop::ControlLoop(CommandScheduler* commands, QObject *parent)
+    : QObject(parent)
+    , m_commands(commands)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_jitter = metrics.histogram("usv_control_send_jitter_seconds", "Deviation of the control frame send interval from its nominal period");
+    m_dispatchDelay = metrics.histogram("usv_control_dispatch_delay_seconds", "Time from a heartbeat tick until its control frame has been written to the link");
+    m_sent = metrics.counter("usv_control_frames_sent_total", "Control heartbeat frames written to the link");
+    m_overruns = metrics.counter("usv_control_missed_ticks_total", "Control heartbeat periods that elapsed without a send");
+
+    m_periodNs.store(static_cast<qint64>(1e9 / m_rateHz));
+    m_state.store(packState(ControlState()));
+
+    connect(&metrics, &MetricsRegistry::updated, this, &ControlLoop::statsChanged);
+
+    // 写完时刻在调度器线程中直接记录，不经过界面线程的事件队列
+    connect(m_commands, &CommandScheduler::commandCompleted, this, [this](quint64, const QString& kind) {
+        if (isControlFrame(kind)) onControlWritten();
+    }, Qt::DirectConnection);
+    connect(m_commands, &CommandScheduler::commandFailed, this, [this](quint64, const QString& kind) {
+        if (isControlFrame(kind)) onControlFailed();
+    }, Qt::DirectConnection);
+}
+
+ControlLoop::~ControlLoop()
+{
+    detach();
+}
+
+double ControlLoop::jitterP50Us() const
+{
+    return m_jitter->quantileNs(0.50) / 1000.0;
+}
+
+double ControlLoop::jitterP99Us() const
+{
+    return m_jitter->quantileNs(0.99) / 1000.0;
+}
+
+double ControlLoop::framesSent() const
+{
+    return static_cast<double>(m_sent->value());
+}
+
+quint64 ControlLoop::packState(const ControlState& state)
+{
+    return (state.pumpMode ? 1ull : 0ull)
+         | (state.pumpState ? 2ull : 0ull)
+         | (static_cast<quint64>(state.boatMode) << 8)
+         | (static_cast<quint64>(state.motor1) << 16)
+         | (static_cast<quint64>(state.motor2) << 32);
+}
+
+ControlState ControlLoop::unpackState(quint64 packed)
+{
+    ControlState state;
+    state.pumpMode = packed & 1ull;
+    state.pumpState = packed & 2ull;
+    state.boatMode = static_cast<quint8>(packed >> 8);
+    state.motor1 = static_cast<quint16>(packed >> 16);
+    state.motor2 = static_cast<quint16>(packed >> 32);
+    return state;
+}
+
+void ControlLoop::setState(const ControlState& state)
+{
+    m_state.store(packState(state), std::memory_order_relaxed);
+}
+
+void ControlLoop::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) return;
+
+    m_enabled = enabled;
+    if (m_enabled && m_attached) {
+        startThread();
+    } else if (!m_enabled) {
+        stopThread();
+    }
+    emit enabledChanged();
+}
+
+void ControlLoop::setRateHz(double rateHz)
+{
+    rateHz = qBound(MIN_RATE_HZ, rateHz, MAX_RATE_HZ);
+    if (qFuzzyCompare(m_rateHz, rateHz)) return;
+
+    // 运行中的定时器在下一个周期读取新周期并重新设定
+    m_rateHz = rateHz;
+    m_periodNs.store(static_cast<qint64>(1e9 / rateHz), std::memory_order_relaxed);
+    m_lastWriteNs.store(0);
+    emit rateHzChanged();
+}
+
+void ControlLoop::attach()
+{
+    detach();
+    m_attached = true;
+    if (m_enabled) startThread();
+}
+
+void ControlLoop::detach()
+{
+    stopThread();
+    m_attached = false;
+}
+
+void ControlLoop::startThread()
+{
+    if (m_running) return;
+
+    m_stop.store(false);
+    m_maxJitterNs.store(0);
+    m_tickNs.store(0);
+    m_lastWriteNs.store(0);
+#ifdef Q_OS_LINUX
+    m_thread = std::thread(&ControlLoop::run, this);
+#else
+    startFallbackTimer();
+#endif
+    m_running = true;
+    emit runningChanged();
+}
+
+void ControlLoop::stopThread()
+{
+    if (!m_running) return;
+
+#ifdef Q_OS_LINUX
+    // 线程每个周期检查一次停止标志，最多等待一个周期
+    m_stop.store(true);
+    m_thread.join();
+#else
+    stopFallbackTimer();
+#endif
+    m_running = false;
+    m_tickNs.store(0);
+    emit runningChanged();
+}
+
+void ControlLoop::startFallbackTimer()
+{
+    // 没有 timerfd 时由调度器线程的高精度定时器触发节拍，同样不经过界面线程；周期按毫秒取整
+    QTimer* timer = new QTimer;
+    timer->setTimerType(Qt::PreciseTimer);
+    timer->setInterval(qMax(1, qRound(m_periodNs.load() / 1e6)));
+    connect(timer, &QTimer::timeout, timer, [this, timer]() {
+        const int intervalMs = qMax(1, qRound(m_periodNs.load(std::memory_order_relaxed) / 1e6));
+        if (timer->interval() != intervalMs) timer->setInterval(intervalMs);
+        tick(MetricsClock::nowNs());
+    });
+    timer->moveToThread(m_commands->thread());
+    QMetaObject::invokeMethod(timer, [timer]() { timer->start(); });
+    m_timer = timer;
+}
+
+void ControlLoop::stopFallbackTimer()
+{
+    // 定时器只能在其所在线程删除；跨线程时等待删除完成，之后不会再有节拍访问本对象
+    QTimer* timer = m_timer;
+    m_timer = nullptr;
+    if (!timer) return;
+    const Qt::ConnectionType type = timer->thread() == QThread::currentThread()
+        ? Qt::DirectConnection : Qt::BlockingQueuedConnection;
+    QMetaObject::invokeMethod(m_commands, [timer]() { delete timer; }, type);
+}
+
+void ControlLoop::run()
+{
+#ifdef Q_OS_LINUX
+    const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timerFd < 0) {
+        qWarning() << "控制心跳 timerfd 创建失败";
+        return;
+    }
+
+    // 尽量提升为实时调度；无权限时保持普通优先级
+    sched_param param{};
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+    // 首次到期取绝对截止时间（当前时刻加一个周期），之后由内核按周期推进，不随唤醒延迟漂移
+    auto arm = [timerFd](qint64 periodNs) {
+        timespec now{};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const qint64 firstNs = now.tv_sec * 1000000000LL + now.tv_nsec + periodNs;
+        itimerspec spec{};
+        spec.it_interval.tv_sec = periodNs / 1000000000;
+        spec.it_interval.tv_nsec = periodNs % 1000000000;
+        spec.it_value.tv_sec = firstNs / 1000000000;
+        spec.it_value.tv_nsec = firstNs % 1000000000;
+        timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+    };
+
+    qint64 periodNs = m_periodNs.load(std::memory_order_relaxed);
+    arm(periodNs);
+
+    while (!m_stop.load(std::memory_order_relaxed)) {
+        quint64 expirations = 0;
+        if (::read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            if (errno == EINTR) continue;
+            qWarning() << "控制心跳定时器读取失败";
+            break;
+        }
+        const qint64 nowNs = MetricsClock::nowNs();
+        if (expirations > 1) m_overruns->add(expirations - 1);
+
+        const qint64 requestedNs = m_periodNs.load(std::memory_order_relaxed);
+        if (requestedNs != periodNs) {
+            periodNs = requestedNs;
+            arm(periodNs);
+        }
+
+        tick(nowNs);
+    }
+
+    ::close(timerFd);
+#endif
+}
+
+void ControlLoop::tick(qint64 nowNs)
+{
+    // 上一个心跳帧还没写完时不再叠加；其间的状态变化会以同一合并键覆盖排队中的帧
+    qint64 idle = 0;
+    if (!m_tickNs.compare_exchange_strong(idle, nowNs)) {
+        m_overruns->add();
+        return;
+    }
+
+    char frame[FrameConstants::CONTROL_FRAME_SIZE];
+    const int size = encodeControlFrame(frame, unpackState(m_state.load(std::memory_order_relaxed)));
+    m_commands->enqueue(CommandScheduler::Control, frame, size, QStringLiteral("heartbeat"),
+                        CommandScheduler::ControlStateKey);
+}
+
+void ControlLoop::onControlWritten()
+{
+    // 没有等待中的节拍说明是变化触发的控制帧，不计入心跳
+    const qint64 tickNs = m_tickNs.exchange(0);
+    if (tickNs == 0) return;
+
+    const qint64 nowNs = MetricsClock::nowNs();
+    m_dispatchDelay->observe(nowNs - tickNs);
+    const qint64 lastNs = m_lastWriteNs.exchange(nowNs);
+    if (lastNs != 0) {
+        const qint64 jitterNs = std::llabs((nowNs - lastNs) - m_periodNs.load(std::memory_order_relaxed));
+        m_jitter->observe(jitterNs);
+        if (jitterNs > m_maxJitterNs.load(std::memory_order_relaxed)) {
+            m_maxJitterNs.store(jitterNs, std::memory_order_relaxed);
+        }
+    }
+    m_sent->add();
+}
+
+void ControlLoop::onControlFailed()
+{
+    // 写出失败或被清空：放弃该节拍，下一个节拍重新入队
+    m_tickNs.store(0);
+}
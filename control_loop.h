@@ -0,0 +1,95 @@
+#pragma once
+
+#include "frame_codec.h"
+#include <QObject>
+#include <atomic>
+#include <thread>
+
+class CommandScheduler;
+class MetricCounter;
+class LatencyHistogram;
+class QTimer;
+
+// 控制心跳：按固定频率发送控制帧（电机、水泵、艇模式），避免链路静默触发船端失控保护。
+// Linux 下由独立线程以 timerfd 按 CLOCK_MONOTONIC 绝对截止时间定时；其他平台由调度器所在线程
+// （串口 I/O 线程）中的 Qt::PreciseTimer 定时器定时。节拍直接在定时线程中把最新状态作为可合并的
+// Control 命令交给 CommandScheduler，不经过界面线程，因此界面或数据库工作不会推迟或合并心跳。
+// 串口只由调度器写出，心跳帧不会与任务帧交错，并遵守单条在途与 Control 优先于 Mission 的约束。
+// 上一个心跳帧尚未写完时新节拍不再入队，计为错过的周期；相邻两次写完时刻的间隔与标称周期之差记为抖动。
+class ControlLoop : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
+    Q_PROPERTY(double rateHz READ rateHz WRITE setRateHz NOTIFY rateHzChanged)
+    Q_PROPERTY(double jitterP50Us READ jitterP50Us NOTIFY statsChanged)
+    Q_PROPERTY(double jitterP99Us READ jitterP99Us NOTIFY statsChanged)
+    Q_PROPERTY(double maxJitterUs READ maxJitterUs NOTIFY statsChanged)
+    Q_PROPERTY(double framesSent READ framesSent NOTIFY statsChanged)
+public:
+    static constexpr double MIN_RATE_HZ = 1.0;
+    static constexpr double MAX_RATE_HZ = 200.0;
+    static constexpr double DEFAULT_RATE_HZ = 20.0;
+
+    explicit ControlLoop(CommandScheduler* commands, QObject *parent = nullptr);
+    ~ControlLoop();
+
+    bool isEnabled() const { return m_enabled; }
+    bool isRunning() const { return m_running; }
+    double rateHz() const { return m_rateHz; }
+    double jitterP50Us() const;
+    double jitterP99Us() const;
+    double maxJitterUs() const { return m_maxJitterNs.load(std::memory_order_relaxed) / 1000.0; }
+    double framesSent() const;
+
+    // 更新待发送的控制状态（任意线程，无锁）
+    void setState(const ControlState& state);
+
+    // 串口打开后调用 attach，关闭前调用 detach
+    void attach();
+    void detach();
+
+public slots:
+    void setEnabled(bool enabled);
+    void setRateHz(double rateHz);
+
+signals:
+    void enabledChanged();
+    void runningChanged();
+    void rateHzChanged();
+    void statsChanged();
+
+private:
+    void startThread();
+    void stopThread();
+    void run();
+    void startFallbackTimer();
+    void stopFallbackTimer();
+    // 定时线程：把节拍转成控制命令入队
+    void tick(qint64 nowNs);
+    // 调度器线程：控制帧写完或失败
+    void onControlWritten();
+    void onControlFailed();
+
+    static quint64 packState(const ControlState& state);
+    static ControlState unpackState(quint64 packed);
+
+    CommandScheduler* m_commands;
+    bool m_enabled = false;
+    double m_rateHz = DEFAULT_RATE_HZ;
+    bool m_attached = false;
+    bool m_running = false;
+
+    std::thread m_thread;
+    QTimer* m_timer = nullptr;      // 非 Linux：运行在调度器线程中的节拍定时器
+    std::atomic<bool> m_stop{false};
+    std::atomic<quint64> m_state{0};
+    std::atomic<qint64> m_periodNs{0};
+    std::atomic<qint64> m_maxJitterNs{0};
+    std::atomic<qint64> m_tickNs{0};            // 尚未写完的节拍时间，0 表示没有
+    std::atomic<qint64> m_lastWriteNs{0};       // 上一个心跳帧写完的时间
+
+    LatencyHistogram* m_jitter;
+    LatencyHistogram* m_dispatchDelay;
+    MetricCounter* m_sent;
+    MetricCounter* m_overruns;
+};
@@ -0,0 +1,376 @@
+#include "correlation_engine.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int CHANNELS = CoMoments::CHANNELS;
+constexpr int BLOCK = 256;
+const QString JOB_GROUP = QStringLiteral("correlation");
+
+}
+
+void CoMoments::add(const double* values)
+{
+    ++m_count;
+    double before[CHANNELS];
+    for (int i = 0; i < CHANNELS; ++i) {
+        before[i] = values[i] - m_mean[i];
+        m_mean[i] += before[i] / m_count;
+    }
+    for (int i = 0; i < CHANNELS; ++i) {
+        for (int j = i; j < CHANNELS; ++j) m_comoment[i][j] += before[i] * (values[j] - m_mean[j]);
+    }
+}
+
+void CoMoments::remove(const double* values)
+{
+    if (m_count <= 1) {
+        clear();
+        return;
+    }
+    // add 的逆运算：C -= (x - 旧均值)(x - 当前均值)
+    double previous[CHANNELS];
+    for (int i = 0; i < CHANNELS; ++i) previous[i] = (m_count * m_mean[i] - values[i]) / (m_count - 1);
+    for (int i = 0; i < CHANNELS; ++i) {
+        for (int j = i; j < CHANNELS; ++j) m_comoment[i][j] -= (values[i] - previous[i]) * (values[j] - m_mean[j]);
+    }
+    std::copy(previous, previous + CHANNELS, m_mean);
+    --m_count;
+}
+
+void CoMoments::merge(const CoMoments& other)
+{
+    if (other.m_count == 0) return;
+    if (m_count == 0) {
+        *this = other;
+        return;
+    }
+    const double total = static_cast<double>(m_count + other.m_count);
+    const double weight = static_cast<double>(m_count) * other.m_count / total;
+    double delta[CHANNELS];
+    for (int i = 0; i < CHANNELS; ++i) {
+        delta[i] = other.m_mean[i] - m_mean[i];
+        m_mean[i] += delta[i] * other.m_count / total;
+    }
+    for (int i = 0; i < CHANNELS; ++i) {
+        for (int j = i; j < CHANNELS; ++j) {
+            m_comoment[i][j] += other.m_comoment[i][j] + delta[i] * delta[j] * weight;
+        }
+    }
+    m_count += other.m_count;
+}
+
+void CoMoments::clear()
+{
+    *this = CoMoments();
+}
+
+double CoMoments::pearson(int a, int b) const
+{
+    const double denominator = std::sqrt(comoment(a, a) * comoment(b, b));
+    if (m_count < 2 || !(denominator > 0.0)) return std::numeric_limits<double>::quiet_NaN();
+    return std::clamp(comoment(a, b) / denominator, -1.0, 1.0);
+}
+
+double CoMoments::slope(int x, int y) const
+{
+    const double variance = comoment(x, x);
+    return variance > 0.0 ? comoment(x, y) / variance : std::numeric_limits<double>::quiet_NaN();
+}
+
+double CoMoments::intercept(int x, int y) const
+{
+    return m_mean[y] - slope(x, y) * m_mean[x];
+}
+
+CoMoments CoMoments::fromSeries(const SensorSeries& series, int begin, int end)
+{
+    CoMoments moments;
+    if (end <= begin) return moments;
+    moments.m_count = end - begin;
+
+    for (int c = 0; c < CHANNELS; ++c) {
+        const float* values = series.channels[c].constData();
+        double sum = 0.0;
+        for (int k = begin; k < end; ++k) sum += values[k];
+        moments.m_mean[c] = sum / moments.m_count;
+    }
+
+    // 按 BLOCK 个样本一段：先把各通道的离差写入连续数组，再逐对做点积。
+    // 点积用 4 个独立累加器，打断加法依赖链（不开 -ffast-math 时编译器不会自行重排求和）
+    alignas(32) double centered[CHANNELS][BLOCK];
+    for (int blockBegin = begin; blockBegin < end; blockBegin += BLOCK) {
+        const int length = std::min(BLOCK, end - blockBegin);
+        for (int c = 0; c < CHANNELS; ++c) {
+            const float* values = series.channels[c].constData() + blockBegin;
+            const double mean = moments.m_mean[c];
+            for (int k = 0; k < length; ++k) centered[c][k] = values[k] - mean;
+        }
+        for (int i = 0; i < CHANNELS; ++i) {
+            const double* a = centered[i];
+            for (int j = i; j < CHANNELS; ++j) {
+                const double* b = centered[j];
+                double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+                int k = 0;
+                for (; k + 4 <= length; k += 4) {
+                    s0 += a[k] * b[k];
+                    s1 += a[k + 1] * b[k + 1];
+                    s2 += a[k + 2] * b[k + 2];
+                    s3 += a[k + 3] * b[k + 3];
+                }
+                for (; k < length; ++k) s0 += a[k] * b[k];
+                moments.m_comoment[i][j] += (s0 + s1) + (s2 + s3);
+            }
+        }
+    }
+    return moments;
+}
+
+CoMoments CoMoments::fromSeriesParallel(const SensorSeries& series, int threads)
+{
+    const int n = series.size();
+    threads = std::clamp(threads, 1, std::max(1, n / CorrelationEngine::MIN_CHUNK_SAMPLES));
+
+    std::vector<CoMoments> partial(threads);
+    auto runChunk = [&](int chunk) {
+        const int begin = static_cast<int>(static_cast<qint64>(n) * chunk / threads);
+        const int end = static_cast<int>(static_cast<qint64>(n) * (chunk + 1) / threads);
+        partial[chunk] = fromSeries(series, begin, end);
+    };
+
+    JobScheduler::instance().parallelFor(threads, runChunk);
+
+    CoMoments moments;
+    for (const CoMoments& chunk : partial) moments.merge(chunk);
+    return moments;
+}
+
+CorrelationWindow::CorrelationWindow(int capacity)
+    : m_capacity(std::max(2, capacity))
+    , m_frames(m_capacity * CHANNELS)
+{
+}
+
+void CorrelationWindow::push(const double* values)
+{
+    float* slot = m_frames.data() + m_head * CHANNELS;
+    if (m_size == m_capacity) {
+        double oldest[CHANNELS];
+        std::copy(slot, slot + CHANNELS, oldest);
+        m_moments.remove(oldest);
+    } else {
+        ++m_size;
+    }
+    std::copy(values, values + CHANNELS, slot);
+    m_head = (m_head + 1) % m_capacity;
+
+    // 存入的是 float，按存入值累加，移除时才能精确抵消
+    double stored[CHANNELS];
+    std::copy(slot, slot + CHANNELS, stored);
+    m_moments.add(stored);
+
+    if (++m_sinceRebuild >= m_capacity) rebuild();
+}
+
+void CorrelationWindow::clear()
+{
+    m_size = 0;
+    m_head = 0;
+    m_sinceRebuild = 0;
+    m_moments.clear();
+}
+
+void CorrelationWindow::setCapacity(int capacity)
+{
+    capacity = std::max(2, capacity);
+    if (capacity == m_capacity) return;
+
+    // 保留最新的帧
+    const int keep = std::min(m_size, capacity);
+    QVector<float> frames(capacity * CHANNELS);
+    for (int k = 0; k < keep; ++k) {
+        const float* source = frame(m_size - keep + k);
+        std::copy(source, source + CHANNELS, frames.data() + k * CHANNELS);
+    }
+    m_capacity = capacity;
+    m_frames = frames;
+    m_size = keep;
+    m_head = keep % capacity;
+    rebuild();
+}
+
+const float* CorrelationWindow::frame(int index) const
+{
+    const int oldest = m_size == m_capacity ? m_head : 0;
+    return m_frames.constData() + ((oldest + index) % m_capacity) * CHANNELS;
+}
+
+void CorrelationWindow::rebuild()
+{
+    m_moments.clear();
+    double values[CHANNELS];
+    for (int k = 0; k < m_size; ++k) {
+        const float* source = frame(k);
+        std::copy(source, source + CHANNELS, values);
+        m_moments.add(values);
+    }
+    m_sinceRebuild = 0;
+}
+
+CorrelationEngine::CorrelationEngine(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void CorrelationEngine::setWindowSize(int frames)
+{
+    if (frames == m_window.capacity()) return;
+    m_window.setCapacity(frames);
+    emit windowSizeChanged();
+}
+
+void CorrelationEngine::addFrame(int co2, int ch2o, int tvoc, int pm25, int pm10,
+                                 double airTemp, double humidity,
+                                 int turbidity, double ph, int tds, double waterTemp,
+                                 int levelValue)
+{
+    const double values[CHANNELS] = {
+        double(co2), double(ch2o), double(tvoc), double(pm25), double(pm10), airTemp, humidity,
+        double(turbidity), ph, double(tds), waterTemp, double(levelValue)
+    };
+    m_window.push(values);
+}
+
+QVariantList CorrelationEngine::liveMatrix() const
+{
+    return matrix(m_window.moments());
+}
+
+QVariantMap CorrelationEngine::livePair(int x, int y) const
+{
+    if (x < 0 || x >= CHANNELS || y < 0 || y >= CHANNELS) return QVariantMap();
+    QVariantMap pair = pairStats(m_window.moments(), x, y);
+
+    QVariantList scatter;
+    const int stride = std::max(1, (m_window.size() + MAX_SCATTER_POINTS - 1) / MAX_SCATTER_POINTS);
+    for (int k = 0; k < m_window.size(); k += stride) {
+        const float* values = m_window.frame(k);
+        scatter.append(QVariantMap{{"x", values[x]}, {"y", values[y]}});
+    }
+    pair["scatter"] = scatter;
+    return pair;
+}
+
+QVariantList CorrelationEngine::matrix(const CoMoments& moments)
+{
+    QVariantList rows;
+    for (int i = 0; i < CHANNELS; ++i) {
+        QVariantList row;
+        for (int j = 0; j < CHANNELS; ++j) row.append(moments.pearson(i, j));
+        rows.append(QVariant(row));
+    }
+    return rows;
+}
+
+QVariantMap CorrelationEngine::pairStats(const CoMoments& moments, int x, int y)
+{
+    const double r = moments.pearson(x, y);
+    const qint64 n = moments.count();
+    double pValue = std::numeric_limits<double>::quiet_NaN();
+    if (!std::isnan(r) && n > 2) {
+        const double t = std::abs(r) < 1.0 ? r * std::sqrt((n - 2) / (1.0 - r * r))
+                                           : std::numeric_limits<double>::infinity();
+        pValue = std::erfc(std::abs(t) / std::sqrt(2.0));
+    }
+    return QVariantMap{
+        {"r", r},
+        {"r2", r * r},
+        {"slope", moments.slope(x, y)},
+        {"intercept", moments.intercept(x, y)},
+        {"pValue", pValue},
+        {"count", n}
+    };
+}
+
+void CorrelationEngine::release()
+{
+    if (--m_running == 0) emit busyChanged();
+}
+
+void CorrelationEngine::requestRange(int requestId, const QDateTime& from, const QDateTime& to, int x, int y,
+                                     int vesselId)
+{
+    if (x < 0 || x >= CHANNELS || y < 0 || y >= CHANNELS) return;
+    const ResultKey cacheKey{QStringLiteral("series:%1").arg(vesselId), from, to, 0};
+    const JobScheduler::CancelFlag token = JobScheduler::instance().supersede(JOB_GROUP);
+    if (m_running++ == 0) emit busyChanged();
+
+    // 区间已读过且读取时已经结束：序列不会再变，直接换通道对
+    if (auto cached = m_cache.find(cacheKey)) {
+        QMetaObject::invokeMethod(this, [=]() {
+            if (!token->load()) finish(requestId, cached, x, y, 0.0);
+            release();
+        }, Qt::QueuedConnection);
+        return;
+    }
+    if (!m_database) {
+        release();
+        return;
+    }
+
+    Database* database = m_database;
+    QMetaObject::invokeMethod(database, [=]() {
+        auto series = std::make_shared<SensorSeries>();
+        const QDateTime loadedAt = QDateTime::currentDateTime();
+        if (!token->load()) database->sensorSeries(from, to, vesselId, *series);
+
+        auto data = std::make_shared<RangeData>();
+        auto elapsedMs = std::make_shared<double>(0.0);
+        JobScheduler::instance().submit(token, JobScheduler::Interactive, this,
+            [=](const std::atomic<bool>&) {
+                QElapsedTimer timer;
+                timer.start();
+                data->series = series;
+                data->moments = CoMoments::fromSeriesParallel(*series, JobScheduler::instance().threadCount());
+                *elapsedMs = timer.nsecsElapsed() / 1e6;
+            },
+            [=](bool cancelled) {
+                if (!cancelled) {
+                    if (ResultCache<RangeData>::cacheable(cacheKey, loadedAt)) {
+                        m_cache.insert(cacheKey, data, series->size());
+                    }
+                    finish(requestId, data, x, y, *elapsedMs);
+                }
+                release();
+            });
+    }, Qt::QueuedConnection);
+}
+
+void CorrelationEngine::finish(int requestId, const std::shared_ptr<const RangeData>& data, int x, int y,
+                               double elapsedMs)
+{
+    QVariantMap pair = pairStats(data->moments, x, y);
+    pair["scatter"] = sampleScatter(*data->series, x, y);
+
+    qDebug() << "相关性计算完成，样本数:" << data->series->size() << "耗时:" << elapsedMs << "ms";
+    emit rangeFinished(requestId, matrix(data->moments), pair, data->series->size(), elapsedMs);
+}
+
+QVariantList CorrelationEngine::sampleScatter(const SensorSeries& series, int x, int y)
+{
+    // 分层抽样：每 stride 个样本中随机取一个，避免固定步长与周期性数据同步
+    QVariantList scatter;
+    const int n = series.size();
+    const int stride = std::max(1, (n + MAX_SCATTER_POINTS - 1) / MAX_SCATTER_POINTS);
+    QRandomGenerator rng(static_cast<quint32>(n));
+    for (int begin = 0; begin < n; begin += stride) {
+        const int k = begin + static_cast<int>(rng.bounded(static_cast<quint32>(std::min(stride, n - begin))));
+        scatter.append(QVariantMap{{"x", series.channels[x][k]}, {"y", series.channels[y][k]}});
+    }
+    return scatter;
+}
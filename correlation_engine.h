@@ -0,0 +1,131 @@
+#pragma once
+
+#include "database.h"
+#include "job_scheduler.h"
+#include <QDateTime>
+#include <QObject>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QVector>
+#include <memory>
+
+// 多通道协矩：各通道均值与两两离差积之和 Σ(xi - x̄i)(xj - x̄j)。
+// 可逐个增删样本（Welford 递推），分块结果可按 Chan 等人的公式合并，合并与顺序累加在数值上等价
+class CoMoments {
+public:
+    static constexpr int CHANNELS = SensorSeries::CHANNEL_COUNT;
+
+    void add(const double* values);
+    // 移除一个之前加入的样本（滑动窗口）
+    void remove(const double* values);
+    void merge(const CoMoments& other);
+    void clear();
+
+    qint64 count() const { return m_count; }
+    double mean(int channel) const { return m_mean[channel]; }
+    double comoment(int a, int b) const { return a <= b ? m_comoment[a][b] : m_comoment[b][a]; }
+    // 皮尔逊相关系数；样本不足或任一通道方差为 0 时为 NaN
+    double pearson(int a, int b) const;
+    // y 对 x 的最小二乘直线 y = slope·x + intercept
+    double slope(int x, int y) const;
+    double intercept(int x, int y) const;
+
+    // 序列 [begin, end) 的协矩：先求块均值再累加离差积（两遍，块内无除法）
+    static CoMoments fromSeries(const SensorSeries& series, int begin, int end);
+    // 按样本切成 threads 块，在 JobScheduler 中并行计算后合并
+    static CoMoments fromSeriesParallel(const SensorSeries& series, int threads);
+
+private:
+    qint64 m_count = 0;
+    double m_mean[CHANNELS] = {};
+    double m_comoment[CHANNELS][CHANNELS] = {};    // 只用上三角
+};
+
+// 实时滑动窗口：保存最近 capacity 帧，每帧 O(通道数²) 更新协矩；
+// 窗口每滚动一整圈用窗口内数据重算一次，消除增删累积的舍入误差
+class CorrelationWindow {
+public:
+    explicit CorrelationWindow(int capacity = 3600);
+
+    void push(const double* values);
+    void clear();
+    void setCapacity(int capacity);
+
+    int capacity() const { return m_capacity; }
+    int size() const { return m_size; }
+    const CoMoments& moments() const { return m_moments; }
+    // 窗口内第 index 帧（0 为最旧）
+    const float* frame(int index) const;
+
+private:
+    void rebuild();
+
+    int m_capacity;
+    int m_size = 0;
+    int m_head = 0;             // 下一帧写入位置
+    int m_sinceRebuild = 0;
+    QVector<float> m_frames;    // capacity × CHANNELS，环形
+    CoMoments m_moments;
+};
+
+// 传感器相关性：实时窗口与历史区间的 12×12 皮尔逊矩阵，以及所选通道对的回归与抽样散点
+class CorrelationEngine : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int windowSize READ windowSize WRITE setWindowSize NOTIFY windowSizeChanged)
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+public:
+    static constexpr int MAX_SCATTER_POINTS = 2000;
+    static constexpr int MIN_CHUNK_SAMPLES = 50000;
+    static constexpr qint64 RESULT_CACHE_SAMPLES = 1000000;  // 缓存的历史序列样本数上限
+
+    explicit CorrelationEngine(QObject *parent = nullptr);
+
+    int windowSize() const { return m_window.capacity(); }
+    void setWindowSize(int frames);
+    bool busy() const { return m_running > 0; }
+    void setDatabase(Database* database) { m_database = database; }
+
+    // 实时窗口：矩阵为 12 行，每行 12 个相关系数（无法计算时为 NaN）
+    Q_INVOKABLE QVariantList liveMatrix() const;
+    // 所选通道对：{r, r2, slope, intercept, pValue, count, scatter: [{x, y}]}
+    Q_INVOKABLE QVariantMap livePair(int x, int y) const;
+
+    // 历史区间：数据库线程读取 vesselId 的序列（默认与实时窗口同为本船），JobScheduler 中分块并行累加后合并，
+    // 结果经 rangeFinished 返回。新请求取代未完成的旧请求；已结束区间的序列与协矩按（船只, 区间）缓存，
+    // 换通道对时只重新抽样散点
+    Q_INVOKABLE void requestRange(int requestId, const QDateTime& from, const QDateTime& to, int x, int y,
+                                  int vesselId = PRIMARY_VESSEL_ID);
+
+    static QVariantList matrix(const CoMoments& moments);
+    // p 值按 t 统计量的正态近似计算，样本数较少时偏小
+    static QVariantMap pairStats(const CoMoments& moments, int x, int y);
+
+public slots:
+    // 与 SensorModule::sensorDataParsed 的参数一致
+    void addFrame(int co2, int ch2o, int tvoc, int pm25, int pm10,
+                  double airTemp, double humidity,
+                  int turbidity, double ph, int tds, double waterTemp,
+                  int levelValue);
+
+signals:
+    void windowSizeChanged();
+    void busyChanged();
+    void rangeFinished(int requestId, const QVariantList& matrix, const QVariantMap& pair, int samples, double elapsedMs);
+
+private:
+    // 一个历史区间的序列与协矩
+    struct RangeData {
+        std::shared_ptr<const SensorSeries> series;
+        CoMoments moments;
+    };
+
+    void release();
+    void finish(int requestId, const std::shared_ptr<const RangeData>& data, int x, int y, double elapsedMs);
+    static QVariantList sampleScatter(const SensorSeries& series, int x, int y);
+
+    CorrelationWindow m_window;
+    Database* m_database = nullptr;
+    int m_running = 0;              // 已发起、尚未结束（含已取消）的请求数
+    ResultCache<RangeData> m_cache{RESULT_CACHE_SAMPLES};
+};
+
@@ -1,7 +1,14 @@
 #include "database.h"
+#include "frame_codec.h"
+#include "geodesy.h"
 #include <QtSql/QSqlQuery>
 #include <QtSql/QSqlError>
 #include <QDebug>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QStringList>
+#include <cmath>
 
 Database::Database(QObject *parent) : QObject(parent) {
 }
@@ -18,6 +25,7 @@ bool Database::initialize() {
 
     if (!db.open()) {
         qDebug() << "Cannot open database:" << db.lastError().text();
+        emit initialized(false);
         return false;
     }
 
@@ -44,6 +52,7 @@ bool Database::initialize() {
 
     if (!query.exec(createSensorTable)) {
         qDebug() << "Failed to create sensor_data table:" << query.lastError().text();
+        emit initialized(false);
         return false;
     }
 
@@ -61,6 +70,7 @@ bool Database::initialize() {
 
     if (!query.exec(createVesselTable)) {
         qDebug() << "Failed to create vessel_data table:" << query.lastError().text();
+        emit initialized(false);
         return false;
     }
 
@@ -76,6 +86,7 @@ bool Database::initialize() {
 
     if (!query.exec(createTrajectoryTable)) {
         qDebug() << "Failed to create trajectory_data table:" << query.lastError().text();
+        emit initialized(false);
         return false;
     }
 
@@ -90,12 +101,167 @@ bool Database::initialize() {
 
     if (!query.exec(createDeviceTable)) {
         qDebug() << "Failed to create device_data table:" << query.lastError().text();
+        emit initialized(false);
         return false;
     }
 
+    QString createGeofenceEventTable = R"(
+        CREATE TABLE IF NOT EXISTS geofence_events (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            timestamp TEXT,
+            fence_id INTEGER,
+            fence_name TEXT,
+            kind INTEGER,
+            entered BOOLEAN,
+            breach BOOLEAN,
+            latitude REAL,
+            longitude REAL
+        )
+    )";
+
+    if (!query.exec(createGeofenceEventTable)) {
+        qDebug() << "Failed to create geofence_events table:" << query.lastError().text();
+        emit initialized(false);
+        return false;
+    }
+
+    QString createAlarmEventTable = R"(
+        CREATE TABLE IF NOT EXISTS alarm_events (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            timestamp TEXT,
+            channel TEXT,
+            level INTEGER,
+            previous_level INTEGER,
+            value REAL
+        )
+    )";
+
+    if (!query.exec(createAlarmEventTable)) {
+        qDebug() << "Failed to create alarm_events table:" << query.lastError().text();
+        emit initialized(false);
+        return false;
+    }
+
+    QString createAnomalyTable = R"(
+        CREATE TABLE IF NOT EXISTS sensor_anomalies (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            sensor_id INTEGER,
+            timestamp TEXT,
+            channel TEXT,
+            kind INTEGER,
+            value REAL,
+            score REAL,
+            expected REAL,
+            UNIQUE (sensor_id, channel, kind)
+        )
+    )";
+
+    if (!query.exec(createAnomalyTable)) {
+        qDebug() << "Failed to create sensor_anomalies table:" << query.lastError().text();
+        emit initialized(false);
+        return false;
+    }
+
+    for (const QString& table : {QStringLiteral("sensor_data"), QStringLiteral("vessel_data"),
+                                 QStringLiteral("trajectory_data"), QStringLiteral("device_data")}) {
+        if (!ensureVesselIdColumn(table)) {
+            emit initialized(false);
+            return false;
+        }
+    }
+
+    if (!ensureTimestampIndexes()) {
+        emit initialized(false);
+        return false;
+    }
+    ensureTrajectorySpatialIndex();
+
+    emit initialized(true);
     return true;
 }
 
+bool Database::ensureTimestampIndexes() {
+    QSqlQuery query;
+    for (const QString& table : {QStringLiteral("sensor_data"), QStringLiteral("trajectory_data")}) {
+        if (!query.exec(QString("CREATE INDEX IF NOT EXISTS idx_%1_timestamp ON %1(timestamp)").arg(table))) {
+            qDebug() << "Failed to create timestamp index:" << table << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+void Database::ensureTrajectorySpatialIndex() {
+    QSqlQuery query;
+    query.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'trajectory_rtree'");
+    const bool existed = query.next();
+
+    // R*Tree 以 32 位浮点保存边界（向外取整），查询时再用原表坐标精确过滤
+    if (!query.exec("CREATE VIRTUAL TABLE IF NOT EXISTS trajectory_rtree USING rtree(id, min_lat, max_lat, min_lon, max_lon)")) {
+        qDebug() << "R*Tree unavailable, trajectory spatial queries will scan the table:" << query.lastError().text();
+        m_spatialIndex = false;
+        return;
+    }
+
+    const QString createInsertTrigger = R"(
+        CREATE TRIGGER IF NOT EXISTS trajectory_rtree_insert AFTER INSERT ON trajectory_data BEGIN
+            INSERT INTO trajectory_rtree (id, min_lat, max_lat, min_lon, max_lon)
+            VALUES (new.id, new.latitude, new.latitude, new.longitude, new.longitude);
+        END
+    )";
+    const QString createDeleteTrigger = R"(
+        CREATE TRIGGER IF NOT EXISTS trajectory_rtree_delete AFTER DELETE ON trajectory_data BEGIN
+            DELETE FROM trajectory_rtree WHERE id = old.id;
+        END
+    )";
+    if (!query.exec(createInsertTrigger) || !query.exec(createDeleteTrigger)) {
+        qDebug() << "Failed to create trajectory index triggers:" << query.lastError().text();
+        m_spatialIndex = false;
+        return;
+    }
+
+    // 首次建立索引时补录已有轨迹
+    if (!existed) {
+        QElapsedTimer timer;
+        timer.start();
+        if (!query.exec(R"(
+            INSERT INTO trajectory_rtree (id, min_lat, max_lat, min_lon, max_lon)
+            SELECT id, latitude, latitude, longitude, longitude FROM trajectory_data
+            WHERE latitude IS NOT NULL AND longitude IS NOT NULL
+        )")) {
+            qDebug() << "Failed to backfill trajectory index:" << query.lastError().text();
+        } else {
+            qDebug() << "轨迹空间索引已建立，补录" << query.numRowsAffected() << "行，耗时" << timer.elapsed() << "ms";
+        }
+    }
+    m_spatialIndex = true;
+}
+
+bool Database::ensureVesselIdColumn(const QString& table) {
+    QSqlQuery query;
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        qDebug() << "Failed to read table info:" << table << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        if (query.value(1).toString() == "vessel_id") {
+            return true;
+        }
+    }
+
+    if (!query.exec(QString("ALTER TABLE %1 ADD COLUMN vessel_id INTEGER NOT NULL DEFAULT 0").arg(table))) {
+        qDebug() << "Failed to add vessel_id column:" << table << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+void Database::shutdown() {
+    if (db.isOpen()) {
+        db.close();
+    }
+}
+
 bool Database::insertSensorData(const QString& timestamp,
                                 int co2, int ch2o, int tvoc, int pm25, int pm10,
                                 double airTemp, double humidity,
@@ -207,3 +373,792 @@ bool Database::insertTrajectoryData(const QString& timestamp,
 
     return true;
 }
+
+bool Database::insertGeofenceEvent(const QString& timestamp, int fenceId, const QString& fenceName, int kind,
+                                   bool entered, bool breach, double latitude, double longitude) {
+    QSqlQuery query;
+    query.prepare(R"(
+        INSERT INTO geofence_events (
+            timestamp, fence_id, fence_name, kind, entered, breach, latitude, longitude
+        ) VALUES (
+            :timestamp, :fence_id, :fence_name, :kind, :entered, :breach, :latitude, :longitude
+        )
+    )");
+
+    query.bindValue(":timestamp", timestamp);
+    query.bindValue(":fence_id", fenceId);
+    query.bindValue(":fence_name", fenceName);
+    query.bindValue(":kind", kind);
+    query.bindValue(":entered", entered);
+    query.bindValue(":breach", breach);
+    query.bindValue(":latitude", latitude);
+    query.bindValue(":longitude", longitude);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to insert geofence event:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool Database::insertAlarmEvent(const QString& timestamp, const QString& channel, int level, int previousLevel,
+                                double value) {
+    QSqlQuery query;
+    query.prepare(R"(
+        INSERT INTO alarm_events (
+            timestamp, channel, level, previous_level, value
+        ) VALUES (
+            :timestamp, :channel, :level, :previous_level, :value
+        )
+    )");
+
+    query.bindValue(":timestamp", timestamp);
+    query.bindValue(":channel", channel);
+    query.bindValue(":level", level);
+    query.bindValue(":previous_level", previousLevel);
+    query.bindValue(":value", value);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to insert alarm event:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool Database::insertAnomalies(const QVector<SensorAnomaly>& anomalies) {
+    if (anomalies.isEmpty()) {
+        return true;
+    }
+
+    if (!db.transaction()) {
+        qDebug() << "Failed to begin transaction:" << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery lookup;
+    lookup.prepare("SELECT id FROM sensor_data WHERE vessel_id = ? AND timestamp <= ? "
+                   "ORDER BY timestamp DESC, id DESC LIMIT 1");
+    QSqlQuery query;
+    query.prepare(R"(
+        INSERT OR IGNORE INTO sensor_anomalies (
+            sensor_id, timestamp, channel, kind, value, score, expected
+        ) VALUES (?, ?, ?, ?, ?, ?, ?)
+    )");
+
+    for (const SensorAnomaly& anomaly : anomalies) {
+        qint64 sensorId = anomaly.sensorId;
+        if (sensorId == 0) {
+            lookup.addBindValue(anomaly.vesselId);
+            lookup.addBindValue(anomaly.timestamp);
+            if (lookup.exec() && lookup.next()) sensorId = lookup.value(0).toLongLong();
+            lookup.finish();
+        }
+
+        query.addBindValue(sensorId);
+        query.addBindValue(anomaly.timestamp);
+        query.addBindValue(anomaly.channel);
+        query.addBindValue(anomaly.kind);
+        query.addBindValue(anomaly.value);
+        query.addBindValue(anomaly.score);
+        query.addBindValue(anomaly.expected);
+        if (!query.exec()) {
+            qDebug() << "Failed to insert sensor anomaly:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+
+    if (!db.commit()) {
+        qDebug() << "Failed to commit sensor anomalies:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool Database::insertTelemetryBatch(const QVector<TelemetrySample>& samples) {
+    if (samples.isEmpty()) {
+        return true;
+    }
+
+    if (!db.transaction()) {
+        qDebug() << "Failed to begin transaction:" << db.lastError().text();
+        return false;
+    }
+
+    // 每张表只 prepare 一次，批内逐行绑定执行
+    QSqlQuery sensorQuery;
+    sensorQuery.prepare(R"(
+        INSERT INTO sensor_data (
+            vessel_id, timestamp, co2, ch2o, tvoc, pm25, pm10,
+            air_temperature, humidity,
+            turbidity, ph, tds, water_temperature,
+            level_value
+        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )");
+    QSqlQuery vesselQuery;
+    vesselQuery.prepare(R"(
+        INSERT INTO vessel_data (
+            vessel_id, timestamp, latitude, longitude, speed, heading
+        ) VALUES (?, ?, ?, ?, ?, ?)
+    )");
+    QSqlQuery trajectoryQuery;
+    trajectoryQuery.prepare(R"(
+        INSERT INTO trajectory_data (
+            vessel_id, timestamp, latitude, longitude
+        ) VALUES (?, ?, ?, ?)
+    )");
+    QSqlQuery deviceQuery;
+    deviceQuery.prepare(R"(
+        INSERT INTO device_data (
+            vessel_id, timestamp, battery, mode
+        ) VALUES (?, ?, ?, ?)
+    )");
+
+    for (const TelemetrySample& sample : samples) {
+        const QString timestamp = QDateTime::fromMSecsSinceEpoch(sample.timestampMs).toString(Qt::ISODate);
+
+        sensorQuery.addBindValue(sample.vesselId);
+        sensorQuery.addBindValue(timestamp);
+        sensorQuery.addBindValue(sample.co2);
+        sensorQuery.addBindValue(sample.ch2o);
+        sensorQuery.addBindValue(sample.tvoc);
+        sensorQuery.addBindValue(sample.pm25);
+        sensorQuery.addBindValue(sample.pm10);
+        sensorQuery.addBindValue(sample.airTemperature);
+        sensorQuery.addBindValue(sample.humidity);
+        sensorQuery.addBindValue(sample.turbidity);
+        sensorQuery.addBindValue(sample.ph);
+        sensorQuery.addBindValue(sample.tds);
+        sensorQuery.addBindValue(sample.waterTemperature);
+        sensorQuery.addBindValue(sample.levelValue);
+
+        vesselQuery.addBindValue(sample.vesselId);
+        vesselQuery.addBindValue(timestamp);
+        vesselQuery.addBindValue(sample.latitude);
+        vesselQuery.addBindValue(sample.longitude);
+        vesselQuery.addBindValue(sample.speed);
+        vesselQuery.addBindValue(sample.heading);
+
+        trajectoryQuery.addBindValue(sample.vesselId);
+        trajectoryQuery.addBindValue(timestamp);
+        trajectoryQuery.addBindValue(sample.latitude);
+        trajectoryQuery.addBindValue(sample.longitude);
+
+        deviceQuery.addBindValue(sample.vesselId);
+        deviceQuery.addBindValue(timestamp);
+        deviceQuery.addBindValue(sample.battery);
+        deviceQuery.addBindValue(sample.mode);
+
+        if (!sensorQuery.exec() || !vesselQuery.exec() || !trajectoryQuery.exec() || !deviceQuery.exec()) {
+            qDebug() << "Failed to insert telemetry batch:"
+                     << sensorQuery.lastError().text() << vesselQuery.lastError().text()
+                     << trajectoryQuery.lastError().text() << deviceQuery.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+
+    if (!db.commit()) {
+        qDebug() << "Failed to commit telemetry batch:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+QVector<DailyDistance> Database::distancePerDay(const QDateTime& from, const QDateTime& to, int vesselId) {
+    QVector<DailyDistance> result;
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    query.prepare(QString(R"(
+        SELECT vessel_id, timestamp, latitude, longitude FROM trajectory_data
+        WHERE timestamp >= ? AND timestamp < ? %1
+        ORDER BY vessel_id, id
+    )").arg(vesselId >= 0 ? "AND vessel_id = ?" : ""));
+    query.addBindValue(from.toLocalTime().toString(Qt::ISODate));
+    query.addBindValue(to.toLocalTime().toString(Qt::ISODate));
+    if (vesselId >= 0) query.addBindValue(vesselId);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to query trajectory data:" << query.lastError().text();
+        return result;
+    }
+
+    // 逐行读取到定长 SoA 缓冲，满块或换日、换船时批量求折线长度
+    constexpr int CHUNK_POINTS = 4096;
+    QVector<double> lat(CHUNK_POINTS), lon(CHUNK_POINTS);
+    int buffered = 0;
+    auto flush = [&]() {
+        if (buffered > 1) {
+            result.last().meters += Geodesy::pathLength(lat.constData(), lon.constData(), buffered);
+        }
+        // 保留最后一个点作为下一块的起点
+        if (buffered > 0) {
+            lat[0] = lat[buffered - 1];
+            lon[0] = lon[buffered - 1];
+            buffered = 1;
+        }
+    };
+
+    int currentVessel = -1;
+    QString currentDay;
+    while (query.next()) {
+        const int rowVessel = query.value(0).toInt();
+        const QString day = query.value(1).toString().left(10);
+
+        if (rowVessel != currentVessel || day != currentDay) {
+            flush();
+            if (rowVessel != currentVessel) buffered = 0;
+            currentVessel = rowVessel;
+            currentDay = day;
+            DailyDistance entry;
+            entry.vesselId = rowVessel;
+            entry.day = day;
+            result.append(entry);
+        } else if (buffered == CHUNK_POINTS) {
+            flush();
+        }
+
+        lat[buffered] = query.value(2).toDouble();
+        lon[buffered] = query.value(3).toDouble();
+        ++buffered;
+        ++result.last().samples;
+    }
+    flush();
+    return result;
+}
+
+void Database::requestDistancePerDay(const QDateTime& from, const QDateTime& to, int vesselId) {
+    QMetaObject::invokeMethod(this, [this, from, to, vesselId]() {
+        QVariantList days;
+        for (const DailyDistance& entry : distancePerDay(from, to, vesselId)) {
+            days.append(QVariantMap{
+                {"vesselId", entry.vesselId},
+                {"day", entry.day},
+                {"distance", entry.meters},
+                {"samples", entry.samples}
+            });
+        }
+        emit distancePerDayReady(days);
+    }, Qt::QueuedConnection);
+}
+
+TrajectoryQuery TrajectoryQuery::inBox(double minLat, double minLon, double maxLat, double maxLon) {
+    TrajectoryQuery query;
+    query.minLatitude = qMin(minLat, maxLat);
+    query.maxLatitude = qMax(minLat, maxLat);
+    query.minLongitude = qMin(minLon, maxLon);
+    query.maxLongitude = qMax(minLon, maxLon);
+    return query;
+}
+
+TrajectoryQuery TrajectoryQuery::around(double latitude, double longitude, double radiusM) {
+    // 圆的外接经纬度框，再按大圆距离精确过滤
+    const double dLat = radiusM / (Geodesy::EARTH_RADIUS_M * Geodesy::DEG_TO_RAD);
+    const double dLon = dLat / qMax(std::cos(latitude * Geodesy::DEG_TO_RAD), 1e-6);
+    TrajectoryQuery query = inBox(latitude - dLat, longitude - dLon, latitude + dLat, longitude + dLon);
+    query.centerLatitude = latitude;
+    query.centerLongitude = longitude;
+    query.radius = radiusM;
+    return query;
+}
+
+int Database::queryTrajectory(const TrajectoryQuery& request,
+                              const std::function<bool(const QVector<TrajectoryFix>&)>& onChunk) {
+    QString sql = m_spatialIndex
+        ? QStringLiteral(R"(
+            SELECT t.id, t.vessel_id, t.timestamp, t.latitude, t.longitude
+            FROM trajectory_rtree r JOIN trajectory_data t ON t.id = r.id
+            WHERE r.max_lat >= ? AND r.min_lat <= ? AND r.max_lon >= ? AND r.min_lon <= ?
+              AND t.latitude BETWEEN ? AND ? AND t.longitude BETWEEN ? AND ?)")
+        : QStringLiteral(R"(
+            SELECT t.id, t.vessel_id, t.timestamp, t.latitude, t.longitude
+            FROM trajectory_data t
+            WHERE t.latitude BETWEEN ? AND ? AND t.longitude BETWEEN ? AND ?)");
+    if (request.from.isValid()) sql += " AND t.timestamp >= ?";
+    if (request.to.isValid()) sql += " AND t.timestamp < ?";
+    if (request.vesselId >= 0) sql += " AND t.vessel_id = ?";
+    sql += " ORDER BY t.id";
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    const int boxBindings = m_spatialIndex ? 2 : 1;
+    for (int i = 0; i < boxBindings; ++i) {
+        query.addBindValue(request.minLatitude);
+        query.addBindValue(request.maxLatitude);
+        query.addBindValue(request.minLongitude);
+        query.addBindValue(request.maxLongitude);
+    }
+    if (request.from.isValid()) query.addBindValue(request.from.toLocalTime().toString(Qt::ISODate));
+    if (request.to.isValid()) query.addBindValue(request.to.toLocalTime().toString(Qt::ISODate));
+    if (request.vesselId >= 0) query.addBindValue(request.vesselId);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to query trajectory data:" << query.lastError().text();
+        return 0;
+    }
+
+    int count = 0;
+    QVector<TrajectoryFix> chunk;
+    chunk.reserve(TRAJECTORY_CHUNK_SIZE);
+    while (query.next()) {
+        TrajectoryFix fix;
+        fix.id = query.value(0).toLongLong();
+        fix.vesselId = query.value(1).toInt();
+        fix.timestamp = query.value(2).toString();
+        fix.latitude = query.value(3).toDouble();
+        fix.longitude = query.value(4).toDouble();
+        if (request.radius > 0) {
+            fix.distance = Geodesy::distance(request.centerLatitude, request.centerLongitude, fix.latitude, fix.longitude);
+            if (fix.distance > request.radius) continue;
+        }
+
+        chunk.append(fix);
+        ++count;
+        if (chunk.size() == TRAJECTORY_CHUNK_SIZE) {
+            if (!onChunk(chunk)) return count;
+            chunk.clear();
+        }
+    }
+    if (!chunk.isEmpty()) onChunk(chunk);
+    return count;
+}
+
+bool Database::nearestTrajectoryFix(double latitude, double longitude, double maxRadius, int vesselId, TrajectoryFix& out) {
+    // 半径内存在候选点时，其中最近者即为全局最近点
+    for (double radius = qMin(NEAREST_START_RADIUS_M, maxRadius); ; radius = qMin(radius * 2, maxRadius)) {
+        TrajectoryQuery query = TrajectoryQuery::around(latitude, longitude, radius);
+        query.vesselId = vesselId;
+
+        bool found = false;
+        queryTrajectory(query, [&](const QVector<TrajectoryFix>& fixes) {
+            for (const TrajectoryFix& fix : fixes) {
+                if (!found || fix.distance < out.distance) {
+                    out = fix;
+                    found = true;
+                }
+            }
+            return true;
+        });
+        if (found) return true;
+        if (radius >= maxRadius) return false;
+    }
+}
+
+namespace {
+
+QVariantMap fixToVariant(const TrajectoryFix& fix) {
+    return QVariantMap{
+        {"id", fix.id},
+        {"vesselId", fix.vesselId},
+        {"timestamp", fix.timestamp},
+        {"latitude", fix.latitude},
+        {"longitude", fix.longitude},
+        {"distance", fix.distance}
+    };
+}
+
+}
+
+void Database::runTrajectoryRequest(int requestId, const TrajectoryQuery& request) {
+    QElapsedTimer timer;
+    timer.start();
+    const int count = queryTrajectory(request, [this, requestId](const QVector<TrajectoryFix>& fixes) {
+        QVariantList chunk;
+        chunk.reserve(fixes.size());
+        for (const TrajectoryFix& fix : fixes) chunk.append(fixToVariant(fix));
+        emit trajectoryChunk(requestId, chunk);
+        return true;
+    });
+    emit trajectoryQueryFinished(requestId, count, timer.nsecsElapsed() / 1e6);
+}
+
+void Database::requestTrajectoryInBox(int requestId, double minLat, double minLon, double maxLat, double maxLon,
+                                      const QDateTime& from, const QDateTime& to, int vesselId) {
+    TrajectoryQuery request = TrajectoryQuery::inBox(minLat, minLon, maxLat, maxLon);
+    request.from = from;
+    request.to = to;
+    request.vesselId = vesselId;
+    QMetaObject::invokeMethod(this, [this, requestId, request]() {
+        runTrajectoryRequest(requestId, request);
+    }, Qt::QueuedConnection);
+}
+
+void Database::requestTrajectoryAround(int requestId, double latitude, double longitude, double radius,
+                                       const QDateTime& from, const QDateTime& to, int vesselId) {
+    TrajectoryQuery request = TrajectoryQuery::around(latitude, longitude, radius);
+    request.from = from;
+    request.to = to;
+    request.vesselId = vesselId;
+    QMetaObject::invokeMethod(this, [this, requestId, request]() {
+        runTrajectoryRequest(requestId, request);
+    }, Qt::QueuedConnection);
+}
+
+void Database::requestNearestFix(int requestId, double latitude, double longitude, double maxRadius, int vesselId) {
+    QMetaObject::invokeMethod(this, [=]() {
+        TrajectoryFix fix;
+        emit nearestFixReady(requestId, nearestTrajectoryFix(latitude, longitude, maxRadius, vesselId, fix)
+                                            ? fixToVariant(fix) : QVariantMap());
+    }, Qt::QueuedConnection);
+}
+
+namespace {
+
+// "yyyy-MM-ddTHH:mm:ss[.zzz]" 转为不含时区的秒数，只用于同库时间戳之间的比较与插值。
+// 逐行调用 QDateTime::fromString 的开销与整个连接相当，这里直接按字符解析
+double isoSeconds(const QString& text) {
+    if (text.size() < 19 || text.at(10) != QLatin1Char('T')) return qQNaN();
+    const QChar* c = text.constData();
+    auto field = [c](int pos, int length) {
+        int value = 0;
+        for (int i = pos; i < pos + length; ++i) value = value * 10 + (c[i].unicode() - '0');
+        return value;
+    };
+
+    // 公历日期转为 1970-01-01 起的天数
+    int year = field(0, 4);
+    const int month = field(5, 2);
+    const int day = field(8, 2);
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - era * 400;
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    const qint64 days = static_cast<qint64>(era) * 146097 + dayOfEra - 719468;
+
+    double seconds = days * 86400.0 + field(11, 2) * 3600 + field(14, 2) * 60 + field(17, 2);
+    if (text.size() >= 23 && c[19] == QLatin1Char('.')) seconds += field(20, 3) / 1000.0;
+    return seconds;
+}
+
+// 按时间顺序接收两路数据的归并状态：每船保存上一个定位点和等待下一个定位点的传感器样本
+class GeoJoin {
+public:
+    explicit GeoJoin(std::function<void(GeoSample&)> output) : m_output(std::move(output)) {}
+
+    void addFix(int vesselId, double t, double latitude, double longitude) {
+        Cursor& cursor = m_cursors[vesselId];
+        for (Pending& pending : cursor.pending) {
+            resolve(pending, cursor, true, t, latitude, longitude);
+        }
+        cursor.pending.clear();
+        cursor.hasPrev = true;
+        cursor.t = t;
+        cursor.latitude = latitude;
+        cursor.longitude = longitude;
+    }
+
+    void addSample(GeoSample& sample, double t) {
+        Cursor& cursor = m_cursors[sample.vesselId];
+        // 之后到达的定位点已不可能用于插值或就近取值的样本，立即按上一个定位点处理，待处理队列保持有界
+        int done = 0;
+        while (done < cursor.pending.size() && t > expiry(cursor, cursor.pending[done].t)) {
+            resolve(cursor.pending[done++], cursor, false, 0.0, 0.0, 0.0);
+        }
+        cursor.pending.remove(0, done);
+
+        if (cursor.hasPrev && cursor.t == t) {
+            sample.latitude = cursor.latitude;
+            sample.longitude = cursor.longitude;
+            m_output(sample);
+            return;
+        }
+        cursor.pending.append({t, sample});
+    }
+
+    bool hasPending() const {
+        for (const Cursor& cursor : m_cursors) {
+            if (!cursor.pending.isEmpty()) return true;
+        }
+        return false;
+    }
+
+    void finish() {
+        for (Cursor& cursor : m_cursors) {
+            for (Pending& pending : cursor.pending) resolve(pending, cursor, false, 0.0, 0.0, 0.0);
+            cursor.pending.clear();
+        }
+    }
+
+    int unmatched() const { return m_unmatched; }
+
+private:
+    struct Pending {
+        double t;
+        GeoSample sample;
+    };
+    struct Cursor {
+        bool hasPrev = false;
+        double t = 0.0;
+        double latitude = 0.0;
+        double longitude = 0.0;
+        QVector<Pending> pending;
+    };
+
+    static double expiry(const Cursor& cursor, double t) {
+        const double snapLimit = t + Database::MAX_SNAP_S;
+        return cursor.hasPrev ? qMax(cursor.t + Database::MAX_INTERPOLATION_GAP_S, snapLimit) : snapLimit;
+    }
+
+    void resolve(Pending& pending, const Cursor& prev, bool hasNext, double nextT, double nextLat, double nextLon) {
+        GeoSample& sample = pending.sample;
+        if (prev.hasPrev && hasNext && nextT - prev.t <= Database::MAX_INTERPOLATION_GAP_S) {
+            const double fraction = nextT > prev.t ? qBound(0.0, (pending.t - prev.t) / (nextT - prev.t), 1.0) : 0.0;
+            sample.latitude = prev.latitude + fraction * (nextLat - prev.latitude);
+            sample.longitude = prev.longitude + fraction * (nextLon - prev.longitude);
+        } else {
+            const double prevGap = prev.hasPrev ? pending.t - prev.t : qInf();
+            const double nextGap = hasNext ? nextT - pending.t : qInf();
+            if (qMin(prevGap, nextGap) > Database::MAX_SNAP_S) {
+                ++m_unmatched;
+                return;
+            }
+            sample.latitude = prevGap <= nextGap ? prev.latitude : nextLat;
+            sample.longitude = prevGap <= nextGap ? prev.longitude : nextLon;
+        }
+        m_output(sample);
+    }
+
+    std::function<void(GeoSample&)> m_output;
+    QHash<int, Cursor> m_cursors;
+    int m_unmatched = 0;
+};
+
+QVariantMap geoSampleToVariant(const GeoSample& sample) {
+    return QVariantMap{
+        {"sensorId", sample.sensorId},
+        {"vesselId", sample.vesselId},
+        {"timestamp", sample.timestamp},
+        {"latitude", sample.latitude},
+        {"longitude", sample.longitude},
+        {"co2", sample.co2},
+        {"ch2o", sample.ch2o},
+        {"tvoc", sample.tvoc},
+        {"pm25", sample.pm25},
+        {"pm10", sample.pm10},
+        {"airTemperature", sample.airTemperature},
+        {"humidity", sample.humidity},
+        {"turbidity", sample.turbidity},
+        {"ph", sample.ph},
+        {"tds", sample.tds},
+        {"waterTemperature", sample.waterTemperature},
+        {"levelValue", sample.levelValue}
+    };
+}
+
+}
+
+int Database::georeferencedSamples(const GeoSampleQuery& request,
+                                   const std::function<bool(const QVector<GeoSample>&)>& onChunk, int* unmatched) {
+    if (unmatched) *unmatched = 0;
+    if (!request.from.isValid() || !request.to.isValid()) return 0;
+
+    // 两路都走 timestamp 索引按时间顺序读取；轨迹范围向两侧放宽，以便区间端点的样本也能插值
+    const QString vesselFilter = request.vesselId >= 0 ? QStringLiteral(" AND vessel_id = ?") : QString();
+    QSqlQuery sensors;
+    sensors.setForwardOnly(true);
+    sensors.prepare(QString(R"(
+        SELECT id, vessel_id, timestamp, co2, ch2o, tvoc, pm25, pm10,
+               air_temperature, humidity, turbidity, ph, tds, water_temperature, level_value
+        FROM sensor_data WHERE timestamp >= ? AND timestamp < ?%1
+        ORDER BY timestamp, id
+    )").arg(vesselFilter));
+    sensors.addBindValue(request.from.toLocalTime().toString(Qt::ISODate));
+    sensors.addBindValue(request.to.toLocalTime().toString(Qt::ISODate));
+    if (request.vesselId >= 0) sensors.addBindValue(request.vesselId);
+
+    const int margin = static_cast<int>(MAX_INTERPOLATION_GAP_S);
+    QSqlQuery fixes;
+    fixes.setForwardOnly(true);
+    fixes.prepare(QString(R"(
+        SELECT vessel_id, timestamp, latitude, longitude
+        FROM trajectory_data WHERE timestamp >= ? AND timestamp < ?%1
+        ORDER BY timestamp, id
+    )").arg(vesselFilter));
+    fixes.addBindValue(request.from.toLocalTime().addSecs(-margin).toString(Qt::ISODate));
+    fixes.addBindValue(request.to.toLocalTime().addSecs(margin).toString(Qt::ISODate));
+    if (request.vesselId >= 0) fixes.addBindValue(request.vesselId);
+
+    if (!sensors.exec() || !fixes.exec()) {
+        qDebug() << "Failed to query georeferenced samples:" << sensors.lastError().text() << fixes.lastError().text();
+        return 0;
+    }
+
+    int count = 0;
+    bool stopped = false;
+    QVector<GeoSample> chunk;
+    chunk.reserve(TRAJECTORY_CHUNK_SIZE);
+    GeoJoin join([&](GeoSample& sample) {
+        if (stopped) return;
+        if (request.hasArea
+            && (sample.latitude < request.minLatitude || sample.latitude > request.maxLatitude
+                || sample.longitude < request.minLongitude || sample.longitude > request.maxLongitude)) {
+            return;
+        }
+        chunk.append(sample);
+        ++count;
+        if (chunk.size() == TRAJECTORY_CHUNK_SIZE) {
+            stopped = !onChunk(chunk);
+            chunk.clear();
+        }
+    });
+
+    auto nextFix = [&fixes](double& t) {
+        while (fixes.next()) {
+            t = isoSeconds(fixes.value(1).toString());
+            if (!qIsNaN(t)) return true;
+        }
+        return false;
+    };
+    auto feedFix = [&fixes, &join](double t) {
+        join.addFix(fixes.value(0).toInt(), t, fixes.value(2).toDouble(), fixes.value(3).toDouble());
+    };
+
+    // 归并：同一时刻先处理定位点
+    double fixT = 0.0;
+    bool hasFix = nextFix(fixT);
+    while (!stopped && sensors.next()) {
+        const QString timestamp = sensors.value(2).toString();
+        const double sensorT = isoSeconds(timestamp);
+        if (qIsNaN(sensorT)) continue;
+
+        while (hasFix && fixT <= sensorT) {
+            feedFix(fixT);
+            hasFix = nextFix(fixT);
+        }
+
+        GeoSample sample;
+        sample.sensorId = sensors.value(0).toLongLong();
+        sample.vesselId = sensors.value(1).toInt();
+        sample.timestamp = timestamp;
+        sample.co2 = sensors.value(3).toInt();
+        sample.ch2o = sensors.value(4).toInt();
+        sample.tvoc = sensors.value(5).toInt();
+        sample.pm25 = sensors.value(6).toInt();
+        sample.pm10 = sensors.value(7).toInt();
+        sample.airTemperature = sensors.value(8).toDouble();
+        sample.humidity = sensors.value(9).toDouble();
+        sample.turbidity = sensors.value(10).toInt();
+        sample.ph = sensors.value(11).toDouble();
+        sample.tds = sensors.value(12).toInt();
+        sample.waterTemperature = sensors.value(13).toDouble();
+        sample.levelValue = sensors.value(14).toInt();
+        join.addSample(sample, sensorT);
+    }
+    // 区间末尾的样本还需要之后的定位点
+    while (!stopped && hasFix && join.hasPending()) {
+        feedFix(fixT);
+        hasFix = nextFix(fixT);
+    }
+    join.finish();
+
+    if (!stopped && !chunk.isEmpty()) onChunk(chunk);
+    if (unmatched) *unmatched = join.unmatched();
+    return count;
+}
+
+void Database::requestGeoreferencedSamples(int requestId, const QDateTime& from, const QDateTime& to,
+                                           double minLat, double minLon, double maxLat, double maxLon, int vesselId) {
+    GeoSampleQuery request;
+    request.from = from;
+    request.to = to;
+    request.vesselId = vesselId;
+    request.hasArea = minLat <= maxLat;
+    request.minLatitude = minLat;
+    request.maxLatitude = maxLat;
+    request.minLongitude = qMin(minLon, maxLon);
+    request.maxLongitude = qMax(minLon, maxLon);
+    QMetaObject::invokeMethod(this, [this, requestId, request]() {
+        QElapsedTimer timer;
+        timer.start();
+        int unmatched = 0;
+        const int count = georeferencedSamples(request, [this, requestId](const QVector<GeoSample>& samples) {
+            QVariantList chunk;
+            chunk.reserve(samples.size());
+            for (const GeoSample& sample : samples) chunk.append(geoSampleToVariant(sample));
+            emit geoSampleChunk(requestId, chunk);
+            return true;
+        }, &unmatched);
+        emit geoSampleQueryFinished(requestId, count, unmatched, timer.nsecsElapsed() / 1e6);
+    }, Qt::QueuedConnection);
+}
+
+bool Database::sensorSeries(const QDateTime& from, const QDateTime& to, int vesselId, SensorSeries& out) {
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    query.prepare(QString(R"(
+        SELECT id, timestamp, co2, ch2o, tvoc, pm25, pm10, air_temperature, humidity,
+               turbidity, ph, tds, water_temperature, level_value
+        FROM sensor_data
+        WHERE timestamp >= ? AND timestamp < ? %1
+        ORDER BY timestamp, id
+    )").arg(vesselId >= 0 ? "AND vessel_id = ?" : ""));
+    query.addBindValue(from.toLocalTime().toString(Qt::ISODate));
+    query.addBindValue(to.toLocalTime().toString(Qt::ISODate));
+    if (vesselId >= 0) query.addBindValue(vesselId);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to query sensor series:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        const double seconds = isoSeconds(query.value(1).toString());
+        if (qIsNaN(seconds)) continue;
+        out.ids.append(query.value(0).toLongLong());
+        out.seconds.append(seconds);
+        for (int c = 0; c < SensorSeries::CHANNEL_COUNT; ++c) {
+            out.channels[c].append(query.value(2 + c).toFloat());
+        }
+    }
+    return true;
+}
+
+bool Database::sensorBuckets(const QDateTime& from, const QDateTime& to, int bucketSeconds, int vesselId,
+                             SensorBuckets& out) {
+    static const char* const columns[SensorBuckets::CHANNEL_COUNT] = {
+        "co2", "ch2o", "tvoc", "pm25", "pm10", "air_temperature", "humidity",
+        "turbidity", "ph", "tds", "water_temperature", "level_value"
+    };
+    const int width = std::max(1, bucketSeconds);
+    QStringList aggregates;
+    for (const char* column : columns) {
+        aggregates << QString("AVG(%1), MIN(%1), MAX(%1)").arg(QLatin1String(column));
+    }
+
+    // strftime('%s') 把本地时间戳按 UTC 解析，得到的秒数与 isoSeconds 一致，桶边界落在本地时间的整点
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    query.prepare(QString(R"(
+        SELECT CAST(strftime('%s', timestamp) AS INTEGER) / ? AS bucket, COUNT(*), %1
+        FROM sensor_data
+        WHERE timestamp >= ? AND timestamp < ? %2
+        GROUP BY bucket
+        ORDER BY bucket
+    )").arg(aggregates.join(", "), vesselId >= 0 ? "AND vessel_id = ?" : ""));
+    query.addBindValue(width);
+    query.addBindValue(from.toLocalTime().toString(Qt::ISODate));
+    query.addBindValue(to.toLocalTime().toString(Qt::ISODate));
+    if (vesselId >= 0) query.addBindValue(vesselId);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to query sensor buckets:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        if (query.value(0).isNull()) continue;
+        out.starts.append(query.value(0).toLongLong() * width);
+        out.counts.append(query.value(1).toInt());
+        for (int c = 0; c < SensorBuckets::CHANNEL_COUNT; ++c) {
+            out.mean[c].append(query.value(2 + c * 3).toFloat());
+            out.minimum[c].append(query.value(3 + c * 3).toFloat());
+            out.maximum[c].append(query.value(4 + c * 3).toFloat());
+        }
+    }
+    return true;
+}
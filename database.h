@@ -4,6 +4,122 @@
 #include <QObject>
 #include <QtSql/QSqlDatabase>
 #include <QString>
+#include <QDateTime>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QVector>
+#include <functional>
+
+struct TelemetrySample;
+
+// 实时串口链路（SensorModule 等）写入的本船编号；船队中其他船只按各自编号写入
+constexpr int PRIMARY_VESSEL_ID = 0;
+
+// 单船单日航程
+struct DailyDistance {
+    int vesselId = 0;
+    QString day;            // yyyy-MM-dd
+    double meters = 0.0;
+    int samples = 0;
+};
+
+// 轨迹点（空间查询结果）
+struct TrajectoryFix {
+    qint64 id = 0;
+    int vesselId = 0;
+    QString timestamp;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    double distance = -1.0;     // 圆形与最近点查询时为到查询点的距离（米）
+};
+
+// 轨迹空间查询条件：经纬度范围，可选圆形过滤、时间范围与船只
+struct TrajectoryQuery {
+    double minLatitude = -90.0;
+    double maxLatitude = 90.0;
+    double minLongitude = -180.0;
+    double maxLongitude = 180.0;
+    // radius > 0 时只保留距中心 radius 米以内的点
+    double centerLatitude = 0.0;
+    double centerLongitude = 0.0;
+    double radius = 0.0;
+    QDateTime from;             // 无效表示不限
+    QDateTime to;
+    int vesselId = -1;
+
+    static TrajectoryQuery inBox(double minLat, double minLon, double maxLat, double maxLon);
+    static TrajectoryQuery around(double latitude, double longitude, double radiusM);
+};
+
+// 带位置的传感器样本：传感器读数配以该时刻插值得到的船只位置
+struct GeoSample {
+    qint64 sensorId = 0;
+    int vesselId = 0;
+    QString timestamp;
+    double latitude = 0.0;
+    double longitude = 0.0;
+
+    int co2 = 0;
+    int ch2o = 0;
+    int tvoc = 0;
+    int pm25 = 0;
+    int pm10 = 0;
+    double airTemperature = 0.0;
+    double humidity = 0.0;
+    int turbidity = 0;
+    double ph = 0.0;
+    int tds = 0;
+    double waterTemperature = 0.0;
+    int levelValue = 0;
+};
+
+// 带位置传感器样本的查询条件：时间范围必填，区域与船只可选
+struct GeoSampleQuery {
+    QDateTime from;
+    QDateTime to;
+    int vesselId = -1;
+    bool hasArea = false;
+    double minLatitude = -90.0;
+    double maxLatitude = 90.0;
+    double minLongitude = -180.0;
+    double maxLongitude = 180.0;
+};
+
+// 传感器历史序列（SoA，按时间顺序）：channels 的顺序与 sensor_data 中 co2 … level_value 列一致
+struct SensorSeries {
+    static constexpr int CHANNEL_COUNT = 12;
+
+    QVector<qint64> ids;
+    QVector<double> seconds;        // 本地时间按 UTC 计的秒数，只用于比较与求间隔
+    QVector<float> channels[CHANNEL_COUNT];
+
+    int size() const { return ids.size(); }
+};
+
+// 按固定时间桶汇总的传感器序列，只包含有读数的桶
+struct SensorBuckets {
+    static constexpr int CHANNEL_COUNT = SensorSeries::CHANNEL_COUNT;
+
+    QVector<qint64> starts;         // 桶起点：本地时间按 UTC 计的秒数
+    QVector<int> counts;
+    QVector<float> mean[CHANNEL_COUNT];
+    QVector<float> minimum[CHANNEL_COUNT];
+    QVector<float> maximum[CHANNEL_COUNT];
+
+    int size() const { return starts.size(); }
+};
+
+// 传感器异常标记；sensorId 为 0 时取 vesselId 在 sensor_data 中不晚于 timestamp 的最新记录
+struct SensorAnomaly {
+    qint64 sensorId = 0;
+    int vesselId = PRIMARY_VESSEL_ID;
+    QString timestamp;
+    QString channel;
+    int kind = 0;
+    double value = 0.0;
+    double score = 0.0;
+    double expected = 0.0;
+};
 
 class Database : public QObject {
     Q_OBJECT
@@ -11,7 +127,6 @@ public:
     explicit Database(QObject *parent = nullptr);
     ~Database();
 
-    bool initialize();
     bool insertSensorData(const QString& timestamp,
                           int co2, int ch2o, int tvoc, int pm25, int pm10,
                           double airTemp, double humidity,
@@ -23,9 +138,92 @@ public:
                           int battery,bool mode);
     bool insertTrajectoryData(const QString& timestamp,
                               double latitude, double longitude);
+    // 围栏进出事件
+    bool insertGeofenceEvent(const QString& timestamp, int fenceId, const QString& fenceName, int kind,
+                             bool entered, bool breach, double latitude, double longitude);
+    // 传感器告警状态变化
+    bool insertAlarmEvent(const QString& timestamp, const QString& channel, int level, int previousLevel,
+                          double value);
+    // 传感器异常标记（同一条记录、通道、类型只记一次）
+    bool insertAnomalies(const QVector<SensorAnomaly>& anomalies);
+    // 船队批量写入：一批样本在一个事务内写入各表，按 vessel_id 区分船只
+    bool insertTelemetryBatch(const QVector<TelemetrySample>& samples);
+
+    // 历史航程：按船只、日期汇总 trajectory_data 中相邻定位点的大圆距离（在数据库线程中调用）。
+    // vesselId < 0 表示全部船只；跨零点的航段计入后一天
+    QVector<DailyDistance> distancePerDay(const QDateTime& from, const QDateTime& to, int vesselId = -1);
+    // 供 QML 调用：排队到数据库线程执行，结果经 distancePerDayReady 返回
+    Q_INVOKABLE void requestDistancePerDay(const QDateTime& from, const QDateTime& to, int vesselId = -1);
+
+    // 轨迹空间查询（在数据库线程中调用）：经 R*Tree 索引筛选候选点，结果按时间顺序分块回调，
+    // 回调返回 false 时提前结束；返回结果总数
+    int queryTrajectory(const TrajectoryQuery& query, const std::function<bool(const QVector<TrajectoryFix>&)>& onChunk);
+    // 距给定点最近的轨迹点：搜索半径从 NEAREST_START_RADIUS_M 倍增至 maxRadius
+    bool nearestTrajectoryFix(double latitude, double longitude, double maxRadius, int vesselId, TrajectoryFix& out);
+    bool hasSpatialIndex() const { return m_spatialIndex; }
+
+    // 供 QML 调用：结果经 trajectoryChunk 分块返回，结束时发出 trajectoryQueryFinished
+    Q_INVOKABLE void requestTrajectoryInBox(int requestId, double minLat, double minLon, double maxLat, double maxLon,
+                                            const QDateTime& from = QDateTime(), const QDateTime& to = QDateTime(),
+                                            int vesselId = -1);
+    Q_INVOKABLE void requestTrajectoryAround(int requestId, double latitude, double longitude, double radius,
+                                             const QDateTime& from = QDateTime(), const QDateTime& to = QDateTime(),
+                                             int vesselId = -1);
+    Q_INVOKABLE void requestNearestFix(int requestId, double latitude, double longitude, double maxRadius, int vesselId = -1);
+
+    static constexpr int TRAJECTORY_CHUNK_SIZE = 1024;
+    static constexpr double NEAREST_START_RADIUS_M = 50.0;
+
+    // 传感器样本与轨迹的时空连接（在数据库线程中调用）：两张表按时间顺序各读一遍做归并，
+    // 每个传感器读数取同船前后两个定位点按时间线性插值。前后定位点间隔超过 MAX_INTERPOLATION_GAP_S 时
+    // 只在 MAX_SNAP_S 以内取最近的定位点，否则丢弃该样本（计入 unmatched）。结果分块回调，返回结果总数
+    int georeferencedSamples(const GeoSampleQuery& query, const std::function<bool(const QVector<GeoSample>&)>& onChunk,
+                             int* unmatched = nullptr);
+    // 供 QML 调用：minLat > maxLat 表示不限区域；结果经 geoSampleChunk 分块返回
+    Q_INVOKABLE void requestGeoreferencedSamples(int requestId, const QDateTime& from, const QDateTime& to,
+                                                 double minLat = 1.0, double minLon = 0.0,
+                                                 double maxLat = -1.0, double maxLon = 0.0, int vesselId = -1);
+
+    // 读取时间范围内的传感器序列（在数据库线程中调用），vesselId < 0 表示全部船只
+    bool sensorSeries(const QDateTime& from, const QDateTime& to, int vesselId, SensorSeries& out);
+    // 按 bucketSeconds 秒分桶汇总（在数据库线程中调用），桶按本地时间对齐
+    bool sensorBuckets(const QDateTime& from, const QDateTime& to, int bucketSeconds, int vesselId,
+                       SensorBuckets& out);
+
+    static constexpr double MAX_INTERPOLATION_GAP_S = 60.0;
+    static constexpr double MAX_SNAP_S = 5.0;
+
+public slots:
+    // 打开数据库并建表；可在工作线程中通过排队调用执行，结果经 initialized 信号返回
+    bool initialize();
+    // 在数据库所属线程中关闭连接，线程退出前调用
+    void shutdown();
+
+signals:
+    void initialized(bool ok);
+    // 每项为 {vesselId, day, distance(米), samples}
+    void distancePerDayReady(const QVariantList& days);
+    // 每项为 {id, vesselId, timestamp, latitude, longitude, distance}
+    void trajectoryChunk(int requestId, const QVariantList& fixes);
+    void trajectoryQueryFinished(int requestId, int count, double elapsedMs);
+    // 未找到时为空
+    void nearestFixReady(int requestId, const QVariantMap& fix);
+    // 每项为 {sensorId, vesselId, timestamp, latitude, longitude, 及各传感器字段}
+    void geoSampleChunk(int requestId, const QVariantList& samples);
+    void geoSampleQueryFinished(int requestId, int count, int unmatched, double elapsedMs);
 
 private:
+    // 旧库升级：为表补充 vessel_id 列（单船数据默认 0）
+    bool ensureVesselIdColumn(const QString& table);
+    // 建立 trajectory_data 的 R*Tree 空间索引，由触发器在插入、删除时维护；
+    // SQLite 未编译 R*Tree 模块时退化为全表扫描
+    void ensureTrajectorySpatialIndex();
+    void runTrajectoryRequest(int requestId, const TrajectoryQuery& query);
+    // 时空连接按时间顺序读取两张表所用的索引
+    bool ensureTimestampIndexes();
+
     QSqlDatabase db;
+    bool m_spatialIndex = false;
 };
 
 #endif // DATABASE_H
@@ -1,12 +1,20 @@
 #include "datasource.h"
+#include "metrics.h"
+#include "trace.h"
+#include "latency_tracer.h"
+#include "simulation_generator.h"
+#include "port_watcher.h"
+#include "command_scheduler.h"
+#include "control_loop.h"
+#include "mission_upload.h"
+#include "serial_replay.h"
+#include "frame_codec.h"
 #include <QDebug>
-#include <QRandomGenerator>
 #include <QDataStream>
-#include <QSerialPortInfo>
 #include <QDateTime>
 #include <QElapsedTimer>
-#include <sstream>
-#include <iomanip>
+#include <QtEndian>
+#include <QVector>
 #include <cmath>
 
 using namespace FrameConstants;
@@ -20,40 +28,75 @@ DataSource::DataSource(QObject *parent)
     , m_isSimulating(false)
     , m_mergedFrameHeader(QString("%1").arg(FRAME_HEADER, 2, 16, QChar('0')).toUpper())
     , m_mergedFrameTrailer(QString("%1").arg(FRAME_TRAILER, 2, 16, QChar('0')).toUpper())
-    , serialPort(new QSerialPort(this))
-    , portUpdateTimer(new QTimer(this))
-    , simulationTimer(new QTimer(this))
+    , serialThread(new QThread(this))
+    , serialPort(new QSerialPort)
+    , portWatcherThread(new QThread(this))
+    , portWatcher(new PortWatcher)
+    , commandScheduler(new CommandScheduler(serialPort))
+    , controlLoop(new ControlLoop(commandScheduler, this))
+    , missionUploader(new MissionUploader(commandScheduler, this))
+    , simulationThread(new QThread(this))
+    , simulationGenerator(new SimulationGenerator)
+    , serialReplay(new SerialReplay(this))
 {
-    // 连接串口信号
-    connect(serialPort, &QSerialPort::readyRead, this, &DataSource::readSerialData);
-    connect(serialPort, &QSerialPort::errorOccurred, this, &DataSource::handleSerialError);
-
-    // 连接定时器信号
-    connect(portUpdateTimer, &QTimer::timeout, this, &DataSource::checkAvailablePorts);
-    connect(simulationTimer, &QTimer::timeout, this, &DataSource::generateFakeData);
-
-    // 启动端口更新定时器
-    portUpdateTimer->start(2000);
-
-    // 设置模拟数据定时器间隔
-    simulationTimer->setInterval(500);
-
-    // 初始化模拟数据计时器
-    m_simulationElapsedTimer.start();
-
-    // 初始化模拟位置（上海）
-    m_simulatedLatitude = 31.230416;
-    m_simulatedLongitude = 121.473701;
-
-    // 立即检查可用端口
-    checkAvailablePorts();
+    // 串口与下行调度器在独立 I/O 线程中运行：写出、bytesWritten 确认与控制心跳都不受界面线程负载影响。
+    // 读到的字节块在读取入口记录单调接收时间，连同数据排队回到本线程进行帧切分
+    serialThread->setObjectName("SerialIoThread");
+    serialPort->moveToThread(serialThread);
+    commandScheduler->moveToThread(serialThread);
+    connect(serialThread, &QThread::finished, commandScheduler, &QObject::deleteLater);
+    connect(serialThread, &QThread::finished, serialPort, &QObject::deleteLater);
+    connect(serialPort, &QSerialPort::readyRead, serialPort, [this]() {
+        const qint64 receiveNs = MetricsClock::nowNs();
+        const QByteArray data = serialPort->readAll();
+        QMetaObject::invokeMethod(this, [this, data, receiveNs]() { handleSerialData(data, receiveNs); },
+                                  Qt::QueuedConnection);
+    });
+    connect(serialPort, &QSerialPort::errorOccurred, serialPort, [this](QSerialPort::SerialPortError serialError) {
+        if (serialError == QSerialPort::NoError) return;
+        const QString message = serialPort->errorString();
+        QMetaObject::invokeMethod(this, [this, serialError, message]() { handleSerialError(serialError, message); },
+                                  Qt::QueuedConnection);
+    });
+    serialThread->start();
+
+    // 串口发现在独立线程中由热插拔事件驱动，初始枚举结果异步返回，不阻塞启动
+    portWatcherThread->setObjectName("PortWatcherThread");
+    portWatcher->moveToThread(portWatcherThread);
+    connect(portWatcherThread, &QThread::started, portWatcher, &PortWatcher::start);
+    connect(portWatcherThread, &QThread::finished, portWatcher, &QObject::deleteLater);
+    connect(portWatcher, &PortWatcher::portsChanged, this, &DataSource::updateAvailablePorts);
+    portWatcherThread->start();
+
+    // 模拟数据在独立线程中生成，字节块排队回到本线程进行帧切分
+    simulationThread->setObjectName("SimulationThread");
+    simulationGenerator->moveToThread(simulationThread);
+    connect(simulationThread, &QThread::finished, simulationGenerator, &QObject::deleteLater);
+    connect(simulationGenerator, &SimulationGenerator::chunkReady, this, &DataSource::onSimulatedChunk);
+    simulationThread->start();
+
+    // 回放的字节块与串口数据走同一条帧切分路径
+    connect(serialReplay, &SerialReplay::chunkReady, this, [this](const QByteArray& chunk, qint64 receiveNs) {
+        MetricsRegistry::instance().serialBytes->add(chunk.size());
+        processReceivedData(chunk, receiveNs);
+    });
+    connect(serialReplay, &SerialReplay::replayFinished, this, &DataSource::replayFinished);
 }
 
 DataSource::~DataSource()
 {
-    if (serialPort->isOpen()) {
-        serialPort->close();
+    // 先停控制心跳，再在 I/O 线程中关闭串口
+    if (m_portOpen) {
+        controlLoop->detach();
+        QMetaObject::invokeMethod(serialPort, [this]() { serialPort->close(); }, Qt::BlockingQueuedConnection);
     }
+    serialThread->quit();
+    serialThread->wait();
+    simulationThread->quit();
+    simulationThread->wait();
+    QMetaObject::invokeMethod(portWatcher, &PortWatcher::stop, Qt::BlockingQueuedConnection);
+    portWatcherThread->quit();
+    portWatcherThread->wait();
 }
 
 QByteArray DataSource::parseHexString(const QString& hexStr)
@@ -93,34 +136,49 @@ int DataSource::calculateFrameSize(const QByteArray& data)
 
 bool DataSource::openSerialPort(const QString& portName, int baudRate)
 {
-    if (serialPort->isOpen()) {
-        serialPort->close();
-    }
-
-    serialPort->setPortName(portName);
-    serialPort->setBaudRate(baudRate);
-    serialPort->setDataBits(QSerialPort::Data8);
-    serialPort->setParity(QSerialPort::NoParity);
-    serialPort->setStopBits(QSerialPort::OneStop);
-    serialPort->setFlowControl(QSerialPort::NoFlowControl);
+    closeSerialPort();
 
     qDebug() << "尝试打开串口:" << portName << "波特率:" << baudRate;
 
-    if (serialPort->open(QIODevice::ReadWrite)) {
+    // 串口属于 I/O 线程，在该线程中配置并打开，这里等待结果
+    bool opened = false;
+    QString errorString;
+    QMetaObject::invokeMethod(serialPort, [&]() {
+        serialPort->setPortName(portName);
+        serialPort->setBaudRate(baudRate);
+        serialPort->setDataBits(QSerialPort::Data8);
+        serialPort->setParity(QSerialPort::NoParity);
+        serialPort->setStopBits(QSerialPort::OneStop);
+        serialPort->setFlowControl(QSerialPort::NoFlowControl);
+        opened = serialPort->open(QIODevice::ReadWrite);
+        if (!opened) errorString = serialPort->errorString();
+    }, Qt::BlockingQueuedConnection);
+
+    if (opened) {
+        m_portOpen = true;
         qDebug() << "串口已打开:" << portName;
+        controlLoop->setState(controlState());
+        controlLoop->attach();
+        missionUploader->setLinkBaudRate(baudRate);
         emit portOpenChanged();
         return true;
     } else {
-        qDebug() << "串口打开失败:" << serialPort->errorString();
-        emit error(serialPort->errorString());
+        qDebug() << "串口打开失败:" << errorString;
+        emit error(errorString);
         return false;
     }
 }
 
 void DataSource::closeSerialPort()
 {
-    if (serialPort->isOpen()) {
-        serialPort->close();
+    if (m_portOpen) {
+        m_portOpen = false;
+        controlLoop->detach();
+        missionUploader->cancel();
+        QMetaObject::invokeMethod(serialPort, [this]() {
+            commandScheduler->clear("串口已关闭");
+            serialPort->close();
+        }, Qt::BlockingQueuedConnection);
         qDebug() << "串口已关闭";
         emit portOpenChanged();
     }
@@ -133,12 +191,9 @@ void DataSource::setIsSimulating(bool enabled)
     m_isSimulating = enabled;
 
     if (enabled) {
-        // 重置模拟数据开始时间
-        m_simulationElapsedTimer.restart();
-        simulationTimer->start();
-        qDebug() << "模拟开始";
+        startSimulationGenerator();
     } else {
-        simulationTimer->stop();
+        QMetaObject::invokeMethod(simulationGenerator, &SimulationGenerator::stop);
         qDebug() << "模拟停止";
     }
 
@@ -172,55 +227,81 @@ bool DataSource::isValidGpsCoordinate(double lat, double lon) const
     return (lat >= -90.0 && lat <= 90.0) && (lon >= -180.0 && lon <= 180.0);
 }
 
-void DataSource::processReceivedData(const QByteArray& data)
+void DataSource::processReceivedData(const QByteArray& data, qint64 receiveNs)
 {
-    buffer.append(data);
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    LatencyTracer& latency = LatencyTracer::instance();
+    MetricScopeTimer framingTimer(metrics.framingLatency);
 
-    // 保持缓冲区至少2字节用于检查帧头帧尾
-    while (buffer.size() >= 2) {
-        // 检查帧头帧尾
-        uint8_t header = static_cast<uint8_t>(buffer[0] & 0xFF);
-        uint8_t trailer = static_cast<uint8_t>(buffer[1] & 0xFF);
+    const FrameDecoder::Stats before = frameDecoder.stats();
 
-        if (header != FRAME_HEADER || trailer != FRAME_TRAILER) {
-            buffer.remove(0, 1); // 移除一个字节并重新检查
-            continue;
-        }
-
-        // 检查是否有足够的数据形成完整的帧
-        if (buffer.size() < RECEIVE_FRAME_SIZE) {
-            // 数据不足，等待更多数据
-            qDebug() << "数据不足，等待更多数据. 当前:" << buffer.size() << "字节，需要:" << RECEIVE_FRAME_SIZE;
-            break;
-        }
-
-        // 提取完整帧
-        QByteArray frame = buffer.left(RECEIVE_FRAME_SIZE);
-        qDebug() << "收到完整数据帧: " << frame.toHex().toUpper();
+    auto onAck = [this](const char* frame) {
+        // 船端任务分块确认
+        missionUploader->handleAck(frame);
+    };
+    frameDecoder.feed(data.constData(), data.size(), receiveNs, [&](const char* frame, qint64 frameReceiveNs) {
+        // 提取完整帧；跨读取块的帧从首字节的接收时间开始计时
+        latency.beginFrame(frameReceiveNs);
+        USV_TRACE1(Trace::Category::Framing, Trace::Level::Debug, "framing.frame", frameDecoder.buffered());
 
         // 提取关键数据段 - 包含所有传感器、船只和设备数据
-        QByteArray mergedData = frame.mid(SENSOR_DATA_OFFSET, 47);
+        QByteArray mergedData = QByteArray::fromRawData(frame + SENSOR_DATA_OFFSET, 47);
         QString hexData = mergedData.toHex().toUpper();
 
         // 发送合并数据信号
+        metrics.framesDecoded->add();
+        metrics.uiPublished->add();
+        latency.mark(LatencyTracer::Decode);
         emit mergedDataReceived(hexData);
+        latency.mark(LatencyTracer::Publish);
+        latency.endFrame();
+    }, onAck);
+
+    const FrameDecoder::Stats& after = frameDecoder.stats();
+    if (after.droppedFrames != before.droppedFrames) {
+        metrics.droppedFrameCount->add(after.droppedFrames - before.droppedFrames);
+        metrics.resyncBytes->add(after.resyncBytes - before.resyncBytes);
+        USV_TRACE2(Trace::Category::Framing, Trace::Level::Info, "framing.resync",
+                   after.resyncBytes - before.resyncBytes, frameDecoder.buffered());
+    } else if (after.resyncBytes != before.resyncBytes) {
+        metrics.resyncBytes->add(after.resyncBytes - before.resyncBytes);
+    }
+    if (frameDecoder.buffered() > 0) {
+        // 数据不足，等待更多数据
+        USV_TRACE2(Trace::Category::Framing, Trace::Level::Debug, "framing.partial", frameDecoder.buffered(), RECEIVE_FRAME_SIZE);
+    }
+
+    metrics.rxBuffer->set(frameDecoder.buffered());
+}
+
+void DataSource::handleSerialData(const QByteArray& data, qint64 receiveNs)
+{
+    // receiveNs 在 I/O 线程的读取入口记录，随帧贯穿后续各阶段
+    MetricsRegistry::instance().serialBytes->add(data.size());
+    USV_TRACE1(Trace::Category::Serial, Trace::Level::Debug, "serial.read", data.size());
+    serialReplay->capture(data, receiveNs);
+    processReceivedData(data, receiveNs);
+}
 
-        // 移除已处理的帧
-        buffer.remove(0, RECEIVE_FRAME_SIZE);
+bool DataSource::setCaptureFile(const QString& path)
+{
+    if (path.isEmpty()) {
+        serialReplay->stopCapture();
+        return true;
     }
+    return serialReplay->startCapture(path);
 }
 
-void DataSource::readSerialData()
+bool DataSource::startReplay(const QString& path, double speed)
 {
-    QByteArray data = serialPort->readAll();
-    qDebug() << "读取到串口数据:" << data.toHex().toUpper();
-    processReceivedData(data);
+    return serialReplay->startReplay(path, speed);
 }
 
 void DataSource::setPumpState(bool state)
 {
     if (m_pumpState != state) {
         m_pumpState = state;
+        sendControlState();
         emit pumpStateChanged();
         qDebug() << "水泵状态：" << (state ? "开启" : "关闭");
     }
@@ -237,6 +318,8 @@ void DataSource::setMotor1(quint16 value)
 
     if (m_motor1 != value) {
         m_motor1 = value;
+        syncSimulationMotors();
+        sendControlState();
         emit motor1Changed();
     }
 }
@@ -252,6 +335,8 @@ void DataSource::setMotor2(quint16 value)
 
     if (m_motor2 != value) {
         m_motor2 = value;
+        syncSimulationMotors();
+        sendControlState();
         emit motor2Changed();
     }
 }
@@ -259,168 +344,160 @@ void DataSource::setMotor2(quint16 value)
 void DataSource::updatePumpModeInDataSource(bool mode){
     if(m_pump_mode!=mode){
     m_pump_mode=mode;
+    sendControlState();
     emit pump_modeChanged();
     }
 }
 void DataSource::updateBoatModeInDataSource(bool mode){
     if(m_boat_mode!=mode){
         m_boat_mode=mode;
+        sendControlState();
         emit boat_modeChanged();
     }
 }
 
 void DataSource::sendData(const std::vector<QString>& taskPointsData)
 {
-    if (!serialPort->isOpen()) {
-        qDebug() << "串口未打开，无法发送数据";
-        emit error("串口未打开，无法发送数据");
+    // 检查任务点数据
+    if (taskPointsData.empty()) {
+        emit error("任务点数据为空");
         return;
     }
 
-    try {
-        // 检查任务点数据
-        if (taskPointsData.empty()) {
-            emit error("任务点数据为空");
-            return;
-        }
+    // 处理时间戳（Home点数据第三项，本地时间）
+    const QStringList homeFields = taskPointsData[0].split(",");
+    if (homeFields.size() < 3) {
+        emit error("Home点数据格式不正确");
+        return;
+    }
+    const QDateTime homeTime = QDateTime::fromString(homeFields[2].trimmed(), "yyyy-MM-dd HH:mm:ss");
+    if (!homeTime.isValid()) {
+        emit error("时间戳解析失败");
+        return;
+    }
 
-        // 创建数据包
-        QByteArray data;
-        // 设置帧头帧尾
-        int minSize =FRAME_HEADER_SIZE+TIMESTAMP_LENGTH+HOME_POINT_SIZE+7;
-        data.resize(minSize);
-        data[0] = FRAME_HEADER;
-        data[1] = FRAME_TRAILER;
-
-        // 处理时间戳
-        QString firstData = taskPointsData[0];
-        QStringList list = firstData.split(",");
-        if (list.size() < 3) {
-            emit error("Home点数据格式不正确");
-            return;
+    QVector<MissionPoint> points;
+    points.reserve(static_cast<int>(taskPointsData.size()));
+    for (size_t i = 0; i < taskPointsData.size(); ++i) {
+        const QStringList parts = taskPointsData[i].split(",");
+        if (parts.size() < 2) {
+            qWarning() << "任务点数据格式不正确: " << taskPointsData[i];
+            continue;
         }
 
-        // 解析时间戳
-        std::string timestampStr = list[2].toStdString();
-        std::tm tm = {};
-        std::istringstream ss(timestampStr);
-        ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-        if (ss.fail()) {
-            emit error("时间戳解析失败");
-            return;
-        }
-        std::time_t time = std::mktime(&tm);
-        qint64 sec = static_cast<qint64>(time);
-
-        // 写入时间戳(8字节, 偏移 2-9): uint64 类型
-        QDataStream timeStream(&data, QIODevice::WriteOnly);
-        timeStream.setByteOrder(QDataStream::LittleEndian);
-        timeStream.device()->seek(FRAME_HEADER_SIZE);
-        timeStream << sec;
-
-        // 处理Home点和任务点数据
-        int taskIndex = 0;
-        for (const auto& dataStr : taskPointsData) {
-            //根据任务点个数扩充data数组大小
-            int taskCount=taskPointsData.size();
-            int ValidTaskCount=taskCount>(MAX_TASK_POINTS+1) ? (MAX_TASK_POINTS+1):taskCount;
-            int totalSize=minSize+(ValidTaskCount-1)*TASK_POINT_SIZE;
-            data.resize(totalSize);
-
-            if (taskIndex > MAX_TASK_POINTS) {
-                qDebug() << "任务点数量超出限制，只处理前" << MAX_TASK_POINTS + 1 << "个点";
-                break;
+        // 解析经纬度
+        bool ok1 = false, ok2 = false;
+        const double longitude = parts[0].toDouble(&ok1);
+        const double latitude = parts[1].toDouble(&ok2);
+        if (!ok1 || !ok2 || !isValidGpsCoordinate(latitude, longitude)) {
+            qWarning() << "无效的经纬度: " << longitude << "," << latitude;
+            if (i == 0) {
+                emit error("Home点经纬度无效");
+                return;
             }
+            continue;
+        }
+        points.append({longitude, latitude});
+    }
 
-            QStringList parts = dataStr.split(",");
-            if (parts.size() < 2) {
-                qWarning() << "任务点数据格式不正确: " << dataStr;
-                continue;
-            }
-
-            // 解析经纬度
-            bool ok1 = false, ok2 = false;
-            double longitude = parts[0].toDouble(&ok1);
-            double latitude = parts[1].toDouble(&ok2);
-
-            if (!ok1 || !ok2 || !isValidGpsCoordinate(latitude, longitude)) {
-                qWarning() << "无效的经纬度: " << longitude << "," << latitude;
-                continue;
-            }
-
-            // 计算数据存储位置
-            int pointOffset;
-            if (taskIndex == 0) {
-                // Home点
-                pointOffset = FRAME_HEADER_SIZE+TIMESTAMP_LENGTH;
-            } else {
-                // 任务点 (索引从0开始)
-                pointOffset =FRAME_HEADER_SIZE+TIMESTAMP_LENGTH+HOME_POINT_SIZE+ (taskIndex - 1) * TASK_POINT_SIZE;
-            }
-            // 写入经度
-            int lonInt = static_cast<int>(longitude);
-            data[pointOffset] = static_cast<char>(lonInt);
-
-            float lonDecimal = longitude - lonInt;
-            memcpy(data.data() + pointOffset + 1, &lonDecimal, 4);
-
-            // 写入纬度
-            int latInt = static_cast<int>(latitude);
-            data[pointOffset + 5] = static_cast<char>(latInt);
+    sendMission(homeTime.toSecsSinceEpoch(), points);
+}
 
-            float latDecimal = latitude - latInt;
-            memcpy(data.data() + pointOffset + 6, &latDecimal, 4);
+bool DataSource::sendMission(qint64 timestampSecs, const QVector<MissionPoint>& points)
+{
+    if (!m_portOpen) {
+        qDebug() << "串口未打开，无法发送数据";
+        emit error("串口未打开，无法发送数据");
+        return false;
+    }
+    if (points.isEmpty()) {
+        emit error("任务点数据为空");
+        return false;
+    }
 
-            taskIndex++;
+    // 分块上传不受单帧点数限制
+    if (m_chunkedMissionUpload) {
+        if (missionUploader->isBusy()) {
+            emit error("任务上传正在进行中");
+            return false;
         }
+        if (!missionUploader->start(timestampSecs, points, controlState())) {
+            emit error("任务航点数量超出分块上传上限");
+            return false;
+        }
+        return true;
+    }
 
-    //处理控制指令块
+    int pointCount = points.size();
+    if (pointCount > MAX_TASK_POINTS + 1) {
+        qDebug() << "任务点数量超出限制，只处理前" << MAX_TASK_POINTS + 1 << "个点";
+        pointCount = MAX_TASK_POINTS + 1;
+    }
 
-        //水泵模式 ( pump_mode , 1字节): 0 = 手动，1 = 自动。
-        qDebug()<<"水泵模式："<<m_pump_mode;
-        data[FRAME_HEADER_SIZE+TIMESTAMP_LENGTH+HOME_POINT_SIZE+(taskIndex-1)*TASK_POINT_SIZE] = m_pump_mode ? 1 : 0;
+    // 帧头(2) + 时间戳(8) + Home点(10) + 任务点(10*N) + 控制指令块(7) + 保留区(14)
+    const int controlOffset = FRAME_HEADER_SIZE + TIMESTAMP_LENGTH + HOME_POINT_SIZE + (pointCount - 1) * TASK_POINT_SIZE;
+    QByteArray data(controlOffset + CONTROL_BLOCK_SIZE + RESERVED_SIZE, '\0');
+    char* out = data.data();
+    out[0] = static_cast<char>(FRAME_HEADER);
+    out[1] = static_cast<char>(FRAME_TRAILER);
 
-        //水泵控制 ( m_pumpState , 1字节): 在手动模式下有效，0 = 关闭，1 = 开启。
-        data[FRAME_HEADER_SIZE+TIMESTAMP_LENGTH+HOME_POINT_SIZE+(taskIndex-1)*TASK_POINT_SIZE+1] = m_pumpState ? 1 : 0;
+    // 写入时间戳(8字节, 偏移 2-9): 小端 int64
+    qToLittleEndian<qint64>(timestampSecs, out + FRAME_HEADER_SIZE);
 
-        //艇模式 ( usv_mode , 1字节): 0 = 手动，1 = 自动，2 = 位置保持
-        qDebug()<<"艇模式："<<m_boat_mode;
-        data[FRAME_HEADER_SIZE+TIMESTAMP_LENGTH+HOME_POINT_SIZE+(taskIndex-1)*TASK_POINT_SIZE+2]=m_boat_mode;
+    // Home点与任务点：经度、纬度各 1 字节整数 + 4 字节 float 小数
+    for (int i = 0; i < pointCount; ++i) {
+        encodeCoordinatePair(out + FRAME_HEADER_SIZE + TIMESTAMP_LENGTH + i * TASK_POINT_SIZE,
+                             points[i].longitude, points[i].latitude);
+    }
 
-        //艇控制 ( usv_ctrl , 4字节):
-        QDataStream motorStream(&data, QIODevice::WriteOnly);
-        motorStream.setByteOrder(QDataStream::LittleEndian);
-        motorStream.device()->seek(FRAME_HEADER_SIZE+TIMESTAMP_LENGTH+HOME_POINT_SIZE+(taskIndex-1)*TASK_POINT_SIZE+3);
-        motorStream << m_motor1;
-        motorStream << m_motor2;
+    // 控制指令块：水泵模式、水泵控制、艇模式、电机1、电机2；保留区保持为 0
+    encodeControlBlock(out + controlOffset, controlState());
 
-    //处理保留区(14字节): 暂时未使用，填充 0。
-        data.resize(data.size()+RESERVED_SIZE);
-        std::fill(data.end()-RESERVED_SIZE,data.end(),0);
+    commandScheduler->enqueue(CommandScheduler::Mission, data, "mission");
+    qDebug() << "任务数据已入队，大小:" << data.size() << "字节，任务点:" << pointCount - 1;
+    return true;
+}
 
-        // 发送数据
-        qint64 bytesWritten = serialPort->write(data);
-        if (bytesWritten != data.size()) {
-            emit error("数据发送不完整");
-            return;
-        }
+void DataSource::setChunkedMissionUpload(bool enabled)
+{
+    if (m_chunkedMissionUpload == enabled) return;
+    m_chunkedMissionUpload = enabled;
+    // 只有船端支持分块确认时才把 0xFA 0xFB 识别为确认帧
+    frameDecoder.setAckFramesEnabled(enabled);
+    emit chunkedMissionUploadChanged();
+}
 
-        qDebug() << "发送数据成功，大小: " << bytesWritten << "字节";
+ControlState DataSource::controlState() const
+{
+    ControlState state;
+    state.pumpMode = m_pump_mode;
+    state.pumpState = m_pumpState;
+    state.boatMode = m_boat_mode ? 1 : 0;
+    state.motor1 = m_motor1;
+    state.motor2 = m_motor2;
+    return state;
+}
 
-    } catch (const std::exception& e) {
-        QString errorMsg = QString("发送数据出错: %1").arg(e.what());
-        qDebug() << errorMsg;
-        emit error(errorMsg);
-    }
+void DataSource::sendControlState()
+{
+    // 控制心跳从这里读取最新状态；变化本身也立即入队，不等下一个节拍
+    controlLoop->setState(controlState());
+    if (!m_portOpen) return;
+
+    // 控制帧统一走最高优先级并与心跳帧按同一合并键合并，尚未写出的旧状态直接被覆盖
+    char frame[CONTROL_FRAME_SIZE];
+    const int size = encodeControlFrame(frame, controlState());
+    commandScheduler->enqueue(CommandScheduler::Control, frame, size, "control",
+                              CommandScheduler::ControlStateKey);
 }
 
-void DataSource::handleSerialError(QSerialPort::SerialPortError error)
+void DataSource::handleSerialError(QSerialPort::SerialPortError error, const QString& message)
 {
     if (error == QSerialPort::NoError) {
         return;
     }
 
-    QString errorMessage = QString("串口错误: %1").arg(serialPort->errorString());
+    QString errorMessage = QString("串口错误: %1").arg(message);
     emit this->error(errorMessage);
     qDebug() << errorMessage;
 
@@ -429,324 +506,73 @@ void DataSource::handleSerialError(QSerialPort::SerialPortError error)
     }
 }
 
-void DataSource::checkAvailablePorts()
+void DataSource::updateAvailablePorts(const QStringList& ports)
 {
-    QStringList currentPorts = m_availablePorts;
-    QStringList newPorts;
-
-    const auto infos = QSerialPortInfo::availablePorts();
-    for (const QSerialPortInfo &info : infos) {
-        newPorts << info.portName();
-    }
-
-    if (newPorts != currentPorts) {
-        m_availablePorts = newPorts;
+    if (ports != m_availablePorts) {
+        m_availablePorts = ports;
         emit availablePortsChanged();
         qDebug() << "可用端口已更新:" << m_availablePorts;
     }
 }
 
-QByteArray DataSource::generateMergedFrame()
-{
-    QByteArray frame;
-    frame.resize(RECEIVE_FRAME_SIZE);
-    frame.fill(0);
-
-    // 设置帧头帧尾
-    frame[0] = FRAME_HEADER;
-    frame[1] = FRAME_TRAILER;
-
-    // 生成传感器数据
-    SensorData sensorData = generateFakeSensorData();
-
-    // 添加PWM值（电机值）
-    uint16_t pwm1 = m_motor1;
-    uint16_t pwm2 = m_motor2;
-
-    // 转为字节数组，小端序
-    frame[SENSOR_DATA_OFFSET] = pwm1 & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 1] = (pwm1 >> 8) & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 2] = pwm2 & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 3] = (pwm2 >> 8) & 0xFF;
-
-    // 添加CO2数据 (2字节, 小端序)
-    uint16_t co2 = sensorData.CO2;
-    frame[SENSOR_DATA_OFFSET + 4] = co2 & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 5] = (co2 >> 8) & 0xFF;
-
-    // 添加甲醛数据 (2字节, 小端序)
-    uint16_t ch2o = sensorData.CH2O;
-    frame[SENSOR_DATA_OFFSET + 6] = ch2o & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 7] = (ch2o >> 8) & 0xFF;
-
-    // 添加TVOC数据 (2字节, 小端序)
-    uint16_t tvoc = sensorData.TVOC;
-    frame[SENSOR_DATA_OFFSET + 8] = tvoc & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 9] = (tvoc >> 8) & 0xFF;
-
-    // 添加PM2.5数据 (2字节, 小端序)
-    uint16_t pm25 = sensorData.PM2_5;
-    frame[SENSOR_DATA_OFFSET + 10] = pm25 & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 11] = (pm25 >> 8) & 0xFF;
-
-    // 添加PM10数据 (2字节, 小端序)
-    uint16_t pm10 = sensorData.PM10;
-    frame[SENSOR_DATA_OFFSET + 12] = pm10 & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 13] = (pm10 >> 8) & 0xFF;
-
-    // 添加空气温度 (2字节分别表示整数和小数部分)
-    frame[SENSOR_DATA_OFFSET + 14] = sensorData.temperature_air_High;
-    frame[SENSOR_DATA_OFFSET + 15] = sensorData.temperature_air_Low;
-
-    // 添加空气湿度 (2字节分别表示整数和小数部分)
-    frame[SENSOR_DATA_OFFSET + 16] = sensorData.humidity_air_High;
-    frame[SENSOR_DATA_OFFSET + 17] = sensorData.humidity_air_Low;
-
-    // 添加浊度 (2字节, 小端序)
-    uint16_t turbidity = sensorData.turbidity;
-    frame[SENSOR_DATA_OFFSET + 18] = turbidity & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 19] = (turbidity >> 8) & 0xFF;
-
-    // 添加pH值 (2字节, 小端序，实际值×100)
-    uint16_t ph = sensorData.PH;
-    frame[SENSOR_DATA_OFFSET + 20] = ph & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 21] = (ph >> 8) & 0xFF;
-
-    // 添加TDS (2字节, 小端序)
-    uint16_t tds = sensorData.TDS;
-    frame[SENSOR_DATA_OFFSET + 22] = tds & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 23] = (tds >> 8) & 0xFF;
-
-    // 添加水温 (2字节分别表示整数和小数部分)
-    frame[SENSOR_DATA_OFFSET + 24] = sensorData.temperaturewater_High;
-    frame[SENSOR_DATA_OFFSET + 25] = sensorData.temperaturewater_Low;
-
-    // 添加液位 (2字节, 小端序)
-    int16_t level = sensorData.dis;
-    frame[SENSOR_DATA_OFFSET + 26] = level & 0xFF;
-    frame[SENSOR_DATA_OFFSET + 27] = (level >> 8) & 0xFF;
-
-    // 生成船只数据
-    BoatData boatData = generateFakeBoatData();
-
-    // 写入纬度数据 (5字节格式: 1字节整数部分 + 4字节小数部分)
-    int latInt = static_cast<int>(boatData.latitude);
-    float latDecimal = boatData.latitude - latInt;
-    frame[LAT_OFFSET] = static_cast<char>(latInt);
-    memcpy(frame.data() + LAT_OFFSET + 1, &latDecimal, 4);
-
-    // 写入经度数据 (5字节格式: 1字节整数部分 + 4字节小数部分)
-    int lonInt = static_cast<int>(boatData.longitude);
-    float lonDecimal = boatData.longitude - lonInt;
-    frame[LON_OFFSET] = static_cast<char>(lonInt);
-    memcpy(frame.data() + LON_OFFSET + 1, &lonDecimal, 4);
-
-    // 写入航向角 (2字节: 1字节整数+符号, 1字节小数部分)
-    int headingInt = static_cast<int>(boatData.heading);
-    uint8_t headingDec = static_cast<uint8_t>((std::abs(boatData.heading) - std::abs(headingInt)) * 100);
-    frame[HEADING_OFFSET] = static_cast<char>(headingInt);
-    frame[HEADING_OFFSET + 1] = headingDec;
-
-    // 写入速度 (2字节: 1字节整数, 1字节小数)
-    uint8_t speedInt = static_cast<uint8_t>(boatData.speed);
-    uint8_t speedDec = static_cast<uint8_t>((boatData.speed - speedInt) * 100);
-    frame[SPEED_OFFSET] = speedInt;
-    frame[SPEED_OFFSET + 1] = speedDec;
-
-    // 生成设备数据
-    DeviceData deviceData = generateFakeDeviceData();
-
-    // 写入电池电量 (2字节, 小端序)
-    uint16_t battery = deviceData.battery;
-    frame[BATTERY_OFFSET] = battery & 0xFF;
-    frame[BATTERY_OFFSET + 1] = (battery >> 8) & 0xFF;
-
-    // 写入模式 (1字节)
-    frame[MODE_OFFSET] = deviceData.mode ? 1 : 0;
-
-    return frame;
-}
-
-void DataSource::generateFakeData()
-{
-    QByteArray fakeFrame = generateMergedFrame();
-
-    if (fakeFrame.size() == RECEIVE_FRAME_SIZE) {
-        // 重要修改：使用完整字节范围，而不是只取部分
-        QByteArray content = fakeFrame.mid(SENSOR_DATA_OFFSET, MODE_OFFSET + 1 - SENSOR_DATA_OFFSET);
-        QString hexData = content.toHex().toUpper();
-
-        // 调试信息 - 显示模拟数据内容和长度
-        qDebug() << "生成模拟数据帧: " << hexData.left(40) << "... 长度:" << hexData.length();
-
-        // 发送合并数据信号，传递完整数据
-        emit mergedDataReceived(hexData);
-    } else {
-        qDebug() << "生成模拟数据帧失败，大小:" << fakeFrame.size() << " 应为:" << RECEIVE_FRAME_SIZE;
-    }
-
-    // 更新模拟位置
-    updateSimulatedPosition();
+void DataSource::onSimulatedChunk(const QByteArray& chunk, qint64 receiveNs)
+{
+    // 模拟字节流与串口数据走同一条帧切分路径
+    if (!m_isSimulating) return;
+    MetricsRegistry::instance().serialBytes->add(chunk.size());
+    processReceivedData(chunk, receiveNs);
 }
 
-DataSource::SensorData DataSource::generateFakeSensorData()
+void DataSource::setSimulationRate(double rateHz)
 {
-    SensorData data;
-    auto rng = QRandomGenerator::global();
-
-    using namespace SensorLimits;
-
-    // 模拟PWM值 (当前电机值)
-    data.PWM_SET1 = m_motor1;
-    data.PWM_SET2 = m_motor2;
-
-    // CO2: 400-2000 ppm 范围内合理波动
-    data.CO2 = rng->bounded(CO2_MIN, CO2_MAX);
-
-    // 甲醛: 0.01-0.15 mg/m³ (以整数表示，单位0.001 mg/m³)
-    data.CH2O = static_cast<uint16_t>(rng->bounded(
-        static_cast<int>(CH2O_MIN * 1000),
-        static_cast<int>(CH2O_MAX * 1000)
-        ));
-
-    // TVOC: 50-1000 ppb
-    data.TVOC = rng->bounded(TVOC_MIN, TVOC_MAX);
-
-    // PM2.5: 0-250 μg/m³
-    data.PM2_5 = rng->bounded(PM25_MIN, PM25_MAX);
-
-    // PM10: 0-350 μg/m³
-    data.PM10 = rng->bounded(PM10_MIN, PM10_MAX);
-
-    // 空气温度: 5-40°C (带有周期性波动)
-    double airTemp = AIR_TEMP_MIN + (AIR_TEMP_MAX - AIR_TEMP_MIN) * 0.5 +
-                     sin(m_simulationElapsedTimer.elapsed() / 10000.0) * 5.0 +
-                     rng->bounded(-100, 101) / 100.0; // 修复: 整数转换为浮点数
-    data.temperature_air_High = static_cast<uint8_t>(airTemp);
-    data.temperature_air_Low = static_cast<uint8_t>((airTemp - static_cast<int>(airTemp)) * 100);
-
-    // 空气湿度: 20-90% (带有周期性波动)
-    double humidity = HUMIDITY_MIN + (HUMIDITY_MAX - HUMIDITY_MIN) * 0.5 +
-                      sin(m_simulationElapsedTimer.elapsed() / 15000.0) * 15.0 +
-                      rng->bounded(-200, 201) / 100.0; // 修复: 整数转换为浮点数
-    humidity = qBound(HUMIDITY_MIN, humidity, HUMIDITY_MAX);
-    data.humidity_air_High = static_cast<uint8_t>(humidity);
-    data.humidity_air_Low = static_cast<uint8_t>((humidity - static_cast<int>(humidity)) * 100);
-
-    // 浊度: 0-25 NTU
-    data.turbidity = rng->bounded(TURBIDITY_MIN, TURBIDITY_MAX);
-
-    // pH值: 5.0-10.0 (整数部分*100)
-    double ph = PH_MIN + rng->bounded(static_cast<int>((PH_MAX - PH_MIN) * 100)) / 100.0;
-    data.PH = static_cast<uint16_t>(ph * 100);
-
-    // TDS: 50-1500 ppm
-    data.TDS = rng->bounded(TDS_MIN, TDS_MAX);
-
-    // 水温: 5-35°C (带有周期性波动)
-    double waterTemp = WATER_TEMP_MIN + (WATER_TEMP_MAX - WATER_TEMP_MIN) * 0.5 +
-                       sin(m_simulationElapsedTimer.elapsed() / 20000.0) * 4.0 +
-                       rng->bounded(-50, 51) / 100.0; // 修复: 整数转换为浮点数
-    data.temperaturewater_High = static_cast<uint8_t>(waterTemp);
-    data.temperaturewater_Low = static_cast<uint8_t>((waterTemp - static_cast<int>(waterTemp)) * 100);
-
-    // 液位: 0-100 mm
-    data.dis = rng->bounded(LEVEL_MIN, LEVEL_MAX);
-
-    return data;
+    rateHz = qBound(0.1, rateHz, 100000.0);
+    if (qFuzzyCompare(m_simulationRate, rateHz)) return;
+    m_simulationRate = rateHz;
+    emit simulationRateChanged();
+    if (m_isSimulating) startSimulationGenerator();
 }
 
-DataSource::BoatData DataSource::generateFakeBoatData()
+void DataSource::setSimulationSeed(quint32 seed)
 {
-    BoatData data;
-
-    // 使用当前模拟位置
-    data.latitude = m_simulatedLatitude;
-    data.longitude = m_simulatedLongitude;
-    data.heading = m_simulatedHeading;
-    data.speed = m_simulatedSpeed;
-
-    return data;
+    if (m_simulationSeed == seed) return;
+    m_simulationSeed = seed;
+    emit simulationSeedChanged();
 }
 
-DataSource::DeviceData DataSource::generateFakeDeviceData()
+void DataSource::setSimulationImpairments(double noiseRate, double dropRate, double corruptRate)
 {
-    DeviceData data;
-    auto rng = QRandomGenerator::global();
-
-    // 电池电量: 随时间缓慢减少 (模拟实际电池消耗)
-    if (m_simulatedBattery > 0) {
-        // 每10分钟减少约1%
-        int elapsedMinutes = m_simulationElapsedTimer.elapsed() / 60000;
-        m_simulatedBattery = 100 - (elapsedMinutes / 10);
-        m_simulatedBattery = qMax(0, qMin(100, static_cast<int>(m_simulatedBattery)));
-    }
-    data.battery = m_simulatedBattery;
-
-    // 模式: 使用当前模式或随机切换
-    if (rng->bounded(100) < 5) { // 5%概率切换模式
-        m_simulatedMode = !m_simulatedMode;
-    }
-    data.mode = m_simulatedMode;
-
-    return data;
+    m_simulationNoiseRate = qBound(0.0, noiseRate, 1.0);
+    m_simulationDropRate = qBound(0.0, dropRate, 1.0);
+    m_simulationCorruptRate = qBound(0.0, corruptRate, 1.0);
+    if (m_isSimulating) startSimulationGenerator();
 }
 
-void DataSource::updateSimulatedPosition()
+void DataSource::syncSimulationMotors()
 {
-    auto rng = QRandomGenerator::global();
-
-    // 删除未使用的变量
-    // double elapsedSec = m_simulationElapsedTimer.elapsed() / 1000.0;
-
-    // 更新速度 (0-5 m/s)
-    if (rng->bounded(100) < 10) { // 10%概率改变速度
-        // 根据电机值计算速度
-        double motor1Normalized = (m_motor1 - MOTOR_NEUTRAL) / static_cast<double>(MOTOR_MAX_VALUE - MOTOR_NEUTRAL);
-        double motor2Normalized = (m_motor2 - MOTOR_NEUTRAL) / static_cast<double>(MOTOR_MAX_VALUE - MOTOR_NEUTRAL);
-
-        // 计算平均速度因子 (-1.0 到 1.0)
-        double speedFactor = (motor1Normalized + motor2Normalized) / 2.0;
-
-        // 转换为速度 (0-5 m/s)
-        m_simulatedSpeed = qAbs(speedFactor) * 5.0;
-    }
-
-    // 更新航向 (-180 到 180)
-    if (rng->bounded(100) < 5) { // 5%概率改变航向
-        // 根据电机差计算航向变化
-        double motor1Normalized = (m_motor1 - MOTOR_NEUTRAL) / static_cast<double>(MOTOR_MAX_VALUE - MOTOR_NEUTRAL);
-        double motor2Normalized = (m_motor2 - MOTOR_NEUTRAL) / static_cast<double>(MOTOR_MAX_VALUE - MOTOR_NEUTRAL);
-
-        // 电机差异决定转向速率
-        double turnRate = (motor2Normalized - motor1Normalized) * 10.0; // 每秒改变的度数
-
-        // 更新航向
-        m_simulatedHeading += turnRate;
-
-        // 保持在-180到180范围内
-        while (m_simulatedHeading > 180.0) m_simulatedHeading -= 360.0;
-        while (m_simulatedHeading < -180.0) m_simulatedHeading += 360.0;
-    }
-
-    // 根据速度和航向更新位置
-    if (m_simulatedSpeed > 0.1) { // 只有当速度足够大时才移动
-        // 将航向转换为弧度，计算移动方向
-        double headingRad = m_simulatedHeading * M_PI / 180.0;
-
-        // 计算位置变化 (基于纬度的经纬度变化率约为111km每度)
-        double metersPerDegree = 111000.0;
-        double latChange = m_simulatedSpeed * cos(headingRad) / metersPerDegree;
-        double lonChange = m_simulatedSpeed * sin(headingRad) / (metersPerDegree * cos(m_simulatedLatitude * M_PI / 180.0));
-
-        // 更新位置
-        m_simulatedLatitude += latChange * 0.01; // 缩放为合适的变化率
-        m_simulatedLongitude += lonChange * 0.01;
+    SimulationGenerator* generator = simulationGenerator;
+    const quint16 motor1 = m_motor1;
+    const quint16 motor2 = m_motor2;
+    QMetaObject::invokeMethod(generator, [generator, motor1, motor2]() {
+        generator->setMotors(motor1, motor2);
+    });
+}
 
-        // 保证位置在有效范围内
-        m_simulatedLatitude = qBound(-90.0, m_simulatedLatitude, 90.0);
-        m_simulatedLongitude = qBound(-180.0, m_simulatedLongitude, 180.0);
-    }
+void DataSource::startSimulationGenerator()
+{
+    SimulationGenerator::Config config;
+    config.rateHz = m_simulationRate;
+    config.seed = m_simulationSeed;
+    config.noiseRate = m_simulationNoiseRate;
+    config.dropRate = m_simulationDropRate;
+    config.corruptRate = m_simulationCorruptRate;
+
+    SimulationGenerator* generator = simulationGenerator;
+    const quint16 motor1 = m_motor1;
+    const quint16 motor2 = m_motor2;
+    QMetaObject::invokeMethod(generator, [generator, config, motor1, motor2]() {
+        generator->setMotors(motor1, motor2);
+        generator->start(config);
+    });
 }
 
 double DataSource::convertAirTemperature(uint8_t high, uint8_t low)
@@ -0,0 +1,249 @@
+#include "epoll_reader.h"
+
+#ifdef Q_OS_LINUX
+
+#include "metrics.h"
+#include <QDebug>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+// 唤醒描述符使用 0，链路号从 1 开始
+constexpr quint64 WAKE_TOKEN = 0;
+
+speed_t speedFor(int baudRate)
+{
+    switch (baudRate) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    case 2000000: return B2000000;
+    case 3000000: return B3000000;
+    case 4000000: return B4000000;
+    default: return B0;
+    }
+}
+
+QString errnoString(const char* what)
+{
+    return QString("%1: %2").arg(what, QString::fromLocal8Bit(std::strerror(errno)));
+}
+
+}
+
+EpollReader::EpollReader()
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_wakeups = metrics.counter("usv_epoll_wakeups_total", "epoll_wait returns on the shared I/O thread");
+    m_reads = metrics.counter("usv_epoll_reads_total", "read() calls issued by the epoll reader");
+}
+
+EpollReader::~EpollReader()
+{
+    stop();
+}
+
+bool EpollReader::start()
+{
+    if (isRunning()) return true;
+
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epollFd < 0) {
+        qWarning() << errnoString("epoll_create1");
+        return false;
+    }
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeFd < 0) {
+        qWarning() << errnoString("eventfd");
+        ::close(m_epollFd);
+        m_epollFd = -1;
+        return false;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_TOKEN;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event);
+
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&EpollReader::run, this);
+    return true;
+}
+
+void EpollReader::stop()
+{
+    if (!isRunning()) return;
+
+    m_running.store(false, std::memory_order_release);
+    const quint64 one = 1;
+    if (::write(m_wakeFd, &one, sizeof(one)) < 0) {
+        qWarning() << errnoString("eventfd write");
+    }
+    if (m_thread.joinable()) m_thread.join();
+
+    std::lock_guard<std::mutex> locker(m_mutex);
+    for (auto& entry : m_links) {
+        ::close(entry.second->fd);
+    }
+    m_links.clear();
+    ::close(m_wakeFd);
+    ::close(m_epollFd);
+    m_wakeFd = -1;
+    m_epollFd = -1;
+}
+
+int EpollReader::addDevice(const QString& path, int baudRate, ReadCallback callback, QString* errorString)
+{
+    const int fd = ::open(path.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        if (errorString) *errorString = errnoString("open");
+        return -1;
+    }
+
+    // 非终端设备（FIFO、socket 等）直接读取，不做串口配置
+    if (isatty(fd)) {
+        termios tty{};
+        if (tcgetattr(fd, &tty) != 0) {
+            if (errorString) *errorString = errnoString("tcgetattr");
+            ::close(fd);
+            return -1;
+        }
+        cfmakeraw(&tty);
+        tty.c_cflag |= CLOCAL | CREAD;
+        tty.c_cc[VMIN] = 0;
+        tty.c_cc[VTIME] = 0;
+
+        const speed_t speed = speedFor(baudRate);
+        if (speed == B0) {
+            if (errorString) *errorString = QString("不支持的波特率: %1").arg(baudRate);
+            ::close(fd);
+            return -1;
+        }
+        cfsetispeed(&tty, speed);
+        cfsetospeed(&tty, speed);
+
+        if (tcsetattr(fd, TCSANOW, &tty) != 0) {
+            if (errorString) *errorString = errnoString("tcsetattr");
+            ::close(fd);
+            return -1;
+        }
+    }
+
+    return addFd(fd, std::move(callback), errorString);
+}
+
+int EpollReader::addFd(int fd, ReadCallback callback, QString* errorString)
+{
+    const int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        if (errorString) *errorString = errnoString("fcntl");
+        ::close(fd);
+        return -1;
+    }
+
+    auto link = std::make_unique<Link>();
+    link->fd = fd;
+    link->buffer.reset(new char[READ_BUFFER_SIZE]);
+    link->callback = std::move(callback);
+
+    std::lock_guard<std::mutex> locker(m_mutex);
+    const int linkId = m_nextLinkId++;
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.u64 = static_cast<quint64>(linkId);
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        if (errorString) *errorString = errnoString("epoll_ctl");
+        ::close(fd);
+        return -1;
+    }
+
+    m_links.emplace(linkId, std::move(link));
+    return linkId;
+}
+
+void EpollReader::removeLink(int linkId)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    auto it = m_links.find(linkId);
+    if (it == m_links.end()) return;
+
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, it->second->fd, nullptr);
+    ::close(it->second->fd);
+    m_links.erase(it);
+}
+
+int EpollReader::linkCount() const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    return static_cast<int>(m_links.size());
+}
+
+void EpollReader::run()
+{
+    epoll_event events[MAX_EVENTS];
+
+    while (m_running.load(std::memory_order_acquire)) {
+        const int count = epoll_wait(m_epollFd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            qWarning() << errnoString("epoll_wait");
+            break;
+        }
+        m_wakeups->add();
+        const qint64 receiveNs = MetricsClock::nowNs();
+
+        std::lock_guard<std::mutex> locker(m_mutex);
+        for (int i = 0; i < count; ++i) {
+            const quint64 token = events[i].data.u64;
+            if (token == WAKE_TOKEN) {
+                quint64 value = 0;
+                if (::read(m_wakeFd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+                    qWarning() << errnoString("eventfd read");
+                }
+                continue;
+            }
+
+            // 链路可能已在本轮之前被移除
+            auto it = m_links.find(static_cast<int>(token));
+            if (it == m_links.end()) continue;
+            readLink(*it->second, receiveNs);
+        }
+    }
+}
+
+void EpollReader::readLink(Link& link, qint64 receiveNs)
+{
+    // 边沿触发：读到 EAGAIN 或短读为止。终端在非规范模式下短读说明内核缓冲已取空，
+    // 之后到达的数据会产生新的边沿，因此可省去一次必然返回 EAGAIN 的 read()
+    for (;;) {
+        const ssize_t n = ::read(link.fd, link.buffer.get(), READ_BUFFER_SIZE);
+        m_reads->add();
+        if (n > 0) {
+            link.callback(link.buffer.get(), static_cast<int>(n), receiveNs);
+            if (n < READ_BUFFER_SIZE) return;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) return;
+
+        // EOF 或读错误（设备拔出、pty 对端关闭）：停止监听，等待上层移除
+        qWarning() << "epoll 链路读取结束:" << (n == 0 ? QString("EOF") : errnoString("read"));
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, link.fd, nullptr);
+        return;
+    }
+}
+
+#endif // Q_OS_LINUX
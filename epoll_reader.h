@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QString>
+
+#ifdef Q_OS_LINUX
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+class MetricCounter;
+
+// Linux 多链路读取后端：所有串口/pty 的文件描述符注册到同一个 epoll 集合，
+// 由一个 I/O 线程边沿触发读取到每条链路预分配的缓冲区，再直接交给帧切分。
+// 线程数与链路数无关；高波特率下一次 read() 可以带回多帧，摊薄每帧的系统调用。
+class EpollReader {
+public:
+    // 在 I/O 线程中调用；data 仅在回调期间有效
+    using ReadCallback = std::function<void(const char* data, int size, qint64 receiveNs)>;
+
+    static constexpr int READ_BUFFER_SIZE = 64 * 1024;
+    static constexpr int MAX_EVENTS = 64;
+
+    EpollReader();
+    ~EpollReader();
+
+    EpollReader(const EpollReader&) = delete;
+    EpollReader& operator=(const EpollReader&) = delete;
+
+    bool start();
+    void stop();
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    // 以原始模式打开串口或 pty 设备并加入 epoll；返回链路号，失败返回 -1
+    int addDevice(const QString& path, int baudRate, ReadCallback callback, QString* errorString = nullptr);
+    // 加入已打开的描述符（所有权转移给读取器，移除时关闭）
+    int addFd(int fd, ReadCallback callback, QString* errorString = nullptr);
+    // 移除链路；返回后回调不会再被调用
+    void removeLink(int linkId);
+    int linkCount() const;
+
+private:
+    struct Link {
+        int fd = -1;
+        std::unique_ptr<char[]> buffer;
+        ReadCallback callback;
+    };
+
+    void run();
+    void readLink(Link& link, qint64 receiveNs);
+
+    int m_epollFd = -1;
+    int m_wakeFd = -1;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+
+    // I/O 线程分发事件期间持有，保证 removeLink 返回后链路不再被使用
+    mutable std::mutex m_mutex;
+    std::unordered_map<int, std::unique_ptr<Link>> m_links;
+    int m_nextLinkId = 1;
+
+    MetricCounter* m_wakeups;
+    MetricCounter* m_reads;
+};
+
+#endif // Q_OS_LINUX
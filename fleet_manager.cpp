@@ -0,0 +1,468 @@
+#include "fleet_manager.h"
+#include "database.h"
+#include "metrics.h"
+#include "trace.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QMutexLocker>
+
+void FleetSampleQueue::push(QVector<TelemetrySample>& samples)
+{
+    if (samples.isEmpty()) return;
+    QMutexLocker locker(&m_mutex);
+    if (m_pending.isEmpty()) {
+        m_pending.swap(samples);
+    } else {
+        m_pending += samples;
+        samples.clear();
+    }
+}
+
+void FleetSampleQueue::takeAll(QVector<TelemetrySample>& out)
+{
+    QMutexLocker locker(&m_mutex);
+    out.swap(m_pending);
+    m_pending.clear();
+}
+
+int FleetSampleQueue::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pending.size();
+}
+
+VesselIngest::VesselIngest(int vesselId, FleetSampleQueue* queue)
+    : m_vesselId(vesselId)
+    , m_queue(queue)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    const QString labels = QString("vessel=\"%1\"").arg(vesselId);
+    m_bytes = metrics.counter("usv_fleet_read_bytes_total", "Bytes read per vessel link", labels);
+    m_frames = metrics.counter("usv_fleet_frames_decoded_total", "Complete frames decoded per vessel", labels);
+    m_resyncBytes = metrics.counter("usv_fleet_resync_bytes_discarded_total", "Bytes discarded while resynchronising per vessel", labels);
+    m_droppedFrames = metrics.counter("usv_fleet_frames_dropped_total", "Frames lost to resynchronisation per vessel", labels);
+    m_rxBuffer = metrics.gauge("usv_fleet_rx_buffer_bytes", "Bytes waiting in the vessel receive buffer", labels);
+    m_framingLatency = metrics.histogram("usv_fleet_framing_duration_seconds", "Time spent framing and decoding one read per vessel", labels);
+}
+
+void VesselIngest::process(const char* data, int size, qint64 receiveNs)
+{
+    MetricScopeTimer framingTimer(m_framingLatency);
+    m_bytes->add(size);
+
+    // 同一读取块内的帧共用一次墙钟时间
+    const qint64 timestampMs = QDateTime::currentMSecsSinceEpoch();
+    const FrameDecoder::Stats before = m_decoder.stats();
+
+    m_decoder.feed(data, size, receiveNs, [&](const char* frame, qint64 frameReceiveNs) {
+        m_batch.append(TelemetrySample());
+        TelemetrySample& sample = m_batch.last();
+        decodeTelemetry(frame, sample);
+        sample.vesselId = m_vesselId;
+        sample.receiveNs = frameReceiveNs;
+        sample.timestampMs = timestampMs;
+    });
+
+    const FrameDecoder::Stats& after = m_decoder.stats();
+    m_frames->add(after.frames - before.frames);
+    if (after.resyncBytes != before.resyncBytes) {
+        m_resyncBytes->add(after.resyncBytes - before.resyncBytes);
+        m_droppedFrames->add(after.droppedFrames - before.droppedFrames);
+        USV_TRACE2(Trace::Category::Framing, Trace::Level::Info, "fleet.resync", m_vesselId,
+                   after.resyncBytes - before.resyncBytes);
+    }
+    m_rxBuffer->set(m_decoder.buffered());
+
+    m_queue->push(m_batch);
+}
+
+void VesselIngest::reset()
+{
+    m_decoder.reset();
+    m_rxBuffer->set(0);
+}
+
+VesselLink::VesselLink(int vesselId, FleetSampleQueue* queue, QObject *parent)
+    : QObject(parent)
+    , m_ingest(vesselId, queue)
+{
+}
+
+void VesselLink::openSerial(const QString& portName, int baudRate)
+{
+    close();
+
+    m_serialPort = new QSerialPort(this);
+    m_serialPort->setPortName(portName);
+    m_serialPort->setBaudRate(baudRate);
+    m_serialPort->setDataBits(QSerialPort::Data8);
+    m_serialPort->setParity(QSerialPort::NoParity);
+    m_serialPort->setStopBits(QSerialPort::OneStop);
+    m_serialPort->setFlowControl(QSerialPort::NoFlowControl);
+    connect(m_serialPort, &QSerialPort::readyRead, this, &VesselLink::readSerialData);
+    connect(m_serialPort, &QSerialPort::errorOccurred, this, [this](QSerialPort::SerialPortError serialError) {
+        if (serialError == QSerialPort::NoError || serialError == QSerialPort::NotOpenError) return;
+        emit error(vesselId(), QString("串口错误: %1").arg(m_serialPort->errorString()));
+    });
+
+    if (!m_serialPort->open(QIODevice::ReadWrite)) {
+        qDebug() << "船只" << vesselId() << "串口打开失败:" << m_serialPort->errorString();
+        emit error(vesselId(), m_serialPort->errorString());
+        return;
+    }
+    qDebug() << "船只" << vesselId() << "串口已打开:" << portName;
+}
+
+void VesselLink::startSimulation(double rateHz, quint32 seed)
+{
+    close();
+
+    // 模拟器与链路在同一线程，chunkReady 直接调用帧切分
+    m_simulation = new SimulationGenerator(this);
+    connect(m_simulation, &SimulationGenerator::chunkReady, this, [this](const QByteArray& chunk, qint64 receiveNs) {
+        m_ingest.process(chunk.constData(), chunk.size(), receiveNs);
+    });
+
+    SimulationGenerator::Config config;
+    config.rateHz = rateHz;
+    // 未指定种子时按船号派生，保证各船轨迹不同且可复现
+    config.seed = seed != 0 ? seed : static_cast<quint32>(vesselId()) + 1;
+    m_simulation->start(config);
+}
+
+void VesselLink::close()
+{
+    if (m_serialPort) {
+        if (m_serialPort->isOpen()) m_serialPort->close();
+        delete m_serialPort;
+        m_serialPort = nullptr;
+    }
+    if (m_simulation) {
+        m_simulation->stop();
+        delete m_simulation;
+        m_simulation = nullptr;
+    }
+    m_ingest.reset();
+}
+
+void VesselLink::readSerialData()
+{
+    const qint64 receiveNs = MetricsClock::nowNs();
+    const QByteArray data = m_serialPort->readAll();
+    m_ingest.process(data.constData(), data.size(), receiveNs);
+}
+
+FleetModel::FleetModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int FleetModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_vessels.size();
+}
+
+QVariant FleetModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_vessels.size()) return QVariant();
+
+    const VesselState& state = m_vessels.at(index.row());
+    switch (role) {
+    case VesselIdRole: return state.vesselId;
+    case LatitudeRole: return state.latest.latitude;
+    case LongitudeRole: return state.latest.longitude;
+    case CoordinateRole: return QVariant::fromValue(QGeoCoordinate(state.latest.latitude, state.latest.longitude));
+    case SpeedRole: return state.latest.speed;
+    case HeadingRole: return state.latest.heading;
+    case BatteryRole: return state.latest.battery;
+    case ModeRole: return state.latest.mode;
+    case FramesRole: return static_cast<double>(state.frames);
+    case PathRole: {
+        QVariantList path;
+        path.reserve(state.trajectory.size());
+        for (const QGeoCoordinate& coordinate : state.trajectory) {
+            path.append(QVariant::fromValue(coordinate));
+        }
+        return path;
+    }
+    case DistanceRole: return state.odometer.total();
+    default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> FleetModel::roleNames() const
+{
+    return {
+        {VesselIdRole, "vesselId"},
+        {LatitudeRole, "latitude"},
+        {LongitudeRole, "longitude"},
+        {CoordinateRole, "coordinate"},
+        {SpeedRole, "speed"},
+        {HeadingRole, "heading"},
+        {BatteryRole, "battery"},
+        {ModeRole, "mode"},
+        {FramesRole, "frames"},
+        {PathRole, "path"},
+        {DistanceRole, "distance"}
+    };
+}
+
+int FleetModel::rowOf(int vesselId) const
+{
+    for (int i = 0; i < m_vessels.size(); ++i) {
+        if (m_vessels.at(i).vesselId == vesselId) return i;
+    }
+    return -1;
+}
+
+void FleetModel::addVessel(int vesselId)
+{
+    if (rowOf(vesselId) >= 0) return;
+
+    beginInsertRows(QModelIndex(), m_vessels.size(), m_vessels.size());
+    VesselState state;
+    state.vesselId = vesselId;
+    state.latest.vesselId = vesselId;
+    m_vessels.append(state);
+    endInsertRows();
+    emit countChanged();
+}
+
+void FleetModel::removeVessel(int vesselId)
+{
+    const int row = rowOf(vesselId);
+    if (row < 0) return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_vessels.removeAt(row);
+    endRemoveRows();
+    emit countChanged();
+}
+
+void FleetModel::applySamples(const QVector<TelemetrySample>& samples)
+{
+    int firstRow = m_vessels.size();
+    int lastRow = -1;
+    int firstPathRow = m_vessels.size();
+    int lastPathRow = -1;
+
+    for (const TelemetrySample& sample : samples) {
+        const int row = rowOf(sample.vesselId);
+        // 已移除船只的残留样本
+        if (row < 0) continue;
+
+        VesselState& state = m_vessels[row];
+        state.latest = sample;
+        ++state.frames;
+        state.odometer.add(sample.latitude, sample.longitude);
+        firstRow = qMin(firstRow, row);
+        lastRow = qMax(lastRow, row);
+
+        if (sample.timestampMs - state.lastTrajectoryMs < TRAJECTORY_INTERVAL_MS) continue;
+        const QGeoCoordinate coordinate(sample.latitude, sample.longitude);
+        if (!coordinate.isValid()) continue;
+
+        state.lastTrajectoryMs = sample.timestampMs;
+        if (state.trajectory.size() >= MAX_TRAJECTORY_POINTS) {
+            state.trajectory.removeFirst();
+        }
+        state.trajectory.append(coordinate);
+        firstPathRow = qMin(firstPathRow, row);
+        lastPathRow = qMax(lastPathRow, row);
+    }
+
+    if (lastRow >= 0) {
+        emit dataChanged(index(firstRow), index(lastRow),
+                         {LatitudeRole, LongitudeRole, CoordinateRole, SpeedRole,
+                          HeadingRole, BatteryRole, ModeRole, FramesRole, DistanceRole});
+    }
+    if (lastPathRow >= 0) {
+        emit dataChanged(index(firstPathRow), index(lastPathRow), {PathRole});
+    }
+}
+
+FleetManager::FleetManager(QObject *parent)
+    : QObject(parent)
+    , drainTimer(new QTimer(this))
+{
+    connect(drainTimer, &QTimer::timeout, this, &FleetManager::flush);
+    drainTimer->start(DRAIN_INTERVAL_MS);
+}
+
+FleetManager::~FleetManager()
+{
+    const QList<int> ids = m_links.keys();
+    for (int vesselId : ids) {
+        removeVessel(vesselId);
+    }
+}
+
+void FleetManager::setEpollBackend(bool enabled)
+{
+#ifndef Q_OS_LINUX
+    if (enabled) {
+        qWarning() << "epoll 读取后端仅支持 Linux";
+        enabled = false;
+    }
+#endif
+    if (m_epollBackend == enabled) return;
+    m_epollBackend = enabled;
+    emit epollBackendChanged();
+}
+
+bool FleetManager::acceptVesselId(int vesselId)
+{
+    if (vesselId <= PRIMARY_VESSEL_ID) {
+        qWarning() << "船只编号无效:" << vesselId;
+        emit error(vesselId, QString("船只编号须大于 %1: %2").arg(PRIMARY_VESSEL_ID).arg(vesselId));
+        return false;
+    }
+    if (m_links.contains(vesselId)) {
+        qWarning() << "船只已存在:" << vesselId;
+        emit error(vesselId, QString("船只已存在: %1").arg(vesselId));
+        return false;
+    }
+    return true;
+}
+
+VesselLink* FleetManager::createLink(int vesselId)
+{
+    if (!acceptVesselId(vesselId)) return nullptr;
+
+    Link entry;
+    entry.thread = new QThread(this);
+    entry.thread->setObjectName(QString("VesselLink-%1").arg(vesselId));
+    entry.link = new VesselLink(vesselId, &m_queue);
+    entry.link->moveToThread(entry.thread);
+    connect(entry.thread, &QThread::finished, entry.link, &QObject::deleteLater);
+    connect(entry.link, &VesselLink::error, this, &FleetManager::error);
+    entry.thread->start();
+
+    m_links.insert(vesselId, entry);
+    m_model.addVessel(vesselId);
+    emit vesselsChanged();
+    return entry.link;
+}
+
+bool FleetManager::addSerialVessel(int vesselId, const QString& portName, int baudRate)
+{
+    if (m_epollBackend) {
+        return addEpollSerialVessel(vesselId, portName, baudRate);
+    }
+
+    VesselLink* link = createLink(vesselId);
+    if (!link) return false;
+    QMetaObject::invokeMethod(link, [link, portName, baudRate]() {
+        link->openSerial(portName, baudRate);
+    });
+    return true;
+}
+
+bool FleetManager::addEpollSerialVessel(int vesselId, const QString& portName, int baudRate)
+{
+#ifdef Q_OS_LINUX
+    if (!acceptVesselId(vesselId)) return false;
+
+    if (!m_epollReader) {
+        m_epollReader = std::make_unique<EpollReader>();
+    }
+    if (!m_epollReader->start()) {
+        emit error(vesselId, "epoll 读取线程启动失败");
+        return false;
+    }
+
+    // QSerialPort 的端口名不含 /dev 前缀
+    const QString devicePath = portName.startsWith('/') ? portName : QString("/dev/%1").arg(portName);
+
+    Link entry;
+    entry.ingest = QSharedPointer<VesselIngest>::create(vesselId, &m_queue);
+    VesselIngest* ingest = entry.ingest.data();
+    QString errorString;
+    entry.epollLinkId = m_epollReader->addDevice(devicePath, baudRate,
+        [ingest](const char* data, int size, qint64 receiveNs) {
+            ingest->process(data, size, receiveNs);
+        }, &errorString);
+    if (entry.epollLinkId < 0) {
+        qDebug() << "船只" << vesselId << "串口打开失败:" << errorString;
+        emit error(vesselId, errorString);
+        return false;
+    }
+
+    m_links.insert(vesselId, entry);
+    m_model.addVessel(vesselId);
+    emit vesselsChanged();
+    qDebug() << "船只" << vesselId << "串口已加入 epoll:" << devicePath;
+    return true;
+#else
+    Q_UNUSED(portName)
+    Q_UNUSED(baudRate)
+    emit error(vesselId, "epoll 读取后端仅支持 Linux");
+    return false;
+#endif
+}
+
+bool FleetManager::addSimulatedVessel(int vesselId, double rateHz, quint32 seed)
+{
+    VesselLink* link = createLink(vesselId);
+    if (!link) return false;
+    rateHz = qBound(0.1, rateHz, 100000.0);
+    QMetaObject::invokeMethod(link, [link, rateHz, seed]() {
+        link->startSimulation(rateHz, seed);
+    });
+    return true;
+}
+
+void FleetManager::removeVessel(int vesselId)
+{
+    auto it = m_links.find(vesselId);
+    if (it == m_links.end()) return;
+
+    const Link entry = it.value();
+    m_links.erase(it);
+
+#ifdef Q_OS_LINUX
+    if (entry.epollLinkId >= 0) {
+        // removeLink 返回后 I/O 线程不再使用该船的解码状态
+        m_epollReader->removeLink(entry.epollLinkId);
+        m_model.removeVessel(vesselId);
+        emit vesselsChanged();
+        return;
+    }
+#endif
+
+    // 在链路线程中关闭串口/模拟器，随后退出线程，链路对象随 finished 释放
+    QMetaObject::invokeMethod(entry.link, &VesselLink::close, Qt::BlockingQueuedConnection);
+    entry.thread->quit();
+    entry.thread->wait();
+    delete entry.thread;
+
+    m_model.removeVessel(vesselId);
+    emit vesselsChanged();
+}
+
+void FleetManager::flush()
+{
+    m_queue.takeAll(m_drained);
+    if (m_drained.isEmpty()) return;
+
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    const int count = m_drained.size();
+    metrics.framesDecoded->add(count);
+    metrics.uiPublished->add(count);
+
+    m_model.applySamples(m_drained);
+
+    // 整批样本在数据库线程中以一个事务写入
+    if (m_database) {
+        metrics.dbRowsQueued->add(count);
+        Database* database = m_database;
+        const QVector<TelemetrySample> batch = m_drained;
+        QMetaObject::invokeMethod(database, [database, batch, &metrics]() {
+            MetricScopeTimer commitTimer(metrics.dbCommitLatency);
+            database->insertTelemetryBatch(batch);
+            metrics.dbRowsWritten->add(batch.size());
+        });
+    }
+
+    m_drained.clear();
+}
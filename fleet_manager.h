@@ -0,0 +1,199 @@
+#pragma once
+
+#include "frame_codec.h"
+#include "geodesy.h"
+#include "epoll_reader.h"
+#include "simulation_generator.h"
+#include <QAbstractListModel>
+#include <QGeoCoordinate>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QSerialPort>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <memory>
+
+class Database;
+class MetricCounter;
+class MetricGauge;
+class LatencyHistogram;
+
+// 各船链路线程与界面线程之间共享的样本队列；每个字节块只加锁一次
+class FleetSampleQueue {
+public:
+    void push(QVector<TelemetrySample>& samples);
+    // 取走全部待处理样本（与 out 交换，避免拷贝）
+    void takeAll(QVector<TelemetrySample>& out);
+    int size() const;
+
+private:
+    mutable QMutex m_mutex;
+    QVector<TelemetrySample> m_pending;
+};
+
+// 单船接收处理：帧切分、二进制解码并按块推入共享队列。
+// 只在一个线程中使用（链路线程或 epoll I/O 线程），不加锁。
+class VesselIngest {
+public:
+    VesselIngest(int vesselId, FleetSampleQueue* queue);
+
+    int vesselId() const { return m_vesselId; }
+    void process(const char* data, int size, qint64 receiveNs);
+    void reset();
+
+private:
+    const int m_vesselId;
+    FleetSampleQueue* m_queue;
+    FrameDecoder m_decoder;
+    QVector<TelemetrySample> m_batch;
+
+    // 按 vessel 标签注册的指标
+    MetricCounter* m_bytes;
+    MetricCounter* m_frames;
+    MetricCounter* m_resyncBytes;
+    MetricCounter* m_droppedFrames;
+    MetricGauge* m_rxBuffer;
+    LatencyHistogram* m_framingLatency;
+};
+
+// 单船链路：运行在独立线程中，负责一路串口或模拟数据源
+class VesselLink : public QObject {
+    Q_OBJECT
+public:
+    VesselLink(int vesselId, FleetSampleQueue* queue, QObject *parent = nullptr);
+
+    int vesselId() const { return m_ingest.vesselId(); }
+
+public slots:
+    // 以下槽必须在链路线程中调用（排队调用），串口和模拟器都在该线程内创建
+    void openSerial(const QString& portName, int baudRate);
+    void startSimulation(double rateHz, quint32 seed);
+    void close();
+
+signals:
+    void error(int vesselId, const QString& message);
+
+private:
+    void readSerialData();
+
+    VesselIngest m_ingest;
+    QSerialPort* m_serialPort = nullptr;
+    SimulationGenerator* m_simulation = nullptr;
+};
+
+// 船队状态模型：每船一行，供地图 MapItemView 显示位置、航向和轨迹
+class FleetModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+public:
+    enum Roles {
+        VesselIdRole = Qt::UserRole + 1,
+        LatitudeRole,
+        LongitudeRole,
+        CoordinateRole,
+        SpeedRole,
+        HeadingRole,
+        BatteryRole,
+        ModeRole,
+        FramesRole,
+        PathRole,
+        DistanceRole        // 累计航程（米）
+    };
+
+    // 轨迹按秒抽稀，最多保留一小时
+    static constexpr int TRAJECTORY_INTERVAL_MS = 1000;
+    static constexpr int MAX_TRAJECTORY_POINTS = 3600;
+
+    explicit FleetModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void addVessel(int vesselId);
+    void removeVessel(int vesselId);
+    // 合并一批样本：每船只取最新状态，整批只发一次 dataChanged
+    void applySamples(const QVector<TelemetrySample>& samples);
+
+signals:
+    void countChanged();
+
+private:
+    struct VesselState {
+        int vesselId = 0;
+        TelemetrySample latest;
+        quint64 frames = 0;
+        qint64 lastTrajectoryMs = 0;
+        QVector<QGeoCoordinate> trajectory;
+        Geodesy::Odometer odometer;
+    };
+
+    int rowOf(int vesselId) const;
+
+    QVector<VesselState> m_vessels;
+};
+
+// 船队管理：每船一个链路线程，所有链路汇入同一条解码、显示、入库流水线
+class FleetManager : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int vesselCount READ vesselCount NOTIFY vesselsChanged)
+    Q_PROPERTY(int pendingSamples READ pendingSamples NOTIFY vesselsChanged)
+    // Linux 下串口链路改由单个 epoll I/O 线程读取（只影响之后添加的船只）
+    Q_PROPERTY(bool epollBackend READ epollBackend WRITE setEpollBackend NOTIFY epollBackendChanged)
+public:
+    static constexpr int DRAIN_INTERVAL_MS = 50;
+
+    explicit FleetManager(QObject *parent = nullptr);
+    ~FleetManager();
+
+    FleetModel* model() { return &m_model; }
+    void setDatabase(Database* database) { m_database = database; }
+
+    // 船只编号须大于 PRIMARY_VESSEL_ID（本船占用 0，-1 在查询接口中表示全部船只），否则发出 error 并返回 false
+    Q_INVOKABLE bool addSerialVessel(int vesselId, const QString& portName, int baudRate = 115200);
+    Q_INVOKABLE bool addSimulatedVessel(int vesselId, double rateHz = 20.0, quint32 seed = 0);
+    Q_INVOKABLE void removeVessel(int vesselId);
+    Q_INVOKABLE QList<int> vesselIds() const { return m_links.keys(); }
+
+    int vesselCount() const { return m_links.size(); }
+    int pendingSamples() const { return m_queue.size(); }
+    bool epollBackend() const { return m_epollBackend; }
+    void setEpollBackend(bool enabled);
+
+public slots:
+    // 取走共享队列中的全部样本，更新模型并排队批量入库（由定时器周期调用）
+    void flush();
+
+signals:
+    void vesselsChanged();
+    void epollBackendChanged();
+    void error(int vesselId, const QString& message);
+
+private:
+    struct Link {
+        QThread* thread = nullptr;
+        VesselLink* link = nullptr;
+        // epoll 后端：链路由共享 I/O 线程读取，解码状态由管理器持有
+        int epollLinkId = -1;
+        QSharedPointer<VesselIngest> ingest;
+    };
+
+    // 编号越界或已存在时发出 error 并返回 false
+    bool acceptVesselId(int vesselId);
+    VesselLink* createLink(int vesselId);
+    bool addEpollSerialVessel(int vesselId, const QString& portName, int baudRate);
+
+    FleetSampleQueue m_queue;
+    FleetModel m_model;
+    QMap<int, Link> m_links;
+    QTimer* drainTimer;
+    Database* m_database = nullptr;
+    QVector<TelemetrySample> m_drained;
+    bool m_epollBackend = false;
+#ifdef Q_OS_LINUX
+    std::unique_ptr<EpollReader> m_epollReader;
+#endif
+};
@@ -0,0 +1,152 @@
+#include "frame_codec.h"
+#include <cmath>
+
+using namespace FrameConstants;
+
+namespace {
+
+inline quint16 readU16(const char* p)
+{
+    return static_cast<quint16>(static_cast<uint8_t>(p[0]) | (static_cast<uint8_t>(p[1]) << 8));
+}
+
+// 坐标 5 字节：1 字节有符号整数部分 + 4 字节 float 小数部分
+inline double readCoordinate(const char* p)
+{
+    const int8_t integer = static_cast<int8_t>(p[0]);
+    float decimal = 0.0f;
+    std::memcpy(&decimal, p + 1, sizeof(decimal));
+    return integer + static_cast<double>(decimal);
+}
+
+}
+
+void encodeCoordinatePair(char* out, double longitude, double latitude)
+{
+    const int lonInt = static_cast<int>(longitude);
+    const float lonDecimal = static_cast<float>(longitude - lonInt);
+    out[0] = static_cast<char>(lonInt);
+    std::memcpy(out + 1, &lonDecimal, sizeof(lonDecimal));
+
+    const int latInt = static_cast<int>(latitude);
+    const float latDecimal = static_cast<float>(latitude - latInt);
+    out[5] = static_cast<char>(latInt);
+    std::memcpy(out + 6, &latDecimal, sizeof(latDecimal));
+}
+
+void decodeCoordinatePair(const char* in, double& longitude, double& latitude)
+{
+    longitude = readCoordinate(in);
+    latitude = readCoordinate(in + 5);
+}
+
+quint16 crc16Ccitt(const char* data, int size)
+{
+    quint16 crc = 0xFFFF;
+    for (int i = 0; i < size; ++i) {
+        crc ^= static_cast<quint16>(static_cast<uint8_t>(data[i]) << 8);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<quint16>((crc << 1) ^ 0x1021) : static_cast<quint16>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void FrameDecoder::reset()
+{
+    m_buffer.clear();
+    m_chunks.clear();
+    m_chunkIndex = 0;
+    m_readPos = 0;
+    m_resyncing = false;
+}
+
+qint64 FrameDecoder::receiveNsAt(int pos)
+{
+    while (m_chunkIndex + 1 < static_cast<int>(m_chunks.size()) && m_chunks[m_chunkIndex + 1].offset <= pos) {
+        ++m_chunkIndex;
+    }
+    return m_chunks[m_chunkIndex].receiveNs;
+}
+
+void FrameDecoder::compact()
+{
+    if (m_readPos == 0) return;
+    if (m_readPos >= m_buffer.size()) {
+        m_buffer.clear();
+        m_chunks.clear();
+    } else {
+        m_buffer.remove(0, m_readPos);
+        // 丢掉已整块读完的数据块，其余偏移随缓冲区前移；首块可能只读了一部分，起点记为 0
+        receiveNsAt(m_readPos);
+        m_chunks.erase(m_chunks.begin(), m_chunks.begin() + m_chunkIndex);
+        for (Chunk& chunk : m_chunks) {
+            chunk.offset = qMax(0, chunk.offset - m_readPos);
+        }
+    }
+    m_chunkIndex = 0;
+    m_readPos = 0;
+}
+
+void decodeTelemetry(const char* frame, TelemetrySample& out)
+{
+    const char* s = frame + SENSOR_DATA_OFFSET;
+
+    out.motor1 = readU16(s);
+    out.motor2 = readU16(s + 2);
+
+    out.co2 = readU16(s + 4);
+    out.ch2o = readU16(s + 6);
+    out.tvoc = readU16(s + 8);
+    out.pm25 = readU16(s + 10);
+    out.pm10 = readU16(s + 12);
+    out.airTemperature = static_cast<uint8_t>(s[14]) + 0.01 * static_cast<uint8_t>(s[15]);
+    out.humidity = static_cast<uint8_t>(s[16]) + 0.01 * static_cast<uint8_t>(s[17]);
+
+    out.turbidity = readU16(s + 18);
+    out.ph = readU16(s + 20) / 100.0;
+    out.tds = readU16(s + 22);
+    out.waterTemperature = static_cast<uint8_t>(s[24]) + 0.01 * static_cast<uint8_t>(s[25]);
+    out.levelValue = static_cast<int16_t>(readU16(s + 26));
+
+    out.latitude = readCoordinate(frame + LAT_OFFSET);
+    out.longitude = readCoordinate(frame + LON_OFFSET);
+
+    // 航向：1 字节有符号整数 + 1 字节百分位
+    const int8_t headingInt = static_cast<int8_t>(frame[HEADING_OFFSET]);
+    const double headingDec = static_cast<uint8_t>(frame[HEADING_OFFSET + 1]) / 100.0;
+    out.heading = headingInt < 0 ? headingInt - headingDec : headingInt + headingDec;
+
+    // 速度：1 字节整数 + 1 字节百分位
+    out.speed = static_cast<uint8_t>(frame[SPEED_OFFSET]) + static_cast<uint8_t>(frame[SPEED_OFFSET + 1]) / 100.0;
+
+    out.battery = readU16(frame + BATTERY_OFFSET);
+    out.mode = frame[MODE_OFFSET] != 0;
+}
+
+void encodeControlBlock(char* out, const ControlState& state)
+{
+    out[0] = state.pumpMode ? 1 : 0;
+    out[1] = state.pumpState ? 1 : 0;
+    out[2] = static_cast<char>(state.boatMode);
+    out[3] = static_cast<char>(state.motor1 & 0xFF);
+    out[4] = static_cast<char>(state.motor1 >> 8);
+    out[5] = static_cast<char>(state.motor2 & 0xFF);
+    out[6] = static_cast<char>(state.motor2 >> 8);
+}
+
+int encodeControlFrame(char* out, const ControlState& state)
+{
+    out[0] = static_cast<char>(FRAME_HEADER);
+    out[1] = static_cast<char>(FRAME_TRAILER);
+    out[FRAME_HEADER_SIZE] = static_cast<char>(CONTROL_FRAME_TYPE);
+    encodeControlBlock(out + FRAME_HEADER_SIZE + 1, state);
+
+    // 校验：类型与控制块逐字节异或
+    quint8 checksum = 0;
+    for (int i = FRAME_HEADER_SIZE; i < CONTROL_FRAME_SIZE - 1; ++i) {
+        checksum ^= static_cast<quint8>(out[i]);
+    }
+    out[CONTROL_FRAME_SIZE - 1] = static_cast<char>(checksum);
+    return CONTROL_FRAME_SIZE;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "frame_constants.h"
+#include <QByteArray>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// 接收帧切分：在字节流中查找帧头帧尾并切出 RECEIVE_FRAME_SIZE 字节的完整帧；
+// 启用确认帧后同时识别船端的任务确认帧（MISSION_ACK_FRAME_SIZE 字节）并交给辅助回调。
+// 未启用时 0xFA 0xFB 只是普通数据，失步查找也不会停在 0xFA 上。
+// 失步时用 memchr 跳到下一个候选帧头，已处理的数据在每次 feed 结束时统一压缩，
+// 避免逐字节 remove 带来的 O(n^2) 拷贝。
+// 每个数据块带有接收时间，跨块的帧按其首字节所在数据块的接收时间标注。
+class FrameDecoder {
+public:
+    struct Stats {
+        quint64 frames = 0;         // 完整帧数
+        quint64 resyncBytes = 0;    // 失步丢弃字节数
+        quint64 droppedFrames = 0;  // 失步次数（每次失步计一帧丢失）
+        quint64 ackFrames = 0;      // 任务确认帧数
+    };
+
+    // 追加 receiveNs 时收到的数据，对每个完整帧调用 onFrame(const char* frame, qint64 frameReceiveNs)，
+    // 对每个任务确认帧调用 onAck(const char* frame)；frameReceiveNs 为帧首字节的接收时间，指针仅在回调期间有效
+    template <typename Callback, typename AckCallback>
+    void feed(const char* data, int size, qint64 receiveNs, Callback&& onFrame, AckCallback&& onAck);
+    template <typename Callback>
+    void feed(const char* data, int size, qint64 receiveNs, Callback&& onFrame)
+    {
+        feed(data, size, receiveNs, std::forward<Callback>(onFrame), [](const char*) {});
+    }
+
+    int buffered() const { return m_buffer.size() - m_readPos; }
+    const Stats& stats() const { return m_stats; }
+    void reset();
+    // 船端支持分块任务确认时启用（默认不识别确认帧）
+    void setAckFramesEnabled(bool enabled) { m_acksEnabled = enabled; }
+    bool ackFramesEnabled() const { return m_acksEnabled; }
+
+private:
+    // 缓冲区中一个数据块的起始偏移与接收时间
+    struct Chunk {
+        int offset = 0;
+        qint64 receiveNs = 0;
+    };
+
+    // pos 处字节的接收时间；pos 只增不减，按块顺序前移
+    qint64 receiveNsAt(int pos);
+    void compact();
+
+    QByteArray m_buffer;
+    std::vector<Chunk> m_chunks;
+    int m_chunkIndex = 0;
+    int m_readPos = 0;
+    bool m_resyncing = false;
+    bool m_acksEnabled = false;
+    Stats m_stats;
+};
+
+template <typename Callback, typename AckCallback>
+void FrameDecoder::feed(const char* data, int size, qint64 receiveNs, Callback&& onFrame, AckCallback&& onAck)
+{
+    using namespace FrameConstants;
+
+    if (size > 0) {
+        m_chunks.push_back({m_buffer.size(), receiveNs});
+        m_buffer.append(data, size);
+    }
+
+    // 保持缓冲区至少2字节用于检查帧头帧尾
+    while (m_buffer.size() - m_readPos >= 2) {
+        const char* p = m_buffer.constData() + m_readPos;
+        const int available = m_buffer.size() - m_readPos;
+
+        if (m_acksEnabled && static_cast<uint8_t>(p[0]) == MISSION_ACK_HEADER
+            && static_cast<uint8_t>(p[1]) == MISSION_ACK_TRAILER) {
+            if (available < MISSION_ACK_FRAME_SIZE) break;
+            m_resyncing = false;
+            ++m_stats.ackFrames;
+            onAck(p);
+            m_readPos += MISSION_ACK_FRAME_SIZE;
+            continue;
+        }
+
+        if (static_cast<uint8_t>(p[0]) != FRAME_HEADER || static_cast<uint8_t>(p[1]) != FRAME_TRAILER) {
+            if (!m_resyncing) {
+                m_resyncing = true;
+                ++m_stats.droppedFrames;
+            }
+            // 跳到下一个可能的帧头（遥测帧头，启用确认帧时还有确认帧头，取较近者）
+            const void* next = std::memchr(p + 1, FRAME_HEADER, available - 1);
+            if (m_acksEnabled) {
+                const int limit = next ? static_cast<int>(static_cast<const char*>(next) - (p + 1)) : available - 1;
+                if (const void* ack = std::memchr(p + 1, MISSION_ACK_HEADER, limit)) next = ack;
+            }
+            const int skip = next ? static_cast<int>(static_cast<const char*>(next) - p) : available;
+            m_stats.resyncBytes += skip;
+            m_readPos += skip;
+            continue;
+        }
+        m_resyncing = false;
+
+        // 数据不足，等待更多数据
+        if (available < RECEIVE_FRAME_SIZE) break;
+
+        ++m_stats.frames;
+        onFrame(p, receiveNsAt(m_readPos));
+        m_readPos += RECEIVE_FRAME_SIZE;
+    }
+
+    compact();
+}
+
+// 解码后的遥测样本（二进制直接解码，不经过十六进制字符串）
+struct TelemetrySample {
+    int vesselId = 0;
+    qint64 receiveNs = 0;       // 单调接收时间
+    qint64 timestampMs = 0;     // 墙钟时间（毫秒）
+
+    quint16 motor1 = 0;
+    quint16 motor2 = 0;
+
+    int co2 = 0;
+    int ch2o = 0;
+    int tvoc = 0;
+    int pm25 = 0;
+    int pm10 = 0;
+    double airTemperature = 0.0;
+    double humidity = 0.0;
+    int turbidity = 0;
+    double ph = 0.0;
+    int tds = 0;
+    double waterTemperature = 0.0;
+    int levelValue = 0;
+
+    double latitude = 0.0;
+    double longitude = 0.0;
+    double speed = 0.0;
+    double heading = 0.0;
+    int battery = 0;
+    bool mode = false;
+};
+
+// 按 FrameConstants 偏移解码完整接收帧；frame 至少 RECEIVE_FRAME_SIZE 字节
+void decodeTelemetry(const char* frame, TelemetrySample& out);
+
+// 下行控制状态（与任务帧控制指令块字段一致）
+struct ControlState {
+    bool pumpMode = false;      // 水泵模式：0 手动，1 自动
+    bool pumpState = false;     // 水泵开关（手动模式有效）
+    quint8 boatMode = 0;        // 艇模式：0 手动，1 自动，2 位置保持
+    quint16 motor1 = 0;
+    quint16 motor2 = 0;
+};
+
+// 写出 7 字节控制指令块（水泵模式、水泵开关、艇模式、电机1、电机2 小端）
+void encodeControlBlock(char* out, const ControlState& state);
+// 写出 CONTROL_FRAME_SIZE 字节的独立控制帧，返回写出字节数
+int encodeControlFrame(char* out, const ControlState& state);
+
+// 航点（任务中第一个为 Home 点）
+struct MissionPoint {
+    double longitude = 0.0;
+    double latitude = 0.0;
+};
+
+// 航点坐标：经度、纬度各为 1 字节有符号整数 + 4 字节 float 小数（共 10 字节）
+void encodeCoordinatePair(char* out, double longitude, double latitude);
+void decodeCoordinatePair(const char* in, double& longitude, double& latitude);
+
+// CRC-16/CCITT-FALSE（多项式 0x1021，初值 0xFFFF）
+quint16 crc16Ccitt(const char* data, int size);
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+
+// 数据帧常量定义
+namespace FrameConstants {
+// 帧大小常量
+const int RECEIVE_FRAME_SIZE = 65;    // 接收帧大小
+
+// 帧头帧尾常量
+const uint8_t FRAME_HEADER = 0xFF;    // 帧头
+const uint8_t FRAME_TRAILER = 0xFE;   // 帧尾
+
+// 接收帧偏移量
+const int SENSOR_DATA_OFFSET = 2;     // 传感器数据起始位置
+const int SENSOR_DATA_LENGTH = 30;    // 传感器数据长度
+const int LAT_OFFSET = 32;            // 纬度起始位置
+const int LON_OFFSET = 37;            // 经度起始位置
+const int HEADING_OFFSET = 42;        // 航向角起始位置
+const int SPEED_OFFSET = 44;          // 速度起始位置
+const int BATTERY_OFFSET = 46;        // 电池起始位置
+const int MODE_OFFSET = 48;           // 模式起始位置
+
+// 发送帧偏移量
+const int FRAME_HEADER_SIZE=2;        //帧头长度
+const int TIMESTAMP_LENGTH = 8;       // 时间戳长度
+const int HOME_POINT_SIZE = 10;       // Home点长度
+const int TASK_POINT_SIZE = 10;       // 任务点长度
+const int MAX_TASK_POINTS = 50;       // 最大任务点数量
+const int CONTROL_BLOCK_SIZE=7;       //控制指令块长度 (7字节, 偏移 20 + 10*N 起)
+const int RESERVED_SIZE=14;           //保留区长度 (14字节, 偏移 27 + 10*N 起)
+
+// 独立控制帧：帧头帧尾 + 类型 + 控制指令块 + 异或校验，不携带任务点
+const uint8_t CONTROL_FRAME_TYPE = 0xC1;  // 控制帧类型
+const int CONTROL_FRAME_SIZE = FRAME_HEADER_SIZE + 1 + CONTROL_BLOCK_SIZE + 1;
+
+// 分块任务上传帧：帧头帧尾 + 类型 + 任务号(2) + 序号(2) + 总块数(2) + 负载长度(1) + 负载 + CRC16(2)
+// 序号 0 为任务头：时间戳(8) + 航点总数(2，含 Home 点) + 控制指令块(7)；其后各块依次携带航点
+const uint8_t MISSION_CHUNK_FRAME_TYPE = 0xC2;
+const int MISSION_CHUNK_HEADER_SIZE = FRAME_HEADER_SIZE + 1 + 2 + 2 + 2 + 1;
+const int MISSION_CHUNK_CRC_SIZE = 2;
+const int MISSION_CHUNK_POINTS = 20;    // 每块航点数
+const int MISSION_HEADER_PAYLOAD_SIZE = TIMESTAMP_LENGTH + 2 + CONTROL_BLOCK_SIZE;
+const int MAX_MISSION_POINTS = 65535;  // 航点总数字段为 16 位
+
+// 任务确认帧（船端上行）：0xFA 0xFB + 任务号(2) + 累计确认序号(2) + 选择确认位图(4) + 异或校验
+// 累计确认序号之前的块均已收到；位图第 i 位表示序号 base+1+i 的块已收到
+const uint8_t MISSION_ACK_HEADER = 0xFA;
+const uint8_t MISSION_ACK_TRAILER = 0xFB;
+const int MISSION_ACK_FRAME_SIZE = 2 + 2 + 2 + 4 + 1;
+
+// 坐标点结构
+const int COORD_INT_SIZE = 1;         // 整数部分大小
+const int COORD_FLOAT_SIZE = 4;       // 小数部分大小
+const int COORD_TOTAL_SIZE = 5;       // 坐标总大小
+
+// 电机控制常量
+const int MOTOR_MIN_VALUE = 675;      // 电机最小值
+const int MOTOR_NEUTRAL = 1013;       // 电机中值
+const int MOTOR_MAX_VALUE = 1353;     // 电机最大值
+
+// 传感器常量
+namespace SensorLimits {
+// CO2范围（ppm）
+const int CO2_MIN = 400;
+const int CO2_MAX = 2000;
+const int CO2_WARNING = 1000;
+const int CO2_CRITICAL = 2000;
+
+// 甲醛范围（mg/m³）
+const double CH2O_MIN = 0.01;
+const double CH2O_MAX = 0.15;
+const double CH2O_WARNING = 0.08;
+const double CH2O_CRITICAL = 0.1;
+
+// TVOC范围（ppb）
+const int TVOC_MIN = 50;
+const int TVOC_MAX = 1000;
+const int TVOC_WARNING = 500;
+const int TVOC_CRITICAL = 800;
+
+// PM2.5范围（μg/m³）
+const int PM25_MIN = 0;
+const int PM25_MAX = 250;
+const int PM25_WARNING = 75;
+const int PM25_CRITICAL = 150;
+
+// PM10范围（μg/m³）
+const int PM10_MIN = 0;
+const int PM10_MAX = 350;
+const int PM10_WARNING = 150;
+const int PM10_CRITICAL = 250;
+
+// 空气温度范围（°C）
+const double AIR_TEMP_MIN = 5.0;
+const double AIR_TEMP_MAX = 40.0;
+
+// 湿度范围（%）
+const double HUMIDITY_MIN = 20.0;
+const double HUMIDITY_MAX = 90.0;
+
+// 浊度范围（NTU）
+const int TURBIDITY_MIN = 0;
+const int TURBIDITY_MAX = 25;
+const int TURBIDITY_WARNING = 5;
+const int TURBIDITY_CRITICAL = 20;
+
+// pH值范围
+const double PH_MIN = 5.0;
+const double PH_MAX = 10.0;
+const double PH_WARNING = 8.5;
+const double PH_CRITICAL = 9.0;
+
+// TDS范围（ppm）
+const int TDS_MIN = 50;
+const int TDS_MAX = 1500;
+const int TDS_WARNING = 500;
+const int TDS_CRITICAL = 1000;
+
+// 水温范围（°C）
+const double WATER_TEMP_MIN = 5.0;
+const double WATER_TEMP_MAX = 35.0;
+
+// 液位范围（mm）
+const int LEVEL_MIN = 0;
+const int LEVEL_MAX = 100;
+}
+}
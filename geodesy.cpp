@@ -0,0 +1,142 @@
+#include "geodesy.h"
+#include <algorithm>
+
+namespace Geodesy {
+
+namespace {
+
+// 每块处理的点数：单位向量分量放在栈上的定长数组中
+constexpr int BLOCK_POINTS = 256;
+
+struct UnitVectors {
+    double cosLat[BLOCK_POINTS + 1];
+    double sinLat[BLOCK_POINTS + 1];
+    double cosLon[BLOCK_POINTS + 1];
+    double sinLon[BLOCK_POINTS + 1];
+
+    void load(const double* lat, const double* lon, int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            const double phi = lat[i] * DEG_TO_RAD;
+            const double lambda = lon[i] * DEG_TO_RAD;
+            cosLat[i] = std::cos(phi);
+            sinLat[i] = std::sin(phi);
+            cosLon[i] = std::cos(lambda);
+            sinLon[i] = std::sin(lambda);
+        }
+    }
+};
+
+// 按块遍历：每块含 BLOCK_POINTS 段，相邻块共享边界点
+template <typename Kernel>
+void forEachBlock(const double* lat, const double* lon, int count, Kernel&& kernel)
+{
+    UnitVectors v;
+    for (int start = 0; start + 1 < count; start += BLOCK_POINTS) {
+        const int points = std::min(BLOCK_POINTS + 1, count - start);
+        v.load(lat + start, lon + start, points);
+        kernel(v, start, points - 1);
+    }
+}
+
+}
+
+double initialBearing(double lat1, double lon1, double lat2, double lon2)
+{
+    const double phi1 = lat1 * DEG_TO_RAD;
+    const double phi2 = lat2 * DEG_TO_RAD;
+    const double dLambda = (lon2 - lon1) * DEG_TO_RAD;
+    const double y = std::sin(dLambda) * std::cos(phi2);
+    const double x = std::cos(phi1) * std::sin(phi2) - std::sin(phi1) * std::cos(phi2) * std::cos(dLambda);
+    const double bearing = std::atan2(y, x) * RAD_TO_DEG;
+    return bearing < 0.0 ? bearing + 360.0 : bearing;
+}
+
+void destination(double lat, double lon, double bearingDeg, double distanceM, double& latOut, double& lonOut)
+{
+    const double delta = distanceM / EARTH_RADIUS_M;
+    const double theta = bearingDeg * DEG_TO_RAD;
+    const double phi1 = lat * DEG_TO_RAD;
+    const double sinPhi2 = std::sin(phi1) * std::cos(delta) + std::cos(phi1) * std::sin(delta) * std::cos(theta);
+    const double phi2 = std::asin(std::clamp(sinPhi2, -1.0, 1.0));
+    const double lambda2 = lon * DEG_TO_RAD
+                         + std::atan2(std::sin(theta) * std::sin(delta) * std::cos(phi1),
+                                      std::cos(delta) - std::sin(phi1) * sinPhi2);
+    latOut = phi2 * RAD_TO_DEG;
+    // 归一化到 [-180, 180)
+    lonOut = std::remainder(lambda2 * RAD_TO_DEG, 360.0);
+}
+
+void segmentDistances(const double* lat, const double* lon, int count, double* out)
+{
+    forEachBlock(lat, lon, count, [out](const UnitVectors& v, int start, int segments) {
+        double* o = out + start;
+        for (int i = 0; i < segments; ++i) {
+            // 单位球上的弦长 c，弧长 = 2·asin(c/2)；小距离下无 Haversine 的 1-cos 抵消误差
+            const double dx = v.cosLat[i + 1] * v.cosLon[i + 1] - v.cosLat[i] * v.cosLon[i];
+            const double dy = v.cosLat[i + 1] * v.sinLon[i + 1] - v.cosLat[i] * v.sinLon[i];
+            const double dz = v.sinLat[i + 1] - v.sinLat[i];
+            const double halfChord = 0.5 * std::sqrt(dx * dx + dy * dy + dz * dz);
+            o[i] = 2.0 * EARTH_RADIUS_M * std::asin(halfChord < 1.0 ? halfChord : 1.0);
+        }
+    });
+}
+
+void segmentBearings(const double* lat, const double* lon, int count, double* out)
+{
+    forEachBlock(lat, lon, count, [out](const UnitVectors& v, int start, int segments) {
+        double* o = out + start;
+        for (int i = 0; i < segments; ++i) {
+            // sin/cos(Δλ) 由两端经度的正余弦展开，不再逐段调用三角函数
+            const double sinDLon = v.sinLon[i + 1] * v.cosLon[i] - v.cosLon[i + 1] * v.sinLon[i];
+            const double cosDLon = v.cosLon[i + 1] * v.cosLon[i] + v.sinLon[i + 1] * v.sinLon[i];
+            const double y = sinDLon * v.cosLat[i + 1];
+            const double x = v.cosLat[i] * v.sinLat[i + 1] - v.sinLat[i] * v.cosLat[i + 1] * cosDLon;
+            const double bearing = std::atan2(y, x) * RAD_TO_DEG;
+            o[i] = bearing < 0.0 ? bearing + 360.0 : bearing;
+        }
+    });
+}
+
+double pathLength(const double* lat, const double* lon, int count)
+{
+    double segments[BLOCK_POINTS];
+    double total = 0.0;
+    for (int start = 0; start + 1 < count; start += BLOCK_POINTS) {
+        const int points = std::min(BLOCK_POINTS + 1, count - start);
+        segmentDistances(lat + start, lon + start, points, segments);
+        for (int i = 0; i < points - 1; ++i) total += segments[i];
+    }
+    return total;
+}
+
+double Odometer::add(double lat, double lon)
+{
+    if (!m_hasAnchor) {
+        m_lat = lat;
+        m_lon = lon;
+        m_hasAnchor = true;
+        return 0.0;
+    }
+
+    const double step = distance(m_lat, m_lon, lat, lon);
+    if (step > m_maxStep) {
+        m_lat = lat;
+        m_lon = lon;
+        return 0.0;
+    }
+    if (step < m_minStep) return 0.0;
+
+    m_lat = lat;
+    m_lon = lon;
+    m_total += step;
+    return step;
+}
+
+void Odometer::reset()
+{
+    m_hasAnchor = false;
+    m_total = 0.0;
+}
+
+}
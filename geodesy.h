@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cmath>
+
+// 大地测量计算（球面模型，平均地球半径）。
+// 批量接口以 SoA 形式（纬度数组、经度数组）处理整条航迹：先逐点求单位向量，再逐段求弦长换算弧长，
+// 每点只做一次三角函数，段循环内没有分支和虚调用，便于编译器向量化。
+// 适用于里程、任务航段与历史航迹统计；船只活动范围内与椭球模型的差异在 0.5% 以内。
+namespace Geodesy {
+
+constexpr double EARTH_RADIUS_M = 6371008.8;
+// 不依赖 M_PI：MSVC 的 <cmath> 只在定义 _USE_MATH_DEFINES 时才提供
+constexpr double PI = 3.14159265358979323846;
+constexpr double DEG_TO_RAD = PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / PI;
+
+// 两点间大圆距离（Haversine，米）
+inline double distance(double lat1, double lon1, double lat2, double lon2)
+{
+    const double sinLat = std::sin((lat2 - lat1) * DEG_TO_RAD / 2);
+    const double sinLon = std::sin((lon2 - lon1) * DEG_TO_RAD / 2);
+    const double h = sinLat * sinLat + std::cos(lat1 * DEG_TO_RAD) * std::cos(lat2 * DEG_TO_RAD) * sinLon * sinLon;
+    return 2.0 * EARTH_RADIUS_M * std::asin(std::sqrt(h < 1.0 ? h : 1.0));
+}
+
+// 初始方位角（度，正北为 0，顺时针 0~360）
+double initialBearing(double lat1, double lon1, double lat2, double lon2);
+
+// 从起点沿方位角 bearingDeg 航行 distanceM 米后的位置
+void destination(double lat, double lon, double bearingDeg, double distanceM, double& latOut, double& lonOut);
+
+// 批量计算相邻点之间的距离（米），out 需容纳 count - 1 个值
+void segmentDistances(const double* lat, const double* lon, int count, double* out);
+// 批量计算相邻点之间的初始方位角（度），out 需容纳 count - 1 个值
+void segmentBearings(const double* lat, const double* lon, int count, double* out);
+// 折线总长（米）
+double pathLength(const double* lat, const double* lon, int count);
+
+// 实时里程：累计相邻定位点的距离。小于 minStepM 的位移不立即计入而是继续累积，
+// 避免静止时定位噪声被当作航程；超过 maxStepM 的跳变视为定位异常并重新起算。
+class Odometer {
+public:
+    explicit Odometer(double minStepM = 0.5, double maxStepM = 1000.0)
+        : m_minStep(minStepM), m_maxStep(maxStepM) {}
+
+    // 返回本次计入的距离
+    double add(double lat, double lon);
+    void reset();
+    double total() const { return m_total; }
+
+private:
+    double m_minStep;
+    double m_maxStep;
+    double m_lat = 0.0;
+    double m_lon = 0.0;
+    bool m_hasAnchor = false;
+    double m_total = 0.0;
+};
+
+}
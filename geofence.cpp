@@ -0,0 +1,530 @@
+#include "geofence.h"
+#include "geodesy.h"
+#include "metrics.h"
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 叉积符号：c 在有向线段 a→b 的哪一侧
+inline double orient(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+}
+
+// 线段 p→q 是否穿过边 a→b。端点落在直线上时统一视为在负侧（半开规则），
+// 射线恰好经过顶点时相邻两条边只计一次
+inline bool crosses(double ax, double ay, double bx, double by,
+                    double px, double py, double qx, double qy)
+{
+    return (orient(ax, ay, bx, by, px, py) > 0) != (orient(ax, ay, bx, by, qx, qy) > 0)
+        && (orient(px, py, qx, qy, ax, ay) > 0) != (orient(px, py, qx, qy, bx, by) > 0);
+}
+
+inline double pointSegmentDistance(double px, double py, double ax, double ay, double bx, double by)
+{
+    const double dx = bx - ax;
+    const double dy = by - ay;
+    const double lengthSq = dx * dx + dy * dy;
+    double t = lengthSq > 0.0 ? ((px - ax) * dx + (py - ay) * dy) / lengthSq : 0.0;
+    t = std::clamp(t, 0.0, 1.0);
+    const double ex = ax + t * dx - px;
+    const double ey = ay + t * dy - py;
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+// Liang–Barsky 裁剪：线段是否与矩形相交（含边界）
+bool segmentTouchesRect(double ax, double ay, double bx, double by,
+                        double x0, double y0, double x1, double y1)
+{
+    double t0 = 0.0;
+    double t1 = 1.0;
+    auto clip = [&t0, &t1](double p, double q) {
+        if (p == 0.0) return q >= 0.0;
+        const double r = q / p;
+        if (p < 0.0) {
+            if (r > t1) return false;
+            if (r > t0) t0 = r;
+        } else {
+            if (r < t0) return false;
+            if (r < t1) t1 = r;
+        }
+        return true;
+    };
+    const double dx = bx - ax;
+    const double dy = by - ay;
+    return clip(-dx, ax - x0) && clip(dx, x1 - ax) && clip(-dy, ay - y0) && clip(dy, y1 - ay);
+}
+
+QVariantList toPath(const QVector<MissionPoint>& polygon)
+{
+    QVariantList path;
+    path.reserve(polygon.size());
+    for (const MissionPoint& point : polygon) {
+        path.append(QVariant::fromValue(QGeoCoordinate(point.latitude, point.longitude)));
+    }
+    return path;
+}
+
+}
+
+void GeofenceIndex::project(double latitude, double longitude, double& x, double& y) const
+{
+    x = (longitude - m_originLon) * m_metersPerDegLon;
+    y = (latitude - m_originLat) * m_metersPerDegLat;
+}
+
+void GeofenceIndex::build(const QVector<Geofence>& fences, double cellSizeM, double horizonM)
+{
+    m_fences = fences;
+    m_edges.clear();
+    m_entries.clear();
+    m_entryEdges.clear();
+    m_cellStart.clear();
+    m_cellSize = cellSizeM;
+    m_horizon = horizonM;
+    m_cols = 0;
+    m_rows = 0;
+
+    double minLat = 90.0, maxLat = -90.0, minLon = 180.0, maxLon = -180.0;
+    for (const Geofence& fence : m_fences) {
+        for (const MissionPoint& point : fence.polygon) {
+            minLat = std::min(minLat, point.latitude);
+            maxLat = std::max(maxLat, point.latitude);
+            minLon = std::min(minLon, point.longitude);
+            maxLon = std::max(maxLon, point.longitude);
+        }
+    }
+    if (minLat > maxLat) return;
+
+    m_originLat = (minLat + maxLat) / 2;
+    m_originLon = (minLon + maxLon) / 2;
+    m_metersPerDegLat = Geodesy::EARTH_RADIUS_M * Geodesy::DEG_TO_RAD;
+    m_metersPerDegLon = m_metersPerDegLat * std::cos(m_originLat * Geodesy::DEG_TO_RAD);
+
+    // 各围栏的边（投影平面）与外包框
+    QVector<int> edgeStart;
+    edgeStart.reserve(m_fences.size() + 1);
+    double minX = 0.0, minY = 0.0, maxX = 0.0, maxY = 0.0;
+    project(minLat, minLon, minX, minY);
+    project(maxLat, maxLon, maxX, maxY);
+    for (const Geofence& fence : m_fences) {
+        edgeStart.append(m_edges.size());
+        const int n = fence.polygon.size();
+        for (int i = 0; i < n; ++i) {
+            const MissionPoint& a = fence.polygon[i];
+            const MissionPoint& b = fence.polygon[(i + 1) % n];
+            Edge edge;
+            project(a.latitude, a.longitude, edge.ax, edge.ay);
+            project(b.latitude, b.longitude, edge.bx, edge.by);
+            m_edges.append(edge);
+        }
+    }
+    edgeStart.append(m_edges.size());
+
+    // 网格四周各留出 horizon，范围外的点距所有边界都超过 horizon
+    m_minX = minX - m_horizon;
+    m_minY = minY - m_horizon;
+    const double width = maxX - minX + 2 * m_horizon;
+    const double height = maxY - minY + 2 * m_horizon;
+    while (std::ceil(width / m_cellSize) * std::ceil(height / m_cellSize) > MAX_CELLS) {
+        m_cellSize *= 1.5;
+    }
+    m_cols = std::max(1, static_cast<int>(std::ceil(width / m_cellSize)));
+    m_rows = std::max(1, static_cast<int>(std::ceil(height / m_cellSize)));
+
+    auto colOf = [this](double x) { return std::clamp(static_cast<int>((x - m_minX) / m_cellSize), 0, m_cols - 1); };
+    auto rowOf = [this](double y) { return std::clamp(static_cast<int>((y - m_minY) / m_cellSize), 0, m_rows - 1); };
+    const double eps = 1e-6;
+
+    QVector<QVector<int>> cellEdges;
+    QVector<double> crossings;
+    for (int f = 0; f < m_fences.size(); ++f) {
+        if (edgeStart[f] == edgeStart[f + 1]) continue;
+
+        double fx0 = m_edges[edgeStart[f]].ax, fx1 = fx0;
+        double fy0 = m_edges[edgeStart[f]].ay, fy1 = fy0;
+        for (int e = edgeStart[f]; e < edgeStart[f + 1]; ++e) {
+            fx0 = std::min(fx0, m_edges[e].ax);
+            fx1 = std::max(fx1, m_edges[e].ax);
+            fy0 = std::min(fy0, m_edges[e].ay);
+            fy1 = std::max(fy1, m_edges[e].ay);
+        }
+        const int c0 = colOf(fx0), c1 = colOf(fx1);
+        const int r0 = rowOf(fy0), r1 = rowOf(fy1);
+        const int boxCols = c1 - c0 + 1;
+
+        // 边 → 与之相交的格子
+        cellEdges.fill(QVector<int>(), boxCols * (r1 - r0 + 1));
+        for (int e = edgeStart[f]; e < edgeStart[f + 1]; ++e) {
+            const Edge& edge = m_edges[e];
+            const int ec0 = colOf(std::min(edge.ax, edge.bx)), ec1 = colOf(std::max(edge.ax, edge.bx));
+            const int er0 = rowOf(std::min(edge.ay, edge.by)), er1 = rowOf(std::max(edge.ay, edge.by));
+            for (int row = er0; row <= er1; ++row) {
+                for (int col = ec0; col <= ec1; ++col) {
+                    const double x0 = m_minX + col * m_cellSize;
+                    const double y0 = m_minY + row * m_cellSize;
+                    if (segmentTouchesRect(edge.ax, edge.ay, edge.bx, edge.by,
+                                           x0 - eps, y0 - eps, x0 + m_cellSize + eps, y0 + m_cellSize + eps)) {
+                        cellEdges[(row - r0) * boxCols + (col - c0)].append(e);
+                    }
+                }
+            }
+        }
+
+        // 逐行扫描格子中心，确定中心点是否在围栏内
+        for (int row = r0; row <= r1; ++row) {
+            const double y = cellCenterY(row);
+            crossings.clear();
+            for (int e = edgeStart[f]; e < edgeStart[f + 1]; ++e) {
+                const Edge& edge = m_edges[e];
+                if ((edge.ay > y) != (edge.by > y)) {
+                    crossings.append(edge.ax + (y - edge.ay) * (edge.bx - edge.ax) / (edge.by - edge.ay));
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            int k = 0;
+            bool inside = false;
+            for (int col = c0; col <= c1; ++col) {
+                const double x = cellCenterX(col);
+                while (k < crossings.size() && crossings[k] < x) {
+                    inside = !inside;
+                    ++k;
+                }
+                const QVector<int>& edges = cellEdges[(row - r0) * boxCols + (col - c0)];
+                if (!inside && edges.isEmpty()) continue;
+
+                Entry entry;
+                entry.cell = row * m_cols + col;
+                entry.fence = f;
+                entry.centerInside = inside;
+                entry.edgeBegin = m_entryEdges.size();
+                m_entryEdges.append(edges);
+                entry.edgeEnd = m_entryEdges.size();
+                m_entries.append(entry);
+            }
+        }
+    }
+
+    // 按格子排序后建立偏移表
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+                     [](const Entry& a, const Entry& b) { return a.cell < b.cell; });
+    m_cellStart.fill(0, m_cols * m_rows + 1);
+    for (const Entry& entry : m_entries) ++m_cellStart[entry.cell + 1];
+    for (int i = 0; i < m_cols * m_rows; ++i) m_cellStart[i + 1] += m_cellStart[i];
+}
+
+void GeofenceIndex::query(double latitude, double longitude, QVector<Hit>& hits) const
+{
+    hits.clear();
+    if (m_cols == 0) return;
+
+    double x, y;
+    project(latitude, longitude, x, y);
+    const int col = static_cast<int>(std::floor((x - m_minX) / m_cellSize));
+    const int row = static_cast<int>(std::floor((y - m_minY) / m_cellSize));
+
+    auto hitFor = [this, &hits](int fence) -> Hit& {
+        for (Hit& hit : hits) {
+            if (hit.fence == fence) return hit;
+        }
+        hits.append({fence, false, m_horizon});
+        return hits.last();
+    };
+
+    // 包含判断：只看所在格子
+    if (col >= 0 && col < m_cols && row >= 0 && row < m_rows) {
+        const int cell = row * m_cols + col;
+        const double cx = cellCenterX(col);
+        const double cy = cellCenterY(row);
+        for (int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i) {
+            const Entry& entry = m_entries[i];
+            bool inside = entry.centerInside;
+            for (int k = entry.edgeBegin; k < entry.edgeEnd; ++k) {
+                const Edge& edge = m_edges[m_entryEdges[k]];
+                if (crosses(edge.ax, edge.ay, edge.bx, edge.by, cx, cy, x, y)) inside = !inside;
+            }
+            if (inside) hitFor(entry.fence).inside = true;
+        }
+    }
+
+    // 边界距离：检查 horizon 范围内的格子
+    const int reach = static_cast<int>(std::ceil(m_horizon / m_cellSize));
+    const int rowBegin = std::max(0, row - reach), rowEnd = std::min(m_rows - 1, row + reach);
+    const int colBegin = std::max(0, col - reach), colEnd = std::min(m_cols - 1, col + reach);
+    for (int r = rowBegin; r <= rowEnd; ++r) {
+        const double y0 = m_minY + r * m_cellSize;
+        const double dy = std::max({0.0, y0 - y, y - (y0 + m_cellSize)});
+        for (int c = colBegin; c <= colEnd; ++c) {
+            const int cell = r * m_cols + c;
+            if (m_cellStart[cell] == m_cellStart[cell + 1]) continue;
+            const double x0 = m_minX + c * m_cellSize;
+            const double dx = std::max({0.0, x0 - x, x - (x0 + m_cellSize)});
+            if (dx * dx + dy * dy >= m_horizon * m_horizon) continue;
+
+            for (int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i) {
+                const Entry& entry = m_entries[i];
+                for (int k = entry.edgeBegin; k < entry.edgeEnd; ++k) {
+                    const Edge& edge = m_edges[m_entryEdges[k]];
+                    const double d = pointSegmentDistance(x, y, edge.ax, edge.ay, edge.bx, edge.by);
+                    if (d < m_horizon) {
+                        Hit& hit = hitFor(entry.fence);
+                        hit.distance = std::min(hit.distance, d);
+                    }
+                }
+            }
+        }
+    }
+}
+
+GeofenceManager::GeofenceManager(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_checkLatency = metrics.histogram("usv_geofence_check_duration_seconds", "Time spent checking one position fix against all geofences");
+    m_transitions = metrics.counter("usv_geofence_transitions_total", "Geofence enter and exit transitions");
+    m_breaches = metrics.counter("usv_geofence_breaches_total", "Keep-out zone entries and survey area exits");
+}
+
+int GeofenceManager::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_fences.size();
+}
+
+QVariant GeofenceManager::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_fences.size()) return QVariant();
+
+    const Geofence& fence = m_fences.at(index.row());
+    const FenceState& state = m_states.at(index.row());
+    switch (role) {
+    case FenceIdRole: return fence.id;
+    case NameRole: return fence.name;
+    case KindRole: return static_cast<int>(fence.kind);
+    case PathRole: return toPath(fence.polygon);
+    case InsideRole: return state.inside;
+    case DistanceRole: return state.distance;
+    case BreachedRole: return isBreached(index.row());
+    default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> GeofenceManager::roleNames() const
+{
+    return {
+        {FenceIdRole, "fenceId"},
+        {NameRole, "name"},
+        {KindRole, "kind"},
+        {PathRole, "path"},
+        {InsideRole, "inside"},
+        {DistanceRole, "distance"},
+        {BreachedRole, "breached"}
+    };
+}
+
+int GeofenceManager::addFence(const QString& name, int kind, const QVariantList& path)
+{
+    Geofence fence;
+    fence.name = name;
+    fence.kind = kind == Geofence::Survey ? Geofence::Survey : Geofence::KeepOut;
+    for (const QVariant& value : path) {
+        const QGeoCoordinate coordinate = value.value<QGeoCoordinate>();
+        if (coordinate.isValid()) fence.polygon.append({coordinate.longitude(), coordinate.latitude()});
+    }
+    if (fence.polygon.size() < 3) return -1;
+    fence.id = m_nextId++;
+
+    beginInsertRows(QModelIndex(), m_fences.size(), m_fences.size());
+    m_fences.append(fence);
+    m_states.append(FenceState());
+    endInsertRows();
+    rebuild();
+    emit countChanged();
+    return fence.id;
+}
+
+int GeofenceManager::loadFromFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "无法打开围栏文件:" << path << file.errorString();
+        return 0;
+    }
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        qWarning() << "围栏文件解析失败:" << path << error.errorString();
+        return 0;
+    }
+
+    QVector<Geofence> fences = m_fences;
+    const int before = fences.size();
+    const QJsonArray features = document.object().value("features").toArray();
+    for (const QJsonValue& value : features) {
+        const QJsonObject feature = value.toObject();
+        const QJsonObject properties = feature.value("properties").toObject();
+        const QJsonObject geometry = feature.value("geometry").toObject();
+        const QString type = geometry.value("type").toString();
+
+        QJsonArray polygons;
+        if (type == QLatin1String("Polygon")) {
+            polygons.append(geometry.value("coordinates"));
+        } else if (type == QLatin1String("MultiPolygon")) {
+            polygons = geometry.value("coordinates").toArray();
+        } else {
+            continue;
+        }
+
+        for (const QJsonValue& polygon : polygons) {
+            // 只取外环，内环（洞）不参与判断
+            const QJsonArray ring = polygon.toArray().at(0).toArray();
+            Geofence fence;
+            fence.name = properties.value("name").toString();
+            fence.kind = properties.value("kind").toString().compare("survey", Qt::CaseInsensitive) == 0
+                             ? Geofence::Survey : Geofence::KeepOut;
+            for (const QJsonValue& vertex : ring) {
+                const QJsonArray position = vertex.toArray();
+                fence.polygon.append({position.at(0).toDouble(), position.at(1).toDouble()});
+            }
+            // GeoJSON 的环首尾重复
+            if (fence.polygon.size() > 1
+                && fence.polygon.first().longitude == fence.polygon.last().longitude
+                && fence.polygon.first().latitude == fence.polygon.last().latitude) {
+                fence.polygon.removeLast();
+            }
+            if (fence.polygon.size() < 3) continue;
+            fences.append(fence);
+        }
+    }
+
+    setFences(fences);
+    qDebug() << "已载入围栏:" << fences.size() - before << "个，来自" << path;
+    return fences.size() - before;
+}
+
+void GeofenceManager::removeFence(int fenceId)
+{
+    for (int row = 0; row < m_fences.size(); ++row) {
+        if (m_fences[row].id != fenceId) continue;
+
+        beginRemoveRows(QModelIndex(), row, row);
+        m_fences.removeAt(row);
+        m_states.removeAt(row);
+        endRemoveRows();
+        rebuild();
+        emit countChanged();
+        return;
+    }
+}
+
+void GeofenceManager::clear()
+{
+    if (m_fences.isEmpty()) return;
+
+    beginResetModel();
+    m_fences.clear();
+    m_states.clear();
+    endResetModel();
+    rebuild();
+    emit countChanged();
+}
+
+QVariantList GeofenceManager::surveyPath() const
+{
+    for (const Geofence& fence : m_fences) {
+        if (fence.kind == Geofence::Survey) return toPath(fence.polygon);
+    }
+    return QVariantList();
+}
+
+void GeofenceManager::setFences(const QVector<Geofence>& fences)
+{
+    // 已有围栏保留进出状态，避免重新载入时重复报告进入
+    QHash<int, FenceState> previous;
+    for (int row = 0; row < m_fences.size(); ++row) {
+        previous.insert(m_fences[row].id, m_states[row]);
+    }
+
+    beginResetModel();
+    m_fences = fences;
+    m_states.clear();
+    m_states.reserve(m_fences.size());
+    for (Geofence& fence : m_fences) {
+        if (fence.id <= 0) fence.id = m_nextId++;
+        m_nextId = qMax(m_nextId, fence.id + 1);
+        m_states.append(previous.value(fence.id));
+    }
+    endResetModel();
+    rebuild();
+    emit countChanged();
+}
+
+void GeofenceManager::updatePosition(double latitude, double longitude)
+{
+    const qint64 startNs = MetricsClock::nowNs();
+    m_index.query(latitude, longitude, m_hits);
+    const qint64 elapsedNs = MetricsClock::nowNs() - startNs;
+    m_checkLatency->observe(elapsedNs);
+    m_lastCheckUs = elapsedNs / 1000.0;
+
+    auto apply = [&](int row, bool inside, double distance) {
+        FenceState& state = m_states[row];
+        const bool wasBreached = isBreached(row);
+        const bool changed = state.inside != inside || state.distance != distance;
+        const bool entered = inside && !state.inside;
+        const bool exited = !inside && state.inside;
+        state.inside = inside;
+        state.distance = distance;
+
+        if (entered || exited) {
+            const Geofence& fence = m_fences[row];
+            const bool breach = fence.kind == Geofence::KeepOut ? entered : state.visited;
+            if (entered) state.visited = true;
+            m_transitions->add();
+            if (breach) m_breaches->add();
+            emit transition(fence.id, fence.name, fence.kind, entered, breach, latitude, longitude);
+        }
+
+        m_breachCount += static_cast<int>(isBreached(row)) - static_cast<int>(wasBreached);
+        if (changed) emit dataChanged(index(row), index(row), {InsideRole, DistanceRole, BreachedRole});
+    };
+
+    // 只更新本次与上次命中的围栏，开销与围栏总数无关
+    QVector<int> previous;
+    previous.swap(m_nearby);
+    for (const GeofenceIndex::Hit& hit : qAsConst(m_hits)) {
+        m_nearby.append(hit.fence);
+        apply(hit.fence, hit.inside, hit.distance < m_index.horizon() ? hit.distance : -1.0);
+    }
+    for (int row : qAsConst(previous)) {
+        if (!m_nearby.contains(row)) apply(row, false, -1.0);
+    }
+
+    emit statusChanged();
+}
+
+bool GeofenceManager::isBreached(int row) const
+{
+    const FenceState& state = m_states[row];
+    return m_fences[row].kind == Geofence::KeepOut ? state.inside : state.visited && !state.inside;
+}
+
+void GeofenceManager::rebuild()
+{
+    m_index.build(m_fences);
+
+    m_nearby.clear();
+    m_breachCount = 0;
+    for (int row = 0; row < m_fences.size(); ++row) {
+        if (m_states[row].inside || m_states[row].distance >= 0.0) m_nearby.append(row);
+        if (isBreached(row)) ++m_breachCount;
+    }
+    emit statusChanged();
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "frame_codec.h"
+#include <QAbstractListModel>
+#include <QGeoCoordinate>
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+
+class MetricCounter;
+class LatencyHistogram;
+
+// 电子围栏：禁入区（进入即告警）或作业区（驶离即告警）
+struct Geofence {
+    enum Kind { KeepOut = 0, Survey = 1 };
+
+    int id = 0;
+    QString name;
+    Kind kind = KeepOut;
+    QVector<MissionPoint> polygon;  // 外环顶点，首尾不重复，方向不限
+};
+
+// 围栏空间索引：所有围栏投影到以围栏范围中心为原点的局部等距平面（米），
+// 叠加均匀网格，每个格子记录与之相交的围栏、该围栏穿过格子的边以及格子中心是否在围栏内。
+// 判断点是否在围栏内只需统计“格子中心 → 该点”线段与格内边的交点奇偶；
+// 边界距离只检查 horizon 范围内的格子。单次查询的开销取决于附近的边数，与围栏总数无关。
+class GeofenceIndex {
+public:
+    struct Hit {
+        int fence;          // fences() 下标
+        bool inside;
+        double distance;    // 到围栏边界的距离（米），超出 horizon 时为 horizon
+    };
+
+    static constexpr double DEFAULT_CELL_SIZE_M = 100.0;
+    static constexpr double DEFAULT_HORIZON_M = 500.0;
+    static constexpr int MAX_CELLS = 1 << 22;
+
+    void build(const QVector<Geofence>& fences,
+               double cellSizeM = DEFAULT_CELL_SIZE_M, double horizonM = DEFAULT_HORIZON_M);
+    // 返回包含该点、或边界在 horizon 以内的围栏；hits 由调用方复用以避免分配
+    void query(double latitude, double longitude, QVector<Hit>& hits) const;
+
+    const QVector<Geofence>& fences() const { return m_fences; }
+    double horizon() const { return m_horizon; }
+    double cellSize() const { return m_cellSize; }
+    int cellCount() const { return m_cols * m_rows; }
+    int entryCount() const { return m_entries.size(); }
+
+private:
+    struct Edge {
+        double ax, ay, bx, by;
+    };
+    struct Entry {
+        int cell;
+        int fence;
+        bool centerInside;
+        int edgeBegin;      // m_entryEdges 中的区间
+        int edgeEnd;
+    };
+
+    void project(double latitude, double longitude, double& x, double& y) const;
+    double cellCenterX(int col) const { return m_minX + (col + 0.5) * m_cellSize; }
+    double cellCenterY(int row) const { return m_minY + (row + 0.5) * m_cellSize; }
+
+    QVector<Geofence> m_fences;
+    QVector<Edge> m_edges;
+    QVector<Entry> m_entries;       // 按格子排序
+    QVector<int> m_cellStart;       // 每个格子在 m_entries 中的起点，长度为格子数 + 1
+    QVector<int> m_entryEdges;
+
+    double m_originLat = 0.0;
+    double m_originLon = 0.0;
+    double m_metersPerDegLat = 0.0;
+    double m_metersPerDegLon = 0.0;
+    double m_minX = 0.0;
+    double m_minY = 0.0;
+    double m_cellSize = DEFAULT_CELL_SIZE_M;
+    double m_horizon = DEFAULT_HORIZON_M;
+    int m_cols = 0;
+    int m_rows = 0;
+};
+
+// 围栏管理：保存围栏列表供地图绘制，对每个定位点检查进出状态并发出 transition 信号。
+// 禁入区进入、作业区驶离记为越界（breach）。
+class GeofenceManager : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(int breachCount READ breachCount NOTIFY statusChanged)
+    Q_PROPERTY(double lastCheckUs READ lastCheckUs NOTIFY statusChanged)
+public:
+    enum Roles {
+        FenceIdRole = Qt::UserRole + 1,
+        NameRole,
+        KindRole,
+        PathRole,
+        InsideRole,
+        DistanceRole,       // 到边界的距离（米），超出检测范围时为 -1
+        BreachedRole
+    };
+
+    explicit GeofenceManager(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int breachCount() const { return m_breachCount; }
+    double lastCheckUs() const { return m_lastCheckUs; }
+
+    // path 为 QGeoCoordinate 列表；返回围栏 id，顶点不足 3 个时返回 -1
+    Q_INVOKABLE int addFence(const QString& name, int kind, const QVariantList& path);
+    // 载入 GeoJSON（Polygon / MultiPolygon 外环），properties.name 为名称，
+    // properties.kind 为 "keepout" 或 "survey"；返回载入的围栏数
+    Q_INVOKABLE int loadFromFile(const QString& path);
+    Q_INVOKABLE void removeFence(int fenceId);
+    Q_INVOKABLE void clear();
+    // 第一个作业区围栏的顶点（QGeoCoordinate 列表），没有作业区时为空
+    Q_INVOKABLE QVariantList surveyPath() const;
+
+    // 批量替换围栏（只重建一次索引）
+    void setFences(const QVector<Geofence>& fences);
+
+public slots:
+    void updatePosition(double latitude, double longitude);
+
+signals:
+    void countChanged();
+    void statusChanged();
+    void transition(int fenceId, const QString& name, int kind, bool entered, bool breach,
+                    double latitude, double longitude);
+
+private:
+    struct FenceState {
+        bool inside = false;
+        bool visited = false;       // 作业区：曾经进入过
+        double distance = -1.0;
+    };
+
+    bool isBreached(int row) const;
+    void rebuild();
+
+    QVector<Geofence> m_fences;
+    QVector<FenceState> m_states;
+    GeofenceIndex m_index;
+    QVector<GeofenceIndex::Hit> m_hits;
+    QVector<int> m_nearby;          // 上一次查询命中的围栏下标
+    int m_nextId = 1;
+    int m_breachCount = 0;
+    double m_lastCheckUs = 0.0;
+
+    LatencyHistogram* m_checkLatency;
+    MetricCounter* m_transitions;
+    MetricCounter* m_breaches;
+};
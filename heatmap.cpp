@@ -0,0 +1,407 @@
+#include "heatmap.h"
+#include "database.h"
+#include "geodesy.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+void HeatmapPyramid::Cell::add(const float* values)
+{
+    for (int c = 0; c < HeatmapSample::CHANNEL_COUNT; ++c) {
+        if (count == 0) {
+            min[c] = values[c];
+            max[c] = values[c];
+        } else {
+            min[c] = std::min(min[c], values[c]);
+            max[c] = std::max(max[c], values[c]);
+        }
+        sum[c] += values[c];
+    }
+    ++count;
+}
+
+void HeatmapPyramid::Cell::merge(const Cell& other)
+{
+    if (other.count == 0) return;
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    for (int c = 0; c < HeatmapSample::CHANNEL_COUNT; ++c) {
+        min[c] = std::min(min[c], other.min[c]);
+        max[c] = std::max(max[c], other.max[c]);
+        sum[c] += other.sum[c];
+    }
+    count += other.count;
+}
+
+void HeatmapPyramid::project(double latitude, double longitude, double& x, double& y)
+{
+    const double clampedLat = std::clamp(latitude, -85.05112878, 85.05112878);
+    const double sinLat = std::sin(clampedLat * Geodesy::DEG_TO_RAD);
+    x = (longitude + 180.0) / 360.0;
+    y = 0.5 - std::log((1.0 + sinLat) / (1.0 - sinLat)) / (4.0 * Geodesy::PI);
+}
+
+void HeatmapPyramid::add(const HeatmapSample& sample)
+{
+    double x, y;
+    project(sample.latitude, sample.longitude, x, y);
+    const double scale = static_cast<double>(1u << MAX_LEVEL);
+    const quint32 limit = (1u << MAX_LEVEL) - 1;
+    const quint32 cellX = std::min(limit, static_cast<quint32>(std::clamp(x, 0.0, 1.0) * scale));
+    const quint32 cellY = std::min(limit, static_cast<quint32>(std::clamp(y, 0.0, 1.0) * scale));
+
+    for (int level = MIN_LEVEL; level <= MAX_LEVEL; ++level) {
+        const int shift = MAX_LEVEL - level;
+        m_levels[level - MIN_LEVEL][key(cellX >> shift, cellY >> shift)].add(sample.values);
+    }
+    m_total.add(sample.values);
+}
+
+void HeatmapPyramid::merge(const HeatmapPyramid& other)
+{
+    for (int i = 0; i < LEVEL_COUNT; ++i) {
+        QHash<quint64, Cell>& level = m_levels[i];
+        for (auto it = other.m_levels[i].constBegin(); it != other.m_levels[i].constEnd(); ++it) {
+            level[it.key()].merge(it.value());
+        }
+    }
+    m_total.merge(other.m_total);
+}
+
+void HeatmapPyramid::clear()
+{
+    for (QHash<quint64, Cell>& level : m_levels) level.clear();
+    m_total = Cell();
+}
+
+const HeatmapPyramid::Cell* HeatmapPyramid::cell(int level, quint32 x, quint32 y) const
+{
+    if (level < MIN_LEVEL || level > MAX_LEVEL) return nullptr;
+    const QHash<quint64, Cell>& cells = m_levels[level - MIN_LEVEL];
+    const auto it = cells.constFind(key(x, y));
+    return it == cells.constEnd() ? nullptr : &it.value();
+}
+
+HeatmapPyramid HeatmapPyramid::build(const QVector<HeatmapSample>& samples, int threads)
+{
+    // 每线程至少分到一万个样本，否则线程开销大于收益
+    threads = std::clamp(threads, 1, samples.size() / 10000 + 1);
+    std::vector<HeatmapPyramid> partial(threads);
+    const int slice = (samples.size() + threads - 1) / threads;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&samples, &partial, slice, t]() {
+            const int end = std::min(samples.size(), (t + 1) * slice);
+            for (int i = t * slice; i < end; ++i) partial[t].add(samples[i]);
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    workers.clear();
+
+    // 按级别并行合并：各级别互不相关
+    HeatmapPyramid result = std::move(partial[0]);
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&result, &partial, threads, t]() {
+            for (int i = t; i < LEVEL_COUNT; i += threads) {
+                QHash<quint64, Cell>& level = result.m_levels[i];
+                for (int p = 1; p < threads; ++p) {
+                    const QHash<quint64, Cell>& source = partial[p].m_levels[i];
+                    for (auto it = source.constBegin(); it != source.constEnd(); ++it) {
+                        level[it.key()].merge(it.value());
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    for (int p = 1; p < threads; ++p) result.m_total.merge(partial[p].m_total);
+    return result;
+}
+
+QRgb heatmapColor(double t, int alpha)
+{
+    static const int stops[5][3] = {
+        {0, 0, 255}, {0, 200, 255}, {0, 210, 60}, {255, 220, 0}, {230, 20, 20}
+    };
+    t = std::clamp(t, 0.0, 1.0) * 4.0;
+    const int i = std::min(3, static_cast<int>(t));
+    const double f = t - i;
+    auto channel = [&](int c) {
+        const double value = stops[i][c] + f * (stops[i + 1][c] - stops[i][c]);
+        return static_cast<int>(value * alpha / 255.0);
+    };
+    return qRgba(channel(0), channel(1), channel(2), alpha);
+}
+
+namespace {
+
+QGeoCoordinate tileCorner(int zoom, int x, int y)
+{
+    const double n = static_cast<double>(1 << zoom);
+    const double longitude = x / n * 360.0 - 180.0;
+    const double latitude = std::atan(std::sinh(Geodesy::PI * (1.0 - 2.0 * y / n))) * Geodesy::RAD_TO_DEG;
+    return QGeoCoordinate(latitude, longitude);
+}
+
+}
+
+HeatmapLayer::HeatmapLayer(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int HeatmapLayer::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() || !enabled() ? 0 : m_tiles.size();
+}
+
+QVariant HeatmapLayer::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_tiles.size()) return QVariant();
+
+    const Tile& tile = m_tiles.at(index.row());
+    switch (role) {
+    case CoordinateRole: return QVariant::fromValue(tileCorner(m_tileZoom, tile.x, tile.y));
+    case TileZoomRole: return m_tileZoom;
+    case SourceRole:
+        return QString("image://heatmap/%1/%2/%3/%4/%5")
+            .arg(m_channel).arg(m_tileZoom).arg(tile.x).arg(tile.y).arg(tile.revision);
+    default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> HeatmapLayer::roleNames() const
+{
+    return {
+        {CoordinateRole, "coordinate"},
+        {TileZoomRole, "tileZoom"},
+        {SourceRole, "source"}
+    };
+}
+
+void HeatmapLayer::setChannel(int channel)
+{
+    channel = std::clamp(channel, -1, HeatmapSample::CHANNEL_COUNT - 1);
+    if (channel == m_channel) return;
+
+    beginResetModel();
+    m_channel = channel;
+    endResetModel();
+    emit channelChanged();
+}
+
+int HeatmapLayer::sampleCount() const
+{
+    QReadLocker locker(&m_lock);
+    return static_cast<int>(m_pyramid.total().count);
+}
+
+double HeatmapLayer::minimum() const
+{
+    QReadLocker locker(&m_lock);
+    return m_channel >= 0 && m_pyramid.total().count ? m_pyramid.total().min[m_channel] : 0.0;
+}
+
+double HeatmapLayer::maximum() const
+{
+    QReadLocker locker(&m_lock);
+    return m_channel >= 0 && m_pyramid.total().count ? m_pyramid.total().max[m_channel] : 0.0;
+}
+
+void HeatmapLayer::setViewport(const QGeoCoordinate& topLeft, const QGeoCoordinate& bottomRight, double zoomLevel)
+{
+    if (!topLeft.isValid() || !bottomRight.isValid()) return;
+
+    double x0, y0, x1, y1;
+    HeatmapPyramid::project(topLeft.latitude(), topLeft.longitude(), x0, y0);
+    HeatmapPyramid::project(bottomRight.latitude(), bottomRight.longitude(), x1, y1);
+
+    // 瓦片级别跟随地图缩放；可见瓦片过多时退到更粗的级别
+    const int minZoom = HeatmapPyramid::MIN_LEVEL - CELL_LEVELS_PER_TILE;
+    const int maxZoom = HeatmapPyramid::MAX_LEVEL - CELL_LEVELS_PER_TILE;
+    int zoom = std::clamp(static_cast<int>(std::floor(zoomLevel)), minZoom, maxZoom);
+    int tx0, ty0, tx1, ty1;
+    forever {
+        const int n = 1 << zoom;
+        tx0 = std::clamp(static_cast<int>(std::min(x0, x1) * n), 0, n - 1);
+        tx1 = std::clamp(static_cast<int>(std::max(x0, x1) * n), 0, n - 1);
+        ty0 = std::clamp(static_cast<int>(std::min(y0, y1) * n), 0, n - 1);
+        ty1 = std::clamp(static_cast<int>(std::max(y0, y1) * n), 0, n - 1);
+        if ((tx1 - tx0 + 1) * (ty1 - ty0 + 1) <= MAX_VISIBLE_TILES || zoom == minZoom) break;
+        --zoom;
+    }
+
+    if (zoom == m_tileZoom && !m_tiles.isEmpty()
+        && m_tiles.first().x == tx0 && m_tiles.first().y == ty0
+        && m_tiles.last().x == tx1 && m_tiles.last().y == ty1) {
+        return;
+    }
+
+    // 新瓦片使用当前版本号：此前缓存的同名图像一定不含之后的样本
+    beginResetModel();
+    m_tileZoom = zoom;
+    m_tiles.clear();
+    for (int y = ty0; y <= ty1; ++y) {
+        for (int x = tx0; x <= tx1; ++x) {
+            m_tiles.append({x, y, m_revision});
+        }
+    }
+    endResetModel();
+}
+
+void HeatmapLayer::addSample(double latitude, double longitude, double turbidity, double tds, double ph)
+{
+    HeatmapSample sample;
+    sample.latitude = latitude;
+    sample.longitude = longitude;
+    sample.values[HeatmapSample::Turbidity] = static_cast<float>(turbidity);
+    sample.values[HeatmapSample::Tds] = static_cast<float>(tds);
+    sample.values[HeatmapSample::Ph] = static_cast<float>(ph);
+    {
+        QWriteLocker locker(&m_lock);
+        m_pyramid.add(sample);
+    }
+    if (m_rebuilding) m_backlog.append(sample);
+    ++m_revision;
+
+    // 只刷新样本所在的可见瓦片
+    if (!m_tiles.isEmpty()) {
+        double x, y;
+        HeatmapPyramid::project(latitude, longitude, x, y);
+        const int n = 1 << m_tileZoom;
+        const int tileX = static_cast<int>(x * n);
+        const int tileY = static_cast<int>(y * n);
+        for (int row = 0; row < m_tiles.size(); ++row) {
+            if (m_tiles[row].x == tileX && m_tiles[row].y == tileY) {
+                m_tiles[row].revision = m_revision;
+                if (enabled()) emit dataChanged(index(row), index(row), {SourceRole});
+                break;
+            }
+        }
+    }
+    emit samplesChanged();
+}
+
+void HeatmapLayer::rebuildFromHistory(const QDateTime& from, const QDateTime& to)
+{
+    if (!m_database || m_rebuilding) return;
+    m_rebuilding = true;
+    emit rebuildingChanged();
+
+    // 数据库线程读取带位置的样本，随后交给工作线程并行分箱
+    Database* database = m_database;
+    QMetaObject::invokeMethod(database, [this, database, from, to]() {
+        auto samples = std::make_shared<QVector<HeatmapSample>>();
+        GeoSampleQuery query;
+        query.from = from;
+        query.to = to;
+        database->georeferencedSamples(query, [&samples](const QVector<GeoSample>& chunk) {
+            for (const GeoSample& geo : chunk) {
+                HeatmapSample sample;
+                sample.latitude = geo.latitude;
+                sample.longitude = geo.longitude;
+                sample.values[HeatmapSample::Turbidity] = geo.turbidity;
+                sample.values[HeatmapSample::Tds] = geo.tds;
+                sample.values[HeatmapSample::Ph] = static_cast<float>(geo.ph);
+                samples->append(sample);
+            }
+            return true;
+        });
+
+        QMetaObject::invokeMethod(this, [this, samples]() {
+            auto pyramid = std::make_shared<HeatmapPyramid>();
+            auto elapsedMs = std::make_shared<double>(0.0);
+            QThread* worker = QThread::create([samples, pyramid, elapsedMs]() {
+                QElapsedTimer timer;
+                timer.start();
+                *pyramid = HeatmapPyramid::build(*samples, QThread::idealThreadCount());
+                *elapsedMs = timer.nsecsElapsed() / 1e6;
+            });
+            worker->setObjectName("HeatmapRebuild");
+            connect(worker, &QThread::finished, this, [this, worker, pyramid, elapsedMs, count = samples->size()]() {
+                applyRebuild(pyramid, count, *elapsedMs);
+                worker->deleteLater();
+            });
+            worker->start();
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void HeatmapLayer::applyRebuild(const std::shared_ptr<HeatmapPyramid>& pyramid, int samples, double elapsedMs)
+{
+    {
+        QWriteLocker locker(&m_lock);
+        m_pyramid = std::move(*pyramid);
+        for (const HeatmapSample& sample : qAsConst(m_backlog)) m_pyramid.add(sample);
+    }
+    m_backlog.clear();
+    ++m_revision;
+
+    beginResetModel();
+    for (Tile& tile : m_tiles) tile.revision = m_revision;
+    endResetModel();
+
+    m_rebuilding = false;
+    qDebug() << "热力图重建完成，样本数:" << samples << "耗时:" << elapsedMs << "ms";
+    emit rebuildingChanged();
+    emit samplesChanged();
+    emit rebuildFinished(samples, elapsedMs);
+}
+
+QImage HeatmapLayer::renderTile(int channel, int zoom, int tileX, int tileY) const
+{
+    QImage image(TILE_SIZE, TILE_SIZE, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    if (channel < 0 || channel >= HeatmapSample::CHANNEL_COUNT) return image;
+
+    QReadLocker locker(&m_lock);
+    const HeatmapPyramid::Cell& total = m_pyramid.total();
+    if (total.count == 0) return image;
+
+    const int level = std::min(zoom + CELL_LEVELS_PER_TILE, static_cast<int>(HeatmapPyramid::MAX_LEVEL));
+    const int cellsPerTile = 1 << (level - zoom);
+    const int cellPixels = TILE_SIZE / cellsPerTile;
+    const double low = total.min[channel];
+    const double range = std::max(1e-6, static_cast<double>(total.max[channel]) - low);
+
+    for (int cy = 0; cy < cellsPerTile; ++cy) {
+        for (int cx = 0; cx < cellsPerTile; ++cx) {
+            const HeatmapPyramid::Cell* cell = m_pyramid.cell(level, static_cast<quint32>(tileX) * cellsPerTile + cx,
+                                                              static_cast<quint32>(tileY) * cellsPerTile + cy);
+            if (!cell) continue;
+
+            const QRgb color = heatmapColor((cell->mean(channel) - low) / range, 170);
+            for (int py = cy * cellPixels; py < (cy + 1) * cellPixels; ++py) {
+                QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(py));
+                std::fill(line + cx * cellPixels, line + (cx + 1) * cellPixels, color);
+            }
+        }
+    }
+    return image;
+}
+
+HeatmapImageProvider::HeatmapImageProvider(const HeatmapLayer* layer)
+    : QQuickImageProvider(QQuickImageProvider::Image)
+    , m_layer(layer)
+{
+}
+
+QImage HeatmapImageProvider::requestImage(const QString& id, QSize* size, const QSize& requestedSize)
+{
+    Q_UNUSED(requestedSize);
+
+    // <channel>/<zoom>/<x>/<y>/<revision>，版本号只用于区分缓存
+    const QStringList parts = id.split('/');
+    QImage image = parts.size() >= 4
+        ? m_layer->renderTile(parts[0].toInt(), parts[1].toInt(), parts[2].toInt(), parts[3].toInt())
+        : QImage(1, 1, QImage::Format_ARGB32_Premultiplied);
+    if (size) *size = image.size();
+    return image;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QGeoCoordinate>
+#include <QHash>
+#include <QImage>
+#include <QQuickImageProvider>
+#include <QReadWriteLock>
+#include <QVector>
+#include <memory>
+
+class Database;
+
+// 热力图样本：位置与各通道数值
+struct HeatmapSample {
+    enum Channel { Turbidity = 0, Tds, Ph, CHANNEL_COUNT };
+
+    double latitude = 0.0;
+    double longitude = 0.0;
+    float values[CHANNEL_COUNT] = {};
+};
+
+// 色标：蓝 → 青 → 绿 → 黄 → 红，t 取 0~1，返回预乘 alpha 的颜色
+QRgb heatmapColor(double t, int alpha);
+
+// 多级网格金字塔：按 Web Mercator 分级，第 z 级把世界划分为 2^z × 2^z 个格子，
+// 每个格子保存各通道的样本数、和、最小值与最大值。
+// 每个样本由最细一级的格子坐标右移得到各级坐标，一次更新所有级别，地图缩放时直接取对应级别，不回扫原始样本。
+class HeatmapPyramid {
+public:
+    static constexpr int MIN_LEVEL = 8;
+    static constexpr int MAX_LEVEL = 22;    // 赤道处约 10 m
+    static constexpr int LEVEL_COUNT = MAX_LEVEL - MIN_LEVEL + 1;
+
+    struct Cell {
+        quint32 count = 0;
+        double sum[HeatmapSample::CHANNEL_COUNT] = {};
+        float min[HeatmapSample::CHANNEL_COUNT] = {};
+        float max[HeatmapSample::CHANNEL_COUNT] = {};
+
+        void add(const float* values);
+        void merge(const Cell& other);
+        float mean(int channel) const { return count ? static_cast<float>(sum[channel] / count) : 0.0f; }
+    };
+
+    void add(const HeatmapSample& sample);
+    void merge(const HeatmapPyramid& other);
+    void clear();
+
+    // 未命中返回 nullptr；返回的指针在下一次修改前有效
+    const Cell* cell(int level, quint32 x, quint32 y) const;
+    // 全部样本的汇总（用于自动色标范围）
+    const Cell& total() const { return m_total; }
+    int cellCount(int level) const { return m_levels[level - MIN_LEVEL].size(); }
+
+    // 多线程构建：样本按线程切片各自建金字塔，再逐个合并
+    static HeatmapPyramid build(const QVector<HeatmapSample>& samples, int threads);
+
+    // Web Mercator 归一化坐标（0~1）
+    static void project(double latitude, double longitude, double& x, double& y);
+
+private:
+    static quint64 key(quint32 x, quint32 y) { return (static_cast<quint64>(x) << 32) | y; }
+
+    QHash<quint64, Cell> m_levels[LEVEL_COUNT];
+    Cell m_total;
+};
+
+// 地图热力图图层：维护当前视口内的 256 px 瓦片列表供 MapItemView 显示，
+// 瓦片图像由 HeatmapImageProvider 按需从金字塔渲染；新样本只刷新所在的可见瓦片。
+class HeatmapLayer : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int channel READ channel WRITE setChannel NOTIFY channelChanged)
+    Q_PROPERTY(bool enabled READ enabled NOTIFY channelChanged)
+    Q_PROPERTY(int sampleCount READ sampleCount NOTIFY samplesChanged)
+    Q_PROPERTY(double minimum READ minimum NOTIFY samplesChanged)
+    Q_PROPERTY(double maximum READ maximum NOTIFY samplesChanged)
+    Q_PROPERTY(bool rebuilding READ rebuilding NOTIFY rebuildingChanged)
+public:
+    enum Roles {
+        CoordinateRole = Qt::UserRole + 1,  // 瓦片左上角
+        TileZoomRole,
+        SourceRole
+    };
+
+    static constexpr int TILE_SIZE = 256;
+    static constexpr int CELL_LEVELS_PER_TILE = 6;  // 每个瓦片 64×64 个格子，4 px 一格
+    static constexpr int MAX_VISIBLE_TILES = 64;
+
+    explicit HeatmapLayer(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // -1 表示关闭
+    int channel() const { return m_channel; }
+    void setChannel(int channel);
+    bool enabled() const { return m_channel >= 0; }
+    int sampleCount() const;
+    double minimum() const;
+    double maximum() const;
+    bool rebuilding() const { return m_rebuilding; }
+
+    void setDatabase(Database* database) { m_database = database; }
+
+    // 地图视口变化时调用（QML 中节流）
+    Q_INVOKABLE void setViewport(const QGeoCoordinate& topLeft, const QGeoCoordinate& bottomRight, double zoomLevel);
+    // 从历史数据（带位置的传感器样本）多线程重建
+    Q_INVOKABLE void rebuildFromHistory(const QDateTime& from, const QDateTime& to);
+
+    // 渲染一个瓦片；可在图像加载线程中调用
+    QImage renderTile(int channel, int zoom, int tileX, int tileY) const;
+
+public slots:
+    void addSample(double latitude, double longitude, double turbidity, double tds, double ph);
+
+signals:
+    void channelChanged();
+    void samplesChanged();
+    void rebuildingChanged();
+    void rebuildFinished(int samples, double elapsedMs);
+
+private:
+    struct Tile {
+        int x;
+        int y;
+        int revision;
+    };
+
+    void applyRebuild(const std::shared_ptr<HeatmapPyramid>& pyramid, int samples, double elapsedMs);
+
+    mutable QReadWriteLock m_lock;  // 保护 m_pyramid
+    HeatmapPyramid m_pyramid;
+
+    Database* m_database = nullptr;
+    int m_channel = -1;
+    int m_tileZoom = 0;
+    QVector<Tile> m_tiles;
+    int m_revision = 0;
+    bool m_rebuilding = false;
+    QVector<HeatmapSample> m_backlog;   // 重建期间到达的实时样本，重建完成后补入
+};
+
+// image://heatmap/<channel>/<zoom>/<x>/<y>/<revision>
+class HeatmapImageProvider : public QQuickImageProvider {
+public:
+    explicit HeatmapImageProvider(const HeatmapLayer* layer);
+
+    QImage requestImage(const QString& id, QSize* size, const QSize& requestedSize) override;
+
+private:
+    const HeatmapLayer* m_layer;
+};
@@ -0,0 +1,229 @@
+#include "history_cache.h"
+#include "alarm_engine.h"
+#include "database.h"
+#include "metrics.h"
+#include <QtCharts/QXYSeries>
+#include <algorithm>
+
+QT_CHARTS_USE_NAMESPACE
+
+namespace {
+
+// 本地时间按 UTC 计的秒数，与库中时间戳的分桶方式一致
+double localSeconds(const QDateTime& time)
+{
+    QDateTime local = time.toLocalTime();
+    local.setTimeSpec(Qt::UTC);
+    return local.toMSecsSinceEpoch() / 1000.0;
+}
+
+QDateTime fromLocalSeconds(qint64 seconds)
+{
+    QDateTime time = QDateTime::fromSecsSinceEpoch(seconds, Qt::UTC);
+    time.setTimeSpec(Qt::LocalTime);
+    return time;
+}
+
+// 序列时间是本地时间按 UTC 计的毫秒数，换成 DateTimeAxis 使用的真实时间戳
+void toLocalTime(QVector<QPointF>& points)
+{
+    for (QPointF& point : points) {
+        QDateTime time = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(point.x()), Qt::UTC);
+        time.setTimeSpec(Qt::LocalTime);
+        point.setX(time.toMSecsSinceEpoch());
+    }
+}
+
+ResultKey cacheKey(const HistorySegments::SegmentId& id, int vesselId)
+{
+    return ResultKey{QStringLiteral("sensor:%1").arg(vesselId), fromLocalSeconds(id.start()), fromLocalSeconds(id.end()),
+                     HistorySegments::bucketSeconds(id.level)};
+}
+
+}
+
+HistoryCache::HistoryCache(QObject *parent)
+    : QObject(parent)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_hits = metrics.counter("usv_history_segment_hits_total", "History chart segments served from cache");
+    m_misses = metrics.counter("usv_history_segment_misses_total", "History chart segments read from the database for display");
+    m_prefetched = metrics.counter("usv_history_segments_prefetched_total", "History chart segments read ahead of display");
+}
+
+void HistoryCache::setView(int requestId, const QDateTime& from, const QDateTime& to, int channel, int maxPoints,
+                           int vesselId)
+{
+    if (!m_database || channel < 0 || channel >= SensorBuckets::CHANNEL_COUNT || !(from < to)) return;
+
+    // 换船时上一条船的段不能再拼进视图
+    if (vesselId != m_vesselId) m_viewSegments.clear();
+    m_vesselId = vesselId;
+
+    m_requestId = requestId;
+    m_from = localSeconds(from);
+    m_to = localSeconds(to);
+    m_channel = channel;
+    m_plan = HistorySegments::plan(m_from, m_to, maxPoints, MAX_PREFETCH_SEGMENTS);
+
+    // 只保留新视图仍可见的段；上一视图尚未开始的读取全部丢弃
+    for (std::deque<SegmentId>& queue : m_queues) queue.clear();
+    QHash<SegmentId, std::shared_ptr<const SensorBuckets>> segments;
+    for (const SegmentId& id : qAsConst(m_plan.visible)) {
+        std::shared_ptr<const SensorBuckets> data = m_viewSegments.value(id);
+        if (!data) data = m_cache.find(cacheKey(id, m_vesselId));
+        if (data) {
+            segments.insert(id, data);
+            m_hits->add();
+        } else {
+            m_misses->add();
+            enqueue(id, JobScheduler::Interactive);
+        }
+    }
+    m_viewSegments = segments;
+    for (const SegmentId& id : qAsConst(m_plan.prefetch)) {
+        if (!m_cache.find(cacheKey(id, m_vesselId))) enqueue(id, JobScheduler::Background);
+    }
+
+    // 一个可见段都没有时保留原曲线，等第一段读到再刷新，避免图表闪空
+    if (!m_viewSegments.isEmpty()) {
+        publish();
+    } else {
+        setLoading(true);
+    }
+    loadNext();
+}
+
+void HistoryCache::enqueue(const SegmentId& id, JobScheduler::Priority priority)
+{
+    if (m_reading && m_readingId == id && m_readingVessel == m_vesselId) return;
+    m_queues[priority].push_back(id);
+}
+
+void HistoryCache::loadNext()
+{
+    if (m_reading || !m_database) return;
+
+    for (int priority = 0; priority < JobScheduler::PriorityCount; ++priority) {
+        std::deque<SegmentId>& queue = m_queues[priority];
+        if (queue.empty()) continue;
+
+        const SegmentId id = queue.front();
+        queue.pop_front();
+        m_reading = true;
+        m_readingId = id;
+        m_readingVessel = m_vesselId;
+
+        const bool prefetch = priority == JobScheduler::Background;
+        const int vesselId = m_vesselId;
+        const ResultKey key = cacheKey(id, vesselId);
+        const int width = static_cast<int>(HistorySegments::bucketSeconds(id.level));
+        const quint64 generation = m_generation;
+        Database* database = m_database;
+        QMetaObject::invokeMethod(database, [=]() {
+            auto buckets = std::make_shared<SensorBuckets>();
+            const QDateTime loadedAt = QDateTime::currentDateTime();
+            const bool ok = database->sensorBuckets(key.from, key.to, width, vesselId, *buckets);
+
+            QMetaObject::invokeMethod(this, [=]() {
+                m_reading = false;
+                if (generation == m_generation) {
+                    if (ok && ResultCache<SensorBuckets>::cacheable(key, loadedAt)) {
+                        // 空段也缓存，代价按 1 个桶计
+                        m_cache.insert(key, buckets, std::max(1, buckets->size()));
+                    }
+                    if (prefetch) m_prefetched->add();
+                    // 读取失败时按空段显示，视图不会一直停在加载状态
+                    if (vesselId == m_vesselId && m_plan.visible.contains(id)) {
+                        m_viewSegments.insert(id, buckets);
+                        publish();
+                    }
+                }
+                loadNext();
+            }, Qt::QueuedConnection);
+        }, Qt::QueuedConnection);
+        return;
+    }
+}
+
+void HistoryCache::publish()
+{
+    QVector<const SensorBuckets*> segments;
+    segments.reserve(m_plan.visible.size());
+    int missing = 0;
+    for (const SegmentId& id : qAsConst(m_plan.visible)) {
+        const auto it = m_viewSegments.constFind(id);
+        if (it == m_viewSegments.constEnd()) {
+            segments.append(nullptr);
+            ++missing;
+        } else {
+            segments.append(it.value().get());
+        }
+    }
+
+    // 帧中甲醛以 0.001 mg/m³ 为单位，按 mg/m³ 输出
+    const double scale = m_channel == AlarmEvaluator::Ch2o ? 0.001 : 1.0;
+    const int width = static_cast<int>(HistorySegments::bucketSeconds(m_plan.level));
+    HistorySegments::stitch(segments, width, m_channel, m_from, m_to, scale, m_curves);
+    for (QVector<QPointF>* points : {&m_curves.mean, &m_curves.minimum, &m_curves.maximum}) toLocalTime(*points);
+
+    setLoading(missing > 0);
+    emit viewReady(m_requestId, QVariantMap{
+        {"level", m_plan.level},
+        {"bucketSeconds", width},
+        {"samples", m_curves.samples},
+        {"minimum", m_curves.lowest},
+        {"maximum", m_curves.highest},
+        {"missing", missing}
+    });
+}
+
+void HistoryCache::setLoading(bool loading)
+{
+    if (loading == m_loading) return;
+    m_loading = loading;
+    emit loadingChanged();
+}
+
+void HistoryCache::clear()
+{
+    m_cache.clear();
+    m_viewSegments.clear();
+    for (std::deque<SegmentId>& queue : m_queues) queue.clear();
+    ++m_generation;
+    setLoading(false);
+}
+
+const QVector<QPointF>* HistoryCache::curve(int role) const
+{
+    switch (role) {
+    case Mean: return &m_curves.mean;
+    case Minimum: return &m_curves.minimum;
+    case Maximum: return &m_curves.maximum;
+    default: return nullptr;
+    }
+}
+
+bool HistoryCache::updateSeries(QAbstractSeries* series, int role) const
+{
+    QXYSeries* xySeries = qobject_cast<QXYSeries*>(series);
+    const QVector<QPointF>* points = curve(role);
+    if (!xySeries || !points) return false;
+    xySeries->replace(*points);
+    return true;
+}
+
+QVariantList HistoryCache::points(int role) const
+{
+    QVariantList result;
+    const QVector<QPointF>* points = curve(role);
+    if (!points) return result;
+    result.reserve(points->size());
+    for (const QPointF& point : *points) {
+        result.append(QVariantMap{
+            {"x", QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(point.x()))},
+            {"y", point.y()}
+        });
+    }
+    return result;
+}
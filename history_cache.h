@@ -0,0 +1,85 @@
+#pragma once
+
+#include "database.h"
+#include "history_segments.h"
+#include "job_scheduler.h"
+#include <QDateTime>
+#include <QObject>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QtCharts/QAbstractSeries>
+#include <array>
+#include <deque>
+#include <memory>
+
+class MetricCounter;
+
+// 历史图表的分段缓存：按 HistorySegments 的级别与段编号缓存数据库的分桶汇总，视图由缓存的段拼接而成。
+// 每次视图变化先用已有的段立即拼接，缺的段按“可见 → 预取”两级优先级逐段读取，
+// 预取左右相邻视图与上下一级缩放的段；视图再次变化时未开始的读取全部丢弃，不会堆积。
+// 曲线数据留在 C++ 侧，由 QML 调用 updateSeries 一次性替换
+class HistoryCache : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
+public:
+    enum Role { Mean = 0, Minimum, Maximum };
+    Q_ENUM(Role)
+
+    static constexpr qint64 CACHE_BUCKETS = 400000;     // 缓存段的桶总数上限（约 70 MB）
+    static constexpr int MAX_PREFETCH_SEGMENTS = 24;
+
+    explicit HistoryCache(QObject *parent = nullptr);
+
+    bool loading() const { return m_loading; }
+    void setDatabase(Database* database) { m_database = database; }
+
+    // 设置图表的可见范围、通道与像素宽度；结果经 viewReady 返回，可见段陆续读到时会再次发出。
+    // 段按船只分别缓存，默认显示本船
+    Q_INVOKABLE void setView(int requestId, const QDateTime& from, const QDateTime& to, int channel, int maxPoints,
+                             int vesselId = PRIMARY_VESSEL_ID);
+    // 用当前视图的曲线替换数据（QXYSeries::replace，只触发一次重绘）；series 不是折线/散点时返回 false
+    Q_INVOKABLE bool updateSeries(QtCharts::QAbstractSeries* series, int role) const;
+    // 当前视图的曲线 [{x: Date, y}]，供不是 QXYSeries 的图表使用
+    Q_INVOKABLE QVariantList points(int role) const;
+    // 数据被导入或删除后调用
+    Q_INVOKABLE void clear();
+
+signals:
+    void loadingChanged();
+    // stats: {level, bucketSeconds, samples, minimum, maximum, missing（尚未读到的可见段数）}
+    void viewReady(int requestId, const QVariantMap& stats);
+
+private:
+    using SegmentId = HistorySegments::SegmentId;
+
+    void enqueue(const SegmentId& id, JobScheduler::Priority priority);
+    void loadNext();
+    void publish();
+    void setLoading(bool loading);
+    const QVector<QPointF>* curve(int role) const;
+
+    Database* m_database = nullptr;
+    ResultCache<SensorBuckets> m_cache{CACHE_BUCKETS};
+
+    // 当前视图
+    int m_requestId = 0;
+    double m_from = 0.0;            // 本地时间按 UTC 计的秒数
+    double m_to = 0.0;
+    int m_channel = 0;
+    int m_vesselId = PRIMARY_VESSEL_ID;
+    HistorySegments::Plan m_plan;
+    QHash<SegmentId, std::shared_ptr<const SensorBuckets>> m_viewSegments;
+    HistorySegments::Curves m_curves;
+
+    // 待读取的段；数据库连接只有一个，同一时间只读一段，保证可见段不被预取挡住太久
+    std::array<std::deque<SegmentId>, JobScheduler::PriorityCount> m_queues;
+    bool m_reading = false;
+    SegmentId m_readingId;
+    int m_readingVessel = PRIMARY_VESSEL_ID;
+    bool m_loading = false;
+    quint64 m_generation = 0;       // clear() 之后丢弃仍在读取的旧结果
+
+    MetricCounter* m_hits;
+    MetricCounter* m_misses;
+    MetricCounter* m_prefetched;
+};
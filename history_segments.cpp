@@ -0,0 +1,132 @@
+#include "history_segments.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace HistorySegments {
+
+namespace {
+
+constexpr qint64 BUCKET_SECONDS[LEVEL_COUNT] = {10, 60, 300, 900, 3600, 3 * 3600, 12 * 3600, 86400};
+
+qint64 floorDiv(double value, qint64 divisor)
+{
+    return static_cast<qint64>(std::floor(value / divisor));
+}
+
+// [from, to) 对应的段编号范围 [first, last]
+void segmentRange(int level, double from, double to, qint64& first, qint64& last)
+{
+    const qint64 length = segmentSeconds(level);
+    first = floorDiv(from, length);
+    last = std::max(first, floorDiv(std::nextafter(to, from), length));
+}
+
+}
+
+qint64 bucketSeconds(int level)
+{
+    return BUCKET_SECONDS[std::clamp(level, 0, LEVEL_COUNT - 1)];
+}
+
+int levelFor(double from, double to, int maxPoints)
+{
+    const double span = std::max(0.0, to - from);
+    const double width = span / std::max(1, maxPoints);
+    for (int level = 0; level < LEVEL_COUNT; ++level) {
+        if (BUCKET_SECONDS[level] >= width) return level;
+    }
+    return LEVEL_COUNT - 1;
+}
+
+QVector<SegmentId> segmentsFor(int level, double from, double to)
+{
+    qint64 first = 0, last = 0;
+    segmentRange(level, from, to, first, last);
+    QVector<SegmentId> ids;
+    ids.reserve(static_cast<int>(last - first + 1));
+    for (qint64 index = first; index <= last; ++index) ids.append({level, index});
+    return ids;
+}
+
+Plan plan(double from, double to, int maxPoints, int maxPrefetch)
+{
+    Plan result;
+    result.level = levelFor(from, to, maxPoints);
+    result.visible = segmentsFor(result.level, from, to);
+
+    auto add = [&](const SegmentId& id) {
+        if (result.prefetch.size() >= maxPrefetch) return;
+        if (id.level == result.level && id.index >= result.visible.first().index
+            && id.index <= result.visible.last().index) {
+            return;
+        }
+        if (!result.prefetch.contains(id)) result.prefetch.append(id);
+    };
+
+    // 平移：左右各一个视图宽度
+    const double span = std::max(0.0, to - from);
+    const QVector<SegmentId> before = segmentsFor(result.level, from - span, from);
+    const QVector<SegmentId> after = segmentsFor(result.level, to, to + span);
+    for (int k = 0; k < std::max(before.size(), after.size()); ++k) {
+        if (k < before.size()) add(before[before.size() - 1 - k]);
+        if (k < after.size()) add(after[k]);
+    }
+
+    // 放大：更细一级从视图中心向外；缩小：更粗一级
+    if (result.level > 0) {
+        QVector<SegmentId> finer = segmentsFor(result.level - 1, from, to);
+        const double center = (from + to) / 2.0;
+        std::stable_sort(finer.begin(), finer.end(), [center](const SegmentId& a, const SegmentId& b) {
+            return std::abs((a.start() + a.end()) / 2.0 - center) < std::abs((b.start() + b.end()) / 2.0 - center);
+        });
+        for (const SegmentId& id : qAsConst(finer)) add(id);
+    }
+    if (result.level < LEVEL_COUNT - 1) {
+        for (const SegmentId& id : segmentsFor(result.level + 1, from, to)) add(id);
+    }
+    return result;
+}
+
+void stitch(const QVector<const SensorBuckets*>& segments, int bucketSeconds, int channel,
+            double from, double to, double scale, Curves& out)
+{
+    out.mean.clear();
+    out.minimum.clear();
+    out.maximum.clear();
+    out.samples = 0;
+    double lowest = std::numeric_limits<double>::infinity();
+    double highest = -std::numeric_limits<double>::infinity();
+
+    int total = 0;
+    for (const SensorBuckets* segment : segments) total += segment ? segment->size() : 0;
+    out.mean.reserve(total);
+    out.minimum.reserve(total);
+    out.maximum.reserve(total);
+
+    const double half = bucketSeconds / 2.0;
+    for (const SensorBuckets* segment : segments) {
+        if (!segment) continue;
+        const qint64* starts = segment->starts.constData();
+        const int n = segment->size();
+        // 段内桶按时间有序，跳过视图左侧的桶
+        int k = static_cast<int>(std::lower_bound(starts, starts + n, from - bucketSeconds,
+                                                  [](qint64 start, double value) { return start <= value; })
+                                 - starts);
+        for (; k < n && starts[k] < to; ++k) {
+            const double x = (starts[k] + half) * 1000.0;
+            const double low = segment->minimum[channel][k] * scale;
+            const double high = segment->maximum[channel][k] * scale;
+            out.mean.append(QPointF(x, segment->mean[channel][k] * scale));
+            out.minimum.append(QPointF(x, low));
+            out.maximum.append(QPointF(x, high));
+            lowest = std::min(lowest, low);
+            highest = std::max(highest, high);
+            out.samples += segment->counts[k];
+        }
+    }
+    out.lowest = out.mean.isEmpty() ? 0.0 : lowest;
+    out.highest = out.mean.isEmpty() ? 0.0 : highest;
+}
+
+}
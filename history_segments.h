@@ -0,0 +1,62 @@
+#pragma once
+
+#include "database.h"
+#include <QHash>
+#include <QPointF>
+#include <QVector>
+
+// 历史图表的分级时间段：第 level 级的桶宽为 bucketSeconds(level)，每 BUCKETS_PER_SEGMENT 个桶组成一段，
+// 段按本地时间对齐，编号为 floor(起点 / 段长)。视图按可见范围与像素宽度选级别，由若干整段拼接而成，
+// 平移时只需补读新露出的段，缩放到相邻级别时可以直接用预取的段。
+// 这里的时间都是本地时间按 UTC 计的秒数（与 SensorSeries::seconds 相同）
+namespace HistorySegments {
+
+constexpr int LEVEL_COUNT = 8;
+constexpr int BUCKETS_PER_SEGMENT = 256;
+
+// 各级桶宽：10 s、1 min、5 min、15 min、1 h、3 h、12 h、1 d
+qint64 bucketSeconds(int level);
+inline qint64 segmentSeconds(int level) { return bucketSeconds(level) * BUCKETS_PER_SEGMENT; }
+// [from, to) 内的桶数不超过 maxPoints 的最细级别（范围过大时取最粗一级）
+int levelFor(double from, double to, int maxPoints);
+
+struct SegmentId {
+    int level = 0;
+    qint64 index = 0;
+
+    qint64 start() const { return index * segmentSeconds(level); }
+    qint64 end() const { return start() + segmentSeconds(level); }
+    bool operator==(const SegmentId& other) const { return level == other.level && index == other.index; }
+};
+
+inline uint qHash(const SegmentId& id, uint seed = 0)
+{
+    return ::qHash(id.index, seed) ^ ::qHash(id.level, seed);
+}
+
+// 与 [from, to) 相交的各段，按时间顺序
+QVector<SegmentId> segmentsFor(int level, double from, double to);
+
+struct Plan {
+    int level = 0;
+    QVector<SegmentId> visible;
+    // 预取顺序：左右各一个视图宽度内的同级段（由近及远、左右交替），
+    // 再是可见范围的下一更细级别（由中心向外）与更粗级别；不含可见段，最多 maxPrefetch 个
+    QVector<SegmentId> prefetch;
+};
+Plan plan(double from, double to, int maxPoints, int maxPrefetch);
+
+struct Curves {
+    QVector<QPointF> mean;          // x 为桶中点（毫秒），y 已乘 scale
+    QVector<QPointF> minimum;
+    QVector<QPointF> maximum;
+    double lowest = 0.0;            // minimum 曲线的最小值与 maximum 曲线的最大值
+    double highest = 0.0;
+    qint64 samples = 0;
+};
+
+// 按时间顺序拼接各段中与 [from, to) 相交的桶；segments 与段顺序一致，尚未读到的段为 nullptr
+void stitch(const QVector<const SensorBuckets*>& segments, int bucketSeconds, int channel,
+            double from, double to, double scale, Curves& out);
+
+}
@@ -0,0 +1,222 @@
+#include "job_scheduler.h"
+#include "metrics.h"
+#include <QMutexLocker>
+#include <QPointer>
+#include <algorithm>
+
+namespace {
+
+// 当前线程所属的调度器与工作线程编号（非工作线程为 nullptr / -1）
+thread_local JobScheduler* t_scheduler = nullptr;
+thread_local int t_worker = -1;
+
+const char* priorityLabel(int priority)
+{
+    switch (priority) {
+    case JobScheduler::Interactive: return "interactive";
+    default: return "background";
+    }
+}
+
+// parallelFor 的共享状态：辅助任务可能在 parallelFor 返回后才被取出，只能通过 shared_ptr 访问
+struct ParallelState {
+    std::atomic<int> next{0};
+    std::atomic<int> finished{0};
+    int count = 0;
+    std::mutex mutex;
+    std::condition_variable done;
+};
+
+}
+
+JobScheduler& JobScheduler::instance()
+{
+    static JobScheduler scheduler;
+    return scheduler;
+}
+
+JobScheduler::JobScheduler(int threads)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    for (int i = 0; i < PriorityCount; ++i) {
+        m_duration[i] = metrics.histogram("usv_job_duration_seconds", "Time spent running a background analysis job",
+                                          QString("priority=\"%1\"").arg(priorityLabel(i)));
+    }
+    m_submitted = metrics.counter("usv_jobs_submitted_total", "Background analysis jobs submitted");
+    m_cancelled = metrics.counter("usv_jobs_cancelled_total", "Background analysis jobs superseded or cancelled");
+    m_stolen = metrics.counter("usv_jobs_stolen_total", "Tasks taken from another worker's queue");
+    m_depth = metrics.gauge("usv_job_queue_depth", "Tasks waiting in the job scheduler");
+
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, threads);
+    for (int i = 0; i < threads; ++i) m_workers.push_back(std::make_unique<Worker>());
+    for (int i = 0; i < threads; ++i) m_workers[i]->thread = std::thread(&JobScheduler::run, this, i);
+}
+
+JobScheduler::~JobScheduler()
+{
+    {
+        QMutexLocker locker(&m_groupMutex);
+        for (const CancelFlag& flag : qAsConst(m_groups)) flag->store(true);
+        m_groups.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (const std::unique_ptr<Worker>& worker : m_workers) worker->thread.join();
+}
+
+JobScheduler::CancelFlag JobScheduler::supersede(const QString& group)
+{
+    auto flag = std::make_shared<std::atomic<bool>>(false);
+    if (group.isEmpty()) return flag;
+
+    QMutexLocker locker(&m_groupMutex);
+    auto it = m_groups.find(group);
+    if (it != m_groups.end()) {
+        it.value()->store(true);
+        it.value() = flag;
+    } else {
+        m_groups.insert(group, flag);
+    }
+    return flag;
+}
+
+void JobScheduler::cancelGroup(const QString& group)
+{
+    QMutexLocker locker(&m_groupMutex);
+    const CancelFlag flag = m_groups.take(group);
+    if (flag) flag->store(true);
+}
+
+void JobScheduler::submit(const CancelFlag& cancel, Priority priority, QObject* context,
+                          std::function<void(const std::atomic<bool>&)> work,
+                          std::function<void(bool)> done)
+{
+    m_submitted->add();
+    const CancelFlag flag = cancel ? cancel : std::make_shared<std::atomic<bool>>(false);
+    QPointer<QObject> receiver(context);
+    LatencyHistogram* duration = m_duration[priority];
+    MetricCounter* cancelledCounter = m_cancelled;
+
+    push([=]() {
+        // 排队期间已被新请求取代的任务不再执行
+        bool cancelled = flag->load();
+        if (!cancelled) {
+            MetricScopeTimer timer(duration);
+            work(*flag);
+            cancelled = flag->load();
+        }
+        if (cancelled) cancelledCounter->add();
+        if (done && receiver) {
+            QMetaObject::invokeMethod(receiver.data(), [done, cancelled]() { done(cancelled); },
+                                      Qt::QueuedConnection);
+        }
+    }, priority);
+}
+
+void JobScheduler::parallelFor(int count, const std::function<void(int)>& body)
+{
+    if (count <= 0) return;
+    const int helpers = std::min(count, threadCount()) - 1;
+    if (helpers <= 0) {
+        for (int i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    auto state = std::make_shared<ParallelState>();
+    state->count = count;
+    const std::function<void(int)>* bodyPtr = &body;
+    // 每个参与者循环领取下一个下标；领完后不再访问 body，因此 parallelFor 返回后才运行的辅助任务是安全的
+    auto drain = [state, bodyPtr]() {
+        int ran = 0;
+        for (int i = state->next.fetch_add(1); i < state->count; i = state->next.fetch_add(1)) {
+            (*bodyPtr)(i);
+            ++ran;
+        }
+        if (ran > 0 && state->finished.fetch_add(ran) + ran == state->count) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->done.notify_all();
+        }
+    };
+
+    for (int i = 0; i < helpers; ++i) push(drain, Interactive);
+    // 调用线程自己也领取下标，最终只需等待其他线程手上正在执行的那几项
+    drain();
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&]() { return state->finished.load() == state->count; });
+}
+
+void JobScheduler::push(Task task, Priority priority)
+{
+    // 先计数再入队，出队时的递减不会让计数变为负数
+    m_depth->set(m_queued.fetch_add(1) + 1);
+    if (t_scheduler == this && t_worker >= 0) {
+        // 工作线程内拆出的子任务压入本线程队列，空闲线程从头部窃取
+        Worker& worker = *m_workers[t_worker];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.tasks.push_back(std::move(task));
+        }
+        // 与休眠判断同步，避免唤醒丢失
+        std::lock_guard<std::mutex> lock(m_mutex);
+    } else {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queues[priority].push_back(std::move(task));
+    }
+    m_wake.notify_one();
+}
+
+bool JobScheduler::take(int self, Task& task)
+{
+    {
+        Worker& own = *m_workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            m_depth->set(m_queued.fetch_sub(1) - 1);
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::deque<Task>& queue : m_queues) {
+            if (queue.empty()) continue;
+            task = std::move(queue.front());
+            queue.pop_front();
+            m_depth->set(m_queued.fetch_sub(1) - 1);
+            return true;
+        }
+    }
+    const int count = threadCount();
+    for (int offset = 1; offset < count; ++offset) {
+        Worker& victim = *m_workers[(self + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        m_depth->set(m_queued.fetch_sub(1) - 1);
+        m_stolen->add();
+        return true;
+    }
+    return false;
+}
+
+void JobScheduler::run(int self)
+{
+    t_scheduler = this;
+    t_worker = self;
+    for (;;) {
+        Task task;
+        if (take(self, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [this]() { return m_stopping || m_queued.load() > 0; });
+        if (m_stopping) return;
+    }
+}
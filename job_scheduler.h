@@ -0,0 +1,173 @@
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class MetricCounter;
+class MetricGauge;
+class LatencyHistogram;
+
+// 后台分析任务调度：固定大小的线程池，每个工作线程有自己的双端队列。
+// 外部提交的任务按优先级进入全局队列；任务内部 parallelFor 拆出的子任务压入本线程队列尾部，
+// 空闲线程先取自己队列的尾部，再取全局队列，最后从其他线程队列的头部窃取。
+// 同一分组（如“趋势分析”）的新任务会取消旧任务：尚未开始的直接丢弃，已在执行的通过取消标志协作退出。
+class JobScheduler {
+public:
+    enum Priority {
+        Interactive = 0,    // 当前界面等待的结果
+        Background,         // 预取等可丢弃的工作
+        PriorityCount
+    };
+
+    using CancelFlag = std::shared_ptr<std::atomic<bool>>;
+
+    static JobScheduler& instance();
+
+    // threads <= 0 时使用全部核心
+    explicit JobScheduler(int threads = 0);
+    ~JobScheduler();
+
+    int threadCount() const { return static_cast<int>(m_workers.size()); }
+
+    // 取消分组中之前的任务并返回新的取消标志；分组为空时只返回新标志
+    CancelFlag supersede(const QString& group);
+    void cancelGroup(const QString& group);
+
+    // work 在线程池中执行，随后 done(cancelled) 排队到 context 所在线程执行（context 已销毁则不调用）。
+    // 任务开始前已取消时不执行 work，直接以 cancelled = true 调用 done
+    void submit(const CancelFlag& cancel, Priority priority, QObject* context,
+                std::function<void(const std::atomic<bool>& cancelled)> work,
+                std::function<void(bool cancelled)> done);
+
+    // 并行执行 body(0) … body(count - 1)，返回时全部完成；调用线程也参与计算，
+    // 在工作线程内调用不会因线程池占满而死锁
+    void parallelFor(int count, const std::function<void(int)>& body);
+
+private:
+    using Task = std::function<void()>;
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    void push(Task task, Priority priority);
+    bool take(int self, Task& task);
+    void run(int self);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::array<std::deque<Task>, PriorityCount> m_queues;
+    std::atomic<int> m_queued{0};   // 全部队列中的任务数，用于休眠判断
+    bool m_stopping = false;
+
+    QMutex m_groupMutex;
+    QHash<QString, CancelFlag> m_groups;
+
+    MetricCounter* m_submitted;
+    MetricCounter* m_cancelled;
+    MetricCounter* m_stolen;
+    MetricGauge* m_depth;
+    std::array<LatencyHistogram*, PriorityCount> m_duration;
+};
+
+// 结果缓存的键：查询（含通道等参数）、时间范围与分辨率
+struct ResultKey {
+    QString query;
+    QDateTime from;
+    QDateTime to;
+    qint64 resolution = 0;
+
+    bool operator==(const ResultKey& other) const
+    {
+        return query == other.query && from == other.from && to == other.to && resolution == other.resolution;
+    }
+};
+
+inline uint qHash(const ResultKey& key, uint seed = 0)
+{
+    return qHash(key.query, seed) ^ qHash(key.from.toMSecsSinceEpoch(), seed)
+         ^ qHash(key.to.toMSecsSinceEpoch(), seed) ^ qHash(key.resolution, seed);
+}
+
+// 按代价限额的 LRU 结果缓存，可跨线程使用；缓存的结果只读共享
+template <typename T>
+class ResultCache {
+public:
+    explicit ResultCache(qint64 maxCost) : m_maxCost(maxCost) {}
+
+    // 区间在读取时已经结束的结果才可缓存，否则后续写入的数据会被遗漏
+    static bool cacheable(const ResultKey& key, const QDateTime& readAt) { return key.to <= readAt; }
+
+    std::shared_ptr<const T> find(const ResultKey& key)
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_index.find(key);
+        if (it == m_index.end()) return nullptr;
+        m_entries.splice(m_entries.begin(), m_entries, it.value());
+        return it.value()->value;
+    }
+
+    void insert(const ResultKey& key, std::shared_ptr<const T> value, qint64 cost)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (cost > m_maxCost) return;
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_cost -= it.value()->cost;
+            m_entries.erase(it.value());
+            m_index.erase(it);
+        }
+        m_entries.push_front({key, std::move(value), cost});
+        m_index.insert(key, m_entries.begin());
+        m_cost += cost;
+        while (m_cost > m_maxCost) {
+            const Entry& oldest = m_entries.back();
+            m_cost -= oldest.cost;
+            m_index.remove(oldest.key);
+            m_entries.pop_back();
+        }
+    }
+
+    void clear()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_entries.clear();
+        m_index.clear();
+        m_cost = 0;
+    }
+
+    int size() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_index.size();
+    }
+
+private:
+    struct Entry {
+        ResultKey key;
+        std::shared_ptr<const T> value;
+        qint64 cost;
+    };
+
+    mutable QMutex m_mutex;
+    std::list<Entry> m_entries;     // 头部为最近使用
+    QHash<ResultKey, typename std::list<Entry>::iterator> m_index;
+    qint64 m_maxCost;
+    qint64 m_cost = 0;
+};
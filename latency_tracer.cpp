@@ -0,0 +1,247 @@
+#include "latency_tracer.h"
+#include "metrics.h"
+#include <QFile>
+#include <QMutexLocker>
+#include <QQuickWindow>
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+const char* const STAGE_NAMES[] = {
+    "receive", "decode", "module_update", "db_enqueue", "publish", "present"
+};
+
+// 对已排序样本取分位数
+double percentile(const std::vector<double>& sorted, double q)
+{
+    if (sorted.empty()) return 0.0;
+    const size_t index = static_cast<size_t>(q * (sorted.size() - 1) + 0.5);
+    return sorted[qMin(index, sorted.size() - 1)];
+}
+
+}
+
+LatencyTracer& LatencyTracer::instance()
+{
+    static LatencyTracer tracer;
+    return tracer;
+}
+
+LatencyTracer::LatencyTracer(QObject *parent)
+    : QObject(parent)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    for (int stage = Decode; stage < StageCount; ++stage) {
+        m_stageHistograms[stage] = metrics.histogram(
+            "usv_latency_stage_seconds", "Time spent in each pipeline stage",
+            QString("stage=\"%1\"").arg(STAGE_NAMES[stage]));
+    }
+    m_totalHistogram = metrics.histogram("usv_latency_total_seconds",
+                                         "Latency from serial byte arrival to presented frame");
+    m_samples.reserve(SAMPLE_CAPACITY);
+
+    // 与指标刷新同频更新摘要属性
+    connect(&metrics, &MetricsRegistry::updated, this, &LatencyTracer::publishSummary);
+}
+
+void LatencyTracer::beginFrame(qint64 receiveNs)
+{
+    m_current = Sample();
+    m_current.receiveNs = receiveNs;
+    m_markNs = receiveNs;
+    m_scopedNs = 0;
+    m_scopeDepth = 0;
+    m_inFrame = true;
+}
+
+void LatencyTracer::mark(Stage stage)
+{
+    if (!m_inFrame) return;
+    const qint64 now = MetricsClock::nowNs();
+    // 至少记 1 ns，与“未经过”区分
+    m_current.stageNs[stage] = qMax<qint64>(1, now - m_markNs - m_scopedNs);
+    m_markNs = now;
+    m_scopedNs = 0;
+}
+
+void LatencyTracer::enter(Stage stage)
+{
+    if (!m_inFrame) return;
+    const qint64 now = MetricsClock::nowNs();
+    if (m_scopeDepth > 0 && m_scopeDepth <= MAX_SCOPE_DEPTH) {
+        // 暂停外层计时
+        const qint64 elapsed = now - m_scopeStartNs;
+        m_current.stageNs[m_scopes[m_scopeDepth - 1]] += elapsed;
+        m_scopedNs += elapsed;
+    }
+    if (m_scopeDepth < MAX_SCOPE_DEPTH) m_scopes[m_scopeDepth] = stage;
+    ++m_scopeDepth;
+    m_scopeStartNs = now;
+}
+
+void LatencyTracer::leave()
+{
+    if (!m_inFrame || m_scopeDepth == 0) return;
+    const qint64 now = MetricsClock::nowNs();
+    --m_scopeDepth;
+    if (m_scopeDepth < MAX_SCOPE_DEPTH) {
+        const qint64 elapsed = qMax<qint64>(1, now - m_scopeStartNs);
+        m_current.stageNs[m_scopes[m_scopeDepth]] += elapsed;
+        m_scopedNs += elapsed;
+    }
+    // 恢复外层计时
+    m_scopeStartNs = now;
+}
+
+void LatencyTracer::endFrame()
+{
+    if (!m_inFrame) return;
+    m_inFrame = false;
+    m_current.publishNs = m_markNs;
+
+    QMutexLocker locker(&m_mutex);
+    // 未关联窗口或窗口长期不渲染时避免无限增长
+    if (m_pending.size() < SAMPLE_CAPACITY) {
+        m_pending.append(m_current);
+    }
+}
+
+void LatencyTracer::attachWindow(QQuickWindow* window)
+{
+    if (!window) return;
+    // 两个信号都在渲染线程发出，afterSynchronizing 时 GUI 线程处于阻塞状态
+    connect(window, &QQuickWindow::afterSynchronizing, this, &LatencyTracer::onAfterSynchronizing, Qt::DirectConnection);
+    connect(window, &QQuickWindow::frameSwapped, this, &LatencyTracer::onFrameSwapped, Qt::DirectConnection);
+}
+
+void LatencyTracer::onAfterSynchronizing()
+{
+    QMutexLocker locker(&m_mutex);
+    m_synced += m_pending;
+    m_pending.clear();
+}
+
+void LatencyTracer::onFrameSwapped()
+{
+    const qint64 now = MetricsClock::nowNs();
+
+    QMutexLocker locker(&m_mutex);
+    for (Sample& sample : m_synced) {
+        sample.stageNs[Present] = qMax<qint64>(1, now - sample.publishNs);
+
+        // 未经过的阶段（如未连接数据库）耗时为 0，不计入
+        for (int stage = Decode; stage < StageCount; ++stage) {
+            if (sample.stageNs[stage] == 0) continue;
+            m_stageHistograms[stage]->observe(sample.stageNs[stage]);
+        }
+        m_totalHistogram->observe(now - sample.receiveNs);
+
+        if (m_samples.size() < SAMPLE_CAPACITY) {
+            m_samples.append(sample);
+        } else {
+            m_samples[m_sampleHead] = sample;
+            m_sampleHead = (m_sampleHead + 1) % SAMPLE_CAPACITY;
+        }
+    }
+    m_synced.clear();
+}
+
+int LatencyTracer::sampleCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_samples.size();
+}
+
+QVariantMap LatencyTracer::report() const
+{
+    QVector<Sample> samples;
+    {
+        QMutexLocker locker(&m_mutex);
+        samples = m_samples;
+    }
+
+    QVariantMap result;
+    result["samples"] = samples.size();
+
+    auto summarize = [](std::vector<double>& values) {
+        std::sort(values.begin(), values.end());
+        QVariantMap m;
+        m["p50"] = percentile(values, 0.50);
+        m["p90"] = percentile(values, 0.90);
+        m["p99"] = percentile(values, 0.99);
+        m["max"] = values.empty() ? 0.0 : values.back();
+        m["count"] = static_cast<int>(values.size());
+        return m;
+    };
+
+    for (int stage = Decode; stage < StageCount; ++stage) {
+        std::vector<double> values;
+        values.reserve(samples.size());
+        for (const Sample& sample : samples) {
+            if (sample.stageNs[stage] == 0) continue;
+            values.push_back(sample.stageNs[stage] / 1e6);
+        }
+        result[STAGE_NAMES[stage]] = summarize(values);
+    }
+
+    std::vector<double> totals;
+    totals.reserve(samples.size());
+    for (const Sample& sample : samples) {
+        totals.push_back((sample.publishNs + sample.stageNs[Present] - sample.receiveNs) / 1e6);
+    }
+    result["total"] = summarize(totals);
+    return result;
+}
+
+QString LatencyTracer::reportText() const
+{
+    const QVariantMap r = report();
+    QString text;
+    QTextStream out(&text);
+    out << "端到端延迟报告 (ms)，样本数 " << r["samples"].toInt() << '\n';
+    out << QString("%1 %2 %3 %4 %5\n").arg("stage", -14).arg("p50", 9).arg("p90", 9).arg("p99", 9).arg("max", 9);
+
+    QStringList rows;
+    for (int stage = Decode; stage < StageCount; ++stage) rows << STAGE_NAMES[stage];
+    rows << "total";
+    for (const QString& name : rows) {
+        const QVariantMap m = r[name].toMap();
+        out << QString("%1 %2 %3 %4 %5\n").arg(name, -14)
+                   .arg(m["p50"].toDouble(), 9, 'f', 3)
+                   .arg(m["p90"].toDouble(), 9, 'f', 3)
+                   .arg(m["p99"].toDouble(), 9, 'f', 3)
+                   .arg(m["max"].toDouble(), 9, 'f', 3);
+    }
+    out.flush();
+    return text;
+}
+
+bool LatencyTracer::writeReport(const QString& path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        qWarning() << "无法写入延迟报告:" << path << file.errorString();
+        return false;
+    }
+    file.write(reportText().toUtf8());
+    return true;
+}
+
+void LatencyTracer::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_samples.clear();
+    m_sampleHead = 0;
+}
+
+void LatencyTracer::publishSummary()
+{
+    const QVariantMap total = report()["total"].toMap();
+    m_totalP50Ms = total["p50"].toDouble();
+    m_totalP99Ms = total["p99"].toDouble();
+    m_totalMaxMs = total["max"].toDouble();
+    emit updated();
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QObject>
+#include <QMutex>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+#include <array>
+
+class QQuickWindow;
+class LatencyHistogram;
+
+// 端到端延迟追踪：串口收到字节 -> 解码 -> 模块更新 -> 入库排队 -> QML 发布 -> 场景图呈现
+// 解码到发布在 GUI 线程中同步完成，因此以"当前帧"记录各阶段耗时；
+// 发布后的帧在下一次场景图同步时归入该帧，交换缓冲区后记为已呈现。
+// 模块解析时同步发出的信号会在槽中排队写库，两段互相嵌套，所以模块更新与入库排队用 Scope 计独占时间，
+// 其余阶段为两次 mark 之间扣除 Scope 时间后的剩余部分；各阶段之和等于总延迟。
+class LatencyTracer : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int sampleCount READ sampleCount NOTIFY updated)
+    Q_PROPERTY(double totalP50Ms READ totalP50Ms NOTIFY updated)
+    Q_PROPERTY(double totalP99Ms READ totalP99Ms NOTIFY updated)
+    Q_PROPERTY(double totalMaxMs READ totalMaxMs NOTIFY updated)
+
+public:
+    enum Stage {
+        Receive = 0,    // readSerialData 读到字节
+        Decode,         // 帧切分与转换（mark）
+        ModuleUpdate,   // 模块解析，不含嵌套的写库排队（Scope）
+        DbEnqueue,      // 写库请求排队（Scope）
+        Publish,        // QML 绑定更新（mark）
+        Present,        // 等待场景图交换缓冲区
+        StageCount
+    };
+    Q_ENUM(Stage)
+
+    static const int SAMPLE_CAPACITY = 8192;   // 保留最近的样本数，用于精确分位数
+
+    static LatencyTracer& instance();
+
+    // 在当前帧内把作用域的耗时计入 stage；可以嵌套，内层时间不计入外层
+    class Scope {
+    public:
+        explicit Scope(Stage stage) { LatencyTracer::instance().enter(stage); }
+        ~Scope() { LatencyTracer::instance().leave(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // 由 GUI 线程调用
+    void beginFrame(qint64 receiveNs);
+    // 上一次 mark 以来扣除 Scope 之后的时间计入 stage
+    void mark(Stage stage);
+    void endFrame();
+    // 关联主窗口，以场景图同步/交换作为呈现时间
+    void attachWindow(QQuickWindow* window);
+
+    int sampleCount() const;
+    double totalP50Ms() const { return m_totalP50Ms; }
+    double totalP99Ms() const { return m_totalP99Ms; }
+    double totalMaxMs() const { return m_totalMaxMs; }
+
+    // 各阶段耗时及总延迟的 p50/p90/p99/max（毫秒）
+    Q_INVOKABLE QVariantMap report() const;
+    Q_INVOKABLE QString reportText() const;
+    Q_INVOKABLE bool writeReport(const QString& path) const;
+    Q_INVOKABLE void reset();
+
+signals:
+    void updated();
+
+private:
+    explicit LatencyTracer(QObject *parent = nullptr);
+
+    static const int MAX_SCOPE_DEPTH = 8;
+
+    // 一帧的各阶段耗时（纳秒），0 表示未经过该阶段
+    struct Sample {
+        qint64 receiveNs = 0;
+        qint64 publishNs = 0;
+        std::array<qint64, StageCount> stageNs{};
+    };
+
+    void enter(Stage stage);
+    void leave();
+    void onAfterSynchronizing();
+    void onFrameSwapped();
+    void publishSummary();
+
+    // GUI 线程
+    Sample m_current;
+    bool m_inFrame = false;
+    qint64 m_markNs = 0;                            // 上一次 mark 的时间
+    qint64 m_scopedNs = 0;                          // 上一次 mark 以来 Scope 的总耗时
+    std::array<Stage, MAX_SCOPE_DEPTH> m_scopes{};  // 当前嵌套的 Scope
+    int m_scopeDepth = 0;
+    qint64 m_scopeStartNs = 0;                      // 最内层 Scope 本段计时的起点
+
+    // GUI 线程与渲染线程共享
+    mutable QMutex m_mutex;
+    QVector<Sample> m_pending;   // 已发布、等待同步
+    QVector<Sample> m_synced;    // 已同步、等待交换
+    QVector<Sample> m_samples;   // 已呈现的环形样本
+    int m_sampleHead = 0;
+
+    std::array<LatencyHistogram*, StageCount> m_stageHistograms{};
+    LatencyHistogram* m_totalHistogram = nullptr;
+
+    double m_totalP50Ms = 0.0;
+    double m_totalP99Ms = 0.0;
+    double m_totalMaxMs = 0.0;
+};
@@ -4,17 +4,55 @@
 #include "vessel_module.h"
 #include "datasource.h"
 #include "database.h"
+#include "metrics.h"
+#include "trace.h"
+#include "latency_tracer.h"
+#include "fleet_manager.h"
+#include "command_scheduler.h"
+#include "control_loop.h"
+#include "mission_upload.h"
+#include "mission_planner.h"
+#include "geofence.h"
+#include "heatmap.h"
+#include "surface_layer.h"
+#include "alarm_engine.h"
+#include "anomaly_detector.h"
+#include "correlation_engine.h"
+#include "trend_analyzer.h"
+#include "history_cache.h"
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include <QDebug>
 #include <QDateTime>
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QQuickWindow>
+#include <QSharedPointer>
+#include <QTimer>
 
 int main(int argc, char *argv[]) {
+    // 启动追踪：从进程入口开始计时，直到首帧渲染完成
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
     QApplication app(argc, argv);
     QQmlApplicationEngine engine;
 
+    // 指标注册表在主线程创建，定时刷新速率并按需导出 Prometheus 文本文件
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    metrics.setTextfilePath(qEnvironmentVariable("USV_METRICS_TEXTFILE"));
+
+    // 结构化追踪：编译启用时安装崩溃导出，并可从 QML 按需导出
+    TraceController traceController;
+
+    // 端到端延迟追踪
+    LatencyTracer& latencyTracer = LatencyTracer::instance();
+#ifdef USV_TRACE_ENABLED
+    Trace::installCrashHandler(qEnvironmentVariable("USV_TRACE_CRASH_FILE", "usv_trace_crash.bin"));
+#endif
+
 
     // qmlRegisterType<SensorModule>("Modules", 1, 0, "SensorModule");
     // qmlRegisterType<VesselModule>("Modules", 1, 0, "VesselModule");
@@ -30,12 +68,76 @@ int main(int argc, char *argv[]) {
     Database database;
     DataSource* dataSource =new DataSource();
     DeviceModule* deviceModuleWithDataSource = new DeviceModule(dataSource);
+    MissionPlanner missionPlanner(dataSource);
+    GeofenceManager geofenceManager;
+    HeatmapLayer heatmapLayer;
+    heatmapLayer.setDatabase(&database);
+    SurfaceLayer surfaceLayer;
+    surfaceLayer.setDatabase(&database);
+    AlarmEngine alarmEngine;
+    AnomalyMonitor anomalyMonitor;
+    anomalyMonitor.setDatabase(&database);
+    CorrelationEngine correlationEngine;
+    correlationEngine.setDatabase(&database);
+    TrendAnalyzer trendAnalyzer;
+    trendAnalyzer.setDatabase(&database);
+    HistoryCache historyCache;
+    historyCache.setDatabase(&database);
 
-
-    if (!database.initialize()) {
-        qDebug() << "Failed to initialize database.";
-        return -1;
+    // 控制心跳：USV_CONTROL_HEARTBEAT_HZ > 0 时在串口打开后按该频率发送控制帧
+    const double heartbeatHz = qEnvironmentVariable("USV_CONTROL_HEARTBEAT_HZ").toDouble();
+    if (heartbeatHz > 0) {
+        dataSource->control()->setRateHz(heartbeatHz);
+        dataSource->control()->setEnabled(true);
+    }
+    // 告警去抖：USV_ALARM_MIN_DURATION_MS 为状态变化需持续的时长（默认 1000 ms）
+    bool alarmDurationOk = false;
+    const int alarmMinDurationMs = qEnvironmentVariable("USV_ALARM_MIN_DURATION_MS").toInt(&alarmDurationOk);
+    if (alarmDurationOk) {
+        alarmEngine.setMinDuration(alarmMinDurationMs);
+    }
+    // 卡滞检测：USV_ANOMALY_STUCK_MINUTES 为读数不变多久判为卡滞（默认 10 分钟，0 关闭）
+    bool stuckMinutesOk = false;
+    const double stuckMinutes = qEnvironmentVariable("USV_ANOMALY_STUCK_MINUTES").toDouble(&stuckMinutesOk);
+    if (stuckMinutesOk) {
+        anomalyMonitor.setStuckSeconds(stuckMinutes * 60.0);
+    }
+    // 实时相关性窗口：USV_CORRELATION_WINDOW 为窗口帧数（默认 3600）
+    const int correlationWindow = qEnvironmentVariableIntValue("USV_CORRELATION_WINDOW");
+    if (correlationWindow > 0) {
+        correlationEngine.setWindowSize(correlationWindow);
+    }
+    // 电子围栏：USV_GEOFENCE_FILE 指定启动时载入的 GeoJSON 文件
+    const QString geofenceFile = qEnvironmentVariable("USV_GEOFENCE_FILE");
+    if (!geofenceFile.isEmpty()) {
+        geofenceManager.loadFromFile(geofenceFile);
     }
+    // 分块任务上传：USV_CHUNKED_MISSION_UPLOAD=1 时默认启用（船端需支持分块确认协议）
+    dataSource->setChunkedMissionUpload(qEnvironmentVariableIntValue("USV_CHUNKED_MISSION_UPLOAD") == 1);
+
+
+    // 数据库在独立线程中打开和建表，不阻塞界面加载
+    QThread databaseThread;
+    databaseThread.setObjectName("DatabaseThread");
+    database.moveToThread(&databaseThread);
+    QObject::connect(&database, &Database::initialized, &app, [&](bool ok) {
+        if (!ok) {
+            qDebug() << "Failed to initialize database.";
+            QCoreApplication::exit(-1);
+            return;
+        }
+        qDebug() << "启动追踪: 数据库就绪" << startupTimer.elapsed() << "ms";
+    }, Qt::QueuedConnection);
+    databaseThread.start();
+    QMetaObject::invokeMethod(&database, "initialize", Qt::QueuedConnection);
+
+    // 船队：每船独立链路线程，样本汇总后批量显示并写入数据库
+    FleetManager fleetManager;
+    fleetManager.setDatabase(&database);
+    fleetManager.setEpollBackend(qEnvironmentVariableIntValue("USV_EPOLL_READER") != 0);
+    QObject::connect(&fleetManager, &FleetManager::error, [](int vesselId, const QString& message) {
+        qWarning() << "船只" << vesselId << message;
+    });
 
     // 信号槽连接，解析传感器和船舶数据
     QObject::connect(dataSource, &DataSource::sensorDataReceived, &sensorModule, &SensorModule::receiveData);
@@ -43,21 +145,94 @@ int main(int argc, char *argv[]) {
     QObject::connect(dataSource, &DataSource::deviceDataReceived, &deviceModule, &DeviceModule::receiveData);
 
 
-    // 连接数据解析后插入数据库
+    // 连接数据解析后插入数据库：时间戳在解析时获取，写入排队到数据库线程执行
     QObject::connect(&sensorModule, &SensorModule::sensorDataParsed, [&](int co2, int ch2o, int tvoc, int pm25, int pm10,
                                                                          double airTemp, double humidity, int turbidity, double ph, int tds, double waterTemp, int levelValue){
+        LatencyTracer::Scope enqueueScope(LatencyTracer::DbEnqueue);
         QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
-        database.insertSensorData(timestamp, co2, ch2o, tvoc, pm25, pm10,
-                                  airTemp, humidity, turbidity, ph, tds, waterTemp, levelValue);
+        metrics.dbRowsQueued->add();
+        QMetaObject::invokeMethod(&database, [=, &database, &metrics]() {
+            MetricScopeTimer commitTimer(metrics.dbCommitLatency);
+            database.insertSensorData(timestamp, co2, ch2o, tvoc, pm25, pm10,
+                                      airTemp, humidity, turbidity, ph, tds, waterTemp, levelValue);
+            metrics.dbRowsWritten->add();
+        });
+    });
+
+    // 水质热力图：传感器读数配以当前船位增量分箱
+    QObject::connect(&sensorModule, &SensorModule::sensorDataParsed, &heatmapLayer, [&](int, int, int, int, int, double, double,
+                                                                                       int turbidity, double ph, int tds, double, int) {
+        const double latitude = vesselModule.latitude();
+        const double longitude = vesselModule.longitude();
+        if (latitude != 0.0 || longitude != 0.0) {
+            heatmapLayer.addSample(latitude, longitude, turbidity, tds, ph);
+        }
     });
 
     QObject::connect(&vesselModule, &VesselModule::vesselDataParsed, [&](double latitude, double longitude, double speed, double heading){
+        LatencyTracer::Scope enqueueScope(LatencyTracer::DbEnqueue);
         QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
-        database.insertVesselData(timestamp, latitude, longitude, speed, heading);
+        metrics.dbRowsQueued->add();
+        QMetaObject::invokeMethod(&database, [=, &database, &metrics]() {
+            MetricScopeTimer commitTimer(metrics.dbCommitLatency);
+            database.insertVesselData(timestamp, latitude, longitude, speed, heading);
+            metrics.dbRowsWritten->add();
+        });
+    });
+    // 每个定位点检查围栏，进出事件排队写入数据库
+    QObject::connect(&vesselModule, &VesselModule::vesselDataParsed, &geofenceManager, [&](double latitude, double longitude, double, double) {
+        geofenceManager.updatePosition(latitude, longitude);
     });
+    QObject::connect(&geofenceManager, &GeofenceManager::transition, [&](int fenceId, const QString& name, int kind, bool entered,
+                                                                         bool breach, double latitude, double longitude) {
+        QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
+        metrics.dbRowsQueued->add();
+        QMetaObject::invokeMethod(&database, [=, &database, &metrics]() {
+            MetricScopeTimer commitTimer(metrics.dbCommitLatency);
+            database.insertGeofenceEvent(timestamp, fenceId, name, kind, entered, breach, latitude, longitude);
+            metrics.dbRowsWritten->add();
+        });
+    });
+    // 传感器告警：每帧判定阈值，状态变化排队写入数据库
+    QObject::connect(&sensorModule, &SensorModule::sensorDataParsed, &alarmEngine, &AlarmEngine::evaluateFrame);
+    QObject::connect(&alarmEngine, &AlarmEngine::alarmChanged, [&](const QString& key, int level, int previous, double value) {
+        QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
+        metrics.dbRowsQueued->add();
+        QMetaObject::invokeMethod(&database, [=, &database, &metrics]() {
+            MetricScopeTimer commitTimer(metrics.dbCommitLatency);
+            database.insertAlarmEvent(timestamp, key, level, previous, value);
+            metrics.dbRowsWritten->add();
+        });
+    });
+    // 异常检测：尖峰与卡滞标记写入数据库（在传感器记录之后排队，按时间匹配记录）
+    QObject::connect(&sensorModule, &SensorModule::sensorDataParsed, &anomalyMonitor, &AnomalyMonitor::evaluateFrame);
+    QObject::connect(&anomalyMonitor, &AnomalyMonitor::anomalyDetected, [&](const QString& key, int kind, double value,
+                                                                           double score, double expected) {
+        SensorAnomaly anomaly;
+        anomaly.timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
+        anomaly.channel = key;
+        anomaly.kind = kind;
+        anomaly.value = value;
+        anomaly.score = score;
+        anomaly.expected = expected;
+        metrics.dbRowsQueued->add();
+        QMetaObject::invokeMethod(&database, [=, &database, &metrics]() {
+            MetricScopeTimer commitTimer(metrics.dbCommitLatency);
+            database.insertAnomalies({anomaly});
+            metrics.dbRowsWritten->add();
+        });
+    });
+    // 实时相关性窗口
+    QObject::connect(&sensorModule, &SensorModule::sensorDataParsed, &correlationEngine, &CorrelationEngine::addFrame);
     QObject::connect(&deviceModule, &DeviceModule::deviceDataParsed, [&](int battery,bool mode){
+        LatencyTracer::Scope enqueueScope(LatencyTracer::DbEnqueue);
         QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
-        database.insertDeviceData(timestamp, battery,mode);
+        metrics.dbRowsQueued->add();
+        QMetaObject::invokeMethod(&database, [=, &database, &metrics]() {
+            MetricScopeTimer commitTimer(metrics.dbCommitLatency);
+            database.insertDeviceData(timestamp, battery,mode);
+            metrics.dbRowsWritten->add();
+        });
     });
 
     // 注册到 QML
@@ -67,18 +242,89 @@ int main(int argc, char *argv[]) {
     engine.rootContext()->setContextProperty("dataSource", dataSource);
     engine.rootContext()->setContextProperty("database", &database);
     engine.rootContext()->setContextProperty("deviceModuleWithDataSource", deviceModuleWithDataSource);
+    engine.rootContext()->setContextProperty("pipelineMetrics", &metrics);
+    engine.rootContext()->setContextProperty("traceController", &traceController);
+    engine.rootContext()->setContextProperty("latencyTracer", &latencyTracer);
+    engine.rootContext()->setContextProperty("commandScheduler", dataSource->commands());
+    engine.rootContext()->setContextProperty("controlLoop", dataSource->control());
+    engine.rootContext()->setContextProperty("missionUploader", dataSource->missions());
+    engine.rootContext()->setContextProperty("fleetManager", &fleetManager);
+    engine.rootContext()->setContextProperty("fleetModel", fleetManager.model());
+    engine.rootContext()->setContextProperty("missionPlanner", &missionPlanner);
+    engine.rootContext()->setContextProperty("geofenceManager", &geofenceManager);
+    engine.rootContext()->setContextProperty("heatmapLayer", &heatmapLayer);
+    engine.addImageProvider("heatmap", new HeatmapImageProvider(&heatmapLayer));
+    engine.rootContext()->setContextProperty("surfaceLayer", &surfaceLayer);
+    engine.rootContext()->setContextProperty("alarmEngine", &alarmEngine);
+    engine.rootContext()->setContextProperty("anomalyMonitor", &anomalyMonitor);
+    engine.rootContext()->setContextProperty("correlationEngine", &correlationEngine);
+    engine.rootContext()->setContextProperty("trendAnalyzer", &trendAnalyzer);
+    engine.rootContext()->setContextProperty("historyCache", &historyCache);
+    engine.addImageProvider("surface", new SurfaceImageProvider(&surfaceLayer));
 
 
 
     const QUrl url(QStringLiteral("qrc:/main.qml"));
-    QObject::connect(&engine, &QQmlApplicationEngine::objectCreated, &app, [url](QObject *obj, const QUrl &objUrl) {
+    QObject::connect(&engine, &QQmlApplicationEngine::objectCreated, &app, [url, &startupTimer](QObject *obj, const QUrl &objUrl) {
         if (!obj && url == objUrl) {
             QCoreApplication::exit(-1);
+            return;
+        }
+
+        // 记录首帧渲染完成时间（只记录一次）
+        QQuickWindow *window = qobject_cast<QQuickWindow *>(obj);
+        if (window) {
+            LatencyTracer::instance().attachWindow(window);
+
+            auto connection = QSharedPointer<QMetaObject::Connection>::create();
+            *connection = QObject::connect(window, &QQuickWindow::frameSwapped, window, [connection, &startupTimer]() {
+                QObject::disconnect(*connection);
+                qDebug() << "启动追踪: 首帧渲染" << startupTimer.elapsed() << "ms";
+            }, Qt::DirectConnection);
         }
     }, Qt::QueuedConnection);
     engine.load(url);
+    qDebug() << "启动追踪: QML 加载完成" << startupTimer.elapsed() << "ms";
+
+    // 串口录制与回放：USV_SERIAL_CAPTURE 录制串口原始字节；USV_REPLAY_FILE 回放录制文件
+    // （USV_REPLAY_SPEED 为倍速，默认 1，<= 0 为尽快回放），结束后输出延迟报告，设置了 USV_LATENCY_REPORT 时同时写入文件
+    const QString latencyReportPath = qEnvironmentVariable("USV_LATENCY_REPORT");
+    const QString captureFile = qEnvironmentVariable("USV_SERIAL_CAPTURE");
+    if (!captureFile.isEmpty()) {
+        dataSource->setCaptureFile(captureFile);
+    }
+    const QString replayFile = qEnvironmentVariable("USV_REPLAY_FILE");
+    if (!replayFile.isEmpty()) {
+        QObject::connect(dataSource, &DataSource::replayFinished, &latencyTracer, [&latencyTracer, latencyReportPath](int chunks) {
+            // 等最后几帧呈现后再出报告
+            QTimer::singleShot(500, &latencyTracer, [&latencyTracer, latencyReportPath, chunks]() {
+                qDebug().noquote() << "串口回放结束，块数" << chunks << '\n' << latencyTracer.reportText();
+                if (!latencyReportPath.isEmpty()) {
+                    latencyTracer.writeReport(latencyReportPath);
+                }
+            });
+        });
+        bool replaySpeedOk = false;
+        const double replaySpeed = qEnvironmentVariable("USV_REPLAY_SPEED").toDouble(&replaySpeedOk);
+        dataSource->startReplay(replayFile, replaySpeedOk ? replaySpeed : 1.0);
+    }
 
+    int ret = app.exec();
+
+    if (!latencyReportPath.isEmpty()) {
+        latencyTracer.writeReport(latencyReportPath);
+    }
+
+    // 先停止各船链路，再把最后一批样本排队到数据库线程
+    const QList<int> vesselIds = fleetManager.vesselIds();
+    for (int vesselId : vesselIds) {
+        fleetManager.removeVessel(vesselId);
+    }
+    fleetManager.flush();
 
+    QMetaObject::invokeMethod(&database, "shutdown", Qt::BlockingQueuedConnection);
+    databaseThread.quit();
+    databaseThread.wait();
 
-    return app.exec();
+    return ret;
 }
@@ -101,17 +101,69 @@ ApplicationWindow {
         }
     }
 
-    // 对话框组件
-    HistoryDataWindow {
-        id: historyDataWindow
-        // anchors.centerIn: parent
-        visible: false
+    // 对话框组件：首次使用时才通过异步 Loader 创建，避免拖慢冷启动
+    Loader {
+        id: historyDataWindowLoader
+        active: false
+        asynchronous: true
+        sourceComponent: Component {
+            HistoryDataWindow {
+                visible: false
+            }
+        }
+
+        property bool showWhenReady: false
+
+        onLoaded: {
+            if (showWhenReady) {
+                showWhenReady = false;
+                item.show();
+                item.raise();
+            }
+        }
+    }
+
+    Loader {
+        id: settingsDialogLoader
+        active: false
+        asynchronous: true
+        sourceComponent: Component {
+            SettingsDialog {
+                anchors.centerIn: Overlay.overlay
+                visible: false
+            }
+        }
+
+        property bool openWhenReady: false
+
+        onLoaded: {
+            if (openWhenReady) {
+                openWhenReady = false;
+                item.open();
+            }
+        }
+    }
+
+    // 打开历史数据窗口（首次调用时异步加载）
+    function openHistoryDataWindow() {
+        if (historyDataWindowLoader.status === Loader.Ready) {
+            historyDataWindowLoader.item.show();
+            historyDataWindowLoader.item.raise();
+            historyDataWindowLoader.item.requestActivate();
+        } else {
+            historyDataWindowLoader.showWhenReady = true;
+            historyDataWindowLoader.active = true;
+        }
     }
 
-    SettingsDialog {
-        id: settingsDialog
-        anchors.centerIn: parent
-        visible: false
+    // 打开设置对话框（首次调用时异步加载）
+    function openSettingsDialog() {
+        if (settingsDialogLoader.status === Loader.Ready) {
+            settingsDialogLoader.item.open();
+        } else {
+            settingsDialogLoader.openWhenReady = true;
+            settingsDialogLoader.active = true;
+        }
     }
 
     // 警告消息组件
@@ -174,8 +226,6 @@ ApplicationWindow {
     Connections {
         target: dataSource
         function onMergedDataReceived(data) {
-            console.log("收到合并数据，长度: " + data.length);
-
             // 将数据分发给各个模块
             sensorModule.receiveData(data);
             vesselModule.receiveData(data);
@@ -183,4 +233,14 @@ ApplicationWindow {
         }
     }
 
+    // 围栏越界提示
+    Connections {
+        target: geofenceManager
+        function onTransition(fenceId, name, kind, entered, breach, latitude, longitude) {
+            if (breach) {
+                warningMessage.showWarning((kind === 0 ? "进入禁入区: " : "驶出作业区: ") + name, dangerColor);
+            }
+        }
+    }
+
 }
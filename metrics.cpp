@@ -0,0 +1,231 @@
+#include "metrics.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStringList>
+#include <QTextStream>
+
+quint64 LatencyHistogram::count() const
+{
+    quint64 total = 0;
+    for (const auto& b : m_buckets) {
+        total += b.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double LatencyHistogram::quantileNs(double q) const
+{
+    std::array<quint64, BUCKET_COUNT> snapshot;
+    quint64 total = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        snapshot[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += snapshot[i];
+    }
+    if (total == 0) return 0.0;
+
+    const double rank = q * static_cast<double>(total);
+    quint64 cumulative = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        if (snapshot[i] == 0) continue;
+        if (cumulative + snapshot[i] >= rank) {
+            const double lower = (i == 0) ? 0.0 : static_cast<double>(BOUNDS_NS[i - 1]);
+            // +Inf 桶没有上界，直接返回最后一个有限上界
+            if (i == BUCKET_COUNT - 1) return lower;
+            const double upper = static_cast<double>(BOUNDS_NS[i]);
+            const double fraction = (rank - cumulative) / static_cast<double>(snapshot[i]);
+            return lower + (upper - lower) * fraction;
+        }
+        cumulative += snapshot[i];
+    }
+    return static_cast<double>(BOUNDS_NS[BUCKET_COUNT - 2]);
+}
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::MetricsRegistry(QObject *parent)
+    : QObject(parent)
+    , rateTimer(new QTimer(this))
+    , exportTimer(new QTimer(this))
+{
+    serialBytes = counter("usv_serial_read_bytes_total", "Bytes read from the serial link");
+    framesDecoded = counter("usv_frames_decoded_total", "Complete frames extracted by the framer");
+    resyncBytes = counter("usv_resync_bytes_discarded_total", "Bytes discarded while searching for a frame header");
+    droppedFrameCount = counter("usv_frames_dropped_total", "Frames lost to header resynchronisation");
+    uiPublished = counter("usv_ui_publish_total", "Frames published to the QML front end");
+    dbRowsQueued = counter("usv_db_rows_queued_total", "Rows queued for the database thread");
+    dbRowsWritten = counter("usv_db_rows_written_total", "Rows written by the database thread");
+    rxBuffer = gauge("usv_rx_buffer_bytes", "Bytes waiting in the receive buffer");
+    framingLatency = histogram("usv_framing_duration_seconds", "Time spent in the framer per read");
+    parseLatency = histogram("usv_parse_duration_seconds", "Time spent decoding a frame in a module");
+    dbCommitLatency = histogram("usv_db_commit_duration_seconds", "Time spent executing one database insert");
+
+    connect(rateTimer, &QTimer::timeout, this, &MetricsRegistry::updateRates);
+    connect(exportTimer, &QTimer::timeout, this, &MetricsRegistry::writeTextfile);
+
+    m_lastRateNs = MetricsClock::nowNs();
+    rateTimer->start(1000);
+    exportTimer->setInterval(5000);
+}
+
+const MetricsRegistry::Entry* MetricsRegistry::findEntry(Kind kind, const QString& name, const QString& labels) const
+{
+    for (const Entry& entry : m_entries) {
+        if (entry.kind == kind && entry.name == name && entry.labels == labels) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+MetricCounter* MetricsRegistry::counter(const QString& name, const QString& help, const QString& labels)
+{
+    QMutexLocker locker(&m_mutex);
+    if (const Entry* existing = findEntry(Kind::Counter, name, labels)) {
+        return existing->counter;
+    }
+    m_counters.push_back(std::make_unique<MetricCounter>());
+    m_entries.push_back({Kind::Counter, name, help, labels, m_counters.back().get(), nullptr, nullptr});
+    return m_counters.back().get();
+}
+
+MetricGauge* MetricsRegistry::gauge(const QString& name, const QString& help, const QString& labels)
+{
+    QMutexLocker locker(&m_mutex);
+    if (const Entry* existing = findEntry(Kind::Gauge, name, labels)) {
+        return existing->gauge;
+    }
+    m_gauges.push_back(std::make_unique<MetricGauge>());
+    m_entries.push_back({Kind::Gauge, name, help, labels, nullptr, m_gauges.back().get(), nullptr});
+    return m_gauges.back().get();
+}
+
+LatencyHistogram* MetricsRegistry::histogram(const QString& name, const QString& help, const QString& labels)
+{
+    QMutexLocker locker(&m_mutex);
+    if (const Entry* existing = findEntry(Kind::Histogram, name, labels)) {
+        return existing->histogram;
+    }
+    m_histograms.push_back(std::make_unique<LatencyHistogram>());
+    m_entries.push_back({Kind::Histogram, name, help, labels, nullptr, nullptr, m_histograms.back().get()});
+    return m_histograms.back().get();
+}
+
+int MetricsRegistry::dbQueueDepth() const
+{
+    const quint64 queued = dbRowsQueued->value();
+    const quint64 written = dbRowsWritten->value();
+    return queued > written ? static_cast<int>(queued - written) : 0;
+}
+
+void MetricsRegistry::setTextfilePath(const QString& path)
+{
+    if (m_textfilePath == path) return;
+
+    m_textfilePath = path;
+    if (m_textfilePath.isEmpty()) {
+        exportTimer->stop();
+    } else {
+        exportTimer->start();
+    }
+    emit textfilePathChanged();
+}
+
+void MetricsRegistry::setExportInterval(int ms)
+{
+    exportTimer->setInterval(qMax(ms, 100));
+}
+
+void MetricsRegistry::updateRates()
+{
+    const qint64 now = MetricsClock::nowNs();
+    const double seconds = (now - m_lastRateNs) / 1e9;
+    if (seconds <= 0.0) return;
+
+    const quint64 bytes = serialBytes->value();
+    const quint64 frames = framesDecoded->value();
+    const quint64 published = uiPublished->value();
+
+    m_bytesPerSecond = (bytes - m_lastBytes) / seconds;
+    m_framesPerSecond = (frames - m_lastFrames) / seconds;
+    m_uiPublishRate = (published - m_lastPublished) / seconds;
+
+    m_lastBytes = bytes;
+    m_lastFrames = frames;
+    m_lastPublished = published;
+    m_lastRateNs = now;
+
+    emit updated();
+}
+
+QString MetricsRegistry::prometheusText() const
+{
+    QString text;
+    QTextStream out(&text);
+
+    auto series = [](const QString& name, const QString& labels, const QString& extra = QString()) {
+        QStringList parts;
+        if (!labels.isEmpty()) parts << labels;
+        if (!extra.isEmpty()) parts << extra;
+        return parts.isEmpty() ? name : QString("%1{%2}").arg(name, parts.join(','));
+    };
+
+    QMutexLocker locker(&m_mutex);
+    QStringList described;
+    for (const Entry& entry : m_entries) {
+        if (!described.contains(entry.name)) {
+            described << entry.name;
+            const char* type = entry.kind == Kind::Counter ? "counter"
+                             : entry.kind == Kind::Gauge ? "gauge" : "histogram";
+            out << "# HELP " << entry.name << ' ' << entry.help << '\n';
+            out << "# TYPE " << entry.name << ' ' << type << '\n';
+        }
+
+        switch (entry.kind) {
+        case Kind::Counter:
+            out << series(entry.name, entry.labels) << ' ' << entry.counter->value() << '\n';
+            break;
+        case Kind::Gauge:
+            out << series(entry.name, entry.labels) << ' ' << entry.gauge->value() << '\n';
+            break;
+        case Kind::Histogram: {
+            const LatencyHistogram* h = entry.histogram;
+            quint64 cumulative = 0;
+            for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+                cumulative += h->bucket(i);
+                const QString le = (i < LatencyHistogram::BUCKET_COUNT - 1)
+                                       ? QString::number(LatencyHistogram::BOUNDS_NS[i] / 1e9, 'g', 6)
+                                       : QStringLiteral("+Inf");
+                out << series(entry.name + "_bucket", entry.labels, QString("le=\"%1\"").arg(le))
+                    << ' ' << cumulative << '\n';
+            }
+            out << series(entry.name + "_sum", entry.labels) << ' '
+                << QString::number(h->sumNs() / 1e9, 'g', 12) << '\n';
+            out << series(entry.name + "_count", entry.labels) << ' ' << cumulative << '\n';
+            break;
+        }
+        }
+    }
+    out.flush();
+    return text;
+}
+
+void MetricsRegistry::writeTextfile()
+{
+    if (m_textfilePath.isEmpty()) return;
+
+    // QSaveFile 先写临时文件再原子重命名，node_exporter 不会读到半截内容
+    QSaveFile file(m_textfilePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "无法写入指标文件:" << m_textfilePath << file.errorString();
+        return;
+    }
+    file.write(prometheusText().toUtf8());
+    if (!file.commit()) {
+        qWarning() << "指标文件提交失败:" << m_textfilePath << file.errorString();
+    }
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QMutex>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+
+// 指标采集：热路径只做一次 relaxed 原子操作，格式化与导出在定时器中完成
+namespace MetricsClock {
+// 单调时钟（纳秒）
+inline qint64 nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+// 单调递增计数器
+class MetricCounter {
+public:
+    void add(quint64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    quint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<quint64> m_value{0};
+};
+
+// 瞬时值（队列深度、缓冲区大小等）
+class MetricGauge {
+public:
+    void set(qint64 v) { m_value.store(v, std::memory_order_relaxed); }
+    void add(qint64 n) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<qint64> m_value{0};
+};
+
+// 固定分桶的延迟直方图（纳秒记录，按秒导出）
+class LatencyHistogram {
+public:
+    static constexpr int BUCKET_COUNT = 16;
+    // 各桶上界（纳秒），最后一个桶为 +Inf
+    static constexpr std::array<qint64, BUCKET_COUNT - 1> BOUNDS_NS = {
+        1000, 5000, 10000, 50000, 100000, 500000,
+        1000000, 5000000, 10000000, 25000000, 50000000, 100000000,
+        250000000, 500000000, 1000000000
+    };
+
+    void observe(qint64 ns)
+    {
+        int i = 0;
+        while (i < BUCKET_COUNT - 1 && ns > BOUNDS_NS[i]) ++i;
+        m_buckets[i].fetch_add(1, std::memory_order_relaxed);
+        m_sumNs.fetch_add(ns > 0 ? static_cast<quint64>(ns) : 0, std::memory_order_relaxed);
+    }
+
+    quint64 count() const;
+    quint64 bucket(int i) const { return m_buckets[i].load(std::memory_order_relaxed); }
+    quint64 sumNs() const { return m_sumNs.load(std::memory_order_relaxed); }
+    // 按分桶线性插值估计分位数（纳秒）
+    double quantileNs(double q) const;
+
+private:
+    std::array<std::atomic<quint64>, BUCKET_COUNT> m_buckets{};
+    std::atomic<quint64> m_sumNs{0};
+};
+
+// 作用域计时，析构时写入直方图
+class MetricScopeTimer {
+public:
+    explicit MetricScopeTimer(LatencyHistogram* histogram)
+        : m_histogram(histogram), m_startNs(MetricsClock::nowNs()) {}
+    ~MetricScopeTimer() { m_histogram->observe(MetricsClock::nowNs() - m_startNs); }
+
+private:
+    LatencyHistogram* m_histogram;
+    qint64 m_startNs;
+};
+
+class MetricsRegistry : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(double bytesPerSecond READ bytesPerSecond NOTIFY updated)
+    Q_PROPERTY(double framesPerSecond READ framesPerSecond NOTIFY updated)
+    Q_PROPERTY(double uiPublishRate READ uiPublishRate NOTIFY updated)
+    Q_PROPERTY(double resyncBytesDiscarded READ resyncBytesDiscarded NOTIFY updated)
+    Q_PROPERTY(double droppedFrames READ droppedFrames NOTIFY updated)
+    Q_PROPERTY(double parseTimeP50Us READ parseTimeP50Us NOTIFY updated)
+    Q_PROPERTY(double parseTimeP99Us READ parseTimeP99Us NOTIFY updated)
+    Q_PROPERTY(double dbCommitP50Ms READ dbCommitP50Ms NOTIFY updated)
+    Q_PROPERTY(double dbCommitP99Ms READ dbCommitP99Ms NOTIFY updated)
+    Q_PROPERTY(int dbQueueDepth READ dbQueueDepth NOTIFY updated)
+    Q_PROPERTY(int rxBufferBytes READ rxBufferBytes NOTIFY updated)
+    Q_PROPERTY(QString textfilePath READ textfilePath WRITE setTextfilePath NOTIFY textfilePathChanged)
+
+public:
+    static MetricsRegistry& instance();
+
+    // 注册指标（冷路径，加锁）；返回的指针在进程生命周期内有效
+    MetricCounter* counter(const QString& name, const QString& help, const QString& labels = QString());
+    MetricGauge* gauge(const QString& name, const QString& help, const QString& labels = QString());
+    LatencyHistogram* histogram(const QString& name, const QString& help, const QString& labels = QString());
+
+    // 内置的接收流水线指标
+    MetricCounter* serialBytes = nullptr;       // 串口读取字节数
+    MetricCounter* framesDecoded = nullptr;     // 完整帧数
+    MetricCounter* resyncBytes = nullptr;       // 失步丢弃字节数
+    MetricCounter* droppedFrameCount = nullptr; // 因失步丢弃的帧
+    MetricCounter* uiPublished = nullptr;       // 发布到界面的帧
+    MetricCounter* dbRowsQueued = nullptr;      // 入队待写数据库的行
+    MetricCounter* dbRowsWritten = nullptr;     // 已写入数据库的行
+    MetricGauge* rxBuffer = nullptr;            // 接收缓冲区字节数
+    LatencyHistogram* framingLatency = nullptr; // 帧切分耗时
+    LatencyHistogram* parseLatency = nullptr;   // 模块解析耗时
+    LatencyHistogram* dbCommitLatency = nullptr;// 数据库写入耗时
+
+    double bytesPerSecond() const { return m_bytesPerSecond; }
+    double framesPerSecond() const { return m_framesPerSecond; }
+    double uiPublishRate() const { return m_uiPublishRate; }
+    double resyncBytesDiscarded() const { return static_cast<double>(resyncBytes->value()); }
+    double droppedFrames() const { return static_cast<double>(droppedFrameCount->value()); }
+    double parseTimeP50Us() const { return parseLatency->quantileNs(0.50) / 1000.0; }
+    double parseTimeP99Us() const { return parseLatency->quantileNs(0.99) / 1000.0; }
+    double dbCommitP50Ms() const { return dbCommitLatency->quantileNs(0.50) / 1e6; }
+    double dbCommitP99Ms() const { return dbCommitLatency->quantileNs(0.99) / 1e6; }
+    int dbQueueDepth() const;
+    int rxBufferBytes() const { return static_cast<int>(rxBuffer->value()); }
+    QString textfilePath() const { return m_textfilePath; }
+
+    // Prometheus 文本格式
+    Q_INVOKABLE QString prometheusText() const;
+
+public slots:
+    // 设置 node_exporter textfile 输出路径，为空则不导出
+    void setTextfilePath(const QString& path);
+    void setExportInterval(int ms);
+
+signals:
+    void updated();
+    void textfilePathChanged();
+
+private:
+    explicit MetricsRegistry(QObject *parent = nullptr);
+
+    enum class Kind { Counter, Gauge, Histogram };
+    struct Entry {
+        Kind kind;
+        QString name;
+        QString help;
+        QString labels;
+        MetricCounter* counter;
+        MetricGauge* gauge;
+        LatencyHistogram* histogram;
+    };
+
+    const Entry* findEntry(Kind kind, const QString& name, const QString& labels) const;
+    void updateRates();
+    void writeTextfile();
+
+    mutable QMutex m_mutex;
+    std::deque<Entry> m_entries;
+    std::deque<std::unique_ptr<MetricCounter>> m_counters;
+    std::deque<std::unique_ptr<MetricGauge>> m_gauges;
+    std::deque<std::unique_ptr<LatencyHistogram>> m_histograms;
+
+    QTimer* rateTimer;
+    QTimer* exportTimer;
+    QString m_textfilePath;
+    qint64 m_lastRateNs = 0;
+    quint64 m_lastBytes = 0;
+    quint64 m_lastFrames = 0;
+    quint64 m_lastPublished = 0;
+    double m_bytesPerSecond = 0.0;
+    double m_framesPerSecond = 0.0;
+    double m_uiPublishRate = 0.0;
+};
@@ -0,0 +1,190 @@
+#include "mission_planner.h"
+#include "datasource.h"
+#include "route_optimizer.h"
+#include "geodesy.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+
+MissionPlanner::MissionPlanner(DataSource* dataSource, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_dataSource(dataSource)
+{
+}
+
+int MissionPlanner::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_points.size();
+}
+
+QVariant MissionPlanner::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_points.size()) return QVariant();
+
+    const MissionPoint& point = m_points.at(index.row());
+    switch (role) {
+    case LatitudeRole: return point.latitude;
+    case LongitudeRole: return point.longitude;
+    case CoordinateRole: return QVariant::fromValue(QGeoCoordinate(point.latitude, point.longitude));
+    case LegDistanceRole: return m_legs.value(index.row());
+    case BearingRole: return m_bearings.value(index.row());
+    case EtaRole: return m_cumulative.value(index.row()) / m_cruiseSpeed;
+    default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> MissionPlanner::roleNames() const
+{
+    return {
+        {LatitudeRole, "latitude"},
+        {LongitudeRole, "longitude"},
+        {CoordinateRole, "coordinate"},
+        {LegDistanceRole, "legDistance"},
+        {BearingRole, "bearing"},
+        {EtaRole, "eta"}
+    };
+}
+
+QGeoCoordinate MissionPlanner::homeCoordinate() const
+{
+    return m_hasHome ? QGeoCoordinate(m_home.latitude, m_home.longitude) : QGeoCoordinate();
+}
+
+QVariantList MissionPlanner::path() const
+{
+    QVariantList path;
+    path.reserve(m_points.size() + 1);
+    if (m_hasHome) path.append(QVariant::fromValue(homeCoordinate()));
+    for (const MissionPoint& point : m_points) {
+        path.append(QVariant::fromValue(QGeoCoordinate(point.latitude, point.longitude)));
+    }
+    return path;
+}
+
+QVector<MissionPoint> MissionPlanner::route() const
+{
+    QVector<MissionPoint> route;
+    route.reserve(m_points.size() + 1);
+    route.append(m_home);
+    route.append(m_points);
+    return route;
+}
+
+void MissionPlanner::setHome(double latitude, double longitude)
+{
+    m_home = {longitude, latitude};
+    m_hasHome = true;
+    m_homeTimestamp = QDateTime::currentSecsSinceEpoch();
+    emit homeChanged();
+    updateLegs();
+}
+
+void MissionPlanner::append(double latitude, double longitude)
+{
+    beginInsertRows(QModelIndex(), m_points.size(), m_points.size());
+    m_points.append({longitude, latitude});
+    endInsertRows();
+    emit countChanged();
+    updateLegs();
+}
+
+void MissionPlanner::remove(int index)
+{
+    if (index < 0 || index >= m_points.size()) return;
+
+    beginRemoveRows(QModelIndex(), index, index);
+    m_points.removeAt(index);
+    endRemoveRows();
+    emit countChanged();
+    updateLegs();
+}
+
+void MissionPlanner::clear()
+{
+    if (m_points.isEmpty()) return;
+
+    beginResetModel();
+    m_points.clear();
+    endResetModel();
+    emit countChanged();
+    updateLegs();
+}
+
+bool MissionPlanner::optimize(bool closedLoop)
+{
+    if (!m_hasHome || m_points.size() < 2) return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const double before = m_totalDistance;
+    const QVector<MissionPoint> points = route();
+    RouteOptimizer::Options options;
+    options.closedLoop = closedLoop;
+    const RouteOptimizer::Result result = RouteOptimizer::optimize(points, options);
+
+    beginResetModel();
+    for (int i = 1; i < result.order.size(); ++i) {
+        m_points[i - 1] = points[result.order[i]];
+    }
+    endResetModel();
+    updateLegs();
+
+    m_lastOptimizeMs = timer.nsecsElapsed() / 1e6;
+    qDebug() << "航线优化完成，点数:" << m_points.size() << "耗时:" << m_lastOptimizeMs << "ms"
+             << "航程:" << before << "->" << m_totalDistance << "m"
+             << "2-opt:" << result.twoOptMoves << "Or-opt:" << result.orOptMoves;
+    emit optimized(before - m_totalDistance, m_lastOptimizeMs);
+    return true;
+}
+
+bool MissionPlanner::upload()
+{
+    if (!m_hasHome || m_points.isEmpty()) return false;
+    return m_dataSource->sendMission(m_homeTimestamp, route());
+}
+
+void MissionPlanner::setCruiseSpeed(double metersPerSecond)
+{
+    metersPerSecond = qMax(MIN_CRUISE_SPEED, metersPerSecond);
+    if (qFuzzyCompare(m_cruiseSpeed, metersPerSecond)) return;
+
+    m_cruiseSpeed = metersPerSecond;
+    emit cruiseSpeedChanged();
+    if (!m_points.isEmpty()) {
+        emit dataChanged(index(0), index(m_points.size() - 1), {EtaRole});
+    }
+    emit routeChanged();
+}
+
+void MissionPlanner::updateLegs()
+{
+    const int count = m_points.size();
+    m_legs.fill(0.0, count);
+    m_bearings.fill(0.0, count);
+    m_cumulative.fill(0.0, count);
+    m_totalDistance = 0.0;
+
+    if (count > 0) {
+        // 航线整理为 SoA 数组后批量计算各段距离与方位；未设置 Home 点时首段为 0
+        const int offset = m_hasHome ? 1 : 0;
+        QVector<double> lat(count + offset), lon(count + offset);
+        if (m_hasHome) {
+            lat[0] = m_home.latitude;
+            lon[0] = m_home.longitude;
+        }
+        for (int i = 0; i < count; ++i) {
+            lat[i + offset] = m_points[i].latitude;
+            lon[i + offset] = m_points[i].longitude;
+        }
+        Geodesy::segmentDistances(lat.constData(), lon.constData(), lat.size(), m_legs.data() + 1 - offset);
+        Geodesy::segmentBearings(lat.constData(), lon.constData(), lat.size(), m_bearings.data() + 1 - offset);
+
+        for (int i = 0; i < count; ++i) {
+            m_totalDistance += m_legs[i];
+            m_cumulative[i] = m_totalDistance;
+        }
+        emit dataChanged(index(0), index(count - 1), {LegDistanceRole, BearingRole, EtaRole});
+    }
+    emit routeChanged();
+}
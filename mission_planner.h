@@ -0,0 +1,85 @@
+#pragma once
+
+#include "frame_codec.h"
+#include <QAbstractListModel>
+#include <QGeoCoordinate>
+#include <QVariantList>
+#include <QVector>
+
+class DataSource;
+
+// 任务规划模型：保存 Home 点与按访问顺序排列的任务点（类型化坐标），
+// 维护每段航程的大圆距离，支持航线优化，并直接交给 DataSource 编码发送，
+// 不再经过 “经度,纬度,时间” 字符串往返。
+class MissionPlanner : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(bool hasHome READ hasHome NOTIFY homeChanged)
+    Q_PROPERTY(QGeoCoordinate homeCoordinate READ homeCoordinate NOTIFY homeChanged)
+    Q_PROPERTY(double totalDistance READ totalDistance NOTIFY routeChanged)
+    Q_PROPERTY(QVariantList path READ path NOTIFY routeChanged)
+    Q_PROPERTY(double cruiseSpeed READ cruiseSpeed WRITE setCruiseSpeed NOTIFY cruiseSpeedChanged)
+    Q_PROPERTY(double totalDuration READ totalDuration NOTIFY routeChanged)
+    Q_PROPERTY(double lastOptimizeMs READ lastOptimizeMs NOTIFY optimized)
+public:
+    enum Roles {
+        LatitudeRole = Qt::UserRole + 1,
+        LongitudeRole,
+        CoordinateRole,
+        LegDistanceRole,    // 从上一个点（首点为 Home 点）到本点的距离（米）
+        BearingRole,        // 本航段的初始方位角（度）
+        EtaRole             // 按巡航速度从 Home 点出发到达本点的时间（秒）
+    };
+
+    static constexpr double DEFAULT_CRUISE_SPEED = 1.5;    // m/s
+    static constexpr double MIN_CRUISE_SPEED = 0.1;
+
+    explicit MissionPlanner(DataSource* dataSource, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool hasHome() const { return m_hasHome; }
+    QGeoCoordinate homeCoordinate() const;
+    double totalDistance() const { return m_totalDistance; }
+    double cruiseSpeed() const { return m_cruiseSpeed; }
+    void setCruiseSpeed(double metersPerSecond);
+    double totalDuration() const { return m_totalDistance / m_cruiseSpeed; }
+    QVariantList path() const;
+    double lastOptimizeMs() const { return m_lastOptimizeMs; }
+
+    // Home 点在前的完整航线
+    QVector<MissionPoint> route() const;
+    qint64 homeTimestamp() const { return m_homeTimestamp; }
+
+    Q_INVOKABLE void setHome(double latitude, double longitude);
+    Q_INVOKABLE void append(double latitude, double longitude);
+    Q_INVOKABLE void remove(int index);
+    Q_INVOKABLE void clear();
+    // 从 Home 点出发重排任务点；closedLoop 为 true 时按返回 Home 点计算航程
+    Q_INVOKABLE bool optimize(bool closedLoop = false);
+    Q_INVOKABLE bool upload();
+
+signals:
+    void countChanged();
+    void homeChanged();
+    void routeChanged();
+    void cruiseSpeedChanged();
+    void optimized(double savedMeters, double elapsedMs);
+
+private:
+    void updateLegs();
+
+    DataSource* m_dataSource;
+    MissionPoint m_home;
+    bool m_hasHome = false;
+    qint64 m_homeTimestamp = 0;     // 设置 Home 点的时间（秒）
+    QVector<MissionPoint> m_points;
+    QVector<double> m_legs;
+    QVector<double> m_bearings;
+    QVector<double> m_cumulative;   // 从 Home 点起的累计航程
+    double m_totalDistance = 0.0;
+    double m_cruiseSpeed = DEFAULT_CRUISE_SPEED;
+    double m_lastOptimizeMs = 0.0;
+};
@@ -0,0 +1,429 @@
+#include "mission_upload.h"
+#include "command_scheduler.h"
+#include "metrics.h"
+#include "trace.h"
+#include <QDebug>
+#include <QtEndian>
+#include <cstring>
+
+using namespace FrameConstants;
+
+namespace {
+
+QByteArray makeChunkFrame(quint16 missionId, quint16 seq, quint16 total, const char* payload, int length)
+{
+    QByteArray frame(MISSION_CHUNK_HEADER_SIZE + length + MISSION_CHUNK_CRC_SIZE, '\0');
+    char* out = frame.data();
+    out[0] = static_cast<char>(FRAME_HEADER);
+    out[1] = static_cast<char>(FRAME_TRAILER);
+    out[2] = static_cast<char>(MISSION_CHUNK_FRAME_TYPE);
+    qToLittleEndian<quint16>(missionId, out + 3);
+    qToLittleEndian<quint16>(seq, out + 5);
+    qToLittleEndian<quint16>(total, out + 7);
+    out[9] = static_cast<char>(length);
+    std::memcpy(out + MISSION_CHUNK_HEADER_SIZE, payload, static_cast<size_t>(length));
+
+    // CRC 覆盖类型字节到负载末尾
+    const int crcOffset = MISSION_CHUNK_HEADER_SIZE + length;
+    qToLittleEndian<quint16>(crc16Ccitt(out + FRAME_HEADER_SIZE, crcOffset - FRAME_HEADER_SIZE), out + crcOffset);
+    return frame;
+}
+
+quint8 xorChecksum(const char* data, int size)
+{
+    quint8 checksum = 0;
+    for (int i = 0; i < size; ++i) {
+        checksum ^= static_cast<quint8>(data[i]);
+    }
+    return checksum;
+}
+
+}
+
+QVector<QByteArray> encodeMissionChunks(quint16 missionId, qint64 timestampSecs,
+                                        const QVector<MissionPoint>& points, const ControlState& control)
+{
+    const int dataChunks = (points.size() + MISSION_CHUNK_POINTS - 1) / MISSION_CHUNK_POINTS;
+    const quint16 total = static_cast<quint16>(1 + dataChunks);
+
+    QVector<QByteArray> chunks;
+    chunks.reserve(total);
+
+    // 任务头：时间戳 + 航点总数 + 控制指令块
+    char header[MISSION_HEADER_PAYLOAD_SIZE];
+    qToLittleEndian<qint64>(timestampSecs, header);
+    qToLittleEndian<quint16>(static_cast<quint16>(points.size()), header + TIMESTAMP_LENGTH);
+    encodeControlBlock(header + TIMESTAMP_LENGTH + 2, control);
+    chunks.append(makeChunkFrame(missionId, 0, total, header, MISSION_HEADER_PAYLOAD_SIZE));
+
+    char payload[MISSION_CHUNK_POINTS * TASK_POINT_SIZE];
+    for (int chunk = 0; chunk < dataChunks; ++chunk) {
+        const int first = chunk * MISSION_CHUNK_POINTS;
+        const int count = qMin(MISSION_CHUNK_POINTS, points.size() - first);
+        for (int i = 0; i < count; ++i) {
+            encodeCoordinatePair(payload + i * TASK_POINT_SIZE, points[first + i].longitude, points[first + i].latitude);
+        }
+        chunks.append(makeChunkFrame(missionId, static_cast<quint16>(chunk + 1), total, payload, count * TASK_POINT_SIZE));
+    }
+    return chunks;
+}
+
+MissionUploader::MissionUploader(CommandScheduler* scheduler, QObject *parent)
+    : QObject(parent)
+    , m_scheduler(scheduler)
+    , ackTimer(new QTimer(this))
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    m_chunksSent = metrics.counter("usv_mission_chunks_sent_total", "Mission upload chunks sent, including retransmissions");
+    m_chunksRetransmitted = metrics.counter("usv_mission_chunks_retransmitted_total", "Mission upload chunks sent again after loss or timeout");
+    m_uploadsCompleted = metrics.counter("usv_mission_uploads_completed_total", "Chunked mission uploads acknowledged in full");
+    m_uploadsFailed = metrics.counter("usv_mission_uploads_failed_total", "Chunked mission uploads cancelled or timed out");
+    m_throughputGauge = metrics.gauge("usv_mission_upload_throughput_bytes", "Goodput of the last chunked mission upload in bytes per second");
+
+    ackTimer->setSingleShot(true);
+    ackTimer->setInterval(ACK_TIMEOUT_MS);
+    connect(ackTimer, &QTimer::timeout, this, &MissionUploader::onAckTimeout);
+    connect(m_scheduler, &CommandScheduler::commandCompleted, this, [this](quint64 id, const QString& kind) {
+        onChunkWritten(id, kind);
+    });
+    connect(m_scheduler, &CommandScheduler::commandFailed, this, [this](quint64 id, const QString& kind) {
+        onChunkFailed(id, kind);
+    });
+}
+
+bool MissionUploader::start(qint64 timestampSecs, const QVector<MissionPoint>& points, const ControlState& control)
+{
+    if (m_busy) {
+        qWarning() << "上一次任务上传尚未完成";
+        return false;
+    }
+    if (points.isEmpty() || points.size() > MAX_MISSION_POINTS) {
+        qWarning() << "任务航点数量无效:" << points.size();
+        return false;
+    }
+
+    ++m_missionId;
+    m_chunks = encodeMissionChunks(m_missionId, timestampSecs, points, control);
+    m_states = QVector<ChunkState>(m_chunks.size(), Pending);
+    m_sendOrder = QVector<quint32>(m_chunks.size(), 0);
+    m_commandSeq.clear();
+    m_linkIdleNs = 0;
+    m_sendCounter = 0;
+    m_highestAckedOrder = 0;
+    m_base = 0;
+    m_ackedCount = 0;
+    m_timeouts = 0;
+    m_retransmits = 0;
+    m_payloadBytes = 0;
+    for (const QByteArray& chunk : m_chunks) {
+        m_payloadBytes += chunk.size();
+    }
+    m_startNs = MetricsClock::nowNs();
+    m_throughput = 0.0;
+
+    m_busy = true;
+    emit busyChanged();
+    emit progressChanged();
+
+    qDebug() << "开始分块上传任务" << m_missionId << "航点:" << points.size() << "分块:" << m_chunks.size();
+    // 确认计时在第一块写出后开始
+    fillWindow();
+    return true;
+}
+
+void MissionUploader::cancel()
+{
+    if (!m_busy) return;
+    finish(false, "任务上传已取消");
+}
+
+void MissionUploader::fillWindow()
+{
+    const int end = qMin(m_base + WINDOW_SIZE, m_chunks.size());
+    for (int seq = m_base; seq < end; ++seq) {
+        if (m_states[seq] == Pending) sendChunk(seq, false);
+    }
+}
+
+void MissionUploader::sendChunk(int seq, bool retransmit)
+{
+    // 先记为排队再入队：写出失败可能在 enqueue 内同步回调
+    m_states[seq] = Queued;
+    m_sendOrder[seq] = ++m_sendCounter;
+    m_enqueueSeq = seq;
+    const quint64 id = m_scheduler->enqueue(CommandScheduler::Mission, m_chunks[seq], "mission-chunk");
+    m_enqueueSeq = -1;
+    if (m_states[seq] == Queued) m_commandSeq.insert(id, seq);
+    m_chunksSent->add();
+    if (retransmit) {
+        ++m_retransmits;
+        m_chunksRetransmitted->add();
+        USV_TRACE2(Trace::Category::Command, Trace::Level::Info, "mission.retransmit", m_missionId, seq);
+    }
+}
+
+void MissionUploader::handleAck(const char* frame)
+{
+    if (!m_busy) return;
+    if (xorChecksum(frame + 2, MISSION_ACK_FRAME_SIZE - 3) != static_cast<quint8>(frame[MISSION_ACK_FRAME_SIZE - 1])) {
+        qDebug() << "任务确认帧校验失败";
+        return;
+    }
+    if (qFromLittleEndian<quint16>(frame + 2) != m_missionId) return;
+
+    const int cumulative = qFromLittleEndian<quint16>(frame + 4);
+    const quint32 bitmap = qFromLittleEndian<quint32>(frame + 6);
+    const int acksBefore = m_ackedCount;
+
+    auto markAcked = [this](int seq) {
+        if (seq < 0 || seq >= m_chunks.size() || m_states[seq] == Acked) return;
+        m_states[seq] = Acked;
+        m_highestAckedOrder = qMax(m_highestAckedOrder, m_sendOrder[seq]);
+        ++m_ackedCount;
+    };
+    for (int seq = m_base; seq < qMin(cumulative, m_chunks.size()); ++seq) {
+        markAcked(seq);
+    }
+    for (int bit = 0; bit < 32; ++bit) {
+        if (bitmap & (1u << bit)) markAcked(cumulative + 1 + bit);
+    }
+    while (m_base < m_chunks.size() && m_states[m_base] == Acked) {
+        ++m_base;
+    }
+
+    if (m_ackedCount == m_chunks.size()) {
+        finish(true, QString("任务上传完成，共 %1 块，重传 %2 块").arg(m_chunks.size()).arg(m_retransmits));
+        return;
+    }
+
+    if (m_ackedCount != acksBefore) {
+        m_timeouts = 0;
+        restartAckTimer();
+        updateThroughput();
+        emit progressChanged();
+    }
+
+    // 链路按序传输：比某个已确认块更早发出却仍未确认的块视为丢失，立即只重传这些块
+    const int end = qMin(m_base + WINDOW_SIZE, m_chunks.size());
+    for (int seq = m_base; seq < end; ++seq) {
+        if (m_states[seq] == Sent && m_sendOrder[seq] < m_highestAckedOrder) {
+            sendChunk(seq, true);
+        }
+    }
+    fillWindow();
+}
+
+int MissionUploader::takeCommandSeq(quint64 commandId, const QString& kind)
+{
+    if (kind != QLatin1String("mission-chunk")) return -1;
+    const auto it = m_commandSeq.constFind(commandId);
+    if (it == m_commandSeq.constEnd()) return m_enqueueSeq;
+    const int seq = it.value();
+    m_commandSeq.erase(it);
+    return seq;
+}
+
+void MissionUploader::onChunkWritten(quint64 commandId, const QString& kind)
+{
+    const int seq = takeCommandSeq(commandId, kind);
+    if (!m_busy || seq < 0 || m_states[seq] != Queued) return;
+
+    // 块已交给串口驱动：按波特率推算它离开串口的时间，从那时起等待确认
+    m_states[seq] = Sent;
+    if (m_baudRate > 0) {
+        const qint64 wireNs = m_chunks[seq].size() * 10LL * 1000000000LL / m_baudRate;  // 8N1 每字节 10 位
+        m_linkIdleNs = qMax(m_linkIdleNs, MetricsClock::nowNs()) + wireNs;
+    }
+    restartAckTimer();
+}
+
+void MissionUploader::onChunkFailed(quint64 commandId, const QString& kind)
+{
+    const int seq = takeCommandSeq(commandId, kind);
+    if (!m_busy || seq < 0 || m_states[seq] != Queued) return;
+
+    // 没有写出：在下一次确认或超时时按未发送块重新入队
+    m_states[seq] = Pending;
+    if (!ackTimer->isActive()) restartAckTimer();
+}
+
+void MissionUploader::restartAckTimer()
+{
+    const qint64 drainNs = qMax<qint64>(0, m_linkIdleNs - MetricsClock::nowNs());
+    ackTimer->start(ACK_TIMEOUT_MS + static_cast<int>(drainNs / 1000000));
+}
+
+void MissionUploader::onAckTimeout()
+{
+    if (!m_busy) return;
+
+    if (++m_timeouts > MAX_TIMEOUTS) {
+        finish(false, "任务上传超时：船端无确认");
+        return;
+    }
+
+    // 只重传窗口内已发出但未确认的块
+    const int end = qMin(m_base + WINDOW_SIZE, m_chunks.size());
+    for (int seq = m_base; seq < end; ++seq) {
+        if (m_states[seq] == Sent) sendChunk(seq, true);
+    }
+    fillWindow();
+    restartAckTimer();
+    emit progressChanged();
+}
+
+void MissionUploader::updateThroughput()
+{
+    const qint64 elapsedNs = MetricsClock::nowNs() - m_startNs;
+    if (elapsedNs <= 0) return;
+
+    qint64 ackedBytes = 0;
+    for (int seq = 0; seq < m_chunks.size(); ++seq) {
+        if (m_states[seq] == Acked) ackedBytes += m_chunks[seq].size();
+    }
+    m_throughput = ackedBytes * 1e9 / elapsedNs;
+}
+
+void MissionUploader::finish(bool ok, const QString& message)
+{
+    ackTimer->stop();
+    m_commandSeq.clear();
+    updateThroughput();
+    m_throughputGauge->set(static_cast<qint64>(m_throughput));
+    (ok ? m_uploadsCompleted : m_uploadsFailed)->add();
+
+    m_busy = false;
+    qDebug() << message << "吞吐:" << m_throughput << "B/s";
+    emit busyChanged();
+    emit progressChanged();
+    emit finished(ok, message);
+}
+
+MissionLoopbackDevice::MissionLoopbackDevice(QObject *parent)
+    : QIODevice(parent)
+    , m_rng(1)
+{
+}
+
+void MissionLoopbackDevice::setDropRate(double dropRate, quint32 seed)
+{
+    m_dropRate = qBound(0.0, dropRate, 1.0);
+    m_rng.seed(seed);
+}
+
+bool MissionLoopbackDevice::isComplete() const
+{
+    if (m_totalChunks == 0) return false;
+    for (const QByteArray& payload : m_received) {
+        if (payload.isNull()) return false;
+    }
+    return true;
+}
+
+QVector<MissionPoint> MissionLoopbackDevice::receivedPoints() const
+{
+    QVector<MissionPoint> points;
+    if (!isComplete()) return points;
+
+    points.reserve(m_pointCount);
+    for (int seq = 1; seq < m_received.size(); ++seq) {
+        const QByteArray& payload = m_received[seq];
+        for (int offset = 0; offset + TASK_POINT_SIZE <= payload.size(); offset += TASK_POINT_SIZE) {
+            MissionPoint point;
+            decodeCoordinatePair(payload.constData() + offset, point.longitude, point.latitude);
+            points.append(point);
+        }
+    }
+    return points;
+}
+
+qint64 MissionLoopbackDevice::readData(char* data, qint64 maxSize)
+{
+    const int count = static_cast<int>(qMin<qint64>(maxSize, m_readBuffer.size()));
+    std::memcpy(data, m_readBuffer.constData(), static_cast<size_t>(count));
+    m_readBuffer.remove(0, count);
+    return count;
+}
+
+qint64 MissionLoopbackDevice::writeData(const char* data, qint64 size)
+{
+    m_writeBuffer.append(data, static_cast<int>(size));
+
+    // 按分块帧格式切分；不是分块帧的数据（控制帧等）直接丢弃
+    while (m_writeBuffer.size() >= MISSION_CHUNK_HEADER_SIZE) {
+        const char* p = m_writeBuffer.constData();
+        if (static_cast<quint8>(p[0]) != FRAME_HEADER || static_cast<quint8>(p[1]) != FRAME_TRAILER
+            || static_cast<quint8>(p[2]) != MISSION_CHUNK_FRAME_TYPE) {
+            const void* next = std::memchr(p + 1, FRAME_HEADER, m_writeBuffer.size() - 1);
+            m_writeBuffer.remove(0, next ? static_cast<int>(static_cast<const char*>(next) - p) : m_writeBuffer.size());
+            continue;
+        }
+
+        const int frameSize = MISSION_CHUNK_HEADER_SIZE + static_cast<quint8>(p[9]) + MISSION_CHUNK_CRC_SIZE;
+        if (m_writeBuffer.size() < frameSize) break;
+        handleChunk(p, frameSize);
+        m_writeBuffer.remove(0, frameSize);
+    }
+
+    // 与串口一致：写出确认在事件循环中异步投递
+    QTimer::singleShot(0, this, [this, size]() { emit bytesWritten(size); });
+    return size;
+}
+
+void MissionLoopbackDevice::handleChunk(const char* frame, int size)
+{
+    const int crcOffset = size - MISSION_CHUNK_CRC_SIZE;
+    if (crc16Ccitt(frame + FRAME_HEADER_SIZE, crcOffset - FRAME_HEADER_SIZE) != qFromLittleEndian<quint16>(frame + crcOffset)) {
+        return;
+    }
+
+    const quint16 missionId = qFromLittleEndian<quint16>(frame + 3);
+    const int seq = qFromLittleEndian<quint16>(frame + 5);
+    const int total = qFromLittleEndian<quint16>(frame + 7);
+    if (missionId != m_missionId || total != m_totalChunks) {
+        // 新任务：清空重组状态
+        m_missionId = missionId;
+        m_totalChunks = total;
+        m_received = QVector<QByteArray>(total);
+        m_timestamp = 0;
+        m_pointCount = 0;
+    }
+    if (seq >= m_totalChunks) return;
+
+    if (m_dropRate > 0.0 && m_rng.generateDouble() < m_dropRate) {
+        ++m_dropped;
+        return;
+    }
+
+    const int length = static_cast<quint8>(frame[9]);
+    m_received[seq] = QByteArray(frame + MISSION_CHUNK_HEADER_SIZE, length);
+    if (seq == 0 && length >= MISSION_HEADER_PAYLOAD_SIZE) {
+        m_timestamp = qFromLittleEndian<qint64>(frame + MISSION_CHUNK_HEADER_SIZE);
+        m_pointCount = qFromLittleEndian<quint16>(frame + MISSION_CHUNK_HEADER_SIZE + TIMESTAMP_LENGTH);
+    }
+    sendAck();
+}
+
+void MissionLoopbackDevice::sendAck()
+{
+    int cumulative = 0;
+    while (cumulative < m_received.size() && !m_received[cumulative].isNull()) {
+        ++cumulative;
+    }
+    quint32 bitmap = 0;
+    for (int bit = 0; bit < 32; ++bit) {
+        const int seq = cumulative + 1 + bit;
+        if (seq < m_received.size() && !m_received[seq].isNull()) bitmap |= (1u << bit);
+    }
+
+    char ack[MISSION_ACK_FRAME_SIZE];
+    ack[0] = static_cast<char>(MISSION_ACK_HEADER);
+    ack[1] = static_cast<char>(MISSION_ACK_TRAILER);
+    qToLittleEndian<quint16>(m_missionId, ack + 2);
+    qToLittleEndian<quint16>(static_cast<quint16>(cumulative), ack + 4);
+    qToLittleEndian<quint32>(bitmap, ack + 6);
+    ack[MISSION_ACK_FRAME_SIZE - 1] = static_cast<char>(xorChecksum(ack + 2, MISSION_ACK_FRAME_SIZE - 3));
+
+    m_readBuffer.append(ack, MISSION_ACK_FRAME_SIZE);
+    QTimer::singleShot(0, this, [this]() { emit readyRead(); });
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "frame_codec.h"
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QVector>
+
+class CommandScheduler;
+class MetricCounter;
+class MetricGauge;
+
+// 把任务切分为带序号的分块帧：序号 0 为任务头，其余每块携带 MISSION_CHUNK_POINTS 个航点
+QVector<QByteArray> encodeMissionChunks(quint16 missionId, qint64 timestampSecs,
+                                        const QVector<MissionPoint>& points, const ControlState& control);
+
+// 分块任务上传：滑动窗口发送，按船端的累计确认 + 选择确认位图推进窗口，
+// 超时只重传窗口内尚未确认的块。下行帧经 CommandScheduler 的任务优先级发送；
+// 确认超时从调度器报告块已写出时开始计，并加上按波特率估计的驱动缓冲排空时间，
+// 仍在排队或尚未离开串口的块不会被判为超时重传（低波特率下一个窗口要写好几秒）。
+class MissionUploader : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+    Q_PROPERTY(double progress READ progress NOTIFY progressChanged)
+    Q_PROPERTY(int chunksTotal READ chunksTotal NOTIFY progressChanged)
+    Q_PROPERTY(int chunksAcked READ chunksAcked NOTIFY progressChanged)
+    Q_PROPERTY(int retransmits READ retransmits NOTIFY progressChanged)
+    Q_PROPERTY(double throughputBytesPerSecond READ throughputBytesPerSecond NOTIFY progressChanged)
+public:
+    static constexpr int WINDOW_SIZE = 8;           // 同时在途的块数
+    static constexpr int ACK_TIMEOUT_MS = 300;      // 最后一块写出后无确认进展时的重传超时
+    static constexpr int MAX_TIMEOUTS = 20;         // 连续超时次数上限
+
+    explicit MissionUploader(CommandScheduler* scheduler, QObject *parent = nullptr);
+
+    bool start(qint64 timestampSecs, const QVector<MissionPoint>& points, const ControlState& control);
+    // 链路波特率，用于估计写出的字节何时离开串口；0 表示不估计（如回环设备）
+    void setLinkBaudRate(int baudRate) { m_baudRate = qMax(0, baudRate); }
+    Q_INVOKABLE void cancel();
+
+    // 处理一帧确认（MISSION_ACK_FRAME_SIZE 字节）
+    void handleAck(const char* frame);
+
+    bool isBusy() const { return m_busy; }
+    double progress() const { return m_chunks.isEmpty() ? 0.0 : static_cast<double>(m_ackedCount) / m_chunks.size(); }
+    int chunksTotal() const { return m_chunks.size(); }
+    int chunksAcked() const { return m_ackedCount; }
+    int retransmits() const { return m_retransmits; }
+    double throughputBytesPerSecond() const { return m_throughput; }
+
+signals:
+    void busyChanged();
+    void progressChanged();
+    void finished(bool ok, const QString& message);
+
+private:
+    enum ChunkState : quint8 { Pending, Queued, Sent, Acked };   // Queued：已入队尚未写出
+
+    void fillWindow();
+    void sendChunk(int seq, bool retransmit);
+    int takeCommandSeq(quint64 commandId, const QString& kind);
+    void onChunkWritten(quint64 commandId, const QString& kind);
+    void onChunkFailed(quint64 commandId, const QString& kind);
+    void restartAckTimer();
+    void onAckTimeout();
+    void finish(bool ok, const QString& message);
+    void updateThroughput();
+
+    CommandScheduler* m_scheduler;
+    QTimer* ackTimer;
+
+    QVector<QByteArray> m_chunks;
+    QVector<ChunkState> m_states;
+    QVector<quint32> m_sendOrder;    // 每块最近一次发出的顺序号
+    QHash<quint64, int> m_commandSeq; // 调度器命令号 -> 块序号（最近一次入队）
+    int m_enqueueSeq = -1;           // 正在入队的块（enqueue 内同步失败时还拿不到命令号）
+    int m_baudRate = 0;
+    qint64 m_linkIdleNs = 0;         // 估计已写出的字节全部离开串口的时间
+    quint32 m_sendCounter = 0;
+    quint32 m_highestAckedOrder = 0; // 已确认块中最晚发出的顺序号
+    quint16 m_missionId = 0;
+    int m_base = 0;                 // 第一个未确认块
+    int m_ackedCount = 0;
+    int m_timeouts = 0;
+    int m_retransmits = 0;
+    qint64 m_payloadBytes = 0;       // 全部分块帧字节数
+    qint64 m_startNs = 0;
+    double m_throughput = 0.0;
+    bool m_busy = false;
+
+    MetricCounter* m_chunksSent;
+    MetricCounter* m_chunksRetransmitted;
+    MetricCounter* m_uploadsCompleted;
+    MetricCounter* m_uploadsFailed;
+    MetricGauge* m_throughputGauge;
+};
+
+// 本地回环设备：模拟船端接收分块任务并回送确认帧，可按概率丢块以验证选择重传。
+// 写入即视为发出，bytesWritten 与确认帧都通过事件循环异步投递，与真实串口时序一致。
+class MissionLoopbackDevice : public QIODevice {
+    Q_OBJECT
+public:
+    explicit MissionLoopbackDevice(QObject *parent = nullptr);
+
+    void setDropRate(double dropRate, quint32 seed = 1);
+
+    // 船端重组结果（全部块收到后有效）
+    bool isComplete() const;
+    QVector<MissionPoint> receivedPoints() const;
+    qint64 receivedTimestamp() const { return m_timestamp; }
+    int chunksDropped() const { return m_dropped; }
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override { return m_readBuffer.size() + QIODevice::bytesAvailable(); }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 size) override;
+
+private:
+    void handleChunk(const char* frame, int size);
+    void sendAck();
+
+    QByteArray m_writeBuffer;
+    QByteArray m_readBuffer;
+    QRandomGenerator m_rng;
+    double m_dropRate = 0.0;
+    int m_dropped = 0;
+
+    quint16 m_missionId = 0;
+    int m_totalChunks = 0;
+    QVector<QByteArray> m_received;     // 按序号保存负载
+    qint64 m_timestamp = 0;
+    int m_pointCount = 0;
+};
@@ -0,0 +1,151 @@
+#include "port_watcher.h"
+#include <QDebug>
+#include <QSerialPortInfo>
+#include <QSocketNotifier>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef Q_OS_LINUX
+// /dev 下可能是串口的设备节点
+bool isSerialNodeName(const char* name)
+{
+    return qstrncmp(name, "tty", 3) == 0 || qstrncmp(name, "rfcomm", 6) == 0;
+}
+#endif
+
+}
+
+PortWatcher::PortWatcher(QObject *parent)
+    : QObject(parent)
+{
+}
+
+PortWatcher::~PortWatcher()
+{
+    stop();
+}
+
+void PortWatcher::start()
+{
+    // 定时器在 start 中创建，确保属于监听线程
+    if (!rescanTimer) {
+        rescanTimer = new QTimer(this);
+        rescanTimer->setSingleShot(true);
+        rescanTimer->setInterval(RESCAN_DELAY_MS);
+        connect(rescanTimer, &QTimer::timeout, this, &PortWatcher::rescan);
+    }
+
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd < 0) {
+        m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_inotifyFd >= 0) {
+            const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+            if (inotify_add_watch(m_inotifyFd, "/dev", mask) < 0) {
+                qWarning() << "无法监听 /dev，改为定时枚举串口";
+                ::close(m_inotifyFd);
+                m_inotifyFd = -1;
+            } else {
+                watchSerialById();
+                inotifyNotifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+                connect(inotifyNotifier, &QSocketNotifier::activated, this, &PortWatcher::readInotifyEvents);
+            }
+        }
+    }
+#endif
+
+    if (m_inotifyFd < 0 && !fallbackTimer) {
+        fallbackTimer = new QTimer(this);
+        connect(fallbackTimer, &QTimer::timeout, this, &PortWatcher::rescan);
+        fallbackTimer->start(FALLBACK_POLL_MS);
+    }
+
+    rescan();
+}
+
+void PortWatcher::stop()
+{
+    if (inotifyNotifier) {
+        inotifyNotifier->setEnabled(false);
+        delete inotifyNotifier;
+        inotifyNotifier = nullptr;
+    }
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0) {
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+        m_serialByIdWatch = -1;
+    }
+#endif
+    if (fallbackTimer) fallbackTimer->stop();
+    if (rescanTimer) rescanTimer->stop();
+}
+
+void PortWatcher::rescan()
+{
+    QStringList ports;
+    const auto infos = QSerialPortInfo::availablePorts();
+    for (const QSerialPortInfo &info : infos) {
+        ports << info.portName();
+    }
+
+    if (ports != m_ports) {
+        m_ports = ports;
+        emit portsChanged(m_ports);
+    }
+}
+
+void PortWatcher::watchSerialById()
+{
+#ifdef Q_OS_LINUX
+    // /dev/serial 与 by-id 目录在第一个 USB 串口出现时才由 udev 创建
+    const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+    inotify_add_watch(m_inotifyFd, "/dev/serial", mask | IN_ONLYDIR);
+    if (m_serialByIdWatch < 0) {
+        m_serialByIdWatch = inotify_add_watch(m_inotifyFd, "/dev/serial/by-id", mask | IN_ONLYDIR);
+    }
+#endif
+}
+
+void PortWatcher::readInotifyEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(inotify_event) char buffer[4096];
+    bool changed = false;
+
+    for (;;) {
+        const ssize_t length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (ssize_t offset = 0; offset < length; ) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_IGNORED) {
+                if (event->wd == m_serialByIdWatch) m_serialByIdWatch = -1;
+                continue;
+            }
+            if (event->wd == m_serialByIdWatch) {
+                changed = true;
+                continue;
+            }
+            if (event->len == 0) continue;
+            if (qstrcmp(event->name, "serial") == 0 || qstrcmp(event->name, "by-id") == 0) {
+                watchSerialById();
+                changed = true;
+            } else if (isSerialNodeName(event->name)) {
+                changed = true;
+            }
+        }
+    }
+
+    // 合并同一次插拔产生的多条事件，只枚举一次
+    if (changed && !rescanTimer->isActive()) {
+        rescanTimer->start();
+    }
+#endif
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+class QSocketNotifier;
+
+// 串口热插拔发现：在独立线程中运行，端口列表变化时发出 portsChanged。
+// Linux 下监听 /dev 与 /dev/serial/by-id 的 inotify 事件，不做任何轮询；
+// 其他平台退化为在该线程内定时枚举，同样不占用界面线程。
+class PortWatcher : public QObject {
+    Q_OBJECT
+public:
+    // inotify 事件合并窗口：设备节点与 by-id 链接通常在几毫秒内相继出现
+    static constexpr int RESCAN_DELAY_MS = 20;
+    static constexpr int FALLBACK_POLL_MS = 2000;
+
+    explicit PortWatcher(QObject *parent = nullptr);
+    ~PortWatcher();
+
+public slots:
+    // 在所属线程中调用：建立监听并立即做一次初始枚举
+    void start();
+    void stop();
+    // 强制重新枚举（例如用户手动刷新）
+    void rescan();
+
+signals:
+    void portsChanged(const QStringList& ports);
+
+private:
+    void readInotifyEvents();
+    void watchSerialById();
+
+    QTimer* rescanTimer = nullptr;
+    QTimer* fallbackTimer = nullptr;
+    QSocketNotifier* inotifyNotifier = nullptr;
+    int m_inotifyFd = -1;
+    int m_serialByIdWatch = -1;
+    QStringList m_ports;
+};
@@ -0,0 +1,390 @@
+#include "route_optimizer.h"
+#include "geodesy.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace RouteOptimizer {
+
+namespace {
+
+const double EPSILON = 1e-7;
+
+// 平面距离；std::hypot 为防溢出做了额外处理，在热循环中明显更慢
+inline double planarDistance(double dx, double dy)
+{
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// 均匀网格：每格约两个点，用于近邻查询和最近邻构造（支持删除已访问点）
+class PointGrid {
+public:
+    PointGrid(const std::vector<double>& x, const std::vector<double>& y)
+        : m_x(x), m_y(y)
+    {
+        const int n = static_cast<int>(x.size());
+        const auto [minX, maxX] = std::minmax_element(x.begin(), x.end());
+        const auto [minY, maxY] = std::minmax_element(y.begin(), y.end());
+        m_minX = *minX;
+        m_minY = *minY;
+
+        const int side = std::max(1, static_cast<int>(std::sqrt(n / 2.0)));
+        m_cellSize = std::max({*maxX - m_minX, *maxY - m_minY, 1.0}) / side;
+        m_nx = std::min(side, static_cast<int>((*maxX - m_minX) / m_cellSize)) + 1;
+        m_ny = std::min(side, static_cast<int>((*maxY - m_minY) / m_cellSize)) + 1;
+
+        m_cells.resize(static_cast<size_t>(m_nx) * m_ny);
+        m_cellOf.resize(n);
+        m_slot.resize(n);
+        for (int id = 0; id < n; ++id) {
+            const int cell = cellIndex(cellX(x[id]), cellY(y[id]));
+            m_cellOf[id] = cell;
+            m_slot[id] = static_cast<int>(m_cells[cell].size());
+            m_cells[cell].push_back(id);
+        }
+    }
+
+    void remove(int id)
+    {
+        std::vector<int>& cell = m_cells[m_cellOf[id]];
+        const int last = cell.back();
+        cell[m_slot[id]] = last;
+        m_slot[last] = m_slot[id];
+        cell.pop_back();
+    }
+
+    // 最近的未删除点，没有时返回 -1
+    int nearest(double qx, double qy) const
+    {
+        const int cx = cellX(qx);
+        const int cy = cellY(qy);
+        int best = -1;
+        double bestDist = std::numeric_limits<double>::max();
+        for (int r = 0; r <= std::max(m_nx, m_ny); ++r) {
+            visitRing(cx, cy, r, [&](int id) {
+                const double d = planarDistance(m_x[id] - qx, m_y[id] - qy);
+                if (d < bestDist) {
+                    bestDist = d;
+                    best = id;
+                }
+            });
+            // 第 r+1 圈中的点距查询点至少 r 个格宽
+            if (best >= 0 && bestDist <= r * m_cellSize) break;
+        }
+        return best;
+    }
+
+    // id 的 k 个近邻（不含自身），按距离升序
+    void kNearest(int id, int k, std::vector<int>& out) const
+    {
+        std::priority_queue<std::pair<double, int>> heap;
+        const int cx = cellX(m_x[id]);
+        const int cy = cellY(m_y[id]);
+        for (int r = 0; r <= std::max(m_nx, m_ny); ++r) {
+            visitRing(cx, cy, r, [&](int other) {
+                if (other == id) return;
+                const double d = planarDistance(m_x[other] - m_x[id], m_y[other] - m_y[id]);
+                if (static_cast<int>(heap.size()) < k) {
+                    heap.emplace(d, other);
+                } else if (d < heap.top().first) {
+                    heap.pop();
+                    heap.emplace(d, other);
+                }
+            });
+            if (static_cast<int>(heap.size()) == k && heap.top().first <= r * m_cellSize) break;
+        }
+
+        out.resize(heap.size());
+        for (int i = static_cast<int>(heap.size()) - 1; i >= 0; --i) {
+            out[i] = heap.top().second;
+            heap.pop();
+        }
+    }
+
+private:
+    int cellX(double x) const { return std::clamp(static_cast<int>((x - m_minX) / m_cellSize), 0, m_nx - 1); }
+    int cellY(double y) const { return std::clamp(static_cast<int>((y - m_minY) / m_cellSize), 0, m_ny - 1); }
+    int cellIndex(int cx, int cy) const { return cy * m_nx + cx; }
+
+    // 访问以 (cx, cy) 为中心、切比雪夫距离为 r 的一圈格子
+    template <typename Visit>
+    void visitRing(int cx, int cy, int r, Visit&& visit) const
+    {
+        auto visitCell = [&](int x, int y) {
+            if (x < 0 || y < 0 || x >= m_nx || y >= m_ny) return;
+            for (int id : m_cells[cellIndex(x, y)]) visit(id);
+        };
+        if (r == 0) {
+            visitCell(cx, cy);
+            return;
+        }
+        for (int x = cx - r; x <= cx + r; ++x) {
+            visitCell(x, cy - r);
+            visitCell(x, cy + r);
+        }
+        for (int y = cy - r + 1; y <= cy + r - 1; ++y) {
+            visitCell(cx - r, y);
+            visitCell(cx + r, y);
+        }
+    }
+
+    const std::vector<double>& m_x;
+    const std::vector<double>& m_y;
+    double m_minX = 0.0;
+    double m_minY = 0.0;
+    double m_cellSize = 1.0;
+    int m_nx = 1;
+    int m_ny = 1;
+    std::vector<std::vector<int>> m_cells;
+    std::vector<int> m_cellOf;
+    std::vector<int> m_slot;
+};
+
+// 基于近邻表的 2-opt / Or-opt 局部搜索。位置 0 的起点不参与移动。
+class LocalSearch {
+public:
+    LocalSearch(const std::vector<double>& x, const std::vector<double>& y,
+                const std::vector<std::vector<int>>& neighbours, bool closedLoop, std::vector<int>& tour)
+        : m_x(x), m_y(y), m_neighbours(neighbours), m_closed(closedLoop), m_tour(tour)
+        , m_n(static_cast<int>(tour.size())), m_pos(tour.size()), m_queued(tour.size(), true)
+    {
+        for (int i = 0; i < m_n; ++i) {
+            m_pos[m_tour[i]] = i;
+            m_queue.push_back(m_tour[i]);
+        }
+    }
+
+    void run(Result& result)
+    {
+        // 每个点平均复查次数上限，防止浮点误差导致的往复移动
+        long budget = 50L * m_n;
+        while (!m_queue.empty() && budget-- > 0) {
+            const int city = m_queue.front();
+            m_queue.pop_front();
+            m_queued[city] = false;
+
+            if (tryTwoOpt(city)) {
+                ++result.twoOptMoves;
+            } else if (tryOrOpt(city)) {
+                ++result.orOptMoves;
+            }
+        }
+    }
+
+private:
+    double dist(int a, int b) const
+    {
+        if (a < 0 || b < 0) return 0.0;
+        return planarDistance(m_x[a] - m_x[b], m_y[a] - m_y[b]);
+    }
+
+    // 位置 i 的后继/前驱城市；开放航线的末端没有后继，起点没有前驱
+    int succ(int i) const
+    {
+        if (i + 1 < m_n) return m_tour[i + 1];
+        return m_closed ? m_tour[0] : -1;
+    }
+    int pred(int i) const
+    {
+        if (i > 0) return m_tour[i - 1];
+        return m_closed ? m_tour[m_n - 1] : -1;
+    }
+
+    void push(int city)
+    {
+        if (city < 0 || m_queued[city]) return;
+        m_queued[city] = true;
+        m_queue.push_back(city);
+    }
+
+    void reverse(int from, int to)
+    {
+        std::reverse(m_tour.begin() + from, m_tour.begin() + to + 1);
+        for (int i = from; i <= to; ++i) m_pos[m_tour[i]] = i;
+    }
+
+    // 以 city 的一条邻边为起点，尝试把它换成到近邻的更短边
+    bool tryTwoOpt(int a)
+    {
+        const int i = m_pos[a];
+
+        // 后继方向：(a,b)(c,d) -> (a,c)(b,d)
+        const int b = succ(i);
+        if (b >= 0) {
+            const double dab = dist(a, b);
+            for (int c : m_neighbours[a]) {
+                const double dac = dist(a, c);
+                if (dac >= dab) break;
+                const int j = m_pos[c];
+                if (c == b) continue;
+                const int d = succ(j);
+                if (d == a) continue;
+                const double gain = dab + dist(c, d) - dac - dist(b, d);
+                if (gain > EPSILON) {
+                    if (j > i) reverse(i + 1, j); else reverse(j + 1, i);
+                    push(a); push(b); push(c); push(d);
+                    return true;
+                }
+            }
+        }
+
+        // 前驱方向：(b,a)(e,c) -> (c,a)(e,b)
+        if (i == 0) return false;
+        const int b2 = pred(i);
+        const double dab = dist(a, b2);
+        for (int c : m_neighbours[a]) {
+            const double dac = dist(a, c);
+            if (dac >= dab) break;
+            const int j = m_pos[c];
+            if (j == 0 || c == b2) continue;
+            const int e = pred(j);
+            if (e == a) continue;
+            const double gain = dab + dist(c, e) - dac - dist(b2, e);
+            if (gain > EPSILON) {
+                if (j < i) reverse(j, i - 1); else reverse(i, j - 1);
+                push(a); push(b2); push(c); push(e);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 把从 city 开始的 1~3 个连续点整体移到近邻旁（可反向）
+    bool tryOrOpt(int a)
+    {
+        const int i = m_pos[a];
+        if (i == 0) return false;
+
+        for (int length = 1; length <= 3; ++length) {
+            const int last = i + length - 1;
+            if (last >= m_n) break;
+
+            const int prev = m_tour[i - 1];
+            const int next = succ(last);
+            if (length >= m_n - 1) break;
+            const int s1 = m_tour[i];
+            const int s2 = m_tour[last];
+            const double removeGain = dist(prev, s1) + dist(s2, next) - dist(prev, next);
+            if (removeGain <= EPSILON) continue;
+
+            for (int endpoint : {s1, s2}) {
+                for (int c : m_neighbours[endpoint]) {
+                    const int j = m_pos[c];
+                    if (j >= i - 1 && j <= last) continue;
+
+                    // 插入到 (c, succ(c)) 之间；succ(c) 为段首时已被上面排除
+                    const int e = succ(j);
+                    if (e == s1) continue;
+                    const double forward = dist(c, s1) + dist(s2, e) - dist(c, e);
+                    const double backward = dist(c, s2) + dist(s1, e) - dist(c, e);
+                    const bool reversed = backward < forward;
+                    const double gain = removeGain - (reversed ? backward : forward);
+                    if (gain > EPSILON) {
+                        moveSegment(i, last, j, reversed);
+                        push(prev); push(next); push(s1); push(s2); push(c); push(e);
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // 把位置 [from, to] 的段移到位置 after 之后
+    void moveSegment(int from, int to, int after, bool reversed)
+    {
+        if (reversed) std::reverse(m_tour.begin() + from, m_tour.begin() + to + 1);
+
+        int low, high;
+        if (after > to) {
+            std::rotate(m_tour.begin() + from, m_tour.begin() + to + 1, m_tour.begin() + after + 1);
+            low = from;
+            high = after;
+        } else {
+            std::rotate(m_tour.begin() + after + 1, m_tour.begin() + from, m_tour.begin() + to + 1);
+            low = after + 1;
+            high = to;
+        }
+        for (int k = low; k <= high; ++k) m_pos[m_tour[k]] = k;
+    }
+
+    const std::vector<double>& m_x;
+    const std::vector<double>& m_y;
+    const std::vector<std::vector<int>>& m_neighbours;
+    const bool m_closed;
+    std::vector<int>& m_tour;
+    const int m_n;
+    std::vector<int> m_pos;
+    std::vector<bool> m_queued;
+    std::deque<int> m_queue;
+};
+
+double tourLength(const std::vector<double>& x, const std::vector<double>& y,
+                  const std::vector<int>& tour, bool closedLoop)
+{
+    double length = 0.0;
+    for (size_t i = 1; i < tour.size(); ++i) {
+        length += planarDistance(x[tour[i]] - x[tour[i - 1]], y[tour[i]] - y[tour[i - 1]]);
+    }
+    if (closedLoop && tour.size() > 1) {
+        length += planarDistance(x[tour.back()] - x[tour.front()], y[tour.back()] - y[tour.front()]);
+    }
+    return length;
+}
+
+}
+
+Result optimize(const QVector<MissionPoint>& points, const Options& options)
+{
+    Result result;
+    const int n = points.size();
+    if (n == 0) return result;
+
+    // 局部等距投影（米）
+    double latSum = 0.0;
+    for (const MissionPoint& point : points) latSum += point.latitude;
+    const double ky = Geodesy::EARTH_RADIUS_M * Geodesy::DEG_TO_RAD;
+    const double kx = ky * std::cos(latSum / n * Geodesy::DEG_TO_RAD);
+    std::vector<double> x(n), y(n);
+    for (int i = 0; i < n; ++i) {
+        x[i] = points[i].longitude * kx;
+        y[i] = points[i].latitude * ky;
+    }
+
+    std::vector<int> tour(n);
+    for (int i = 0; i < n; ++i) tour[i] = i;
+    result.inputLength = tourLength(x, y, tour, options.closedLoop);
+
+    if (n > 3) {
+        PointGrid grid(x, y);
+
+        // 近邻表在删除点之前建立
+        const int k = std::min(options.neighbours, n - 1);
+        std::vector<std::vector<int>> neighbours(n);
+        for (int i = 0; i < n; ++i) grid.kNearest(i, k, neighbours[i]);
+
+        // 最近邻构造初始航线
+        grid.remove(0);
+        for (int i = 1; i < n; ++i) {
+            const int next = grid.nearest(x[tour[i - 1]], y[tour[i - 1]]);
+            grid.remove(next);
+            tour[i] = next;
+        }
+        result.seedLength = tourLength(x, y, tour, options.closedLoop);
+
+        LocalSearch search(x, y, neighbours, options.closedLoop, tour);
+        search.run(result);
+    } else {
+        result.seedLength = result.inputLength;
+    }
+
+    result.optimizedLength = tourLength(x, y, tour, options.closedLoop);
+    result.order = QVector<int>(tour.begin(), tour.end());
+    return result;
+}
+
+}
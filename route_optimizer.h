@@ -0,0 +1,29 @@
+#pragma once
+
+#include "frame_codec.h"
+#include <QVector>
+
+// 航线优化：最近邻构造初始航线，再用 2-opt 与 Or-opt 局部搜索改进。
+// 距离在以航点质心为原点的局部等距投影平面上计算（任务范围通常只有数公里，误差可忽略）；
+// 候选移动只在每个点的 K 近邻内搜索，并用“不看位”队列只复查发生变化的点，
+// 数千个航点的优化耗时在毫秒到几十毫秒量级。
+namespace RouteOptimizer {
+
+struct Options {
+    bool closedLoop = false;    // 航线是否返回起点
+    int neighbours = 10;        // 每点候选近邻数
+};
+
+struct Result {
+    QVector<int> order;             // 访问顺序（输入下标），order[0] 恒为 0
+    double inputLength = 0.0;       // 按输入顺序的航线长度（米，投影平面）
+    double seedLength = 0.0;        // 最近邻初始航线长度
+    double optimizedLength = 0.0;   // 局部搜索后的长度
+    int twoOptMoves = 0;
+    int orOptMoves = 0;
+};
+
+// points[0] 为起点（Home 点），始终保持在首位
+Result optimize(const QVector<MissionPoint>& points, const Options& options = Options());
+
+}
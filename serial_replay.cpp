@@ -0,0 +1,121 @@
+#include "serial_replay.h"
+#include "metrics.h"
+#include <QDataStream>
+#include <QDebug>
+#include <cmath>
+
+namespace {
+
+const QByteArray CAPTURE_MAGIC("USVCAP1\n");
+
+}
+
+SerialReplay::SerialReplay(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &SerialReplay::replayDue);
+}
+
+bool SerialReplay::startCapture(const QString& path)
+{
+    stopCapture();
+    m_capture.setFileName(path);
+    if (!m_capture.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "无法写入串口录制文件:" << path << m_capture.errorString();
+        return false;
+    }
+    m_capture.write(CAPTURE_MAGIC);
+    m_captureStartNs = -1;
+    qDebug() << "串口录制:" << path;
+    return true;
+}
+
+void SerialReplay::stopCapture()
+{
+    if (m_capture.isOpen()) m_capture.close();
+}
+
+void SerialReplay::capture(const QByteArray& chunk, qint64 receiveNs)
+{
+    if (!m_capture.isOpen() || chunk.isEmpty()) return;
+    if (m_captureStartNs < 0) m_captureStartNs = receiveNs;
+
+    QDataStream out(&m_capture);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << static_cast<qint64>(receiveNs - m_captureStartNs) << static_cast<quint32>(chunk.size());
+    out.writeRawData(chunk.constData(), chunk.size());
+}
+
+bool SerialReplay::startReplay(const QString& path, double speed)
+{
+    stopReplay();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "无法打开串口录制文件:" << path << file.errorString();
+        return false;
+    }
+    if (file.read(CAPTURE_MAGIC.size()) != CAPTURE_MAGIC) {
+        qWarning() << "不是串口录制文件:" << path;
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+    m_chunks.clear();
+    while (!in.atEnd()) {
+        qint64 offsetNs = 0;
+        quint32 size = 0;
+        in >> offsetNs >> size;
+        QByteArray data(static_cast<int>(size), Qt::Uninitialized);
+        if (in.status() != QDataStream::Ok || in.readRawData(data.data(), data.size()) != data.size()) {
+            // 录制中途退出时最后一块可能不完整
+            qWarning() << "串口录制文件在第" << m_chunks.size() << "块处截断";
+            break;
+        }
+        m_chunks.append({offsetNs, data});
+    }
+
+    m_next = 0;
+    m_speed = speed;
+    m_replayStartNs = MetricsClock::nowNs();
+    qDebug() << "串口回放:" << path << "块数:" << m_chunks.size() << "倍速:" << speed;
+    m_timer.start(0);
+    return true;
+}
+
+void SerialReplay::stopReplay()
+{
+    m_timer.stop();
+    m_chunks.clear();
+    m_next = 0;
+}
+
+void SerialReplay::replayDue()
+{
+    const qint64 now = MetricsClock::nowNs();
+    if (m_speed <= 0.0) {
+        if (m_next < m_chunks.size()) emit chunkReady(m_chunks[m_next++].data, now);
+    } else {
+        // 补齐已到时间的块，定时器误差不会累积
+        const qint64 elapsedNs = now - m_replayStartNs;
+        while (m_next < m_chunks.size() && m_chunks[m_next].offsetNs / m_speed <= elapsedNs) {
+            emit chunkReady(m_chunks[m_next++].data, MetricsClock::nowNs());
+        }
+    }
+
+    if (m_next >= m_chunks.size()) {
+        const int chunks = m_chunks.size();
+        m_chunks.clear();
+        m_next = 0;
+        emit replayFinished(chunks);
+        return;
+    }
+    if (m_speed <= 0.0) {
+        m_timer.start(0);
+    } else {
+        const double dueNs = m_chunks[m_next].offsetNs / m_speed - (MetricsClock::nowNs() - m_replayStartNs);
+        m_timer.start(qMax(0, static_cast<int>(std::ceil(dueNs / 1e6))));
+    }
+}
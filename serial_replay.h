@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+// 串口录制与回放：录制文件以 "USVCAP1\n" 开头，之后每个读取块依次为
+// qint64 相对首块的接收时间（纳秒）、quint32 长度与原始字节（小端）。
+// 回放按原始间隔（可倍速）把字节块交回 DataSource 的帧切分路径，接收时间取回放时刻，
+// 因此同一段录制可以反复得到延迟报告。只在 GUI 线程中使用。
+class SerialReplay : public QObject {
+    Q_OBJECT
+public:
+    explicit SerialReplay(QObject *parent = nullptr);
+
+    bool startCapture(const QString& path);
+    void stopCapture();
+    bool capturing() const { return m_capture.isOpen(); }
+    void capture(const QByteArray& chunk, qint64 receiveNs);
+
+    // speed 为回放倍速，<= 0 时不按录制间隔，每次事件循环回放一块
+    bool startReplay(const QString& path, double speed);
+    void stopReplay();
+    bool replaying() const { return m_timer.isActive(); }
+
+signals:
+    void chunkReady(const QByteArray& chunk, qint64 receiveNs);
+    void replayFinished(int chunks);
+
+private:
+    struct Chunk {
+        qint64 offsetNs;
+        QByteArray data;
+    };
+
+    void replayDue();
+
+    QFile m_capture;
+    qint64 m_captureStartNs = -1;
+
+    QVector<Chunk> m_chunks;
+    int m_next = 0;
+    double m_speed = 1.0;
+    qint64 m_replayStartNs = 0;
+    QTimer m_timer;
+};
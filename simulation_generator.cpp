@@ -0,0 +1,392 @@
+#include "simulation_generator.h"
+#include "metrics.h"
+#include "geodesy.h"
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+using namespace FrameConstants;
+
+SimulatedVessel::SimulatedVessel(quint32 seed)
+    : m_rng(seed)
+{
+}
+
+void SimulatedVessel::reseed(quint32 seed)
+{
+    m_rng.seed(seed);
+    m_simTimeMs = 0.0;
+    m_simulatedLatitude = 31.230416;
+    m_simulatedLongitude = 121.473701;
+    m_simulatedHeading = 0.0;
+    m_simulatedSpeed = 0.0;
+    m_simulatedBattery = 100;
+    m_simulatedMode = false;
+}
+
+void SimulatedVessel::setMotors(quint16 motor1, quint16 motor2)
+{
+    m_motor1 = motor1;
+    m_motor2 = motor2;
+}
+
+QByteArray SimulatedVessel::generateMergedFrame(double dtMs)
+{
+    QByteArray frame;
+    frame.resize(RECEIVE_FRAME_SIZE);
+    frame.fill(0);
+
+    // 设置帧头帧尾
+    frame[0] = FRAME_HEADER;
+    frame[1] = FRAME_TRAILER;
+
+    // 生成传感器数据
+    DataSource::SensorData sensorData = generateFakeSensorData();
+
+    // 添加PWM值（电机值）
+    uint16_t pwm1 = m_motor1;
+    uint16_t pwm2 = m_motor2;
+
+    // 转为字节数组，小端序
+    frame[SENSOR_DATA_OFFSET] = pwm1 & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 1] = (pwm1 >> 8) & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 2] = pwm2 & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 3] = (pwm2 >> 8) & 0xFF;
+
+    // 添加CO2数据 (2字节, 小端序)
+    uint16_t co2 = sensorData.CO2;
+    frame[SENSOR_DATA_OFFSET + 4] = co2 & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 5] = (co2 >> 8) & 0xFF;
+
+    // 添加甲醛数据 (2字节, 小端序)
+    uint16_t ch2o = sensorData.CH2O;
+    frame[SENSOR_DATA_OFFSET + 6] = ch2o & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 7] = (ch2o >> 8) & 0xFF;
+
+    // 添加TVOC数据 (2字节, 小端序)
+    uint16_t tvoc = sensorData.TVOC;
+    frame[SENSOR_DATA_OFFSET + 8] = tvoc & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 9] = (tvoc >> 8) & 0xFF;
+
+    // 添加PM2.5数据 (2字节, 小端序)
+    uint16_t pm25 = sensorData.PM2_5;
+    frame[SENSOR_DATA_OFFSET + 10] = pm25 & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 11] = (pm25 >> 8) & 0xFF;
+
+    // 添加PM10数据 (2字节, 小端序)
+    uint16_t pm10 = sensorData.PM10;
+    frame[SENSOR_DATA_OFFSET + 12] = pm10 & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 13] = (pm10 >> 8) & 0xFF;
+
+    // 添加空气温度 (2字节分别表示整数和小数部分)
+    frame[SENSOR_DATA_OFFSET + 14] = sensorData.temperature_air_High;
+    frame[SENSOR_DATA_OFFSET + 15] = sensorData.temperature_air_Low;
+
+    // 添加空气湿度 (2字节分别表示整数和小数部分)
+    frame[SENSOR_DATA_OFFSET + 16] = sensorData.humidity_air_High;
+    frame[SENSOR_DATA_OFFSET + 17] = sensorData.humidity_air_Low;
+
+    // 添加浊度 (2字节, 小端序)
+    uint16_t turbidity = sensorData.turbidity;
+    frame[SENSOR_DATA_OFFSET + 18] = turbidity & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 19] = (turbidity >> 8) & 0xFF;
+
+    // 添加pH值 (2字节, 小端序，实际值×100)
+    uint16_t ph = sensorData.PH;
+    frame[SENSOR_DATA_OFFSET + 20] = ph & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 21] = (ph >> 8) & 0xFF;
+
+    // 添加TDS (2字节, 小端序)
+    uint16_t tds = sensorData.TDS;
+    frame[SENSOR_DATA_OFFSET + 22] = tds & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 23] = (tds >> 8) & 0xFF;
+
+    // 添加水温 (2字节分别表示整数和小数部分)
+    frame[SENSOR_DATA_OFFSET + 24] = sensorData.temperaturewater_High;
+    frame[SENSOR_DATA_OFFSET + 25] = sensorData.temperaturewater_Low;
+
+    // 添加液位 (2字节, 小端序)
+    int16_t level = sensorData.dis;
+    frame[SENSOR_DATA_OFFSET + 26] = level & 0xFF;
+    frame[SENSOR_DATA_OFFSET + 27] = (level >> 8) & 0xFF;
+
+    // 生成船只数据
+    DataSource::BoatData boatData = generateFakeBoatData();
+
+    // 写入纬度数据 (5字节格式: 1字节整数部分 + 4字节小数部分)
+    int latInt = static_cast<int>(boatData.latitude);
+    float latDecimal = boatData.latitude - latInt;
+    frame[LAT_OFFSET] = static_cast<char>(latInt);
+    memcpy(frame.data() + LAT_OFFSET + 1, &latDecimal, 4);
+
+    // 写入经度数据 (5字节格式: 1字节整数部分 + 4字节小数部分)
+    int lonInt = static_cast<int>(boatData.longitude);
+    float lonDecimal = boatData.longitude - lonInt;
+    frame[LON_OFFSET] = static_cast<char>(lonInt);
+    memcpy(frame.data() + LON_OFFSET + 1, &lonDecimal, 4);
+
+    // 写入航向角 (2字节: 1字节整数+符号, 1字节小数部分)
+    int headingInt = static_cast<int>(boatData.heading);
+    uint8_t headingDec = static_cast<uint8_t>((std::abs(boatData.heading) - std::abs(headingInt)) * 100);
+    frame[HEADING_OFFSET] = static_cast<char>(headingInt);
+    frame[HEADING_OFFSET + 1] = headingDec;
+
+    // 写入速度 (2字节: 1字节整数, 1字节小数)
+    uint8_t speedInt = static_cast<uint8_t>(boatData.speed);
+    uint8_t speedDec = static_cast<uint8_t>((boatData.speed - speedInt) * 100);
+    frame[SPEED_OFFSET] = speedInt;
+    frame[SPEED_OFFSET + 1] = speedDec;
+
+    // 生成设备数据
+    DataSource::DeviceData deviceData = generateFakeDeviceData();
+
+    // 写入电池电量 (2字节, 小端序)
+    uint16_t battery = deviceData.battery;
+    frame[BATTERY_OFFSET] = battery & 0xFF;
+    frame[BATTERY_OFFSET + 1] = (battery >> 8) & 0xFF;
+
+    // 写入模式 (1字节)
+    frame[MODE_OFFSET] = deviceData.mode ? 1 : 0;
+
+    // 推进模拟时钟与位置
+    m_simTimeMs += dtMs;
+    updateSimulatedPosition(dtMs);
+
+    return frame;
+}
+
+DataSource::SensorData SimulatedVessel::generateFakeSensorData()
+{
+    DataSource::SensorData data;
+
+    using namespace SensorLimits;
+
+    // 模拟PWM值 (当前电机值)
+    data.PWM_SET1 = m_motor1;
+    data.PWM_SET2 = m_motor2;
+
+    // CO2: 400-2000 ppm 范围内合理波动
+    data.CO2 = m_rng.bounded(CO2_MIN, CO2_MAX);
+
+    // 甲醛: 0.01-0.15 mg/m³ (以整数表示，单位0.001 mg/m³)
+    data.CH2O = static_cast<uint16_t>(m_rng.bounded(
+        static_cast<int>(CH2O_MIN * 1000),
+        static_cast<int>(CH2O_MAX * 1000)
+        ));
+
+    // TVOC: 50-1000 ppb
+    data.TVOC = m_rng.bounded(TVOC_MIN, TVOC_MAX);
+
+    // PM2.5: 0-250 μg/m³
+    data.PM2_5 = m_rng.bounded(PM25_MIN, PM25_MAX);
+
+    // PM10: 0-350 μg/m³
+    data.PM10 = m_rng.bounded(PM10_MIN, PM10_MAX);
+
+    // 空气温度: 5-40°C (带有周期性波动)
+    double airTemp = AIR_TEMP_MIN + (AIR_TEMP_MAX - AIR_TEMP_MIN) * 0.5 +
+                     sin(m_simTimeMs / 10000.0) * 5.0 +
+                     m_rng.bounded(-100, 101) / 100.0;
+    data.temperature_air_High = static_cast<uint8_t>(airTemp);
+    data.temperature_air_Low = static_cast<uint8_t>((airTemp - static_cast<int>(airTemp)) * 100);
+
+    // 空气湿度: 20-90% (带有周期性波动)
+    double humidity = HUMIDITY_MIN + (HUMIDITY_MAX - HUMIDITY_MIN) * 0.5 +
+                      sin(m_simTimeMs / 15000.0) * 15.0 +
+                      m_rng.bounded(-200, 201) / 100.0;
+    humidity = qBound(HUMIDITY_MIN, humidity, HUMIDITY_MAX);
+    data.humidity_air_High = static_cast<uint8_t>(humidity);
+    data.humidity_air_Low = static_cast<uint8_t>((humidity - static_cast<int>(humidity)) * 100);
+
+    // 浊度: 0-25 NTU
+    data.turbidity = m_rng.bounded(TURBIDITY_MIN, TURBIDITY_MAX);
+
+    // pH值: 5.0-10.0 (整数部分*100)
+    double ph = PH_MIN + m_rng.bounded(static_cast<int>((PH_MAX - PH_MIN) * 100)) / 100.0;
+    data.PH = static_cast<uint16_t>(ph * 100);
+
+    // TDS: 50-1500 ppm
+    data.TDS = m_rng.bounded(TDS_MIN, TDS_MAX);
+
+    // 水温: 5-35°C (带有周期性波动)
+    double waterTemp = WATER_TEMP_MIN + (WATER_TEMP_MAX - WATER_TEMP_MIN) * 0.5 +
+                       sin(m_simTimeMs / 20000.0) * 4.0 +
+                       m_rng.bounded(-50, 51) / 100.0;
+    data.temperaturewater_High = static_cast<uint8_t>(waterTemp);
+    data.temperaturewater_Low = static_cast<uint8_t>((waterTemp - static_cast<int>(waterTemp)) * 100);
+
+    // 液位: 0-100 mm
+    data.dis = m_rng.bounded(LEVEL_MIN, LEVEL_MAX);
+
+    return data;
+}
+
+DataSource::BoatData SimulatedVessel::generateFakeBoatData()
+{
+    DataSource::BoatData data;
+
+    // 使用当前模拟位置
+    data.latitude = m_simulatedLatitude;
+    data.longitude = m_simulatedLongitude;
+    data.heading = m_simulatedHeading;
+    data.speed = m_simulatedSpeed;
+
+    return data;
+}
+
+DataSource::DeviceData SimulatedVessel::generateFakeDeviceData()
+{
+    DataSource::DeviceData data;
+
+    // 电池电量: 随时间缓慢减少 (模拟实际电池消耗)
+    if (m_simulatedBattery > 0) {
+        // 每10分钟减少约1%
+        int elapsedMinutes = static_cast<int>(m_simTimeMs / 60000);
+        m_simulatedBattery = 100 - (elapsedMinutes / 10);
+        m_simulatedBattery = qMax(0, qMin(100, static_cast<int>(m_simulatedBattery)));
+    }
+    data.battery = m_simulatedBattery;
+
+    // 模式: 使用当前模式或随机切换
+    if (m_rng.bounded(100) < 5) { // 5%概率切换模式
+        m_simulatedMode = !m_simulatedMode;
+    }
+    data.mode = m_simulatedMode;
+
+    return data;
+}
+
+void SimulatedVessel::updateSimulatedPosition(double dtMs)
+{
+    // 更新速度 (0-5 m/s)
+    if (m_rng.bounded(100) < 10) { // 10%概率改变速度
+        // 根据电机值计算速度
+        double motor1Normalized = (m_motor1 - MOTOR_NEUTRAL) / static_cast<double>(MOTOR_MAX_VALUE - MOTOR_NEUTRAL);
+        double motor2Normalized = (m_motor2 - MOTOR_NEUTRAL) / static_cast<double>(MOTOR_MAX_VALUE - MOTOR_NEUTRAL);
+
+        // 计算平均速度因子 (-1.0 到 1.0)
+        double speedFactor = (motor1Normalized + motor2Normalized) / 2.0;
+
+        // 转换为速度 (0-5 m/s)
+        m_simulatedSpeed = qAbs(speedFactor) * 5.0;
+    }
+
+    // 更新航向 (-180 到 180)
+    if (m_rng.bounded(100) < 5) { // 5%概率改变航向
+        // 根据电机差计算航向变化
+        double motor1Normalized = (m_motor1 - MOTOR_NEUTRAL) / static_cast<double>(MOTOR_MAX_VALUE - MOTOR_NEUTRAL);
+        double motor2Normalized = (m_motor2 - MOTOR_NEUTRAL) / static_cast<double>(MOTOR_MAX_VALUE - MOTOR_NEUTRAL);
+
+        // 电机差异决定转向速率
+        double turnRate = (motor2Normalized - motor1Normalized) * 10.0; // 每秒改变的度数
+
+        // 更新航向
+        m_simulatedHeading += turnRate;
+
+        // 保持在-180到180范围内
+        while (m_simulatedHeading > 180.0) m_simulatedHeading -= 360.0;
+        while (m_simulatedHeading < -180.0) m_simulatedHeading += 360.0;
+    }
+
+    // 根据速度和航向更新位置
+    if (m_simulatedSpeed > 0.1) { // 只有当速度足够大时才移动
+        // 沿当前航向按大圆推算新位置（原 500ms 周期下缩放 0.01，按实际步长等比例换算，与帧率无关）
+        const double scale = 0.01 * dtMs / 500.0;
+        Geodesy::destination(m_simulatedLatitude, m_simulatedLongitude, m_simulatedHeading,
+                             m_simulatedSpeed * scale, m_simulatedLatitude, m_simulatedLongitude);
+
+        // 保证位置在有效范围内
+        m_simulatedLatitude = qBound(-90.0, m_simulatedLatitude, 90.0);
+        m_simulatedLongitude = qBound(-180.0, m_simulatedLongitude, 180.0);
+    }
+}
+
+SimulationGenerator::SimulationGenerator(QObject *parent)
+    : QObject(parent)
+    , tickTimer(new QTimer(this))
+{
+    tickTimer->setTimerType(Qt::PreciseTimer);
+    connect(tickTimer, &QTimer::timeout, this, &SimulationGenerator::tick);
+}
+
+void SimulationGenerator::start(const SimulationGenerator::Config& config)
+{
+    m_config = config;
+    m_config.rateHz = qMax(config.rateHz, 0.1);
+
+    const quint32 seed = config.seed != 0 ? config.seed : QRandomGenerator::global()->generate();
+    m_vessel.reseed(seed);
+    // 损伤注入使用独立的派生种子，开关损伤不会改变帧内容序列
+    m_impairmentRng.seed(seed ^ 0x9E3779B9u);
+
+    m_framesProduced = 0;
+    m_chunk.clear();
+    m_clock.start();
+
+    // 低帧率时放宽定时器周期，高帧率时每毫秒按经过时间补齐应生成的帧
+    const int intervalMs = qBound(1, static_cast<int>(1000.0 / m_config.rateHz), 50);
+    tickTimer->start(intervalMs);
+
+    qDebug() << "模拟开始，帧率:" << m_config.rateHz << "Hz 种子:" << seed;
+    emit started(seed);
+    tick();
+}
+
+void SimulationGenerator::stop()
+{
+    tickTimer->stop();
+}
+
+void SimulationGenerator::setMotors(quint16 motor1, quint16 motor2)
+{
+    m_vessel.setMotors(motor1, motor2);
+}
+
+void SimulationGenerator::appendFrame(const QByteArray& frame)
+{
+    // 噪声：帧前插入 1~8 个随机字节
+    if (m_config.noiseRate > 0.0 && m_impairmentRng.generateDouble() < m_config.noiseRate) {
+        const int count = m_impairmentRng.bounded(1, 9);
+        for (int i = 0; i < count; ++i) {
+            m_chunk.append(static_cast<char>(m_impairmentRng.bounded(256)));
+        }
+    }
+
+    QByteArray bytes = frame;
+
+    // 损坏：随机改写一个字节（可能命中帧头帧尾，触发重新同步）
+    if (m_config.corruptRate > 0.0 && m_impairmentRng.generateDouble() < m_config.corruptRate) {
+        const int index = m_impairmentRng.bounded(bytes.size());
+        bytes[index] = static_cast<char>(bytes[index] ^ static_cast<char>(m_impairmentRng.bounded(1, 256)));
+    }
+
+    // 丢字节：随机删除一个字节
+    if (m_config.dropRate > 0.0 && m_impairmentRng.generateDouble() < m_config.dropRate) {
+        bytes.remove(m_impairmentRng.bounded(bytes.size()), 1);
+    }
+
+    m_chunk.append(bytes);
+}
+
+void SimulationGenerator::tick()
+{
+    // 按经过时间计算应生成的帧数，保证长期平均帧率准确；最多补齐 1 秒的积压
+    const qint64 due = static_cast<qint64>(m_clock.nsecsElapsed() / 1e9 * m_config.rateHz) + 1;
+    qint64 pending = due - m_framesProduced;
+    const qint64 maxBacklog = qMax<qint64>(1, static_cast<qint64>(m_config.rateHz));
+    if (pending > maxBacklog) {
+        m_framesProduced = due - maxBacklog;
+        pending = maxBacklog;
+    }
+    if (pending <= 0) return;
+
+    const double dtMs = 1000.0 / m_config.rateHz;
+    m_chunk.reserve(static_cast<int>(pending) * (RECEIVE_FRAME_SIZE + 8));
+    for (qint64 i = 0; i < pending; ++i) {
+        appendFrame(m_vessel.generateMergedFrame(dtMs));
+    }
+    m_framesProduced += pending;
+
+    emit chunkReady(m_chunk, MetricsClock::nowNs());
+    m_chunk = QByteArray();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "datasource.h"
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTimer>
+
+// 模拟船只：按固定种子生成与真实协议逐字节一致的 65 字节接收帧。
+// 所有随机量都来自自身的 QRandomGenerator，时间使用模拟时钟，因此同一种子与帧率可完全复现。
+class SimulatedVessel {
+public:
+    explicit SimulatedVessel(quint32 seed = 1);
+
+    void reseed(quint32 seed);
+    void setMotors(quint16 motor1, quint16 motor2);
+
+    // 生成一帧并推进 dtMs 毫秒的模拟状态
+    QByteArray generateMergedFrame(double dtMs);
+
+private:
+    DataSource::SensorData generateFakeSensorData();
+    DataSource::BoatData generateFakeBoatData();
+    DataSource::DeviceData generateFakeDeviceData();
+    void updateSimulatedPosition(double dtMs);
+
+    QRandomGenerator m_rng;
+    double m_simTimeMs = 0.0;
+    quint16 m_motor1 = FrameConstants::MOTOR_NEUTRAL;
+    quint16 m_motor2 = FrameConstants::MOTOR_NEUTRAL;
+
+    // 初始位置（上海）
+    double m_simulatedLatitude = 31.230416;
+    double m_simulatedLongitude = 121.473701;
+    double m_simulatedHeading = 0.0;
+    double m_simulatedSpeed = 0.0;
+    uint16_t m_simulatedBattery = 100;
+    bool m_simulatedMode = false;
+};
+
+// 高速率模拟数据源：在独立线程中按设定帧率生成字节流，可注入噪声、丢字节与损坏帧。
+// 输出的字节块交给 DataSource 的真实帧切分路径，因此模拟同时也是负载测试。
+class SimulationGenerator : public QObject {
+    Q_OBJECT
+public:
+    struct Config {
+        double rateHz = 2.0;          // 帧率（1 Hz ~ 10 kHz 以上）
+        quint32 seed = 0;             // 0 表示随机种子
+        double noiseRate = 0.0;       // 每帧之前插入随机噪声字节的概率
+        double dropRate = 0.0;        // 每帧随机丢失一个字节的概率
+        double corruptRate = 0.0;     // 每帧随机改写一个字节（含帧头帧尾）的概率
+    };
+
+    explicit SimulationGenerator(QObject *parent = nullptr);
+
+public slots:
+    void start(const SimulationGenerator::Config& config);
+    void stop();
+    void setMotors(quint16 motor1, quint16 motor2);
+
+signals:
+    // receiveNs 为该块生成时的单调时间，与串口读取的时间戳同源
+    void chunkReady(const QByteArray& chunk, qint64 receiveNs);
+    void started(quint32 effectiveSeed);
+
+private:
+    void tick();
+    void appendFrame(const QByteArray& frame);
+
+    QTimer* tickTimer;
+    QElapsedTimer m_clock;
+    Config m_config;
+    SimulatedVessel m_vessel;
+    QRandomGenerator m_impairmentRng;
+    QByteArray m_chunk;
+    qint64 m_framesProduced = 0;
+};
@@ -0,0 +1,415 @@
+#include "surface_interpolation.h"
+#include "geodesy.h"
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace SurfaceInterpolation {
+
+namespace {
+
+constexpr int MAX_NEIGHBOURS = 32;
+constexpr int LEAF_SIZE = 8;
+
+// 静态 2-d 树：点按节点重新排列存放，叶子保存一段连续区间
+class KdTree {
+public:
+    void build(std::vector<double> x, std::vector<double> y, std::vector<double> value)
+    {
+        const int count = static_cast<int>(x.size());
+        std::vector<int> order(count);
+        for (int i = 0; i < count; ++i) order[i] = i;
+        m_nodes.clear();
+        m_nodes.reserve(2 * count / LEAF_SIZE + 1);
+        buildNode(order, 0, count, x, y);
+
+        m_x.resize(count);
+        m_y.resize(count);
+        m_value.resize(count);
+        for (int i = 0; i < count; ++i) {
+            m_x[i] = x[order[i]];
+            m_y[i] = y[order[i]];
+            m_value[i] = value[order[i]];
+        }
+    }
+
+    // 取最近的 k 个点，按距离升序写入 index / distSq，返回实际个数
+    int nearest(double qx, double qy, int k, int* index, double* distSq) const
+    {
+        int found = 0;
+        if (m_nodes.empty()) return 0;
+
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = m_nodes[stack[--top]];
+            if (found == k) {
+                const double dx = std::max({0.0, node.minX - qx, qx - node.maxX});
+                const double dy = std::max({0.0, node.minY - qy, qy - node.maxY});
+                if (dx * dx + dy * dy >= distSq[k - 1]) continue;
+            }
+
+            if (node.left < 0) {
+                for (int i = node.begin; i < node.end; ++i) {
+                    const double dx = m_x[i] - qx;
+                    const double dy = m_y[i] - qy;
+                    const double d = dx * dx + dy * dy;
+                    if (found == k && d >= distSq[k - 1]) continue;
+                    // 插入排序（k 很小）
+                    int j = found < k ? found++ : k - 1;
+                    while (j > 0 && distSq[j - 1] > d) {
+                        distSq[j] = distSq[j - 1];
+                        index[j] = index[j - 1];
+                        --j;
+                    }
+                    distSq[j] = d;
+                    index[j] = i;
+                }
+                continue;
+            }
+
+            // 先访问查询点所在一侧（后入栈）
+            const bool goLeft = node.axis == 0 ? qx < node.split : qy < node.split;
+            stack[top++] = goLeft ? node.right : node.left;
+            stack[top++] = goLeft ? node.left : node.right;
+        }
+        return found;
+    }
+
+    double x(int i) const { return m_x[i]; }
+    double y(int i) const { return m_y[i]; }
+    double value(int i) const { return m_value[i]; }
+
+private:
+    struct Node {
+        double minX, minY, maxX, maxY;
+        double split;
+        int axis;
+        int left;       // -1 表示叶子
+        int right;
+        int begin;
+        int end;
+    };
+
+    int buildNode(std::vector<int>& order, int begin, int end,
+                  const std::vector<double>& x, const std::vector<double>& y)
+    {
+        Node node;
+        node.minX = node.minY = std::numeric_limits<double>::max();
+        node.maxX = node.maxY = std::numeric_limits<double>::lowest();
+        for (int i = begin; i < end; ++i) {
+            node.minX = std::min(node.minX, x[order[i]]);
+            node.maxX = std::max(node.maxX, x[order[i]]);
+            node.minY = std::min(node.minY, y[order[i]]);
+            node.maxY = std::max(node.maxY, y[order[i]]);
+        }
+        node.begin = begin;
+        node.end = end;
+        node.left = node.right = -1;
+        node.axis = node.maxX - node.minX >= node.maxY - node.minY ? 0 : 1;
+        node.split = 0.0;
+
+        const int self = static_cast<int>(m_nodes.size());
+        m_nodes.push_back(node);
+        if (end - begin <= LEAF_SIZE) return self;
+
+        // 沿较长的轴按中位数划分
+        const int mid = begin + (end - begin) / 2;
+        const std::vector<double>& key = node.axis == 0 ? x : y;
+        std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                         [&key](int a, int b) { return key[a] < key[b]; });
+        const double split = key[order[mid]];
+        const int left = buildNode(order, begin, mid, x, y);
+        const int right = buildNode(order, mid, end, x, y);
+        m_nodes[self].split = split;
+        m_nodes[self].left = left;
+        m_nodes[self].right = right;
+        return self;
+    }
+
+    std::vector<Node> m_nodes;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_value;
+};
+
+// 由随机点对的经验变差函数估计指数模型参数：
+// 偏基台值取样本方差减块金，块金由前两个距离段线性外推到 0，变程取经验值首次达到 95% 基台的距离
+Variogram fitVariogram(const KdTree& tree, int count, double maxLag)
+{
+    constexpr int BINS = 20;
+    constexpr int PAIRS = 200000;
+    Variogram model;
+    if (count < 2 || maxLag <= 0.0) return model;
+
+    double mean = 0.0;
+    for (int i = 0; i < count; ++i) mean += tree.value(i);
+    mean /= count;
+    double variance = 0.0;
+    for (int i = 0; i < count; ++i) variance += (tree.value(i) - mean) * (tree.value(i) - mean);
+    variance /= count;
+    if (variance <= 0.0) variance = 1e-12;
+
+    double sum[BINS] = {};
+    int pairs[BINS] = {};
+    std::mt19937 rng(20240601);
+    std::uniform_int_distribution<int> pick(0, count - 1);
+    for (int p = 0; p < PAIRS; ++p) {
+        const int a = pick(rng);
+        const int b = pick(rng);
+        const double h = std::hypot(tree.x(a) - tree.x(b), tree.y(a) - tree.y(b));
+        const int bin = static_cast<int>(h / maxLag * BINS);
+        if (a == b || bin >= BINS) continue;
+        const double d = tree.value(a) - tree.value(b);
+        sum[bin] += 0.5 * d * d;
+        ++pairs[bin];
+    }
+
+    double gamma[BINS];
+    for (int i = 0; i < BINS; ++i) gamma[i] = pairs[i] ? sum[i] / pairs[i] : variance;
+    const double lag = maxLag / BINS;
+    const double nugget = std::clamp(gamma[0] - (gamma[1] - gamma[0]) * 0.5, 0.0, variance);
+
+    model.nugget = nugget;
+    model.sill = std::max(variance - nugget, variance * 1e-3);
+    model.range = maxLag;
+    for (int i = 0; i < BINS; ++i) {
+        if (pairs[i] && gamma[i] >= 0.95 * variance) {
+            model.range = std::max(lag, (i + 0.5) * lag);
+            break;
+        }
+    }
+    return model;
+}
+
+// 高斯消元（部分主元），n ≤ MAX_NEIGHBOURS + 1；奇异时返回 false
+bool solve(double* a, double* b, int n)
+{
+    for (int col = 0; col < n; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < n; ++row) {
+            if (std::abs(a[row * n + col]) > std::abs(a[pivot * n + col])) pivot = row;
+        }
+        if (std::abs(a[pivot * n + col]) < 1e-12) return false;
+        if (pivot != col) {
+            for (int k = 0; k < n; ++k) std::swap(a[col * n + k], a[pivot * n + k]);
+            std::swap(b[col], b[pivot]);
+        }
+        for (int row = col + 1; row < n; ++row) {
+            const double factor = a[row * n + col] / a[col * n + col];
+            for (int k = col; k < n; ++k) a[row * n + k] -= factor * a[col * n + k];
+            b[row] -= factor * b[col];
+        }
+    }
+    for (int row = n - 1; row >= 0; --row) {
+        double value = b[row];
+        for (int k = row + 1; k < n; ++k) value -= a[row * n + k] * b[k];
+        b[row] = value / a[row * n + row];
+    }
+    return true;
+}
+
+}
+
+double Variogram::operator()(double h) const
+{
+    return h <= 0.0 ? 0.0 : nugget + sill * (1.0 - std::exp(-3.0 * h / range));
+}
+
+Grid interpolate(const QVector<Point>& points,
+                 double minLatitude, double minLongitude, double maxLatitude, double maxLongitude,
+                 const Options& options)
+{
+    Grid grid;
+    grid.minLatitude = std::min(minLatitude, maxLatitude);
+    grid.maxLatitude = std::max(minLatitude, maxLatitude);
+    grid.minLongitude = std::min(minLongitude, maxLongitude);
+    grid.maxLongitude = std::max(minLongitude, maxLongitude);
+    grid.width = std::max(1, options.width);
+    grid.height = std::max(1, options.height);
+    grid.values.fill(std::numeric_limits<float>::quiet_NaN(), grid.width * grid.height);
+    if (points.isEmpty()) return grid;
+
+    // 局部等距投影（米）
+    const double originLat = (grid.minLatitude + grid.maxLatitude) / 2;
+    const double originLon = (grid.minLongitude + grid.maxLongitude) / 2;
+    const double metersPerDegLat = Geodesy::EARTH_RADIUS_M * Geodesy::DEG_TO_RAD;
+    const double metersPerDegLon = metersPerDegLat * std::cos(originLat * Geodesy::DEG_TO_RAD);
+
+    std::vector<double> x(points.size()), y(points.size()), value(points.size());
+    for (int i = 0; i < points.size(); ++i) {
+        x[i] = (points[i].longitude - originLon) * metersPerDegLon;
+        y[i] = (points[i].latitude - originLat) * metersPerDegLat;
+        value[i] = points[i].value;
+    }
+    KdTree tree;
+    tree.build(std::move(x), std::move(y), std::move(value));
+
+    const int k = std::clamp(options.neighbours, 1, std::min(MAX_NEIGHBOURS, points.size()));
+    const bool kriging = options.method == OrdinaryKriging && k >= 3;
+    if (kriging) {
+        const double width = (grid.maxLongitude - grid.minLongitude) * metersPerDegLon;
+        const double height = (grid.maxLatitude - grid.minLatitude) * metersPerDegLat;
+        grid.variogram = fitVariogram(tree, points.size(), 0.5 * std::hypot(width, height));
+    }
+
+    const double dLat = (grid.maxLatitude - grid.minLatitude) / grid.height;
+    const double dLon = (grid.maxLongitude - grid.minLongitude) / grid.width;
+    const double maxDistSq = options.maxDistance > 0 ? options.maxDistance * options.maxDistance
+                                                     : std::numeric_limits<double>::infinity();
+    const double halfPower = options.power / 2;
+
+    auto computeRow = [&](int row, std::vector<char>& inside, std::vector<double>& crossings) {
+        const double latitude = grid.maxLatitude - (row + 0.5) * dLat;
+        const double cy = (latitude - originLat) * metersPerDegLat;
+
+        // 掩膜：扫描线与多边形求交，区间内的格子为有效
+        if (!options.mask.isEmpty()) {
+            crossings.clear();
+            const int n = options.mask.size();
+            for (int i = 0; i < n; ++i) {
+                const MissionPoint& a = options.mask[i];
+                const MissionPoint& b = options.mask[(i + 1) % n];
+                if ((a.latitude > latitude) != (b.latitude > latitude)) {
+                    crossings.push_back(a.longitude + (latitude - a.latitude) * (b.longitude - a.longitude)
+                                                          / (b.latitude - a.latitude));
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+            std::fill(inside.begin(), inside.end(), 0);
+            for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+                const int c0 = std::max(0, static_cast<int>(std::ceil((crossings[i] - grid.minLongitude) / dLon - 0.5)));
+                const int c1 = std::min(grid.width - 1, static_cast<int>(std::floor((crossings[i + 1] - grid.minLongitude) / dLon - 0.5)));
+                for (int c = c0; c <= c1; ++c) inside[c] = 1;
+            }
+        }
+
+        int index[MAX_NEIGHBOURS];
+        double distSq[MAX_NEIGHBOURS];
+        double weight[MAX_NEIGHBOURS + 1];
+        double matrix[(MAX_NEIGHBOURS + 1) * (MAX_NEIGHBOURS + 1)];
+        float* out = grid.values.data() + row * grid.width;
+
+        for (int col = 0; col < grid.width; ++col) {
+            if (!options.mask.isEmpty() && !inside[col]) continue;
+            const double cx = (grid.minLongitude + (col + 0.5) * dLon - originLon) * metersPerDegLon;
+            const int found = tree.nearest(cx, cy, k, index, distSq);
+            if (found == 0 || distSq[0] > maxDistSq) continue;
+            if (distSq[0] < 1e-6) {
+                out[col] = static_cast<float>(tree.value(index[0]));
+                continue;
+            }
+
+            if (kriging) {
+                // [γ(dij) 1; 1 0] · [w; μ] = [γ(di0); 1]
+                const int n = found + 1;
+                for (int i = 0; i < found; ++i) {
+                    matrix[i * n + i] = 0.0;
+                    for (int j = i + 1; j < found; ++j) {
+                        const double g = grid.variogram(std::hypot(tree.x(index[i]) - tree.x(index[j]),
+                                                                   tree.y(index[i]) - tree.y(index[j])));
+                        matrix[i * n + j] = g;
+                        matrix[j * n + i] = g;
+                    }
+                    matrix[i * n + found] = 1.0;
+                    matrix[found * n + i] = 1.0;
+                    weight[i] = grid.variogram(std::sqrt(distSq[i]));
+                }
+                matrix[found * n + found] = 0.0;
+                weight[found] = 1.0;
+                if (solve(matrix, weight, n)) {
+                    double estimate = 0.0;
+                    for (int i = 0; i < found; ++i) estimate += weight[i] * tree.value(index[i]);
+                    out[col] = static_cast<float>(estimate);
+                    continue;
+                }
+                // 近邻重合导致矩阵奇异时退回反距离加权
+            }
+
+            // 先统一算权重再加权求和，循环内无分支
+            if (halfPower == 1.0) {
+                for (int i = 0; i < found; ++i) weight[i] = 1.0 / distSq[i];
+            } else {
+                for (int i = 0; i < found; ++i) weight[i] = std::pow(distSq[i], -halfPower);
+            }
+            double weightSum = 0.0;
+            double estimate = 0.0;
+            for (int i = 0; i < found; ++i) {
+                weightSum += weight[i];
+                estimate += weight[i] * tree.value(index[i]);
+            }
+            out[col] = static_cast<float>(estimate / weightSum);
+        }
+    };
+
+    // 线程池按行块动态领取任务
+    constexpr int ROWS_PER_TASK = 8;
+    const int threads = std::max(1, options.threads > 0 ? options.threads
+                                                        : static_cast<int>(std::thread::hardware_concurrency()));
+    std::atomic<int> nextRow{0};
+    auto worker = [&]() {
+        std::vector<char> inside(grid.width);
+        std::vector<double> crossings;
+        for (int begin = nextRow.fetch_add(ROWS_PER_TASK); begin < grid.height; begin = nextRow.fetch_add(ROWS_PER_TASK)) {
+            const int end = std::min(grid.height, begin + ROWS_PER_TASK);
+            for (int row = begin; row < end; ++row) computeRow(row, inside, crossings);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& thread : pool) thread.join();
+
+    grid.minimum = std::numeric_limits<float>::max();
+    grid.maximum = std::numeric_limits<float>::lowest();
+    for (float v : qAsConst(grid.values)) {
+        if (std::isnan(v)) continue;
+        grid.minimum = std::min(grid.minimum, v);
+        grid.maximum = std::max(grid.maximum, v);
+        ++grid.filled;
+    }
+    if (grid.filled == 0) grid.minimum = grid.maximum = 0.0f;
+    return grid;
+}
+
+bool writeAsciiGrid(const Grid& grid, const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+    const double dLon = (grid.maxLongitude - grid.minLongitude) / grid.width;
+    const double dLat = (grid.maxLatitude - grid.minLatitude) / grid.height;
+    QTextStream out(&file);
+    out.setRealNumberPrecision(10);
+    out << "ncols " << grid.width << '\n'
+        << "nrows " << grid.height << '\n'
+        << "xllcorner " << grid.minLongitude << '\n'
+        << "yllcorner " << grid.minLatitude << '\n';
+    if (std::abs(dLon - dLat) < 1e-12) {
+        out << "cellsize " << dLon << '\n';
+    } else {
+        out << "dx " << dLon << '\n' << "dy " << dLat << '\n';
+    }
+    out << "NODATA_value -9999\n";
+
+    out.setRealNumberPrecision(6);
+    for (int row = 0; row < grid.height; ++row) {
+        const float* line = grid.values.constData() + row * grid.width;
+        for (int col = 0; col < grid.width; ++col) {
+            if (col) out << ' ';
+            if (std::isnan(line[col])) out << -9999;
+            else out << line[col];
+        }
+        out << '\n';
+    }
+    return out.status() == QTextStream::Ok;
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "frame_codec.h"
+#include <QString>
+#include <QVector>
+
+// 水质曲面插值：把散点样本插值到规则经纬度网格。
+// 样本投影到局部等距平面后建 k-d 树，每个格子只取 K 个近邻；
+// 网格按行分块由线程池并行计算，行内先收集近邻距离再统一计算权重，便于编译器向量化。
+namespace SurfaceInterpolation {
+
+enum Method {
+    InverseDistance = 0,    // 反距离加权
+    OrdinaryKriging = 1     // 普通克里金（指数变差函数，由样本自动拟合）
+};
+
+struct Point {
+    double latitude;
+    double longitude;
+    double value;
+};
+
+// 指数模型：γ(h) = nugget + sill · (1 − exp(−3h / range))
+struct Variogram {
+    double nugget = 0.0;
+    double sill = 1.0;      // 偏基台值（不含块金）
+    double range = 1.0;     // 有效变程（米）
+
+    double operator()(double h) const;
+};
+
+struct Options {
+    Method method = InverseDistance;
+    int width = 1000;
+    int height = 1000;
+    int neighbours = 12;
+    double power = 2.0;             // 反距离幂
+    double maxDistance = 0.0;       // 最近样本超过该距离（米）的格子留空，0 表示不限
+    QVector<MissionPoint> mask;     // 非空时只计算多边形内的格子
+    int threads = 0;                // 0 表示使用全部核心
+};
+
+struct Grid {
+    double minLatitude = 0.0;
+    double minLongitude = 0.0;
+    double maxLatitude = 0.0;
+    double maxLongitude = 0.0;
+    int width = 0;
+    int height = 0;
+    QVector<float> values;          // 行优先，第 0 行在北侧；无数据为 NaN
+    Variogram variogram;            // 克里金模式下拟合得到的模型
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+    int filled = 0;                 // 有值的格子数
+};
+
+Grid interpolate(const QVector<Point>& points,
+                 double minLatitude, double minLongitude, double maxLatitude, double maxLongitude,
+                 const Options& options = Options());
+
+// 写出 ESRI ASCII 网格（GDAL 兼容，非正方形格子时使用 dx/dy）
+bool writeAsciiGrid(const Grid& grid, const QString& path);
+
+}
@@ -0,0 +1,221 @@
+#include "surface_layer.h"
+#include "database.h"
+#include "geodesy.h"
+#include "heatmap.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QUrl>
+#include <algorithm>
+#include <cmath>
+
+SurfaceLayer::SurfaceLayer(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QString SurfaceLayer::source() const
+{
+    return available() ? QString("image://surface/%1").arg(m_revision) : QString();
+}
+
+void SurfaceLayer::setResolution(int resolution)
+{
+    resolution = std::clamp(resolution, 16, 4096);
+    if (resolution == m_resolution) return;
+    m_resolution = resolution;
+    emit settingsChanged();
+}
+
+void SurfaceLayer::setMaxDistance(double meters)
+{
+    meters = std::max(0.0, meters);
+    if (meters == m_maxDistance) return;
+    m_maxDistance = meters;
+    emit settingsChanged();
+}
+
+void SurfaceLayer::computeInBox(int channel, int method, const QDateTime& from, const QDateTime& to,
+                                const QGeoCoordinate& topLeft, const QGeoCoordinate& bottomRight)
+{
+    if (!topLeft.isValid() || !bottomRight.isValid()) return;
+    start(channel, method, from, to,
+          std::min(topLeft.latitude(), bottomRight.latitude()), std::min(topLeft.longitude(), bottomRight.longitude()),
+          std::max(topLeft.latitude(), bottomRight.latitude()), std::max(topLeft.longitude(), bottomRight.longitude()),
+          QVector<MissionPoint>());
+}
+
+void SurfaceLayer::computeInPolygon(int channel, int method, const QDateTime& from, const QDateTime& to,
+                                    const QVariantList& path)
+{
+    QVector<MissionPoint> mask;
+    double minLatitude = 90.0, maxLatitude = -90.0, minLongitude = 180.0, maxLongitude = -180.0;
+    for (const QVariant& value : path) {
+        const QGeoCoordinate coordinate = value.value<QGeoCoordinate>();
+        if (!coordinate.isValid()) continue;
+        mask.append({coordinate.longitude(), coordinate.latitude()});
+        minLatitude = std::min(minLatitude, coordinate.latitude());
+        maxLatitude = std::max(maxLatitude, coordinate.latitude());
+        minLongitude = std::min(minLongitude, coordinate.longitude());
+        maxLongitude = std::max(maxLongitude, coordinate.longitude());
+    }
+    if (mask.size() < 3) return;
+    start(channel, method, from, to, minLatitude, minLongitude, maxLatitude, maxLongitude, mask);
+}
+
+void SurfaceLayer::start(int channel, int method, const QDateTime& from, const QDateTime& to,
+                         double minLatitude, double minLongitude, double maxLatitude, double maxLongitude,
+                         const QVector<MissionPoint>& mask)
+{
+    if (!m_database || m_busy) return;
+    if (channel < 0 || channel >= HeatmapSample::CHANNEL_COUNT) return;
+    if (maxLatitude <= minLatitude || maxLongitude <= minLongitude) return;
+    m_busy = true;
+    emit busyChanged();
+
+    // 网格长边取 resolution 格，短边按实际距离比例，使格子接近正方形
+    SurfaceInterpolation::Options options;
+    options.method = method == SurfaceInterpolation::OrdinaryKriging ? SurfaceInterpolation::OrdinaryKriging
+                                                                     : SurfaceInterpolation::InverseDistance;
+    options.maxDistance = m_maxDistance;
+    options.mask = mask;
+    options.threads = QThread::idealThreadCount();
+    const double aspect = (maxLongitude - minLongitude) * std::cos((minLatitude + maxLatitude) / 2 * Geodesy::DEG_TO_RAD)
+                          / (maxLatitude - minLatitude);
+    options.width = aspect >= 1.0 ? m_resolution : std::max(1, qRound(m_resolution * aspect));
+    options.height = aspect >= 1.0 ? std::max(1, qRound(m_resolution / aspect)) : m_resolution;
+
+    GeoSampleQuery query;
+    query.from = from;
+    query.to = to;
+    query.hasArea = true;
+    const double marginLat = (maxLatitude - minLatitude) * SAMPLE_MARGIN;
+    const double marginLon = (maxLongitude - minLongitude) * SAMPLE_MARGIN;
+    query.minLatitude = minLatitude - marginLat;
+    query.maxLatitude = maxLatitude + marginLat;
+    query.minLongitude = minLongitude - marginLon;
+    query.maxLongitude = maxLongitude + marginLon;
+
+    // 数据库线程读取样本，随后交给工作线程插值（内部再按行分给线程池）
+    Database* database = m_database;
+    QMetaObject::invokeMethod(database, [=]() {
+        auto points = std::make_shared<QVector<SurfaceInterpolation::Point>>();
+        database->georeferencedSamples(query, [&points, channel](const QVector<GeoSample>& chunk) {
+            for (const GeoSample& geo : chunk) {
+                const double value = channel == HeatmapSample::Turbidity ? geo.turbidity
+                                   : channel == HeatmapSample::Tds ? geo.tds
+                                   : geo.ph;
+                points->append({geo.latitude, geo.longitude, value});
+            }
+            return true;
+        });
+
+        QMetaObject::invokeMethod(this, [=]() {
+            auto grid = std::make_shared<SurfaceInterpolation::Grid>();
+            auto elapsedMs = std::make_shared<double>(0.0);
+            QThread* worker = QThread::create([=]() {
+                QElapsedTimer timer;
+                timer.start();
+                *grid = SurfaceInterpolation::interpolate(*points, minLatitude, minLongitude,
+                                                          maxLatitude, maxLongitude, options);
+                *elapsedMs = timer.nsecsElapsed() / 1e6;
+            });
+            worker->setObjectName("SurfaceInterpolation");
+            connect(worker, &QThread::finished, this, [=]() {
+                applyResult(grid, channel, options.method, points->size(), *elapsedMs);
+                worker->deleteLater();
+            });
+            worker->start();
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void SurfaceLayer::applyResult(const std::shared_ptr<SurfaceInterpolation::Grid>& grid, int channel, int method,
+                               int samples, double elapsedMs)
+{
+    m_grid = std::move(*grid);
+    m_channel = channel;
+    m_method = method;
+    m_sampleCount = samples;
+    m_elapsedMs = elapsedMs;
+    ++m_revision;
+
+    // 渲染网格：无数据的格子透明
+    QImage image(m_grid.width, m_grid.height, QImage::Format_ARGB32_Premultiplied);
+    const double range = std::max(1e-6, static_cast<double>(m_grid.maximum) - m_grid.minimum);
+    for (int row = 0; row < m_grid.height; ++row) {
+        const float* values = m_grid.values.constData() + row * m_grid.width;
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(row));
+        for (int col = 0; col < m_grid.width; ++col) {
+            line[col] = std::isnan(values[col]) ? qRgba(0, 0, 0, 0)
+                                                : heatmapColor((values[col] - m_grid.minimum) / range, 170);
+        }
+    }
+    {
+        QMutexLocker locker(&m_imageMutex);
+        m_image = image;
+    }
+
+    // MapQuickItem 在 zoomLevel 下按原尺寸显示，取使图像宽度恰好对应网格经度跨度的缩放级别
+    double x0, y0, x1, y1;
+    HeatmapPyramid::project(m_grid.maxLatitude, m_grid.minLongitude, x0, y0);
+    HeatmapPyramid::project(m_grid.minLatitude, m_grid.maxLongitude, x1, y1);
+    const double worldPixels = m_grid.width / std::max(1e-12, x1 - x0);
+    m_coordinate = QGeoCoordinate(m_grid.maxLatitude, m_grid.minLongitude);
+    m_overlayZoom = std::log2(worldPixels / HeatmapLayer::TILE_SIZE);
+    m_overlayWidth = m_grid.width;
+    m_overlayHeight = (y1 - y0) * worldPixels;
+
+    m_busy = false;
+    qDebug() << "水质曲面插值完成，样本数:" << samples << "网格:" << m_grid.width << "x" << m_grid.height
+             << "耗时:" << elapsedMs << "ms";
+    emit busyChanged();
+    emit surfaceChanged();
+    emit computeFinished(samples, elapsedMs);
+}
+
+void SurfaceLayer::clear()
+{
+    if (m_busy) return;
+    m_grid = SurfaceInterpolation::Grid();
+    m_channel = -1;
+    m_sampleCount = 0;
+    {
+        QMutexLocker locker(&m_imageMutex);
+        m_image = QImage();
+    }
+    emit surfaceChanged();
+}
+
+bool SurfaceLayer::exportRaster(const QString& path) const
+{
+    if (!available()) return false;
+    const QUrl url(path);
+    return SurfaceInterpolation::writeAsciiGrid(m_grid, url.isLocalFile() ? url.toLocalFile() : path);
+}
+
+QImage SurfaceLayer::image() const
+{
+    QMutexLocker locker(&m_imageMutex);
+    return m_image;
+}
+
+SurfaceImageProvider::SurfaceImageProvider(const SurfaceLayer* layer)
+    : QQuickImageProvider(QQuickImageProvider::Image)
+    , m_layer(layer)
+{
+}
+
+QImage SurfaceImageProvider::requestImage(const QString& id, QSize* size, const QSize& requestedSize)
+{
+    Q_UNUSED(id);   // 版本号只用于区分缓存
+    Q_UNUSED(requestedSize);
+
+    QImage image = m_layer->image();
+    if (image.isNull()) {
+        image = QImage(1, 1, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+    }
+    if (size) *size = image.size();
+    return image;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "surface_interpolation.h"
+#include <QDateTime>
+#include <QGeoCoordinate>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QQuickImageProvider>
+#include <QVariantList>
+#include <memory>
+
+class Database;
+
+// 水质曲面图层：从历史带位置样本插值出规则网格，渲染成一张图像叠加到地图上。
+// 图像按网格经纬度等间距生成，显示时用 MapQuickItem 按 Web Mercator 缩放，
+// 作业区尺度下两者的纵向差异可以忽略。
+class SurfaceLayer : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+    Q_PROPERTY(bool available READ available NOTIFY surfaceChanged)
+    Q_PROPERTY(int channel READ channel NOTIFY surfaceChanged)
+    Q_PROPERTY(int method READ method NOTIFY surfaceChanged)
+    Q_PROPERTY(QString source READ source NOTIFY surfaceChanged)
+    Q_PROPERTY(QGeoCoordinate coordinate READ coordinate NOTIFY surfaceChanged)
+    Q_PROPERTY(double overlayZoom READ overlayZoom NOTIFY surfaceChanged)
+    Q_PROPERTY(double overlayWidth READ overlayWidth NOTIFY surfaceChanged)
+    Q_PROPERTY(double overlayHeight READ overlayHeight NOTIFY surfaceChanged)
+    Q_PROPERTY(double minimum READ minimum NOTIFY surfaceChanged)
+    Q_PROPERTY(double maximum READ maximum NOTIFY surfaceChanged)
+    Q_PROPERTY(int sampleCount READ sampleCount NOTIFY surfaceChanged)
+    Q_PROPERTY(double elapsedMs READ elapsedMs NOTIFY surfaceChanged)
+    Q_PROPERTY(int resolution READ resolution WRITE setResolution NOTIFY settingsChanged)
+    Q_PROPERTY(double maxDistance READ maxDistance WRITE setMaxDistance NOTIFY settingsChanged)
+public:
+    static constexpr int DEFAULT_RESOLUTION = 1000;         // 网格长边格数
+    static constexpr double DEFAULT_MAX_DISTANCE_M = 200.0;  // 距最近样本超过该距离的格子留空
+    static constexpr double SAMPLE_MARGIN = 0.1;            // 取样范围向外扩展的比例，保证边缘格子有近邻
+
+    explicit SurfaceLayer(QObject *parent = nullptr);
+
+    bool busy() const { return m_busy; }
+    bool available() const { return m_grid.filled > 0; }
+    int channel() const { return m_channel; }
+    int method() const { return m_method; }
+    QString source() const;
+    QGeoCoordinate coordinate() const { return m_coordinate; }
+    double overlayZoom() const { return m_overlayZoom; }
+    double overlayWidth() const { return m_overlayWidth; }
+    double overlayHeight() const { return m_overlayHeight; }
+    double minimum() const { return m_grid.minimum; }
+    double maximum() const { return m_grid.maximum; }
+    int sampleCount() const { return m_sampleCount; }
+    double elapsedMs() const { return m_elapsedMs; }
+    int resolution() const { return m_resolution; }
+    void setResolution(int resolution);
+    double maxDistance() const { return m_maxDistance; }
+    void setMaxDistance(double meters);
+
+    void setDatabase(Database* database) { m_database = database; }
+
+    // channel 取 HeatmapSample::Channel，method 取 SurfaceInterpolation::Method
+    Q_INVOKABLE void computeInBox(int channel, int method, const QDateTime& from, const QDateTime& to,
+                                  const QGeoCoordinate& topLeft, const QGeoCoordinate& bottomRight);
+    // path 为 QGeoCoordinate 列表（如作业区围栏），只计算多边形内的格子
+    Q_INVOKABLE void computeInPolygon(int channel, int method, const QDateTime& from, const QDateTime& to,
+                                      const QVariantList& path);
+    Q_INVOKABLE void clear();
+    // 导出 ESRI ASCII 网格（.asc），可直接在 GIS 软件中作为栅格图层打开
+    Q_INVOKABLE bool exportRaster(const QString& path) const;
+
+    // 可在图像加载线程中调用
+    QImage image() const;
+
+signals:
+    void busyChanged();
+    void surfaceChanged();
+    void settingsChanged();
+    void computeFinished(int samples, double elapsedMs);
+
+private:
+    void start(int channel, int method, const QDateTime& from, const QDateTime& to,
+               double minLatitude, double minLongitude, double maxLatitude, double maxLongitude,
+               const QVector<MissionPoint>& mask);
+    void applyResult(const std::shared_ptr<SurfaceInterpolation::Grid>& grid, int channel, int method,
+                     int samples, double elapsedMs);
+
+    Database* m_database = nullptr;
+    bool m_busy = false;
+    int m_channel = -1;
+    int m_method = SurfaceInterpolation::InverseDistance;
+    int m_resolution = DEFAULT_RESOLUTION;
+    double m_maxDistance = DEFAULT_MAX_DISTANCE_M;
+
+    SurfaceInterpolation::Grid m_grid;
+    int m_sampleCount = 0;
+    double m_elapsedMs = 0.0;
+    int m_revision = 0;
+    QGeoCoordinate m_coordinate;
+    double m_overlayZoom = 0.0;
+    double m_overlayWidth = 0.0;
+    double m_overlayHeight = 0.0;
+
+    mutable QMutex m_imageMutex;    // 保护 m_image
+    QImage m_image;
+};
+
+// image://surface/<revision>
+class SurfaceImageProvider : public QQuickImageProvider {
+public:
+    explicit SurfaceImageProvider(const SurfaceLayer* layer);
+
+    QImage requestImage(const QString& id, QSize* size, const QSize& requestedSize) override;
+
+private:
+    const SurfaceLayer* m_layer;
+};
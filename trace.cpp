@@ -0,0 +1,249 @@
+#include "trace.h"
+#include "metrics.h"
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Trace {
+
+namespace detail {
+std::atomic<quint32> categoryMask{0xFFFFFFFFu};
+std::atomic<quint8> minimumLevel{static_cast<quint8>(Level::Debug)};
+}
+
+namespace {
+
+static_assert((RING_CAPACITY & (RING_CAPACITY - 1)) == 0, "RING_CAPACITY 必须是 2 的幂");
+
+const int MAX_RINGS = 64;   // 最多记录的线程数，超出的线程不再记录
+
+// 单写者环形缓冲区：只有所属线程写入，导出时按 head 读取最近 RING_CAPACITY 条
+struct ThreadRing {
+    Record records[RING_CAPACITY];
+    std::atomic<quint64> head{0};
+    quint32 threadId = 0;
+};
+
+std::atomic<ThreadRing*> g_rings[MAX_RINGS];
+std::atomic<int> g_ringCount{0};
+
+const char* g_eventNames[MAX_EVENTS];
+std::atomic<int> g_eventCount{0};
+QMutex g_eventMutex;
+
+thread_local ThreadRing* t_ring = nullptr;
+thread_local bool t_ringExhausted = false;
+
+const char* const CATEGORY_NAMES[] = {
+    "serial", "framing", "simulation", "ui", "database", "command"
+};
+const char* const LEVEL_NAMES[] = { "debug", "info", "warning" };
+
+#ifdef Q_OS_UNIX
+int g_crashFd = -1;
+#else
+std::FILE* g_crashFile = nullptr;
+#endif
+
+ThreadRing* currentRing()
+{
+    if (t_ring || t_ringExhausted) return t_ring;
+
+    const int slot = g_ringCount.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= MAX_RINGS) {
+        t_ringExhausted = true;
+        return nullptr;
+    }
+
+    // 缓冲区不释放：线程退出后其记录仍可导出，崩溃处理也无需同步
+    ThreadRing* ring = new ThreadRing;
+    ring->threadId = static_cast<quint32>(slot);
+    g_rings[slot].store(ring, std::memory_order_release);
+    t_ring = ring;
+    return ring;
+}
+
+void crashWrite(const void* data, size_t size)
+{
+#ifdef Q_OS_UNIX
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::write(g_crashFd, p, size);
+        if (n <= 0) return;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+#else
+    std::fwrite(data, 1, size, g_crashFile);
+#endif
+}
+
+// 崩溃时只调用可重入的写操作：事件名表 + 每个线程的原始记录
+void crashHandler(int sig)
+{
+    const char magic[8] = {'U', 'S', 'V', 'T', 'R', 'C', '0', '1'};
+    crashWrite(magic, sizeof(magic));
+
+    const qint32 eventCount = qMin(g_eventCount.load(std::memory_order_acquire), MAX_EVENTS);
+    crashWrite(&eventCount, sizeof(eventCount));
+    for (int i = 0; i < eventCount; ++i) {
+        const char* name = g_eventNames[i] ? g_eventNames[i] : "";
+        const quint16 len = static_cast<quint16>(std::strlen(name));
+        crashWrite(&len, sizeof(len));
+        crashWrite(name, len);
+    }
+
+    const qint32 ringCount = qMin(g_ringCount.load(std::memory_order_acquire), MAX_RINGS);
+    crashWrite(&ringCount, sizeof(ringCount));
+    for (int i = 0; i < ringCount; ++i) {
+        ThreadRing* ring = g_rings[i].load(std::memory_order_acquire);
+        const quint64 head = ring ? ring->head.load(std::memory_order_acquire) : 0;
+        crashWrite(&head, sizeof(head));
+        if (ring) crashWrite(ring->records, sizeof(ring->records));
+    }
+
+#ifdef Q_OS_UNIX
+    ::fsync(g_crashFd);
+#else
+    std::fflush(g_crashFile);
+#endif
+
+    std::signal(sig, SIG_DFL);
+    std::raise(sig);
+}
+
+}
+
+quint16 registerEvent(const char* name)
+{
+    QMutexLocker locker(&g_eventMutex);
+    const int count = g_eventCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (std::strcmp(g_eventNames[i], name) == 0) return static_cast<quint16>(i);
+    }
+    if (count >= MAX_EVENTS) {
+        qWarning() << "追踪事件数超出上限:" << name;
+        return static_cast<quint16>(MAX_EVENTS - 1);
+    }
+    g_eventNames[count] = name;
+    g_eventCount.store(count + 1, std::memory_order_release);
+    return static_cast<quint16>(count);
+}
+
+void setMinimumLevel(Level level)
+{
+    detail::minimumLevel.store(static_cast<quint8>(level), std::memory_order_relaxed);
+}
+
+void setCategoryEnabled(Category category, bool enabled)
+{
+    const quint32 bit = 1u << static_cast<quint8>(category);
+    if (enabled) {
+        detail::categoryMask.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        detail::categoryMask.fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+void record(quint16 eventId, Category category, Level level, qint64 a0, qint64 a1, qint64 a2)
+{
+    ThreadRing* ring = currentRing();
+    if (!ring) return;
+
+    const quint64 index = ring->head.load(std::memory_order_relaxed);
+    Record& r = ring->records[index & (RING_CAPACITY - 1)];
+    r.timestampNs = MetricsClock::nowNs();
+    r.threadId = ring->threadId;
+    r.eventId = eventId;
+    r.category = static_cast<quint8>(category);
+    r.level = static_cast<quint8>(level);
+    r.args[0] = a0;
+    r.args[1] = a1;
+    r.args[2] = a2;
+    ring->head.store(index + 1, std::memory_order_release);
+}
+
+bool dumpText(const QString& path)
+{
+    // 导出为尽力而为：写线程仍在运行时，最旧的几条记录可能已被覆盖
+    std::vector<Record> all;
+    const int ringCount = qMin(g_ringCount.load(std::memory_order_acquire), MAX_RINGS);
+    for (int i = 0; i < ringCount; ++i) {
+        ThreadRing* ring = g_rings[i].load(std::memory_order_acquire);
+        if (!ring) continue;
+        const quint64 head = ring->head.load(std::memory_order_acquire);
+        const quint64 first = head > quint64(RING_CAPACITY) ? head - RING_CAPACITY : 0;
+        for (quint64 k = first; k < head; ++k) {
+            all.push_back(ring->records[k & (RING_CAPACITY - 1)]);
+        }
+    }
+    std::sort(all.begin(), all.end(), [](const Record& a, const Record& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        qWarning() << "无法写入追踪文件:" << path << file.errorString();
+        return false;
+    }
+
+    const int eventCount = qMin(g_eventCount.load(std::memory_order_acquire), MAX_EVENTS);
+    QTextStream out(&file);
+    out << "# timestamp_ns thread category level event a0 a1 a2\n";
+    for (const Record& r : all) {
+        const char* name = r.eventId < eventCount ? g_eventNames[r.eventId] : "?";
+        const char* category = r.category < static_cast<quint8>(Category::CategoryCount)
+                                   ? CATEGORY_NAMES[r.category] : "?";
+        const char* level = r.level <= static_cast<quint8>(Level::Warning) ? LEVEL_NAMES[r.level] : "?";
+        out << r.timestampNs << ' ' << r.threadId << ' ' << category << ' ' << level << ' '
+            << name << ' ' << r.args[0] << ' ' << r.args[1] << ' ' << r.args[2] << '\n';
+    }
+    return true;
+}
+
+void installCrashHandler(const QString& path)
+{
+#ifdef Q_OS_UNIX
+    if (g_crashFd >= 0) ::close(g_crashFd);
+    g_crashFd = ::open(QFile::encodeName(path).constData(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (g_crashFd < 0) {
+        qWarning() << "无法创建崩溃追踪文件:" << path;
+        return;
+    }
+#else
+    if (g_crashFile) std::fclose(g_crashFile);
+    g_crashFile = std::fopen(QFile::encodeName(path).constData(), "wb");
+    if (!g_crashFile) {
+        qWarning() << "无法创建崩溃追踪文件:" << path;
+        return;
+    }
+#endif
+
+    std::signal(SIGSEGV, crashHandler);
+    std::signal(SIGABRT, crashHandler);
+    std::signal(SIGFPE, crashHandler);
+    std::signal(SIGILL, crashHandler);
+}
+
+}
+
+bool TraceController::compiledIn() const
+{
+#ifdef USV_TRACE_ENABLED
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+
+// 结构化追踪：二进制记录写入每线程环形缓冲区，按需或崩溃时导出。
+// 编译开关 USV_TRACE_ENABLED（qmake CONFIG+=usv_trace）关闭时，USV_TRACE 宏展开为空，
+// 参数不求值、不做任何格式化。
+namespace Trace {
+
+enum class Category : quint8 {
+    Serial = 0,     // 串口读取
+    Framing,        // 帧切分
+    Simulation,     // 模拟数据
+    Ui,             // 界面发布
+    Database,       // 数据库
+    Command,        // 下行指令
+    CategoryCount
+};
+
+enum class Level : quint8 {
+    Debug = 0,
+    Info,
+    Warning
+};
+
+// 单条记录（定长 40 字节），事件名通过 eventId 查表
+struct Record {
+    qint64 timestampNs;
+    quint32 threadId;
+    quint16 eventId;
+    quint8 category;
+    quint8 level;
+    qint64 args[3];
+};
+
+const int RING_CAPACITY = 8192;   // 每线程记录数（2 的幂）
+const int MAX_EVENTS = 256;       // 最多可注册的事件名
+
+namespace detail {
+extern std::atomic<quint32> categoryMask;
+extern std::atomic<quint8> minimumLevel;
+}
+
+// 注册事件名（每个调用点只执行一次），name 必须是静态字符串
+quint16 registerEvent(const char* name);
+// 运行时最低级别与分类掩码
+void setMinimumLevel(Level level);
+void setCategoryEnabled(Category category, bool enabled);
+
+inline bool isEnabled(Category category, Level level)
+{
+    return static_cast<quint8>(level) >= detail::minimumLevel.load(std::memory_order_relaxed)
+           && (detail::categoryMask.load(std::memory_order_relaxed) & (1u << static_cast<quint8>(category)));
+}
+
+// 写入当前线程的环形缓冲区
+void record(quint16 eventId, Category category, Level level, qint64 a0, qint64 a1, qint64 a2);
+// 按时间合并所有线程的记录并以文本导出
+bool dumpText(const QString& path);
+// 安装崩溃处理：收到致命信号时把原始记录以二进制写入 path
+void installCrashHandler(const QString& path);
+
+}
+
+#ifdef USV_TRACE_ENABLED
+#define USV_TRACE_IMPL(cat, lvl, name, a0, a1, a2)                                          \
+    do {                                                                                   \
+        if (Trace::isEnabled(cat, lvl)) {                                                  \
+            static const quint16 usvTraceEventId = Trace::registerEvent(name);             \
+            Trace::record(usvTraceEventId, cat, lvl, qint64(a0), qint64(a1), qint64(a2));  \
+        }                                                                                  \
+    } while (0)
+#else
+#define USV_TRACE_IMPL(cat, lvl, name, a0, a1, a2) do {} while (0)
+#endif
+
+#define USV_TRACE0(cat, lvl, name) USV_TRACE_IMPL(cat, lvl, name, 0, 0, 0)
+#define USV_TRACE1(cat, lvl, name, a0) USV_TRACE_IMPL(cat, lvl, name, a0, 0, 0)
+#define USV_TRACE2(cat, lvl, name, a0, a1) USV_TRACE_IMPL(cat, lvl, name, a0, a1, 0)
+#define USV_TRACE3(cat, lvl, name, a0, a1, a2) USV_TRACE_IMPL(cat, lvl, name, a0, a1, a2)
+
+// 暴露给 QML 的追踪控制（按需导出）
+class TraceController : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool compiledIn READ compiledIn CONSTANT)
+public:
+    explicit TraceController(QObject *parent = nullptr) : QObject(parent) {}
+
+    bool compiledIn() const;
+    Q_INVOKABLE bool dump(const QString& path) { return Trace::dumpText(path); }
+};
@@ -0,0 +1,166 @@
+#include "trend_analysis.h"
+#include <algorithm>
+#include <cmath>
+
+namespace TrendAnalysis {
+
+namespace {
+
+constexpr double SECONDS_PER_DAY = 86400.0;
+constexpr int HOURS_PER_DAY = 24;
+
+bool cancelled(const std::atomic<bool>* cancel)
+{
+    return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+}
+
+void movingStatistics(const QVector<double>& seconds, const QVector<float>& values, double windowSeconds,
+                      QVector<double>& mean, QVector<double>& deviation)
+{
+    const int n = values.size();
+    mean.resize(n);
+    deviation.resize(n);
+    if (n == 0) return;
+
+    double offset = 0.0;
+    for (float value : values) offset += value;
+    offset /= n;
+
+    // sum[k]、squares[k] 为前 k 个样本（减去 offset 后）的和与平方和
+    QVector<double> sum(n + 1), squares(n + 1);
+    sum[0] = squares[0] = 0.0;
+    for (int k = 0; k < n; ++k) {
+        const double x = values[k] - offset;
+        sum[k + 1] = sum[k] + x;
+        squares[k + 1] = squares[k] + x * x;
+    }
+
+    int begin = 0;
+    for (int i = 0; i < n; ++i) {
+        while (seconds[i] - seconds[begin] > windowSeconds) ++begin;
+        const int count = i - begin + 1;
+        const double s1 = sum[i + 1] - sum[begin];
+        const double s2 = squares[i + 1] - squares[begin];
+        const double average = s1 / count;
+        mean[i] = average + offset;
+        deviation[i] = count > 1 ? std::sqrt(std::max(0.0, (s2 - s1 * average) / (count - 1))) : 0.0;
+    }
+}
+
+Result analyze(const QVector<double>& seconds, const QVector<float>& values, const Options& options,
+               const std::atomic<bool>* cancel)
+{
+    Result result;
+    const int n = values.size();
+    result.count = n;
+    if (n == 0) return result;
+    const double scale = options.scale;
+
+    // 整体统计与回归：时间、数值都先取均值再累加离差积
+    double timeMean = 0.0, valueMean = 0.0;
+    float minimum = values[0], maximum = values[0];
+    for (int k = 0; k < n; ++k) {
+        timeMean += seconds[k];
+        valueMean += values[k];
+        minimum = std::min(minimum, values[k]);
+        maximum = std::max(maximum, values[k]);
+    }
+    timeMean /= n;
+    valueMean /= n;
+
+    double sxx = 0.0, sxy = 0.0, syy = 0.0;
+    double hourSum[HOURS_PER_DAY] = {};
+    int hourCount[HOURS_PER_DAY] = {};
+    for (int k = 0; k < n; ++k) {
+        const double dt = seconds[k] - timeMean;
+        const double dv = values[k] - valueMean;
+        sxx += dt * dt;
+        sxy += dt * dv;
+        syy += dv * dv;
+
+        // 序列时间为本地时间按 UTC 计的秒数，取模即为本地钟点
+        const int hour = std::clamp(static_cast<int>(std::fmod(seconds[k], SECONDS_PER_DAY) / 3600.0),
+                                    0, HOURS_PER_DAY - 1);
+        hourSum[hour] += values[k];
+        ++hourCount[hour];
+    }
+    const double slope = sxx > 0.0 ? sxy / sxx : 0.0;
+
+    result.mean = valueMean * scale;
+    result.minimum = minimum * scale;
+    result.maximum = maximum * scale;
+    result.slopePerDay = slope * SECONDS_PER_DAY * scale;
+    result.r2 = sxx > 0.0 && syy > 0.0 ? sxy * sxy / (sxx * syy) : 0.0;
+    result.residualStd = n > 2 ? std::sqrt(std::max(0.0, (syy - slope * sxy) / (n - 2))) * std::abs(scale) : 0.0;
+
+    double peak = 0.0, trough = 0.0;
+    for (int hour = 0; hour < HOURS_PER_DAY; ++hour) {
+        if (hourCount[hour] == 0) continue;
+        const double average = hourSum[hour] / hourCount[hour];
+        if (result.peakHour < 0 || average > peak) {
+            peak = average;
+            result.peakHour = hour;
+        }
+        if (result.troughHour < 0 || average < trough) {
+            trough = average;
+            result.troughHour = hour;
+        }
+    }
+    result.dailyAmplitude = (peak - trough) * std::abs(scale);
+
+    auto point = [&](int k, double value) { return QPointF(seconds[k] * 1000.0, value * scale); };
+    result.trend = {
+        point(0, valueMean + slope * (seconds[0] - timeMean)),
+        point(n - 1, valueMean + slope * (seconds[n - 1] - timeMean))
+    };
+
+    if (cancelled(cancel)) {
+        result.cancelled = true;
+        return result;
+    }
+
+    // 原始曲线：每个桶保留最小、最大两点（按时间先后），抽稀后不丢尖峰
+    const int buckets = std::max(1, std::min(n, options.maxPoints / 2));
+    result.raw.reserve(buckets * 2);
+    for (int b = 0; b < buckets; ++b) {
+        const int begin = static_cast<int>(static_cast<qint64>(n) * b / buckets);
+        const int end = static_cast<int>(static_cast<qint64>(n) * (b + 1) / buckets);
+        int low = begin, high = begin;
+        for (int k = begin + 1; k < end; ++k) {
+            if (values[k] < values[low]) low = k;
+            if (values[k] > values[high]) high = k;
+        }
+        result.raw.append(point(std::min(low, high), values[std::min(low, high)]));
+        if (low != high) result.raw.append(point(std::max(low, high), values[std::max(low, high)]));
+    }
+
+    if (cancelled(cancel)) {
+        result.cancelled = true;
+        return result;
+    }
+
+    QVector<double> mean, deviation;
+    movingStatistics(seconds, values, options.windowSeconds, mean, deviation);
+    if (cancelled(cancel)) {
+        result.cancelled = true;
+        return result;
+    }
+
+    // 平滑曲线等间隔取点，并保证包含最后一个样本
+    const int stride = std::max(1, (n + options.maxPoints - 1) / std::max(1, options.maxPoints));
+    auto appendSmooth = [&](int k) {
+        result.movingAverage.append(point(k, mean[k]));
+        result.upper.append(point(k, mean[k] + options.bandWidth * deviation[k]));
+        result.lower.append(point(k, mean[k] - options.bandWidth * deviation[k]));
+    };
+    result.movingAverage.reserve(n / stride + 2);
+    result.upper.reserve(n / stride + 2);
+    result.lower.reserve(n / stride + 2);
+    for (int k = 0; k < n; k += stride) appendSmooth(k);
+    if ((n - 1) % stride != 0) appendSmooth(n - 1);
+    return result;
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QPointF>
+#include <QVector>
+#include <atomic>
+
+// 历史序列的趋势分析：移动平均、滚动标准差带与线性趋势。
+// 滚动统计用前缀和 Σx、Σx² 加双指针求时间窗口，任意窗口长度都是 O(n)；
+// 前缀和之前先减去序列均值，避免大数相减损失精度。
+// 输出点的 x 为序列时间（秒）× 1000，y 已乘 scale，抽稀后可直接交给 QXYSeries::replace
+namespace TrendAnalysis {
+
+struct Options {
+    double windowSeconds = 86400.0;     // 移动窗口长度（向前取）
+    double bandWidth = 2.0;             // 带宽：均值 ± bandWidth·σ
+    int maxPoints = 2000;               // 每条曲线的最多点数
+    double scale = 1.0;                 // 输出前乘以该系数（单位换算）
+};
+
+struct Result {
+    QVector<QPointF> raw;               // 每个时间桶取最小、最大两点，保留尖峰
+    QVector<QPointF> movingAverage;
+    QVector<QPointF> upper;
+    QVector<QPointF> lower;
+    QVector<QPointF> trend;             // 回归直线的两个端点
+
+    int count = 0;
+    double mean = 0.0;
+    double minimum = 0.0;
+    double maximum = 0.0;
+    double slopePerDay = 0.0;           // 回归斜率（单位/天）
+    double r2 = 0.0;
+    double residualStd = 0.0;           // 回归残差的标准差
+    // 日内规律：按一天中的小时求均值
+    int peakHour = -1;
+    int troughHour = -1;
+    double dailyAmplitude = 0.0;        // 小时均值的最大值减最小值
+    bool cancelled = false;
+};
+
+// 以 i 结尾、时间跨度不超过 windowSeconds 的窗口的均值与标准差（样本标准差，单点窗口为 0）
+void movingStatistics(const QVector<double>& seconds, const QVector<float>& values, double windowSeconds,
+                      QVector<double>& mean, QVector<double>& deviation);
+
+// cancel 非空时在各阶段之间检查，置位后尽快返回 cancelled 的结果
+Result analyze(const QVector<double>& seconds, const QVector<float>& values, const Options& options = Options(),
+               const std::atomic<bool>* cancel = nullptr);
+
+}
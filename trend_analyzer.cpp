@@ -0,0 +1,158 @@
+#include "trend_analyzer.h"
+#include "alarm_engine.h"
+#include "database.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QtCharts/QXYSeries>
+#include <algorithm>
+
+QT_CHARTS_USE_NAMESPACE
+
+namespace {
+
+const QString JOB_GROUP = QStringLiteral("trend");
+
+// 序列时间是本地时间按 UTC 计的毫秒数，换成 DateTimeAxis 使用的真实时间戳
+void toLocalTime(QVector<QPointF>& points)
+{
+    for (QPointF& point : points) {
+        QDateTime time = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(point.x()), Qt::UTC);
+        time.setTimeSpec(Qt::LocalTime);
+        point.setX(time.toMSecsSinceEpoch());
+    }
+}
+
+}
+
+TrendAnalyzer::TrendAnalyzer(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void TrendAnalyzer::cancel()
+{
+    JobScheduler::instance().cancelGroup(JOB_GROUP);
+}
+
+void TrendAnalyzer::release()
+{
+    if (--m_running == 0) emit busyChanged();
+}
+
+void TrendAnalyzer::request(int requestId, const QString& key, const QDateTime& from, const QDateTime& to,
+                            double windowHours, int vesselId)
+{
+    const int channel = AlarmEvaluator::channelFromKey(key);
+    if (!m_database || channel < 0 || !(from < to)) return;
+
+    TrendAnalysis::Options options;
+    if (windowHours <= 0.0) windowHours = std::clamp(from.secsTo(to) / 3600.0 / 7.0, 1.0, 24.0);
+    options.windowSeconds = windowHours * 3600.0;
+    options.bandWidth = BAND_WIDTH;
+    // 帧中甲醛以 0.001 mg/m³ 为单位，按 mg/m³ 输出
+    options.scale = channel == AlarmEvaluator::Ch2o ? 0.001 : 1.0;
+
+    const ResultKey cacheKey{QString("%1/%2@%3h").arg(vesselId).arg(key).arg(windowHours), from, to, options.maxPoints};
+    const JobScheduler::CancelFlag token = JobScheduler::instance().supersede(JOB_GROUP);
+    if (m_running++ == 0) emit busyChanged();
+
+    if (auto cached = m_cache.find(cacheKey)) {
+        QMetaObject::invokeMethod(this, [=]() {
+            if (!token->load()) publish(requestId, key, windowHours, cached, 0.0);
+            release();
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    // 数据库线程读取序列，调度器中计算；每一步之前检查是否已被新请求取代
+    Database* database = m_database;
+    QMetaObject::invokeMethod(database, [=]() {
+        auto series = std::make_shared<SensorSeries>();
+        const QDateTime loadedAt = QDateTime::currentDateTime();
+        if (!token->load()) database->sensorSeries(from, to, vesselId, *series);
+
+        auto result = std::make_shared<TrendAnalysis::Result>();
+        auto elapsedMs = std::make_shared<double>(0.0);
+        JobScheduler::instance().submit(token, JobScheduler::Interactive, this,
+            [=](const std::atomic<bool>& cancelled) {
+                QElapsedTimer timer;
+                timer.start();
+                *result = TrendAnalysis::analyze(series->seconds, series->channels[channel], options, &cancelled);
+                if (!result->cancelled) {
+                    for (QVector<QPointF>* points : {&result->raw, &result->movingAverage, &result->upper,
+                                                     &result->lower, &result->trend}) {
+                        toLocalTime(*points);
+                    }
+                }
+                *elapsedMs = timer.nsecsElapsed() / 1e6;
+            },
+            [=](bool cancelled) {
+                if (!cancelled && !result->cancelled) {
+                    if (ResultCache<TrendAnalysis::Result>::cacheable(cacheKey, loadedAt)) {
+                        m_cache.insert(cacheKey, result, result->raw.size() + result->movingAverage.size() * 3);
+                    }
+                    publish(requestId, key, windowHours, result, *elapsedMs);
+                }
+                release();
+            });
+    }, Qt::QueuedConnection);
+}
+
+void TrendAnalyzer::publish(int requestId, const QString& key, double windowHours,
+                            const std::shared_ptr<const TrendAnalysis::Result>& result, double elapsedMs)
+{
+    m_result = result;
+
+    QVariantMap stats{
+        {"count", m_result->count},
+        {"mean", m_result->mean},
+        {"minimum", m_result->minimum},
+        {"maximum", m_result->maximum},
+        {"slopePerDay", m_result->slopePerDay},
+        {"r2", m_result->r2},
+        {"residualStd", m_result->residualStd},
+        {"peakHour", m_result->peakHour},
+        {"troughHour", m_result->troughHour},
+        {"dailyAmplitude", m_result->dailyAmplitude},
+        {"windowHours", windowHours}
+    };
+    if (!m_result->trend.isEmpty()) {
+        stats["start"] = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(m_result->trend.first().x()));
+        stats["end"] = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(m_result->trend.last().x()));
+        stats["trendEnd"] = m_result->trend.last().y();
+    }
+    qDebug() << "趋势分析完成，样本数:" << m_result->count << "窗口:" << windowHours << "h"
+             << "耗时:" << elapsedMs << "ms";
+    emit analysisFinished(requestId, key, stats, elapsedMs);
+}
+
+bool TrendAnalyzer::updateSeries(QAbstractSeries* series, int role) const
+{
+    QXYSeries* xySeries = qobject_cast<QXYSeries*>(series);
+    if (!xySeries) return false;
+    if (!m_result) {
+        xySeries->clear();
+        return true;
+    }
+
+    switch (role) {
+    case Raw:
+        xySeries->replace(m_result->raw);
+        break;
+    case MovingAverage:
+        xySeries->replace(m_result->movingAverage);
+        break;
+    case Upper:
+        xySeries->replace(m_result->upper);
+        break;
+    case Lower:
+        xySeries->replace(m_result->lower);
+        break;
+    case Trend:
+        xySeries->replace(m_result->trend);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
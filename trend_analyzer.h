@@ -0,0 +1,52 @@
+#pragma once
+
+#include "database.h"
+#include "job_scheduler.h"
+#include "trend_analysis.h"
+#include <QDateTime>
+#include <QObject>
+#include <QVariantMap>
+#include <QtCharts/QAbstractSeries>
+#include <memory>
+
+// 历史趋势分析服务：数据库线程读取序列，JobScheduler 中计算移动平均、标准差带与回归趋势。
+// 新请求会取消尚未完成的旧请求；已结束区间的结果按（船只、通道与窗口, 区间, 点数）缓存。
+// 曲线数据留在 C++ 侧，由 QML 调用 updateSeries 一次性替换
+class TrendAnalyzer : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+public:
+    enum Role { Raw = 0, MovingAverage, Upper, Lower, Trend };
+    Q_ENUM(Role)
+
+    static constexpr double BAND_WIDTH = 2.0;
+    static constexpr qint64 RESULT_CACHE_POINTS = 200000;   // 缓存结果的曲线点数上限
+
+    explicit TrendAnalyzer(QObject *parent = nullptr);
+
+    bool busy() const { return m_running > 0; }
+    void setDatabase(Database* database) { m_database = database; }
+
+    // windowHours <= 0 时按区间长度自动选择（区间的 1/7，限制在 1 ~ 24 小时）；只分析 vesselId 的记录，默认为本船
+    Q_INVOKABLE void request(int requestId, const QString& key, const QDateTime& from, const QDateTime& to,
+                             double windowHours = 0.0, int vesselId = PRIMARY_VESSEL_ID);
+    Q_INVOKABLE void cancel();
+    // 用最近一次结果替换曲线数据（QXYSeries::replace，只触发一次重绘）；series 不是折线/散点时返回 false
+    Q_INVOKABLE bool updateSeries(QtCharts::QAbstractSeries* series, int role) const;
+
+signals:
+    void busyChanged();
+    // stats: {count, mean, minimum, maximum, slopePerDay, r2, residualStd,
+    //         peakHour, troughHour, dailyAmplitude, windowHours, start, end, trendEnd（趋势线终点的值）}
+    void analysisFinished(int requestId, const QString& key, const QVariantMap& stats, double elapsedMs);
+
+private:
+    void release();
+    void publish(int requestId, const QString& key, double windowHours,
+                 const std::shared_ptr<const TrendAnalysis::Result>& result, double elapsedMs);
+
+    Database* m_database = nullptr;
+    int m_running = 0;              // 已发起、尚未结束（含已取消）的请求数
+    std::shared_ptr<const TrendAnalysis::Result> m_result;
+    ResultCache<TrendAnalysis::Result> m_cache{RESULT_CACHE_POINTS};
+};
@@ -69,6 +69,7 @@ void VesselModule::parseData(const QString& data) {
     m_displayData["latitude"] = latitude;
     m_displayData["speed"] = speed;
     m_displayData["heading"] = heading;
+    m_odometer.add(latitude, longitude);
 
     // 发送信号
     emit vesselDataParsed(latitude, longitude, speed, heading);
@@ -76,6 +77,11 @@ void VesselModule::parseData(const QString& data) {
 }
 
 
+void VesselModule::resetOdometer() {
+    m_odometer.reset();
+    emit displayDataChanged();
+}
+
 void VesselModule::updateData() {
     // Simulation data update is handled in DataSource
 }
@@ -2,6 +2,7 @@
 #define VESSEL_MODULE_H
 
 #include "visualization_base.h"
+#include "geodesy.h"
 
 class VesselModule : public VisualizationBase {
     Q_OBJECT
@@ -9,6 +10,7 @@ class VesselModule : public VisualizationBase {
     Q_PROPERTY(double longitude READ longitude NOTIFY displayDataChanged)
     Q_PROPERTY(double speed READ speed NOTIFY displayDataChanged)
     Q_PROPERTY(double heading READ heading NOTIFY displayDataChanged)
+    Q_PROPERTY(double odometer READ odometer NOTIFY displayDataChanged)
 
 public:
     explicit VesselModule(QObject *parent = nullptr);
@@ -18,7 +20,10 @@ public:
     double longitude() const { return m_displayData["longitude"].toDouble(); }
     double speed() const { return m_displayData["speed"].toDouble(); }
     double heading() const { return m_displayData["heading"].toDouble(); }
+    // 本次运行累计航程（米）
+    double odometer() const { return m_odometer.total(); }
 
+    Q_INVOKABLE void resetOdometer();
 
 signals:
     void vesselDataParsed(double latitude, double longitude, double speed, double heading);
@@ -29,6 +34,8 @@ protected:
 public slots:
     void updateData() override;
 
+private:
+    Geodesy::Odometer m_odometer;
 
 };
 
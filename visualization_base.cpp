@@ -1,11 +1,18 @@
 //visualization_base.cpp
 #include "visualization_base.h"
+#include "metrics.h"
+#include "latency_tracer.h"
 
 VisualizationBase::VisualizationBase(QObject *parent)
     : QObject(parent) {}
 
 void VisualizationBase::receiveData(const QString& data) {
-    parseData(data);
+    {
+        // parseData 中同步发出的信号会在槽里排队写库，那部分时间由内层 Scope 计入 DbEnqueue
+        LatencyTracer::Scope moduleScope(LatencyTracer::ModuleUpdate);
+        MetricScopeTimer parseTimer(MetricsRegistry::instance().parseLatency);
+        parseData(data);
+    }
     emit displayDataChanged();
 }
 